@@ -0,0 +1,132 @@
+#include "AudioBank.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+using namespace Aftr;
+using namespace irrklang;
+
+namespace
+{
+    // Effects are small and latency sensitive: decoded once at load. Music is minutes long: streamed.
+    const AudioBank::Asset assets[] = {
+        { SoundId::EXPLOSION, "explosion.wav", SoundId::COUNT, ESM_NO_STREAMING, 1.0f, 10.0f },
+        { SoundId::DOPPLER, "doppler.wav", SoundId::COUNT, ESM_NO_STREAMING, 1.0f, 10.0f },
+        { SoundId::ENGINE_LOOP, "engine.synth", SoundId::DOPPLER, ESM_STREAMING, 0.8f, 15.0f }, // Generated: always streams
+        { SoundId::LULLABY, "media_Subwoofer_Lullaby.ogg", SoundId::COUNT, ESM_STREAMING, 0.5f, 1.0f },
+        { SoundId::SPACE, "space.ogg", SoundId::COUNT, ESM_STREAMING, 0.5f, 1.0f },
+        { SoundId::TRAFFIC_ENGINE, "airplane-fly-by-01a.wav", SoundId::DOPPLER, ESM_NO_STREAMING, 0.8f, 15.0f },
+    };
+    static_assert(sizeof(assets) / sizeof(assets[0]) == static_cast<size_t>(SoundId::COUNT), "Every SoundId needs an asset entry");
+}
+
+const AudioBank::Asset& AudioBank::getAsset(SoundId id)
+{
+    return assets[static_cast<int>(id)];
+}
+
+int AudioBank::load(ISoundEngine* soundEngine, const std::string& soundFolder)
+{
+    clear();
+    engine = soundEngine;
+    if (engine == nullptr)
+    {
+        printf("AudioBank: no sound engine; all sounds are silent\n");
+        return 0;
+    }
+
+    AudioPackFileFactory* factory = new AudioPackFileFactory();
+    if (factory->open(soundFolder + "/" + PackName))
+    {
+        engine->addFileFactory(factory); // The engine holds its own reference
+        pack = factory;
+        printf("AudioBank: reading sounds from %s/%s (%u files)\n", soundFolder.c_str(), PackName, factory->getPack().getEntryCount());
+    }
+    else
+    {
+        factory->drop();
+    }
+
+    synth = new EngineSynthLoader();
+    engine->registerAudioStreamLoader(synth); // Also held by the engine
+
+    int loaded = 0;
+    for (const Asset& a : assets)
+    {
+        const std::string path = soundFolder + "/" + a.file;
+        ISoundSource* source = nullptr;
+        if ((pack != nullptr && pack->contains(a.file)) || std::ifstream(path))
+            source = engine->addSoundSourceFromFile(path.c_str(), a.mode, a.mode == ESM_NO_STREAMING);
+        if (source == nullptr)
+            continue;
+        source->setDefaultVolume(a.volume);
+        source->setDefaultMinDistance(a.minDistance);
+        sources[static_cast<int>(a.id)] = source;
+        ++loaded;
+    }
+
+    // Missing files borrow their stand-in's decoded data under their own name and defaults
+    for (const Asset& a : assets)
+    {
+        if (sources[static_cast<int>(a.id)] != nullptr)
+            continue;
+        ISoundSource* base = a.fallback != SoundId::COUNT ? sources[static_cast<int>(a.fallback)] : nullptr;
+        if (base != nullptr)
+        {
+            ISoundSource* alias = engine->addSoundSourceAlias(base, a.file);
+            if (alias != nullptr)
+            {
+                alias->setDefaultVolume(a.volume);
+                alias->setDefaultMinDistance(a.minDistance);
+            }
+            sources[static_cast<int>(a.id)] = alias;
+            aliased[static_cast<int>(a.id)] = true;
+            printf("AudioBank: %s/%s is missing; using %s instead\n", soundFolder.c_str(), a.file, getAsset(a.fallback).file);
+        }
+        else
+        {
+            printf("AudioBank: %s/%s is missing; it will be silent\n", soundFolder.c_str(), a.file);
+        }
+    }
+    return loaded;
+}
+
+void AudioBank::clear()
+{
+    for (ISoundSource*& s : sources)
+    {
+        if (s != nullptr && engine != nullptr)
+            engine->removeSoundSource(s);
+        s = nullptr;
+    }
+    if (pack != nullptr)
+    {
+        pack->drop(); // The engine may still hold it for readers in flight
+        pack = nullptr;
+    }
+    if (synth != nullptr)
+    {
+        synth->drop(); // Streams hold it too, for its controls
+        synth = nullptr;
+    }
+    std::fill(aliased, aliased + static_cast<int>(SoundId::COUNT), false);
+    engine = nullptr;
+}
+
+ISound* AudioBank::play2D(SoundId id, bool looped, bool startPaused, bool track) const
+{
+    ISoundSource* source = getSource(id);
+    return source != nullptr ? engine->play2D(source, looped, startPaused, track) : nullptr;
+}
+
+ISound* AudioBank::play3D(SoundId id, const vec3df& position, bool looped, bool startPaused, bool track) const
+{
+    ISoundSource* source = getSource(id);
+    return source != nullptr ? engine->play3D(source, position, looped, startPaused, track) : nullptr;
+}
+
+EngineSynthControls* AudioBank::getEngineSynth() const
+{
+    const int id = static_cast<int>(SoundId::ENGINE_LOOP);
+    return synth != nullptr && sources[id] != nullptr && !aliased[id] ? &synth->getControls() : nullptr;
+}
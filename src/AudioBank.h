@@ -0,0 +1,81 @@
+#pragma once
+
+#include "AudioPack.h"
+#include "EngineSynth.h"
+#include <irrKlang.h>
+#include <cstdint>
+#include <string>
+
+namespace Aftr
+{
+    enum class SoundId : uint8_t
+    {
+        EXPLOSION,
+        DOPPLER,
+        ENGINE_LOOP,    // The player's jet, synthesized from engine.synth
+        LULLABY,
+        SPACE,
+        TRAFFIC_ENGINE, // Recorded loop for the background aircraft
+        COUNT
+    };
+
+    /**
+       Every sound the module plays, registered with the irrKlang engine once at startup. Short
+       effects are decoded into memory up front; the long music tracks stream. Events then play
+       by id through the cached ISoundSource, so a collision or takeoff neither builds a path
+       string nor makes irrKlang look a file up and decode it on the spot.
+
+       When the sounds folder holds a baked sounds.apak (SceneBaker --audio), it is mapped once and
+       installed as the engine's file factory: every asset, effects and streams alike, is then read
+       from that one mapping instead of its own file.
+
+       The player's engine is a .synth preset played through EngineSynthLoader, which the bank
+       registers with the engine; getEngineSynth() is where the sim sets its spool and thrust.
+
+       An asset whose file is missing is reported once at load and either aliased to its listed
+       stand-in or left silent; playing a silent id is a no-op that returns nullptr.
+    */
+    class AudioBank
+    {
+    public:
+        struct Asset
+        {
+            SoundId id;
+            const char* file;     // Relative to the sounds folder
+            SoundId fallback;     // Played instead when file is missing; COUNT for none
+            irrklang::E_STREAM_MODE mode;
+            float volume;
+            float minDistance;    // 3D rolloff starts here, world units
+        };
+
+        AudioBank() = default;
+        AudioBank(const AudioBank&) = delete;
+        AudioBank& operator=(const AudioBank&) = delete;
+        ~AudioBank() { clear(); }
+
+        static constexpr const char* PackName = "sounds.apak";
+
+        // Returns how many assets were registered from their own file. engine may be null.
+        int load(irrklang::ISoundEngine* engine, const std::string& soundFolder);
+        void clear();
+
+        irrklang::ISound* play2D(SoundId id, bool looped = false, bool startPaused = false, bool track = false) const;
+        irrklang::ISound* play3D(SoundId id, const irrklang::vec3df& position, bool looped = false, bool startPaused = false,
+                                 bool track = false) const;
+
+        irrklang::ISoundSource* getSource(SoundId id) const { return sources[static_cast<int>(id)]; }
+        bool isAvailable(SoundId id) const { return getSource(id) != nullptr; }
+        irrklang::ISoundEngine* getEngine() const { return engine; }
+        static const Asset& getAsset(SoundId id);
+        const AudioPackFileFactory* getPack() const { return pack; } // Null unless a pack was found
+        // The synthesized engine's controls, or null when ENGINE_LOOP fell back to a recording.
+        EngineSynthControls* getEngineSynth() const;
+
+    private:
+        irrklang::ISoundEngine* engine = nullptr;
+        AudioPackFileFactory* pack = nullptr;
+        EngineSynthLoader* synth = nullptr;
+        bool aliased[static_cast<int>(SoundId::COUNT)] = {};
+        irrklang::ISoundSource* sources[static_cast<int>(SoundId::COUNT)] = {};
+    };
+}
@@ -0,0 +1,170 @@
+#include "AudioCapture.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+using namespace Aftr;
+
+namespace
+{
+    void put32(FILE* f, uint32_t v)
+    {
+        const unsigned char b[4] = { uint8_t(v), uint8_t(v >> 8), uint8_t(v >> 16), uint8_t(v >> 24) };
+        fwrite(b, 1, 4, f);
+    }
+
+    void put16(FILE* f, uint16_t v)
+    {
+        const unsigned char b[2] = { uint8_t(v), uint8_t(v >> 8) };
+        fwrite(b, 1, 2, f);
+    }
+}
+
+AudioCapture::AudioCapture(size_t capacityFrames)
+{
+    size_t samples = 1;
+    while (samples < capacityFrames * Channels)
+        samples <<= 1;
+    ring.resize(samples);
+    mask = samples - 1;
+}
+
+AudioCapture::~AudioCapture()
+{
+    stopWav();
+}
+
+void AudioCapture::OnAudioDataReady(const void* data, int byteCount, int playbackrate)
+{
+    sampleRate.store(playbackrate, std::memory_order_relaxed);
+    const size_t frames = byteCount > 0 ? static_cast<size_t>(byteCount) / (sizeof(int16_t) * Channels) : 0;
+    const int16_t* in = static_cast<const int16_t*>(data);
+
+    const size_t h = head.load(std::memory_order_relaxed);
+    const size_t free = ring.size() - (h - tail.load(std::memory_order_acquire));
+    const size_t keep = std::min(frames, free / Channels);
+    const size_t samples = keep * Channels;
+    if (samples > 0) // memcpy from a null buffer is undefined even for zero bytes
+    {
+        const size_t first = std::min(samples, ring.size() - (h & mask));
+        std::memcpy(&ring[h & mask], in, first * sizeof(int16_t));
+        if (samples > first)
+            std::memcpy(&ring[0], in + first, (samples - first) * sizeof(int16_t));
+        head.store(h + samples, std::memory_order_release);
+    }
+
+    framesCaptured.fetch_add(keep, std::memory_order_relaxed);
+    if (keep < frames)
+        framesDropped.fetch_add(frames - keep, std::memory_order_relaxed);
+}
+
+size_t AudioCapture::drain(std::vector<int16_t>& out)
+{
+    const size_t t = tail.load(std::memory_order_relaxed);
+    const size_t samples = head.load(std::memory_order_acquire) - t;
+    if (samples == 0)
+        return 0;
+    const size_t at = out.size();
+    out.resize(at + samples);
+    const size_t first = std::min(samples, ring.size() - (t & mask));
+    std::memcpy(out.data() + at, &ring[t & mask], first * sizeof(int16_t));
+    if (samples > first)
+        std::memcpy(out.data() + at + first, &ring[0], (samples - first) * sizeof(int16_t));
+    tail.store(t + samples, std::memory_order_release);
+    return samples / Channels;
+}
+
+bool AudioCapture::writeWavHeader(FILE* f, int rate, uint32_t dataBytes)
+{
+    if (fseek(f, 0, SEEK_SET) != 0)
+        return false;
+    fwrite("RIFF", 1, 4, f);
+    put32(f, 36 + dataBytes);
+    fwrite("WAVEfmt ", 1, 8, f);
+    put32(f, 16);
+    put16(f, 1); // PCM
+    put16(f, Channels);
+    put32(f, static_cast<uint32_t>(rate));
+    put32(f, static_cast<uint32_t>(rate) * Channels * sizeof(int16_t));
+    put16(f, Channels * sizeof(int16_t));
+    put16(f, 16);
+    fwrite("data", 1, 4, f);
+    put32(f, dataBytes);
+    return !ferror(f);
+}
+
+bool AudioCapture::startWav(const std::string& path)
+{
+    stopWav();
+    wav = fopen(path.c_str(), "wb");
+    if (wav == nullptr)
+    {
+        printf("AudioCapture: cannot write %s\n", path.c_str());
+        return false;
+    }
+    writeWavHeader(wav, 44100, 0); // Rate and sizes are patched in stopWav
+    framesWritten = 0;
+    writing = true;
+    writer = std::thread(&AudioCapture::writerLoop, this);
+    return true;
+}
+
+void AudioCapture::writeAvailable()
+{
+    scratch.clear();
+    const size_t frames = drain(scratch);
+    if (frames == 0)
+        return;
+    fwrite(scratch.data(), sizeof(int16_t), frames * Channels, wav);
+    framesWritten += frames;
+}
+
+void AudioCapture::writerLoop()
+{
+    while (writing.load(std::memory_order_relaxed))
+    {
+        writeAvailable();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+void AudioCapture::stopWav()
+{
+    if (wav == nullptr)
+        return;
+    writing = false;
+    if (writer.joinable())
+        writer.join();
+    writeAvailable();
+    const int rate = getSampleRate();
+    writeWavHeader(wav, rate > 0 ? rate : 44100, static_cast<uint32_t>(framesWritten * Channels * sizeof(int16_t)));
+    fclose(wav);
+    wav = nullptr;
+}
+
+std::vector<float> AudioCapture::findOnsets(const std::vector<int16_t>& stereo, int rate, float threshold, float windowSec)
+{
+    std::vector<float> onsets;
+    const size_t window = std::max<size_t>(1, static_cast<size_t>(rate * windowSec));
+    const size_t frames = stereo.size() / Channels;
+    const double on = threshold * 32768.0;
+    bool armed = true;
+    for (size_t start = 0; start + window <= frames; start += window)
+    {
+        double sum = 0.0;
+        for (size_t i = start * Channels; i < (start + window) * Channels; ++i)
+            sum += double(stereo[i]) * stereo[i];
+        const double rms = std::sqrt(sum / (window * Channels));
+        if (armed && rms >= on)
+        {
+            onsets.push_back(static_cast<float>(start) / rate);
+            armed = false;
+        }
+        else if (rms < on * 0.5)
+        {
+            armed = true;
+        }
+    }
+    return onsets;
+}
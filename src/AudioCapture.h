@@ -0,0 +1,71 @@
+#pragma once
+
+#include <irrKlang.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       Receives irrKlang's final mix (16-bit interleaved stereo) on the mixer thread and hands
+       it to the main side through a single-producer/single-consumer ring: the callback only
+       copies samples and bumps an atomic, never locks, allocates or touches a file. A mix
+       that arrives while the ring is full is counted as dropped rather than waited on.
+
+       The consumer is either drain(), for tests and tools that want the samples, or a writer
+       thread started with startWav() that streams them into a .wav file. irrKlang only calls
+       receivers on its software drivers (WinMM, ALSA, Core Audio); with ESOD_NULL nothing
+       arrives, so headless runs that want the mix use ALSA's "null" device instead.
+    */
+    class AudioCapture : public irrklang::ISoundMixedOutputReceiver
+    {
+    public:
+        static constexpr int Channels = 2;
+
+        explicit AudioCapture(size_t capacityFrames = 1u << 16);
+        ~AudioCapture() override;
+        AudioCapture(const AudioCapture&) = delete;
+        AudioCapture& operator=(const AudioCapture&) = delete;
+
+        // Mixer thread.
+        void OnAudioDataReady(const void* data, int byteCount, int playbackrate) override;
+
+        // Consumer side; use drain() or the writer thread, not both.
+        size_t drain(std::vector<int16_t>& out);
+        bool startWav(const std::string& path);
+        void stopWav(); // Drains what is left and finishes the header
+
+        int getSampleRate() const { return sampleRate.load(std::memory_order_relaxed); }
+        uint64_t getFramesCaptured() const { return framesCaptured.load(std::memory_order_relaxed); }
+        uint64_t getFramesDropped() const { return framesDropped.load(std::memory_order_relaxed); }
+        uint64_t getFramesWritten() const { return framesWritten; }
+
+        // Start times, in seconds, of the sounds in a captured mix: windows whose RMS climbs past
+        // threshold (fraction of full scale) after having fallen below half of it.
+        static std::vector<float> findOnsets(const std::vector<int16_t>& stereo, int sampleRate, float threshold = 0.05f,
+                                             float windowSec = 0.01f);
+        static bool writeWavHeader(FILE* f, int sampleRate, uint32_t dataBytes);
+
+    private:
+        void writerLoop();
+        void writeAvailable();
+
+        std::vector<int16_t> ring; // Samples, size a power of two
+        size_t mask;
+        alignas(64) std::atomic<size_t> head{ 0 }; // Written by the mixer thread
+        alignas(64) std::atomic<size_t> tail{ 0 }; // Written by the consumer
+        std::atomic<int> sampleRate{ 0 };
+        std::atomic<uint64_t> framesCaptured{ 0 };
+        std::atomic<uint64_t> framesDropped{ 0 };
+
+        FILE* wav = nullptr;
+        uint64_t framesWritten = 0;
+        std::vector<int16_t> scratch;
+        std::thread writer;
+        std::atomic<bool> writing{ false };
+    };
+}
@@ -0,0 +1,260 @@
+#include "AudioPack.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace Aftr;
+using namespace irrklang;
+
+namespace
+{
+    uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) / a * a; }
+
+    bool isSlash(char c) { return c == '/' || c == '\\'; }
+
+    // True if path is entry, or ends in entry right after a folder separator. Either kind of
+    // slash matches either kind, so "..\\mm\\sounds\\a\\x.wav" finds the entry "a/x.wav".
+    bool endsWithEntry(const std::string& path, const char* entry, size_t entryLength)
+    {
+        if (path.size() < entryLength)
+            return false;
+        const size_t at = path.size() - entryLength;
+        for (size_t i = 0; i < entryLength; ++i)
+        {
+            const char p = path[at + i], e = entry[i];
+            if (p != e && !(isSlash(p) && isSlash(e)))
+                return false;
+        }
+        return at == 0 || isSlash(path[at - 1]);
+    }
+
+    // Serves one pack entry from the mapping; holds the factory so the mapping outlives it.
+    class PackReader : public IFileReader
+    {
+    public:
+        PackReader(AudioPackFileFactory* owner, const uint8_t* data, ik_s32 size, const std::string& name)
+            : owner(owner), data(data), size(size), name(name)
+        {
+            owner->grab();
+        }
+        ~PackReader() override { owner->drop(); }
+
+        ik_s32 read(void* buffer, ik_u32 sizeToRead) override
+        {
+            const ik_s32 n = std::min<ik_s32>(static_cast<ik_s32>(std::min<ik_u32>(sizeToRead, 0x7fffffff)), size - pos);
+            std::memcpy(buffer, data + pos, static_cast<size_t>(n));
+            pos += n;
+            return n;
+        }
+
+        bool seek(ik_s32 finalPos, bool relativeMovement) override
+        {
+            const int64_t to = relativeMovement ? int64_t(pos) + finalPos : int64_t(finalPos);
+            if (to < 0 || to > size)
+                return false;
+            pos = static_cast<ik_s32>(to);
+            return true;
+        }
+
+        ik_s32 getSize() override { return size; }
+        ik_s32 getPos() override { return pos; }
+        const ik_c8* getFileName() override { return name.c_str(); }
+
+    private:
+        AudioPackFileFactory* owner;
+        const uint8_t* data;
+        ik_s32 size;
+        ik_s32 pos = 0;
+        std::string name;
+    };
+
+    // Files the pack doesn't hold, read the way irrKlang would read them itself.
+    class DiskReader : public IFileReader
+    {
+    public:
+        DiskReader(FILE* f, const std::string& name) : f(f), name(name)
+        {
+            fseek(f, 0, SEEK_END);
+            size = static_cast<ik_s32>(ftell(f));
+            fseek(f, 0, SEEK_SET);
+        }
+        ~DiskReader() override { fclose(f); }
+
+        ik_s32 read(void* buffer, ik_u32 sizeToRead) override { return static_cast<ik_s32>(fread(buffer, 1, sizeToRead, f)); }
+        bool seek(ik_s32 finalPos, bool relativeMovement) override { return fseek(f, finalPos, relativeMovement ? SEEK_CUR : SEEK_SET) == 0; }
+        ik_s32 getSize() override { return size; }
+        ik_s32 getPos() override { return static_cast<ik_s32>(ftell(f)); }
+        const ik_c8* getFileName() override { return name.c_str(); }
+
+    private:
+        FILE* f;
+        ik_s32 size = 0;
+        std::string name;
+    };
+}
+
+bool Aftr::bakeAudioPack(const std::string& folder, const std::vector<std::string>& files, const std::string& outPath)
+{
+    using namespace AudioPackFormat;
+    std::vector<std::string> contents;
+    std::vector<Entry> entries;
+    std::string strings;
+    std::vector<std::string> names;
+    for (const std::string& name : files)
+    {
+        // Entries keep their path relative to folder, so equal file names in different
+        // subfolders stay distinct; the same path twice would be ambiguous
+        std::string stored = name;
+        std::replace(stored.begin(), stored.end(), '\\', '/');
+        if (std::find(names.begin(), names.end(), stored) != names.end())
+        {
+            printf("bakeAudioPack: %s is listed twice\n", stored.c_str());
+            return false;
+        }
+        names.push_back(stored);
+
+        std::ifstream in(folder + "/" + stored, std::ios::binary);
+        if (!in)
+        {
+            printf("bakeAudioPack: cannot read %s/%s\n", folder.c_str(), name.c_str());
+            return false;
+        }
+        contents.emplace_back(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        Entry e{};
+        e.nameOffset = static_cast<uint32_t>(strings.size());
+        e.size = contents.back().size();
+        strings += names.back();
+        strings.push_back('\0');
+        entries.push_back(e);
+    }
+
+    Header h{};
+    std::memcpy(h.magic, Magic, sizeof(Magic));
+    h.version = Version;
+    h.entryCount = static_cast<uint32_t>(entries.size());
+    h.stringBytes = static_cast<uint32_t>(strings.size());
+    h.entryOffset = sizeof(Header);
+    h.stringOffset = h.entryOffset + entries.size() * sizeof(Entry);
+    uint64_t cursor = h.stringOffset + strings.size();
+    for (Entry& e : entries)
+    {
+        cursor = alignUp(cursor, PageSize);
+        e.dataOffset = cursor;
+        cursor += e.size;
+    }
+    h.fileSize = cursor;
+
+    // Written beside the target and renamed over it: a running AudioBank may have the old pack
+    // mapped, and truncating that file in place would fault its next read
+    const std::string temp = outPath + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary);
+        if (!out)
+        {
+            printf("bakeAudioPack: cannot write %s\n", temp.c_str());
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            static const char zeros[PageSize] = {};
+            out.write(zeros, static_cast<std::streamsize>(entries[i].dataOffset - static_cast<uint64_t>(out.tellp())));
+            out.write(contents[i].data(), static_cast<std::streamsize>(contents[i].size()));
+        }
+        if (!out.flush())
+        {
+            printf("bakeAudioPack: cannot write %s\n", temp.c_str());
+            out.close();
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, outPath, ec);
+    if (ec)
+    {
+        printf("bakeAudioPack: cannot replace %s: %s\n", outPath.c_str(), ec.message().c_str());
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool AudioPack::open(const std::string& path)
+{
+    using namespace AudioPackFormat;
+    close();
+    if (!file.open(path))
+        return false;
+
+    auto fail = [&](const char* why)
+    {
+        printf("AudioPack: %s: %s\n", path.c_str(), why);
+        close();
+        return false;
+    };
+
+    const size_t size = file.size();
+    if (size < sizeof(Header))
+        return fail("truncated header");
+    const Header* h = reinterpret_cast<const Header*>(file.data());
+    if (std::memcmp(h->magic, Magic, sizeof(Magic)) != 0)
+        return fail("not an audio pack");
+    if (h->version != Version)
+        return fail("baked with a different format version; rebake it");
+    if (h->fileSize != size)
+        return fail("size does not match its header");
+
+    auto inRange = [size](uint64_t offset, uint64_t bytes) { return offset <= size && bytes <= size - offset; };
+    if (!inRange(h->entryOffset, uint64_t(h->entryCount) * sizeof(Entry)) || !inRange(h->stringOffset, h->stringBytes) ||
+        h->entryOffset % alignof(Entry) != 0 || (h->stringBytes > 0 && file.data()[h->stringOffset + h->stringBytes - 1] != '\0'))
+        return fail("table out of range");
+
+    header = h;
+    for (uint32_t i = 0; i < h->entryCount; ++i)
+    {
+        const Entry& e = entries()[i];
+        if (!inRange(e.dataOffset, e.size) || e.dataOffset % PageSize != 0 || e.nameOffset >= h->stringBytes || e.size > 0x7fffffff)
+            return fail("entry out of range");
+    }
+    return true;
+}
+
+const AudioPackFormat::Entry* AudioPack::find(const std::string& name) const
+{
+    if (header == nullptr)
+        return nullptr;
+    // The longest matching entry wins: "sounds/a/x.wav" prefers "a/x.wav" over a top-level "x.wav"
+    const AudioPackFormat::Entry* best = nullptr;
+    size_t bestLength = 0;
+    for (uint32_t i = 0; i < header->entryCount; ++i)
+    {
+        const char* entry = getName(i);
+        const size_t length = std::strlen(entry);
+        if (length > bestLength && endsWithEntry(name, entry, length))
+        {
+            best = &entries()[i];
+            bestLength = length;
+        }
+    }
+    return best;
+}
+
+IFileReader* AudioPackFileFactory::createFileReader(const ik_c8* filename)
+{
+    if (const AudioPackFormat::Entry* e = pack.find(filename))
+    {
+        packOpens.fetch_add(1, std::memory_order_relaxed);
+        return new PackReader(this, pack.getData(*e), static_cast<ik_s32>(e->size), filename);
+    }
+    FILE* f = fopen(filename, "rb");
+    if (f == nullptr)
+        return nullptr;
+    diskOpens.fetch_add(1, std::memory_order_relaxed);
+    return new DiskReader(f, filename);
+}
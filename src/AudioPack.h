@@ -0,0 +1,96 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <irrKlang.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    namespace AudioPackFormat
+    {
+        constexpr char Magic[8] = { 'A', 'F', 'T', 'R', 'A', 'P', 'A', 'K' };
+        constexpr uint32_t Version = 1;
+        constexpr uint32_t PageSize = 4096; // Every file starts on a page, so reads never share a page with a neighbour
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t entryCount;
+            uint32_t stringBytes;
+            uint32_t reserved;
+            uint64_t entryOffset;
+            uint64_t stringOffset;
+            uint64_t fileSize;
+        };
+
+        struct Entry
+        {
+            uint32_t nameOffset; // File name without folders, into the string table, NUL terminated
+            uint32_t reserved;
+            uint64_t dataOffset; // Page aligned
+            uint64_t size;
+        };
+
+        static_assert(sizeof(Header) == 48, "Header layout is part of the file format");
+        static_assert(sizeof(Entry) == 24, "Entry layout is part of the file format");
+    }
+
+    // Copies the named files of folder, byte for byte, into one page-aligned pack at outPath.
+    // Entries are named by their path relative to folder.
+    bool bakeAudioPack(const std::string& folder, const std::vector<std::string>& files, const std::string& outPath);
+
+    /**
+       Zero-copy view of a baked audio pack. open() maps it and validates every entry once;
+       find() then returns the file's bytes straight from the mapping.
+    */
+    class AudioPack
+    {
+    public:
+        bool open(const std::string& path);
+        void close() { file.close(); header = nullptr; }
+        bool isOpen() const { return header != nullptr; }
+
+        // The entry whose stored relative path name ends with, at a folder boundary; the longest
+        // such entry if several do. name may carry any leading folders. Null when absent.
+        const AudioPackFormat::Entry* find(const std::string& name) const;
+        const uint8_t* getData(const AudioPackFormat::Entry& e) const { return file.data() + e.dataOffset; }
+        uint32_t getEntryCount() const { return header ? header->entryCount : 0; }
+        const char* getName(uint32_t i) const { return string(entries()[i].nameOffset); }
+
+    private:
+        const AudioPackFormat::Entry* entries() const { return reinterpret_cast<const AudioPackFormat::Entry*>(file.data() + header->entryOffset); }
+        const char* string(uint32_t offset) const { return reinterpret_cast<const char*>(file.data() + header->stringOffset + offset); }
+
+        MappedFile file;
+        const AudioPackFormat::Header* header = nullptr;
+    };
+
+    /**
+       irrKlang file access backed by an AudioPack. Files in the pack are served from the
+       mapping, so decoders and streams read from the page cache with no open() or read()
+       per file; anything else falls through to a plain disk reader. Readers keep the factory
+       (and so the mapping) alive, and irrKlang may create them on its streaming thread; the
+       pack is read-only after open(), so that needs no locking.
+    */
+    class AudioPackFileFactory : public irrklang::IFileFactory
+    {
+    public:
+        bool open(const std::string& packPath) { return pack.open(packPath); }
+        bool contains(const std::string& name) const { return pack.find(name) != nullptr; }
+        const AudioPack& getPack() const { return pack; }
+
+        irrklang::IFileReader* createFileReader(const irrklang::ik_c8* filename) override;
+
+        uint32_t getPackOpens() const { return packOpens.load(std::memory_order_relaxed); }
+        uint32_t getDiskOpens() const { return diskOpens.load(std::memory_order_relaxed); }
+
+    private:
+        AudioPack pack;
+        std::atomic<uint32_t> packOpens{ 0 };
+        std::atomic<uint32_t> diskOpens{ 0 };
+    };
+}
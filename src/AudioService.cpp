@@ -0,0 +1,102 @@
+#include "AudioService.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace Aftr;
+using namespace irrklang;
+
+AudioService& AudioService::get()
+{
+    static AudioService service;
+    return service;
+}
+
+void AudioService::open(const std::string& driver, const std::string& captureFile)
+{
+    headless = driver == "null" || driver == "capture";
+    if (headless)
+    {
+        // Headless: nothing is heard, so mix on the caller's thread from update() instead of a mixer thread
+        const int options = ESEO_DEFAULT_OPTIONS & ~ESEO_MULTI_THREADED;
+        if (driver == "capture")
+        {
+            // Mixed output only reaches receivers on the software drivers; ALSA's "null" device
+            // runs that mixer without a sound card
+#ifdef _WIN32
+            engine = createIrrKlangDevice(ESOD_WIN_MM, options);
+#else
+            engine = createIrrKlangDevice(ESOD_ALSA, options, "null");
+#endif
+            capture = std::make_unique<AudioCapture>();
+            if (engine != nullptr && engine->setMixedDataOutputReceiver(capture.get()))
+            {
+                if (!captureFile.empty())
+                    capture->startWav(captureFile);
+            }
+            else
+            {
+                printf("Audio capture is not available on this driver; recording sound events only\n");
+                capture.reset();
+            }
+        }
+        if (engine == nullptr)
+            engine = createIrrKlangDevice(ESOD_NULL, options);
+    }
+    else
+    {
+        engine = createIrrKlangDevice();
+    }
+
+    if (engine == nullptr)
+        printf("No sound device could be opened; running silent\n");
+}
+
+ISoundEngine* AudioService::acquire(const std::string& driver, const std::string& captureFile, const std::string& soundFolder)
+{
+    auto start = std::chrono::steady_clock::now();
+    reused = opened && driver == openDriver && captureFile == openCaptureFile && soundFolder == openSoundFolder;
+    if (!reused)
+    {
+        shutdown();
+        open(driver, captureFile);
+        bank.load(engine, soundFolder);
+        openDriver = driver;
+        openCaptureFile = captureFile;
+        openSoundFolder = soundFolder;
+        opened = true;
+    }
+    lastAcquireMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    Profiler::get().addSample(Profiler::get().registerTimer(reused ? "Startup: audio (reused)" : "Startup: audio (opened)"), lastAcquireMs);
+    printf("Audio: %s device and sound bank in %.2f ms\n", reused ? "reused the" : "opened a", lastAcquireMs);
+    return engine;
+}
+
+void AudioService::release()
+{
+    if (engine != nullptr)
+        engine->stopAllSounds();
+    if (EngineSynthControls* synth = bank.getEngineSynth())
+        synth->set(EngineSynthInput{});
+}
+
+void AudioService::shutdown()
+{
+    bank.clear(); // Sources belong to the engine, so release them before dropping it
+    if (engine != nullptr)
+    {
+        if (capture != nullptr)
+            engine->setMixedDataOutputReceiver(nullptr);
+        engine->drop();
+        engine = nullptr;
+    }
+    if (capture != nullptr)
+    {
+        capture->stopWav();
+        printf("Audio capture: %llu frames at %d Hz, %llu dropped\n", static_cast<unsigned long long>(capture->getFramesCaptured()),
+               capture->getSampleRate(), static_cast<unsigned long long>(capture->getFramesDropped()));
+        capture.reset();
+    }
+    opened = false;
+    headless = false;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AudioBank.h"
+#include "AudioCapture.h"
+#include <irrKlang.h>
+#include <memory>
+#include <string>
+
+namespace Aftr
+{
+    /**
+       The irrKlang device and the sound bank, owned for the life of the process rather than by
+       a GLViewNewModule. main.cpp rebuilds the GLView on every restart request; opening a
+       device probes the audio drivers and loads plugins, and the bank decodes every effect,
+       so each GLView only acquire()s what the first one opened and release()s it (every
+       sound stopped) when it is torn down. The device is reopened only if aftr.conf asked for
+       a different driver or capture file. shutdown() at process exit closes everything.
+    */
+    class AudioService
+    {
+    public:
+        static AudioService& get();
+
+        // driver is audioDriver from aftr.conf: auto, null or capture. Returns the engine, or
+        // null when no device could be opened (sounds are then silent, not errors).
+        irrklang::ISoundEngine* acquire(const std::string& driver, const std::string& captureFile, const std::string& soundFolder);
+        void release();
+        void shutdown();
+
+        irrklang::ISoundEngine* getEngine() const { return engine; }
+        AudioBank& getBank() { return bank; }
+        AudioCapture* getCapture() const { return capture.get(); }
+        bool isHeadless() const { return headless; } // null or capture: single-threaded, mixed by the caller's update()
+
+        double getLastAcquireMs() const { return lastAcquireMs; }
+        bool wasReused() const { return reused; }
+
+    private:
+        AudioService() = default;
+        ~AudioService() { shutdown(); }
+        AudioService(const AudioService&) = delete;
+        AudioService& operator=(const AudioService&) = delete;
+
+        void open(const std::string& driver, const std::string& captureFile);
+
+        irrklang::ISoundEngine* engine = nullptr;
+        AudioBank bank;
+        std::unique_ptr<AudioCapture> capture;
+        std::string openDriver;
+        std::string openCaptureFile;
+        std::string openSoundFolder;
+        bool opened = false;
+        bool headless = false;
+        bool reused = false;
+        double lastAcquireMs = 0.0;
+    };
+}
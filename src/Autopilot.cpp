@@ -0,0 +1,90 @@
+#include "Autopilot.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Aftr;
+
+float Aftr::pidUpdate(const PidGains& g, PidState& s, float error, float dt, bool integrate)
+{
+    float derivative = 0.0f;
+    if (s.primed && dt > 0.0f)
+        derivative = (error - s.prevError) / dt;
+    s.prevError = error;
+    s.primed = true;
+
+    if (integrate)
+        s.integral += error * dt;
+    if (g.ki > 0.0f)
+        s.integral = std::clamp(s.integral, -g.integralLimit / g.ki, g.integralLimit / g.ki);
+
+    return std::clamp(g.kp * error + g.ki * s.integral + g.kd * derivative, -g.outputLimit, g.outputLimit);
+}
+
+FlightControls Autopilot::step(AutopilotState& ap, const AutopilotTargets& t, const FlightState& f,
+                               const FlightControls& pilot, const FlightModelParams& model, float dt) const
+{
+    FlightControls out = pilot;
+
+    // Nothing accumulated while the pilot flew, and no derivative against an error from before
+    // the hand-over, reaches the surfaces when the autopilot takes control
+    if (ap.engaged && !ap.wasEngaged)
+        ap.roll = ap.pitch = ap.altitude = ap.heading = ap.speed = PidState{};
+    ap.wasEngaged = ap.engaged;
+
+    float headingTarget = t.heading;
+    float altitudeTarget = t.altitude;
+    bool holdHeading = (ap.modes & apmHEADING_HOLD) != 0;
+    bool holdAltitude = (ap.modes & apmALTITUDE_HOLD) != 0;
+
+    if ((ap.modes & apmWAYPOINT_NAV) && ap.activeWaypoint < t.waypointCount)
+    {
+        Vector toWp = t.waypoints[ap.activeWaypoint] - f.position;
+        if (std::sqrt(toWp.x * toWp.x + toWp.y * toWp.y) < t.waypointRadius && ap.activeWaypoint + 1 < t.waypointCount)
+        {
+            ++ap.activeWaypoint;
+            toWp = t.waypoints[ap.activeWaypoint] - f.position;
+        }
+        headingTarget = std::atan2(toWp.y, toWp.x);
+        altitudeTarget = t.waypoints[ap.activeWaypoint].z;
+        holdHeading = holdAltitude = true;
+    }
+
+    float rollTarget = t.roll;
+    float pitchTarget = t.pitch;
+    if (holdHeading)
+        rollTarget = pidUpdate(gains.heading, ap.heading, wrapRadians(headingTarget - f.heading), dt, ap.engaged);
+    if (holdAltitude)
+        pitchTarget = pidUpdate(gains.altitude, ap.altitude, altitudeTarget - f.position.z, dt, ap.engaged);
+
+    ap.commandedHeading = headingTarget;
+    ap.commandedAltitude = altitudeTarget;
+    ap.commandedRoll = rollTarget;
+    ap.commandedPitch = pitchTarget;
+
+    if (!ap.engaged)
+        return out;
+
+    if (holdHeading || (ap.modes & apmATTITUDE_HOLD))
+    {
+        out.roll = pidUpdate(gains.roll, ap.roll, wrapRadians(rollTarget - f.roll), dt);
+        out.yaw = 0.0f;
+    }
+    if (holdAltitude || (ap.modes & apmATTITUDE_HOLD))
+        out.pitch = pidUpdate(gains.pitch, ap.pitch, pitchTarget - f.pitch, dt);
+
+    if (ap.modes & apmSPEED_HOLD)
+    {
+        float feedForward = model.maxAirspeed > 0.0f ? t.airspeed / model.maxAirspeed : 0.0f;
+        out.thrust = std::clamp(feedForward + pidUpdate(gains.speed, ap.speed, t.airspeed - f.airspeed, dt), 0.0f, 1.0f);
+    }
+
+    return out;
+}
+
+void Autopilot::stepBatch(AutopilotState* ap, const AutopilotTargets* targets, const FlightState* flight,
+                          const FlightControls* pilot, FlightControls* out, size_t count,
+                          const FlightModelParams& model, float dt) const
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = step(ap[i], targets[i], flight[i], pilot[i], model, dt);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "FlightModel.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Aftr
+{
+    struct PidGains
+    {
+        float kp = 0.0f;
+        float ki = 0.0f;
+        float kd = 0.0f;
+        float integralLimit = 1.0f; // Clamp on ki * integral, prevents windup
+        float outputLimit = 1.0f;
+    };
+
+    struct PidState
+    {
+        float integral = 0.0f;
+        float prevError = 0.0f;
+        bool primed = false; // False until the first update so the derivative doesn't kick
+    };
+
+    // With integrate false the integral is frozen: the output still uses it, but the error is not added.
+    float pidUpdate(const PidGains& gains, PidState& state, float error, float dt, bool integrate = true);
+
+    // Modes may be combined; altitude and heading hold drive the attitude loops beneath them.
+    enum AutopilotMode : uint32_t
+    {
+        apmNONE = 0,
+        apmATTITUDE_HOLD = 1 << 0,
+        apmALTITUDE_HOLD = 1 << 1,
+        apmHEADING_HOLD = 1 << 2,
+        apmSPEED_HOLD = 1 << 3,
+        apmWAYPOINT_NAV = 1 << 4
+    };
+
+    struct AutopilotGains
+    {
+        PidGains roll{ 3.0f, 0.2f, 0.1f, 0.3f, 1.0f };        // roll error (rad) -> roll stick
+        PidGains pitch{ 4.0f, 0.5f, 0.2f, 0.3f, 1.0f };       // pitch error (rad) -> pitch stick
+        PidGains altitude{ 0.06f, 0.004f, 0.08f, 0.1f, 0.35f }; // altitude error -> pitch target (rad)
+        PidGains heading{ 1.2f, 0.0f, 0.3f, 0.1f, 0.5f };     // heading error (rad) -> roll target (rad)
+        PidGains speed{ 0.25f, 0.08f, 0.0f, 0.3f, 1.0f };     // airspeed error -> thrust trim
+    };
+
+    struct AutopilotTargets
+    {
+        float roll = 0.0f;
+        float pitch = 0.0f;
+        float altitude = 20.0f;
+        float heading = 0.0f;
+        float airspeed = 4.0f;
+        const Vector* waypoints = nullptr; // Owned by the caller, visited in order
+        size_t waypointCount = 0;
+        float waypointRadius = 6.0f;
+    };
+
+    /**
+       Per-aircraft controller memory. Plain data with no heap ownership so an array of these
+       can be stepped for every AI aircraft, copied for prediction, or reset with assignment.
+    */
+    struct AutopilotState
+    {
+        uint32_t modes = apmNONE;
+        bool engaged = false; // When false the flight director still computes commands but the pilot flies
+        bool wasEngaged = false; // engaged as of the previous step; every loop restarts on the transition
+        PidState roll, pitch, altitude, heading, speed;
+        size_t activeWaypoint = 0;
+
+        // Flight director output of the most recent step
+        float commandedRoll = 0.0f;
+        float commandedPitch = 0.0f;
+        float commandedHeading = 0.0f;
+        float commandedAltitude = 0.0f;
+    };
+
+    /**
+       Cascaded PID autopilot: waypoint navigation feeds heading and altitude targets, heading
+       and altitude hold feed roll and pitch targets, and attitude hold turns those into stick
+       demands. Speed hold sets thrust. Intended to run once per fixed physics step.
+    */
+    class Autopilot
+    {
+    public:
+        Autopilot() = default;
+        explicit Autopilot(const AutopilotGains& gains) : gains(gains) {}
+
+        FlightControls step(AutopilotState& ap, const AutopilotTargets& targets, const FlightState& flight,
+                            const FlightControls& pilot, const FlightModelParams& model, float dt) const;
+
+        void stepBatch(AutopilotState* ap, const AutopilotTargets* targets, const FlightState* flight,
+                       const FlightControls* pilot, FlightControls* out, size_t count,
+                       const FlightModelParams& model, float dt) const;
+
+        const AutopilotGains& getGains() const { return gains; }
+        AutopilotGains& getGains() { return gains; }
+
+    private:
+        AutopilotGains gains;
+    };
+}
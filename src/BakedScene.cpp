@@ -0,0 +1,289 @@
+#include "BakedScene.h"
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace Aftr;
+
+namespace
+{
+    constexpr float DegToRad = 3.14159265358979f / 180.0f;
+
+    uint64_t alignUp(uint64_t v, uint64_t a)
+    {
+        return (v + a - 1) / a * a;
+    }
+}
+
+bool SceneDescription::load(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        printf("SceneDescription: cannot open %s\n", path.c_str());
+        return false;
+    }
+
+    models.clear();
+    placements.clear();
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo)
+    {
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+        std::istringstream ss(line);
+        std::string keyword;
+        if (!(ss >> keyword))
+            continue;
+
+        if (keyword == "model")
+        {
+            Model m;
+            if (!(ss >> m.name >> m.path))
+            {
+                printf("%s:%d: expected 'model <name> <path>'\n", path.c_str(), lineNo);
+                return false;
+            }
+            models.push_back(m);
+        }
+        else if (keyword == "place")
+        {
+            std::string name;
+            Placement p;
+            if (!(ss >> name >> p.position[0] >> p.position[1] >> p.position[2]))
+            {
+                printf("%s:%d: expected 'place <name> x y z [heading pitch roll scale]'\n", path.c_str(), lineNo);
+                return false;
+            }
+            float h = 0, pt = 0, r = 0, s = 1;
+            ss >> h >> pt >> r >> s; // Optional trailing fields keep their defaults
+            p.heading = h * DegToRad;
+            p.pitch = pt * DegToRad;
+            p.roll = r * DegToRad;
+            p.scale = s;
+
+            auto it = std::find_if(models.begin(), models.end(), [&](const Model& m) { return m.name == name; });
+            if (it == models.end())
+            {
+                printf("%s:%d: place refers to unknown model '%s'\n", path.c_str(), lineNo, name.c_str());
+                return false;
+            }
+            p.model = static_cast<uint32_t>(it - models.begin());
+            placements.push_back(p);
+        }
+        else
+        {
+            printf("%s:%d: unknown keyword '%s'\n", path.c_str(), lineNo, keyword.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Aftr::bakeScene(const SceneDescription& scene, const std::string& mmRoot, const std::string& outPath)
+{
+    using namespace BakedFormat;
+
+    std::string strings;
+    auto addString = [&strings](const std::string& s)
+    {
+        const uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(s);
+        strings.push_back('\0');
+        return offset;
+    };
+
+    std::vector<Mesh> meshes(scene.models.size());
+    std::vector<std::vector<float>> vertexData(scene.models.size());
+    std::vector<std::vector<uint32_t>> indexData(scene.models.size());
+    for (size_t i = 0; i < scene.models.size(); ++i)
+    {
+        IndexedMesh src;
+        if (!MeshSimplifier::readVrml(mmRoot + "/" + scene.models[i].path, src))
+            return false;
+
+        // Smooth normals, as the instanced renderer computes them from a parsed model
+        std::vector<Vector> normals(src.points.size(), Vector(0, 0, 0));
+        for (size_t t = 0; t + 2 < src.triangles.size(); t += 3)
+        {
+            const Vector& a = src.points[src.triangles[t]];
+            const Vector n = (src.points[src.triangles[t + 1]] - a).crossProduct(src.points[src.triangles[t + 2]] - a);
+            for (int k = 0; k < 3; ++k)
+                normals[src.triangles[t + k]] += n;
+        }
+        std::vector<float>& v = vertexData[i];
+        v.reserve(src.points.size() * 6);
+        for (size_t p = 0; p < src.points.size(); ++p)
+        {
+            Vector n = normals[p];
+            if (n.length() > 0.0f)
+                n.normalize();
+            v.insert(v.end(), { src.points[p].x, src.points[p].y, src.points[p].z, n.x, n.y, n.z });
+        }
+        indexData[i] = src.triangles;
+
+        Vector lo, hi;
+        src.bounds(lo, hi);
+        Mesh& m = meshes[i];
+        std::memset(&m, 0, sizeof(m));
+        m.nameOffset = addString(scene.models[i].name);
+        m.sourceOffset = addString(scene.models[i].path);
+        m.vertexCount = static_cast<uint32_t>(src.points.size());
+        m.indexCount = static_cast<uint32_t>(src.triangles.size());
+        std::copy(src.color, src.color + 3, m.color);
+        m.color[3] = 1.0f;
+        for (int k = 0; k < 3; ++k)
+        {
+            m.boundsLo[k] = lo[k];
+            m.boundsHi[k] = hi[k];
+        }
+    }
+
+    std::vector<Placement> placements;
+    for (const SceneDescription::Placement& p : scene.placements)
+        placements.push_back(Placement{ p.model, { p.position[0], p.position[1], p.position[2] }, p.heading, p.pitch, p.roll, p.scale });
+
+    // Layout: header, mesh table, placements, strings, then aligned vertex/index arrays
+    Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, Magic, sizeof(Magic));
+    h.version = Version;
+    h.meshCount = static_cast<uint32_t>(meshes.size());
+    h.placementCount = static_cast<uint32_t>(placements.size());
+    h.stringBytes = static_cast<uint32_t>(strings.size());
+    h.meshTableOffset = sizeof(Header);
+    h.placementOffset = h.meshTableOffset + meshes.size() * sizeof(Mesh);
+    h.stringOffset = h.placementOffset + placements.size() * sizeof(Placement);
+    uint64_t cursor = h.stringOffset + strings.size();
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        cursor = alignUp(cursor, DataAlignment);
+        meshes[i].vertexOffset = cursor;
+        cursor += vertexData[i].size() * sizeof(float);
+        cursor = alignUp(cursor, DataAlignment);
+        meshes[i].indexOffset = cursor;
+        cursor += indexData[i].size() * sizeof(uint32_t);
+    }
+    h.fileSize = cursor;
+
+    // Written beside the target and renamed over it: a running module may have the old blob
+    // mapped, and truncating that file in place would fault its next read
+    const std::string temp = outPath + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary);
+        if (!out)
+        {
+            printf("bakeScene: cannot write %s\n", temp.c_str());
+            return false;
+        }
+        auto padTo = [&out](uint64_t offset)
+        {
+            static const char zeros[DataAlignment] = {};
+            const uint64_t at = static_cast<uint64_t>(out.tellp());
+            out.write(zeros, static_cast<std::streamsize>(offset - at));
+        };
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(meshes.data()), static_cast<std::streamsize>(meshes.size() * sizeof(Mesh)));
+        out.write(reinterpret_cast<const char*>(placements.data()), static_cast<std::streamsize>(placements.size() * sizeof(Placement)));
+        out.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            padTo(meshes[i].vertexOffset);
+            out.write(reinterpret_cast<const char*>(vertexData[i].data()), static_cast<std::streamsize>(vertexData[i].size() * sizeof(float)));
+            padTo(meshes[i].indexOffset);
+            out.write(reinterpret_cast<const char*>(indexData[i].data()), static_cast<std::streamsize>(indexData[i].size() * sizeof(uint32_t)));
+        }
+        if (!out.flush())
+        {
+            printf("bakeScene: cannot write %s\n", temp.c_str());
+            out.close();
+            std::remove(temp.c_str());
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, outPath, ec);
+    if (ec)
+    {
+        printf("bakeScene: cannot replace %s: %s\n", outPath.c_str(), ec.message().c_str());
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool BakedScene::open(const std::string& path)
+{
+    using namespace BakedFormat;
+    close();
+    if (!file.open(path))
+        return false;
+
+    auto fail = [&](const char* why)
+    {
+        printf("BakedScene: %s: %s\n", path.c_str(), why);
+        close();
+        return false;
+    };
+
+    const size_t size = file.size();
+    if (size < sizeof(Header))
+        return fail("truncated header");
+    const Header* h = reinterpret_cast<const Header*>(file.data());
+    if (std::memcmp(h->magic, Magic, sizeof(Magic)) != 0)
+        return fail("not a baked scene");
+    if (h->version != Version)
+        return fail("baked with a different format version; rebake it");
+    if (h->fileSize != size)
+        return fail("size does not match its header");
+
+    auto inRange = [size](uint64_t offset, uint64_t bytes) { return offset <= size && bytes <= size - offset; };
+    if (!inRange(h->meshTableOffset, uint64_t(h->meshCount) * sizeof(Mesh)) ||
+        !inRange(h->placementOffset, uint64_t(h->placementCount) * sizeof(Placement)) ||
+        !inRange(h->stringOffset, h->stringBytes) || h->meshTableOffset % alignof(Mesh) != 0 || h->placementOffset % alignof(Placement) != 0)
+        return fail("table out of range");
+    if (h->stringBytes == 0 || file.data()[h->stringOffset + h->stringBytes - 1] != '\0')
+        return fail("string table is not terminated");
+
+    header = h;
+    for (uint32_t i = 0; i < h->meshCount; ++i)
+    {
+        const Mesh& m = getMesh(i);
+        if (!inRange(m.vertexOffset, uint64_t(m.vertexCount) * 6 * sizeof(float)) || !inRange(m.indexOffset, uint64_t(m.indexCount) * sizeof(uint32_t)) ||
+            m.vertexOffset % DataAlignment != 0 || m.indexOffset % DataAlignment != 0 || m.nameOffset >= h->stringBytes ||
+            m.sourceOffset >= h->stringBytes)
+            return fail("mesh data out of range");
+        if (m.indexCount % 3 != 0)
+            return fail("mesh indices are not whole triangles");
+        const uint32_t* indices = getIndices(i);
+        for (uint32_t k = 0; k < m.indexCount; ++k)
+        {
+            if (indices[k] >= m.vertexCount)
+                return fail("mesh index out of range");
+        }
+    }
+    for (uint32_t i = 0; i < h->placementCount; ++i)
+    {
+        if (getPlacement(i).mesh >= h->meshCount)
+            return fail("placement refers to a missing mesh");
+    }
+    return true;
+}
+
+uint32_t BakedScene::findMesh(const std::string& modelPath) const
+{
+    for (uint32_t i = 0; i < getMeshCount(); ++i)
+    {
+        const std::string source = getMeshSource(i);
+        if (modelPath.size() >= source.size() && modelPath.compare(modelPath.size() - source.size(), source.size(), source) == 0 &&
+            (modelPath.size() == source.size() || modelPath[modelPath.size() - source.size() - 1] == '/'))
+            return i;
+    }
+    return NotFound;
+}
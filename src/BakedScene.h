@@ -0,0 +1,119 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       The airfield's untextured models, and any static props placed from them, as a text file the
+       module reads at startup and SceneBaker compiles into a binary blob:
+
+          # comment
+          model <name> <path relative to the shared mm folder>
+          place <name> x y z [heading pitch roll scale]   (angles in degrees)
+    */
+    struct SceneDescription
+    {
+        struct Model
+        {
+            std::string name;
+            std::string path;
+        };
+        struct Placement
+        {
+            uint32_t model;
+            float position[3];
+            float heading = 0.0f, pitch = 0.0f, roll = 0.0f; // Radians
+            float scale = 1.0f;
+        };
+
+        std::vector<Model> models;
+        std::vector<Placement> placements;
+
+        bool load(const std::string& path); // Prints the offending line and returns false on a malformed file
+    };
+
+    namespace BakedFormat
+    {
+        constexpr char Magic[8] = { 'A', 'F', 'T', 'R', 'B', 'S', 'C', 'N' };
+        constexpr uint32_t Version = 1;
+        constexpr uint32_t DataAlignment = 16;
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t meshCount;
+            uint32_t placementCount;
+            uint32_t stringBytes;
+            uint64_t meshTableOffset;
+            uint64_t placementOffset;
+            uint64_t stringOffset;
+            uint64_t fileSize;
+        };
+
+        // Vertex data is interleaved position + normal (6 floats), indices are uint32 triangles;
+        // both start on DataAlignment and can go to glBufferData straight from the mapping.
+        struct Mesh
+        {
+            uint32_t nameOffset;   // Into the string table, NUL terminated
+            uint32_t sourceOffset; // Original model path, kept for diagnostics
+            uint64_t vertexOffset;
+            uint64_t indexOffset;
+            uint32_t vertexCount;
+            uint32_t indexCount;
+            float color[4];
+            float boundsLo[3];
+            float boundsHi[3];
+        };
+
+        struct Placement
+        {
+            uint32_t mesh;
+            float position[3];
+            float heading, pitch, roll, scale;
+        };
+
+        static_assert(sizeof(Header) == 56, "Header layout is part of the file format");
+        static_assert(sizeof(Mesh) == 72, "Mesh layout is part of the file format");
+        static_assert(sizeof(Placement) == 32, "Placement layout is part of the file format");
+    }
+
+    // Writes the scene's meshes (read from VRML under mmRoot) and placements to outPath.
+    bool bakeScene(const SceneDescription& scene, const std::string& mmRoot, const std::string& outPath);
+
+    /**
+       Zero-copy view of a baked scene. open() maps the file and validates the header, every
+       offset and every index once; afterwards all accessors point straight into the mapping.
+    */
+    class BakedScene
+    {
+    public:
+        static constexpr uint32_t NotFound = 0xFFFFFFFFu;
+
+        bool open(const std::string& path);
+        void close() { file.close(); header = nullptr; }
+
+        uint32_t getMeshCount() const { return header ? header->meshCount : 0; }
+        uint32_t getPlacementCount() const { return header ? header->placementCount : 0; }
+        const BakedFormat::Mesh& getMesh(uint32_t i) const { return meshes()[i]; }
+        const BakedFormat::Placement& getPlacement(uint32_t i) const { return placements()[i]; }
+        const char* getMeshName(uint32_t i) const { return string(getMesh(i).nameOffset); }
+        const char* getMeshSource(uint32_t i) const { return string(getMesh(i).sourceOffset); }
+        uint32_t findMesh(const std::string& modelPath) const; // By source path, with or without the mm folder in front; NotFound if absent
+        const float* getVertices(uint32_t i) const { return reinterpret_cast<const float*>(file.data() + getMesh(i).vertexOffset); }
+        const uint32_t* getIndices(uint32_t i) const { return reinterpret_cast<const uint32_t*>(file.data() + getMesh(i).indexOffset); }
+        size_t getFileSize() const { return file.size(); }
+
+    private:
+        const BakedFormat::Mesh* meshes() const { return reinterpret_cast<const BakedFormat::Mesh*>(file.data() + header->meshTableOffset); }
+        const BakedFormat::Placement* placements() const { return reinterpret_cast<const BakedFormat::Placement*>(file.data() + header->placementOffset); }
+        const char* string(uint32_t offset) const { return reinterpret_cast<const char*>(file.data() + header->stringOffset + offset); }
+
+        MappedFile file;
+        const BakedFormat::Header* header = nullptr;
+    };
+}
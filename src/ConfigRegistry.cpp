@@ -0,0 +1,155 @@
+#include "ConfigRegistry.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+using namespace Aftr;
+
+namespace
+{
+    std::string lower(std::string s)
+    {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return s;
+    }
+
+    std::string trim(const std::string& s)
+    {
+        const size_t b = s.find_first_not_of(" \t\r\n");
+        const size_t e = s.find_last_not_of(" \t\r\n");
+        return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+    }
+}
+
+void ConfigRegistry::add(const char* key, float* slot, float def, float lo, float hi, const char* unit, const char* help)
+{
+    entries.push_back(Entry{ key, Type::FLOAT, slot, def, lo, hi, "", unit, help });
+    setDefault(entries.back());
+}
+
+void ConfigRegistry::add(const char* key, int* slot, int def, int lo, int hi, const char* unit, const char* help)
+{
+    entries.push_back(Entry{ key, Type::INT, slot, double(def), double(lo), double(hi), "", unit, help });
+    setDefault(entries.back());
+}
+
+void ConfigRegistry::add(const char* key, bool* slot, bool def, const char* help)
+{
+    entries.push_back(Entry{ key, Type::BOOL, slot, def ? 1.0 : 0.0, 0.0, 1.0, "", "", help });
+    setDefault(entries.back());
+}
+
+void ConfigRegistry::add(const char* key, std::string* slot, const std::string& def, const char* help)
+{
+    entries.push_back(Entry{ key, Type::STRING, slot, 0.0, 0.0, 0.0, def, "", help });
+    setDefault(entries.back());
+}
+
+void ConfigRegistry::setDefault(Entry& e) const
+{
+    switch (e.type)
+    {
+    case Type::FLOAT: *static_cast<float*>(e.slot) = static_cast<float>(e.def); break;
+    case Type::INT: *static_cast<int*>(e.slot) = static_cast<int>(e.def); break;
+    case Type::BOOL: *static_cast<bool*>(e.slot) = e.def != 0.0; break;
+    case Type::STRING: *static_cast<std::string*>(e.slot) = e.defText; break;
+    }
+    e.source = Source::DEFAULT;
+}
+
+bool ConfigRegistry::resolve(const LookupFn& lookup)
+{
+    bool ok = true;
+    for (Entry& e : entries)
+    {
+        setDefault(e);
+        const std::string raw = trim(lookup(lower(e.key)));
+        if (raw.empty())
+            continue;
+
+        if (e.type == Type::STRING)
+        {
+            *static_cast<std::string*>(e.slot) = raw;
+            e.source = Source::CONFIG;
+            continue;
+        }
+
+        double v = 0.0;
+        bool parsed = false;
+        if (e.type == Type::BOOL)
+        {
+            const std::string b = lower(raw);
+            parsed = b == "1" || b == "0" || b == "true" || b == "false" || b == "yes" || b == "no";
+            v = (b == "1" || b == "true" || b == "yes") ? 1.0 : 0.0;
+        }
+        else
+        {
+            char* end = nullptr;
+            v = std::strtod(raw.c_str(), &end);
+            parsed = end != raw.c_str() && trim(end).empty() && std::isfinite(v) && (e.type == Type::FLOAT || v == std::floor(v));
+        }
+        if (!parsed)
+        {
+            printf("Config: %s=%s is not a valid %s; using the default\n", e.key.c_str(), raw.c_str(),
+                   e.type == Type::BOOL ? "boolean" : e.type == Type::INT ? "integer" : "number");
+            e.source = Source::INVALID;
+            ok = false;
+            continue;
+        }
+
+        e.source = Source::CONFIG;
+        if (v < e.lo || v > e.hi)
+        {
+            printf("Config: %s=%s is outside [%g, %g]; clamped\n", e.key.c_str(), raw.c_str(), e.lo, e.hi);
+            v = std::clamp(v, e.lo, e.hi);
+            e.source = Source::CLAMPED;
+        }
+        if (e.type == Type::FLOAT)
+            *static_cast<float*>(e.slot) = static_cast<float>(v);
+        else if (e.type == Type::INT)
+            *static_cast<int*>(e.slot) = static_cast<int>(v);
+        else
+            *static_cast<bool*>(e.slot) = v != 0.0;
+    }
+    return ok;
+}
+
+void ConfigRegistry::dump(FILE* out, const char* title) const
+{
+    static const char* sources[] = { "default", "aftr.conf", "clamped", "invalid, default" };
+    fprintf(out, "%s:\n", title);
+    for (const Entry& e : entries)
+    {
+        char value[256];
+        switch (e.type)
+        {
+        case Type::FLOAT: snprintf(value, sizeof(value), "%g", *static_cast<const float*>(e.slot)); break;
+        case Type::INT: snprintf(value, sizeof(value), "%d", *static_cast<const int*>(e.slot)); break;
+        case Type::BOOL: snprintf(value, sizeof(value), "%d", *static_cast<const bool*>(e.slot) ? 1 : 0); break;
+        case Type::STRING: snprintf(value, sizeof(value), "%s", static_cast<const std::string*>(e.slot)->c_str()); break;
+        }
+        fprintf(out, "  %-22s = %-24s %-10s (%s) %s\n", e.key.c_str(), value, e.unit, sources[static_cast<int>(e.source)], e.help);
+    }
+}
+
+std::map<std::string, std::string> ConfigRegistry::parseConf(const std::string& text)
+{
+    std::map<std::string, std::string> values;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos)
+            continue;
+        std::string key = lower(trim(line.substr(0, eq)));
+        if (!key.empty())
+            values[key] = trim(line.substr(eq + 1));
+    }
+    return values;
+}
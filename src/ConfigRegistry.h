@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       Typed view of aftr.conf keys. Each key is registered once against a plain variable with
+       its default, valid range and unit; resolve() looks every key up a single time, parses it,
+       clamps it into range and stores it in the variable. Code that reads the value per tick then
+       does a plain load instead of a string lookup and conversion. dump() prints every effective
+       value and where it came from, so a run's log records exactly what it ran with.
+    */
+    class ConfigRegistry
+    {
+    public:
+        // Returns the raw value for a lower-case key, or "" when it is not set.
+        using LookupFn = std::function<std::string(const std::string& key)>;
+
+        void add(const char* key, float* slot, float def, float lo, float hi, const char* unit, const char* help);
+        void add(const char* key, int* slot, int def, int lo, int hi, const char* unit, const char* help);
+        void add(const char* key, bool* slot, bool def, const char* help);
+        void add(const char* key, std::string* slot, const std::string& def, const char* help);
+
+        // Sets every slot. Out-of-range numbers are clamped with a warning; a value that does not
+        // parse keeps the default and makes resolve() return false.
+        bool resolve(const LookupFn& lookup);
+        void dump(FILE* out, const char* title) const;
+        size_t size() const { return entries.size(); }
+
+        // key=value lines of an aftr.conf with lower-cased keys, for resolving outside the engine.
+        static std::map<std::string, std::string> parseConf(const std::string& text);
+
+    private:
+        enum class Type { FLOAT, INT, BOOL, STRING };
+        enum class Source { DEFAULT, CONFIG, CLAMPED, INVALID };
+
+        struct Entry
+        {
+            std::string key;
+            Type type;
+            void* slot;
+            double def, lo, hi;
+            std::string defText;
+            const char* unit;
+            const char* help;
+            Source source = Source::DEFAULT;
+        };
+
+        void setDefault(Entry& e) const;
+
+        std::vector<Entry> entries;
+    };
+}
@@ -0,0 +1,58 @@
+#include "ConfigReloader.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace Aftr;
+
+void ConfigReloader::start(const std::string& conf, const std::string& scenarioFile)
+{
+    stop();
+    confPath = conf;
+    scenarioPath = scenarioFile;
+    watcher.clear();
+    reloadParams();
+    watcher.watch(confPath);
+    if (!scenarioPath.empty())
+    {
+        reloadScenario();
+        watcher.watch(scenarioPath);
+    }
+
+    watcher.start([this](const std::string& path)
+        {
+            if (path == confPath)
+                reloadParams();
+            else
+                reloadScenario();
+        });
+}
+
+bool ConfigReloader::reloadParams()
+{
+    std::ifstream in(confPath);
+    if (!in)
+    {
+        printf("ConfigReloader: cannot open %s; keeping the current parameters\n", confPath.c_str());
+        return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+
+    // Keys removed from the file go back to their defaults rather than keeping the last value
+    auto next = std::make_shared<SimParams>();
+    if (!SimParams::parse(text.str(), *next))
+        return false;
+    next->generation = getParams()->generation + 1;
+    params.store(std::move(next), std::memory_order_release);
+    return true;
+}
+
+bool ConfigReloader::reloadScenario()
+{
+    auto next = std::make_shared<Scenario>();
+    if (!next->open(scenarioPath))
+        return false; // open() printed why; the running scenario stays
+    scenario.store(std::move(next), std::memory_order_release);
+    return true;
+}
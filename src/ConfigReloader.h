@@ -0,0 +1,41 @@
+#pragma once
+
+#include "FileWatcher.h"
+#include "Scenario.h"
+#include "SimParams.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace Aftr
+{
+    /**
+       Keeps the latest SimParams and Scenario published as immutable snapshots. Files are
+       reparsed on the FileWatcher's thread when they change and swapped in atomically; the sim
+       loads the current pointers once per tick and never sees a half-built snapshot. A file
+       that fails to parse leaves the previous snapshot in place.
+    */
+    class ConfigReloader
+    {
+    public:
+        ~ConfigReloader() { stop(); }
+
+        // Loads both files now, then watches them. scenarioPath may be empty.
+        void start(const std::string& confPath, const std::string& scenarioPath);
+        void stop() { watcher.stop(); }
+
+        std::shared_ptr<const SimParams> getParams() const { return params.load(std::memory_order_acquire); }
+        std::shared_ptr<const Scenario> getScenario() const { return scenario.load(std::memory_order_acquire); } // Null until one loads
+        bool isUsingInotify() const { return watcher.isUsingInotify(); }
+
+        bool reloadParams();
+        bool reloadScenario();
+
+    private:
+        std::string confPath;
+        std::string scenarioPath;
+        std::atomic<std::shared_ptr<const SimParams>> params{ std::make_shared<const SimParams>() };
+        std::atomic<std::shared_ptr<const Scenario>> scenario;
+        FileWatcher watcher;
+    };
+}
@@ -0,0 +1,51 @@
+#include "EngineSound.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Aftr;
+
+Vector EngineSound::clampSpeed(const Vector& v) const
+{
+    const float speed = v.length();
+    return speed > params.maxSpeed ? v * (params.maxSpeed / speed) : v;
+}
+
+void EngineSound::reset()
+{
+    hasLastCamera = false;
+    frame.listener.velocity = Vector{ 0, 0, 0 };
+}
+
+const AudioFrame& EngineSound::update(const Vector& cameraPos, const Vector& cameraLook, const Vector& cameraUp,
+                                      const Vector& jetPos, const Vector& jetVelocity, float thrust, bool running, float dt)
+{
+    AudioListenerPose& l = frame.listener;
+    l.velocity = hasLastCamera && dt > 0.0f ? clampSpeed((cameraPos - lastCameraPos) / dt) : Vector{ 0, 0, 0 };
+    l.position = cameraPos;
+    l.look = cameraLook;
+    l.up = cameraUp;
+    lastCameraPos = cameraPos;
+    hasLastCamera = true;
+
+    const float target = running ? std::clamp(thrust, 0.0f, 1.0f) : 0.0f;
+    const float blend = params.responseSec > 0.0f ? 1.0f - std::exp(-std::max(dt, 0.0f) / params.responseSec) : 1.0f;
+    level += (target - level) * blend;
+
+    EngineVoice& e = frame.engine;
+    e.position = jetPos;
+    e.velocity = running ? clampSpeed(jetVelocity) : Vector{ 0, 0, 0 };
+    e.spool = level;
+    e.playbackSpeed = params.idleSpeed + (params.fullSpeed - params.idleSpeed) * level;
+    // Idle volume only while running, so a stopped engine fades all the way out
+    const float floor = running ? params.idleVolume : 0.0f;
+    e.volume = floor + (params.fullVolume - floor) * level;
+
+    e.levelsChanged = std::abs(e.playbackSpeed - sentSpeed) >= params.minLevelChange ||
+                      std::abs(e.volume - sentVolume) >= params.minLevelChange;
+    if (e.levelsChanged)
+    {
+        sentSpeed = e.playbackSpeed;
+        sentVolume = e.volume;
+    }
+    return frame;
+}
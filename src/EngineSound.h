@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Vector.h"
+
+namespace Aftr
+{
+    // Where the ear is this frame. velocity drives the listener's half of the Doppler shift.
+    struct AudioListenerPose
+    {
+        Vector position{ 0, 0, 0 };
+        Vector look{ 1, 0, 0 };
+        Vector up{ 0, 0, 1 };
+        Vector velocity{ 0, 0, 0 };
+    };
+
+    struct EngineVoice
+    {
+        Vector position{ 0, 0, 0 };
+        Vector velocity{ 0, 0, 0 };
+        float playbackSpeed = 1.0f; // Pitch multiplier
+        float volume = 0.0f;
+        float spool = 0.0f;         // Smoothed engine speed, 0 idle .. 1 full; drives a synthesized engine
+        bool levelsChanged = false; // playbackSpeed or volume moved enough to be worth sending
+    };
+
+    // Everything the audio device is told in one frame, so it can be pushed from one call site.
+    struct AudioFrame
+    {
+        AudioListenerPose listener;
+        EngineVoice engine;
+    };
+
+    struct EngineSoundParams
+    {
+        float idleSpeed = 0.8f;      // Playback speed at zero thrust
+        float fullSpeed = 1.5f;      // ... and at full thrust
+        float idleVolume = 0.35f;
+        float fullVolume = 1.0f;
+        float responseSec = 0.3f;    // Time constant for pitch and volume to follow thrust
+        float maxSpeed = 60.0f;      // Velocities are clamped here, world units/sec, so a teleport can't scream
+        float minLevelChange = 0.005f;
+    };
+
+    /**
+       Turns the camera and jet state into the listener pose and engine voice for a frame. It
+       holds no audio handles: GLViewNewModule pushes the result to irrKlang in one place. The
+       camera has no velocity of its own, so it is differenced from the previous frame; pitch and
+       volume ease toward the thrust setting rather than stepping with the slider.
+    */
+    class EngineSound
+    {
+    public:
+        EngineSound() = default;
+        explicit EngineSound(const EngineSoundParams& params) : params(params) {}
+
+        // running is false when the engine is spooled down (on the ground, crashed); it fades out.
+        const AudioFrame& update(const Vector& cameraPos, const Vector& cameraLook, const Vector& cameraUp,
+                                 const Vector& jetPos, const Vector& jetVelocity, float thrust, bool running, float dt);
+
+        // Forgets the previous camera position, e.g. after the camera is snapped somewhere new.
+        void reset();
+
+        const AudioFrame& getFrame() const { return frame; }
+        const EngineSoundParams& getParams() const { return params; }
+
+    private:
+        Vector clampSpeed(const Vector& v) const;
+
+        EngineSoundParams params;
+        AudioFrame frame;
+        Vector lastCameraPos{ 0, 0, 0 };
+        bool hasLastCamera = false;
+        float level = 0.0f;          // Smoothed thrust, 0..1
+        float sentSpeed = -1.0f;     // Last levels reported as changed
+        float sentVolume = -1.0f;
+    };
+}
@@ -0,0 +1,250 @@
+#include "EngineSynth.h"
+#include "ConfigRegistry.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define AFTR_SYNTH_USE_SSE 1
+#endif
+
+using namespace Aftr;
+using namespace irrklang;
+
+namespace
+{
+    constexpr float TwoPi = 6.28318530718f;
+    constexpr float ThrustResponseSec = 0.05f; // Roar follows the throttle this quickly; spool arrives smoothed
+    constexpr float WhineShape[4] = { 1.0f, 0.5f, 0.3f, 0.15f };
+    constexpr float RumbleShape[4] = { 1.0f, 0.6f, 0.35f, 0.2f };
+}
+
+void EngineSynthPreset::registerWith(ConfigRegistry& r, EngineSynthPreset& p)
+{
+    const EngineSynthPreset d; // Defaults are the member initializers
+    r.add("sampleRate", &p.sampleRate, d.sampleRate, 8000, 96000, "Hz", "Output sample rate");
+    r.add("idleShaftHz", &p.idleShaftHz, d.idleShaftHz, 1.0f, 1000.0f, "Hz", "Shaft speed at idle");
+    r.add("fullShaftHz", &p.fullShaftHz, d.fullShaftHz, 1.0f, 2000.0f, "Hz", "Shaft speed at full power");
+    r.add("blades", &p.blades, d.blades, 1, 64, "", "Fan blades; whine is shaft speed x blades");
+    r.add("detune", &p.detune, d.detune, 0.0f, 0.05f, "", "Whine harmonic spread");
+    r.add("whineLevel", &p.whineLevel, d.whineLevel, 0.0f, 1.0f, "", "Turbine whine gain");
+    r.add("rumbleLevel", &p.rumbleLevel, d.rumbleLevel, 0.0f, 1.0f, "", "Shaft rumble gain");
+    r.add("noiseLevel", &p.noiseLevel, d.noiseLevel, 0.0f, 1.0f, "", "Combustion roar gain");
+    r.add("noiseLowHz", &p.noiseLowHz, d.noiseLowHz, 20.0f, 20000.0f, "Hz", "Roar cutoff at zero thrust");
+    r.add("noiseHighHz", &p.noiseHighHz, d.noiseHighHz, 20.0f, 20000.0f, "Hz", "Roar cutoff at full thrust");
+    r.add("masterLevel", &p.masterLevel, d.masterLevel, 0.0f, 1.0f, "", "Output gain");
+}
+
+EngineSynth::EngineSynth(const EngineSynthPreset& preset, const EngineSynthControls* controls)
+    : preset(preset), controls(controls), useSimd(hasSimd())
+{
+    for (int k = 0; k < Partials; ++k)
+    {
+        cosv[k] = 1.0f;
+        sinv[k] = 0.0f;
+        rotCos[k] = 1.0f;
+        rotSin[k] = 0.0f;
+        amp[k] = ampStep[k] = ampTarget[k] = 0.0f;
+    }
+}
+
+bool EngineSynth::hasSimd()
+{
+#ifdef AFTR_SYNTH_USE_SSE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void EngineSynth::stepPartials(float* out)
+{
+    for (int i = 0; i < BlockFrames; ++i)
+    {
+        float sum = 0.0f;
+        for (int k = 0; k < Partials; ++k)
+        {
+            const float c = cosv[k] * rotCos[k] - sinv[k] * rotSin[k];
+            sinv[k] = cosv[k] * rotSin[k] + sinv[k] * rotCos[k];
+            cosv[k] = c;
+            sum += amp[k] * sinv[k];
+            amp[k] += ampStep[k];
+        }
+        out[i] = sum;
+    }
+}
+
+void EngineSynth::stepPartialsSimd(float* out)
+{
+#ifdef AFTR_SYNTH_USE_SSE
+    static_assert(Partials == 8, "Two SSE lanes of four partials");
+    __m128 c0 = _mm_load_ps(cosv), c1 = _mm_load_ps(cosv + 4);
+    __m128 s0 = _mm_load_ps(sinv), s1 = _mm_load_ps(sinv + 4);
+    const __m128 rc0 = _mm_load_ps(rotCos), rc1 = _mm_load_ps(rotCos + 4);
+    const __m128 rs0 = _mm_load_ps(rotSin), rs1 = _mm_load_ps(rotSin + 4);
+    __m128 a0 = _mm_load_ps(amp), a1v = _mm_load_ps(amp + 4);
+    const __m128 da0 = _mm_load_ps(ampStep), da1 = _mm_load_ps(ampStep + 4);
+    for (int i = 0; i < BlockFrames; ++i)
+    {
+        const __m128 n0 = _mm_sub_ps(_mm_mul_ps(c0, rc0), _mm_mul_ps(s0, rs0));
+        const __m128 n1 = _mm_sub_ps(_mm_mul_ps(c1, rc1), _mm_mul_ps(s1, rs1));
+        s0 = _mm_add_ps(_mm_mul_ps(c0, rs0), _mm_mul_ps(s0, rc0));
+        s1 = _mm_add_ps(_mm_mul_ps(c1, rs1), _mm_mul_ps(s1, rc1));
+        c0 = n0;
+        c1 = n1;
+
+        // Horizontal sum of the eight weighted partials
+        __m128 v = _mm_add_ps(_mm_mul_ps(a0, s0), _mm_mul_ps(a1v, s1));
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        out[i] = _mm_cvtss_f32(v);
+
+        a0 = _mm_add_ps(a0, da0);
+        a1v = _mm_add_ps(a1v, da1);
+    }
+    _mm_store_ps(cosv, c0);
+    _mm_store_ps(cosv + 4, c1);
+    _mm_store_ps(sinv, s0);
+    _mm_store_ps(sinv + 4, s1);
+    _mm_store_ps(amp, a0);
+    _mm_store_ps(amp + 4, a1v);
+#else
+    stepPartials(out);
+#endif
+}
+
+void EngineSynth::renderBlock(float* out)
+{
+    const float rate = static_cast<float>(preset.sampleRate);
+    const EngineSynthInput in = controls != nullptr ? controls->get() : EngineSynthInput{};
+    spool = std::clamp(in.spool, 0.0f, 1.0f);
+    thrust += (std::clamp(in.thrust, 0.0f, 1.0f) - thrust) * (1.0f - std::exp(-BlockFrames / rate / ThrustResponseSec));
+
+    // Frequencies and target gains for this block; gains ramp to them sample by sample
+    const float shaft = preset.idleShaftHz + (preset.fullShaftHz - preset.idleShaftHz) * spool;
+    const float bladePass = shaft * static_cast<float>(preset.blades);
+    const float whine = preset.whineLevel * (0.25f + 0.75f * spool);
+    const float rumble = preset.rumbleLevel * (0.5f + 0.5f * thrust);
+    for (int k = 0; k < 4; ++k)
+    {
+        const float h = static_cast<float>(k + 1);
+        const float freq[2] = { bladePass * h * (1.0f + preset.detune * h), shaft * h };
+        const float gain[2] = { whine * WhineShape[k], rumble * RumbleShape[k] };
+        for (int bank = 0; bank < 2; ++bank)
+        {
+            const int p = k + bank * 4;
+            const float step = TwoPi * freq[bank] / rate;
+            rotCos[p] = std::cos(step);
+            rotSin[p] = std::sin(step);
+            ampTarget[p] = freq[bank] < rate * 0.45f ? gain[bank] : 0.0f; // Nothing that would alias
+            ampStep[p] = (ampTarget[p] - amp[p]) / BlockFrames;
+
+            // Recurrence rounding slowly changes the phasor's length; put it back on the unit circle
+            const float len = std::sqrt(cosv[p] * cosv[p] + sinv[p] * sinv[p]);
+            cosv[p] /= len;
+            sinv[p] /= len;
+        }
+    }
+
+    if (useSimd)
+        stepPartialsSimd(out);
+    else
+        stepPartials(out);
+    std::copy(ampTarget, ampTarget + Partials, amp); // No drift from summing the steps
+
+    // Roar: white noise through an RBJ low-pass that opens with thrust
+    const float cutoff = std::min(preset.noiseLowHz + (preset.noiseHighHz - preset.noiseLowHz) * thrust, rate * 0.45f);
+    const float w = TwoPi * cutoff / rate;
+    const float alpha = std::sin(w) / (2.0f * 0.7071f);
+    const float a0 = 1.0f + alpha;
+    b1 = (1.0f - std::cos(w)) / a0;
+    b0 = b2 = b1 * 0.5f;
+    a1 = -2.0f * std::cos(w) / a0;
+    a2 = (1.0f - alpha) / a0;
+    const float noiseTarget = preset.noiseLevel * (0.15f + 0.85f * thrust);
+    const float noiseStep = (noiseTarget - noiseGain) / BlockFrames;
+    for (int i = 0; i < BlockFrames; ++i)
+    {
+        noiseState ^= noiseState << 13;
+        noiseState ^= noiseState >> 17;
+        noiseState ^= noiseState << 5;
+        const float x = static_cast<float>(static_cast<int32_t>(noiseState)) * (1.0f / 2147483648.0f);
+        const float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+        out[i] = std::clamp((out[i] + y * noiseGain) * preset.masterLevel, -1.0f, 1.0f);
+        noiseGain += noiseStep;
+    }
+    noiseGain = noiseTarget;
+}
+
+void EngineSynth::render(int16_t* out, int frames)
+{
+    for (int i = 0; i < frames; ++i)
+    {
+        if (blockPos == BlockFrames)
+        {
+            renderBlock(block);
+            blockPos = 0;
+        }
+        out[i] = static_cast<int16_t>(block[blockPos++] * 32767.0f);
+    }
+}
+
+EngineSynthStream::EngineSynthStream(const EngineSynthPreset& preset, const EngineSynthControls* controls, IRefCounted* owner)
+    : synth(preset, controls), owner(owner)
+{
+    owner->grab();
+    profileId = Profiler::get().registerTimer("Audio: engine synth (mixer)");
+}
+
+EngineSynthStream::~EngineSynthStream()
+{
+    owner->drop();
+}
+
+SAudioStreamFormat EngineSynthStream::getFormat()
+{
+    SAudioStreamFormat f;
+    f.ChannelCount = 1; // Mono, so irrKlang can place it in 3D
+    f.FrameCount = -1;  // Endless
+    f.SampleRate = synth.getPreset().sampleRate;
+    f.SampleFormat = ESF_S16;
+    return f;
+}
+
+ik_s32 EngineSynthStream::readFrames(void* target, ik_s32 frameCountToRead)
+{
+    ProfileScope profile(profileId);
+    synth.render(static_cast<int16_t*>(target), frameCountToRead);
+    return frameCountToRead;
+}
+
+bool EngineSynthLoader::isALoadableFileExtension(const ik_c8* fileName)
+{
+    const size_t n = std::strlen(fileName);
+    return n >= 6 && std::strcmp(fileName + n - 6, ".synth") == 0;
+}
+
+IAudioStream* EngineSynthLoader::createAudioStream(IFileReader* file)
+{
+    std::string text(static_cast<size_t>(std::max(file->getSize(), 0)), '\0');
+    file->seek(0);
+    text.resize(static_cast<size_t>(std::max(file->read(text.data(), static_cast<ik_u32>(text.size())), 0)));
+
+    EngineSynthPreset preset;
+    ConfigRegistry registry;
+    EngineSynthPreset::registerWith(registry, preset);
+    const auto values = ConfigRegistry::parseConf(text);
+    registry.resolve([&values](const std::string& key)
+        {
+            auto it = values.find(key);
+            return it != values.end() ? it->second : std::string();
+        });
+    return new EngineSynthStream(preset, &controls, this);
+}
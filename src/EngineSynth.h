@@ -0,0 +1,131 @@
+#pragma once
+
+#include <irrKlang.h>
+#include <atomic>
+#include <cstdint>
+
+namespace Aftr
+{
+    class ConfigRegistry;
+
+    // Voice of the synthesized jet engine, read from a .synth file of key=value lines (the
+    // member names). Frequencies are Hz; levels are linear gains of the mono output.
+    struct EngineSynthPreset
+    {
+        int sampleRate = 44100;
+        float idleShaftHz = 45.0f;   // Spool rotation at idle ...
+        float fullShaftHz = 140.0f;  // ... and at full power
+        int blades = 12;             // Turbine whine sits at shaft speed x blades
+        float detune = 0.004f;       // Spread of the whine harmonics, so they beat like a real fan stage
+        float whineLevel = 0.25f;
+        float rumbleLevel = 0.2f;    // Shaft harmonics
+        float noiseLevel = 0.3f;     // Combustion roar
+        float noiseLowHz = 400.0f;   // Roar's low-pass cutoff at zero thrust ...
+        float noiseHighHz = 3500.0f; // ... and at full thrust
+        float masterLevel = 0.8f;
+
+        static void registerWith(ConfigRegistry& registry, EngineSynthPreset& p);
+    };
+
+    // What the sim tells the synth. spool is the smoothed engine speed (0 idle .. 1 full),
+    // thrust the throttle setting. Both in [0,1].
+    struct EngineSynthInput
+    {
+        float spool = 0.0f;
+        float thrust = 0.0f;
+    };
+
+    // Handover from the sim thread to irrKlang's mixer: one 8-byte atomic, so neither side locks.
+    class EngineSynthControls
+    {
+    public:
+        void set(const EngineSynthInput& in) { input.store(in, std::memory_order_relaxed); }
+        EngineSynthInput get() const { return input.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<EngineSynthInput> input{ EngineSynthInput{} };
+        static_assert(std::atomic<EngineSynthInput>::is_always_lock_free, "The mixer thread must never wait on the sim");
+    };
+
+    /**
+       Procedural jet engine: a bank of eight sine partials (four whine harmonics of the blade
+       pass frequency, four rumble harmonics of the shaft) plus low-passed noise for the
+       combustion roar, all driven by spool and thrust. Output is mono 16-bit, made in fixed
+       BlockFrames blocks; controls are read once per block and every gain and frequency ramps
+       across the block, so a thrust step never clicks. The partials are rotating phasors held
+       structure-of-arrays and stepped four at a time with SSE where it is available.
+    */
+    class EngineSynth
+    {
+    public:
+        static constexpr int BlockFrames = 256;
+        static constexpr int Partials = 8;
+
+        EngineSynth(const EngineSynthPreset& preset, const EngineSynthControls* controls);
+
+        // Fills any number of frames; internally always whole blocks.
+        void render(int16_t* out, int frames);
+        void renderBlock(float* out); // BlockFrames samples in [-1, 1]
+
+        void setUseSimd(bool on) { useSimd = on && hasSimd(); }
+        static bool hasSimd();
+        const EngineSynthPreset& getPreset() const { return preset; }
+
+    private:
+        void stepPartials(float* out);
+        void stepPartialsSimd(float* out);
+
+        EngineSynthPreset preset;
+        const EngineSynthControls* controls;
+        bool useSimd;
+
+        // Partial state, structure-of-arrays for the SIMD path
+        alignas(16) float cosv[Partials];
+        alignas(16) float sinv[Partials];
+        alignas(16) float rotCos[Partials];
+        alignas(16) float rotSin[Partials];
+        alignas(16) float amp[Partials];
+        alignas(16) float ampStep[Partials];
+        alignas(16) float ampTarget[Partials];
+
+        float spool = 0.0f;
+        float thrust = 0.0f;
+        uint32_t noiseState = 0x12345678u;
+        float b0 = 0, b1 = 0, b2 = 0, a1 = 0, a2 = 0; // Roar low-pass biquad
+        float x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        float noiseGain = 0.0f;
+
+        float block[BlockFrames];
+        int blockPos = BlockFrames; // Samples of block already handed out
+    };
+
+    // irrKlang stream over an EngineSynth; never ends, so play it looped or not, it runs until stopped.
+    class EngineSynthStream : public irrklang::IAudioStream
+    {
+    public:
+        EngineSynthStream(const EngineSynthPreset& preset, const EngineSynthControls* controls, irrklang::IRefCounted* owner);
+        ~EngineSynthStream() override;
+
+        irrklang::SAudioStreamFormat getFormat() override;
+        bool setPosition(irrklang::ik_s32 pos) override { return pos >= 0; }
+        irrklang::ik_s32 readFrames(void* target, irrklang::ik_s32 frameCountToRead) override;
+
+    private:
+        EngineSynth synth;
+        irrklang::IRefCounted* owner; // Keeps the controls alive
+        int profileId;
+    };
+
+    // Makes any "*.synth" preset file an engine sound driven by getControls().
+    class EngineSynthLoader : public irrklang::IAudioStreamLoader
+    {
+    public:
+        bool isALoadableFileExtension(const irrklang::ik_c8* fileName) override;
+        irrklang::IAudioStream* createAudioStream(irrklang::IFileReader* file) override;
+
+        EngineSynthControls& getControls() { return controls; }
+
+    private:
+        EngineSynthControls controls;
+    };
+}
@@ -0,0 +1,172 @@
+#include "FileWatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace Aftr;
+
+namespace
+{
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void readStamp(const std::string& path, int64_t& stamp, int64_t& size)
+    {
+        std::error_code ec;
+        const auto t = std::filesystem::last_write_time(path, ec);
+        stamp = ec ? -1 : static_cast<int64_t>(t.time_since_epoch().count());
+        const auto s = std::filesystem::file_size(path, ec);
+        size = ec ? -1 : static_cast<int64_t>(s);
+    }
+}
+
+void FileWatcher::watch(const std::string& path)
+{
+    Watched w;
+    w.path = path;
+    const std::filesystem::path p(path);
+    w.folder = p.has_parent_path() ? p.parent_path().string() : ".";
+    w.name = p.filename().string();
+    files.push_back(w);
+}
+
+void FileWatcher::start(ChangedFn changed, int poll, int settle)
+{
+    stop();
+    onChanged = std::move(changed);
+    pollMs = std::max(poll, 1);
+    settleMs = std::max(settle, 0);
+    for (Watched& w : files)
+    {
+        readStamp(w.path, w.stamp, w.size);
+        w.dueMs = -1;
+    }
+
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    folderWatches.clear();
+    for (const Watched& w : files)
+    {
+        const int wd = inotifyFd >= 0 ? inotify_add_watch(inotifyFd, w.folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) : -1;
+        if (wd < 0 && inotifyFd >= 0)
+        {
+            close(inotifyFd); // A folder that can't be watched sends everything to the polling path
+            inotifyFd = -1;
+        }
+        folderWatches.push_back(wd);
+    }
+#endif
+
+    running = true;
+    worker = std::thread(&FileWatcher::run, this);
+}
+
+void FileWatcher::stop()
+{
+    running = false;
+    if (worker.joinable())
+        worker.join();
+#ifdef __linux__
+    if (inotifyFd >= 0)
+        close(inotifyFd);
+#endif
+    inotifyFd = -1;
+}
+
+void FileWatcher::run()
+{
+    while (running)
+    {
+        // Wake for the next poll or for the earliest pending change to settle, whichever is first
+        int64_t now = nowMs();
+        int64_t waitMs = pollMs;
+        for (const Watched& w : files)
+        {
+            if (w.dueMs >= 0)
+                waitMs = std::min(waitMs, std::max<int64_t>(w.dueMs - now, 0));
+        }
+
+        if (inotifyFd >= 0)
+        {
+#ifdef __linux__
+            pollfd pfd{ inotifyFd, POLLIN, 0 };
+            ::poll(&pfd, 1, static_cast<int>(waitMs)); // Bounded so stop() is noticed within pollMs
+            readInotify(nowMs());
+#endif
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
+            pollStamps(nowMs());
+        }
+
+        now = nowMs();
+        for (Watched& w : files)
+        {
+            if (w.dueMs >= 0 && now >= w.dueMs)
+            {
+                w.dueMs = -1;
+                if (onChanged)
+                    onChanged(w.path);
+            }
+        }
+    }
+}
+
+bool FileWatcher::readInotify(int64_t now)
+{
+    bool any = false;
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    for (;;)
+    {
+        const ssize_t n = read(inotifyFd, buffer, sizeof(buffer));
+        if (n <= 0)
+            break;
+        for (ssize_t offset = 0; offset < n;)
+        {
+            const inotify_event* e = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + e->len;
+            if (e->len == 0)
+                continue;
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                if (folderWatches[i] == e->wd && files[i].name == e->name)
+                {
+                    files[i].dueMs = now + settleMs; // Restarted by every further event in the burst
+                    any = true;
+                }
+            }
+        }
+    }
+#else
+    (void)now;
+#endif
+    return any;
+}
+
+bool FileWatcher::pollStamps(int64_t now)
+{
+    bool any = false;
+    for (Watched& w : files)
+    {
+        int64_t stamp, size;
+        readStamp(w.path, stamp, size);
+        if (stamp != w.stamp || size != w.size)
+        {
+            w.stamp = stamp;
+            w.size = size;
+            w.dueMs = now + settleMs;
+            any = true;
+        }
+    }
+    return any;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       Watches a fixed set of files and reports each one that changes, on a background thread.
+       On Linux it blocks in inotify on the files' folders, so saves made by replacing the file
+       (write to a temp, rename over) are seen as well as in-place writes. Elsewhere, or if
+       inotify is unavailable, it polls modification time and size. A burst of events for one
+       file within the settle time is reported once, after the writer has finished.
+    */
+    class FileWatcher
+    {
+    public:
+        using ChangedFn = std::function<void(const std::string& path)>;
+
+        FileWatcher() = default;
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+        ~FileWatcher() { stop(); }
+
+        void watch(const std::string& path); // Before start()
+        void clear() { stop(); files.clear(); }
+        // onChanged runs on the watcher thread with the path exactly as given to watch().
+        void start(ChangedFn onChanged, int pollMs = 250, int settleMs = 50);
+        void stop();
+        bool isUsingInotify() const { return inotifyFd >= 0; }
+
+    private:
+        struct Watched
+        {
+            std::string path;
+            std::string folder;
+            std::string name;
+            int64_t stamp = -1; // Polling fallback: mtime and size folded together
+            int64_t size = -1;
+            int64_t dueMs = -1;  // When a pending change is reported, -1 if none
+        };
+
+        void run();
+        bool readInotify(int64_t nowMs);
+        bool pollStamps(int64_t nowMs);
+
+        std::vector<Watched> files;
+        std::vector<int> folderWatches; // inotify watch descriptor per entry in files
+        ChangedFn onChanged;
+        int pollMs = 250;
+        int settleMs = 50;
+        int inotifyFd = -1;
+        std::atomic<bool> running{ false };
+        std::thread worker;
+    };
+}
@@ -0,0 +1,32 @@
+#include "FlightModel.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Aftr;
+
+void FlightModel::step(FlightState& s, const FlightControls& c, const Vector& wind, float dt) const
+{
+    const float thrust = std::clamp(c.thrust, 0.0f, 1.0f);
+    const float targetSpeed = thrust * params.maxAirspeed;
+    s.airspeed += (targetSpeed - s.airspeed) * std::min(dt / params.spoolTimeSec, 1.0f);
+
+    s.roll = wrapRadians(s.roll + std::clamp(c.roll, -1.0f, 1.0f) * params.maxRollRate * dt);
+    s.pitch = std::clamp(s.pitch + std::clamp(c.pitch, -1.0f, 1.0f) * params.maxPitchRate * dt, -1.4f, 1.4f);
+    s.heading = wrapRadians(s.heading + (std::clamp(c.yaw, -1.0f, 1.0f) * params.maxYawRate + params.bankTurnGain * std::sin(s.roll)) * dt);
+
+    s.velocity = lookDirection(s) * s.airspeed + wind;
+    s.position += s.velocity * dt;
+
+    if (s.position.z <= params.groundLevel)
+    {
+        s.position.z = params.groundLevel;
+        s.velocity.z = std::max(s.velocity.z, 0.0f);
+        s.pitch = std::max(s.pitch, 0.0f);
+    }
+}
+
+Vector FlightModel::lookDirection(const FlightState& s)
+{
+    const float cp = std::cos(s.pitch);
+    return Vector(cp * std::cos(s.heading), cp * std::sin(s.heading), std::sin(s.pitch));
+}
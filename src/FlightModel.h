@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Vector.h"
+
+namespace Aftr
+{
+    // Pilot or autopilot inputs. thrust is in [0,1]; roll, pitch and yaw are normalized rate demands in [-1,1].
+    struct FlightControls
+    {
+        float thrust = 0.0f;
+        float roll = 0.0f;
+        float pitch = 0.0f;
+        float yaw = 0.0f;
+    };
+
+    // Kinematic aircraft state. Angles are radians; heading is measured from +X toward +Y,
+    // pitch is positive nose up and roll is positive right wing down.
+    struct FlightState
+    {
+        Vector position{ 0, 0, 0 };
+        Vector velocity{ 0, 0, 0 }; // Inertial velocity including wind, world units/sec
+        float heading = 0.0f;
+        float pitch = 0.0f;
+        float roll = 0.0f;
+        float airspeed = 0.0f;
+    };
+
+    // Wraps an angle into [-pi, pi] radians.
+    inline float wrapRadians(float a)
+    {
+        constexpr float Pi = 3.14159265358979f;
+        while (a > Pi)
+            a -= 2.0f * Pi;
+        while (a < -Pi)
+            a += 2.0f * Pi;
+        return a;
+    }
+
+    struct FlightModelParams
+    {
+        float maxAirspeed = 6.0f;   // Airspeed at full thrust, world units/sec
+        float spoolTimeSec = 1.5f;  // Time constant for airspeed to follow thrust
+        float maxRollRate = 1.2f;   // rad/sec at full stick
+        float maxPitchRate = 0.6f;
+        float maxYawRate = 0.6f;
+        float bankTurnGain = 0.8f;  // Heading rate per unit sin(roll), rad/sec
+        float groundLevel = 1.1f;   // Lowest z the jet can occupy (resting on the runway)
+    };
+
+    /**
+       Fixed-step kinematic flight model. It has no engine dependencies beyond Vector so it can
+       be stepped headless, in batches, or ahead of time for prediction.
+    */
+    class FlightModel
+    {
+    public:
+        static constexpr float FixedStepSec = 1.0f / 120.0f;
+
+        FlightModel() = default;
+        explicit FlightModel(const FlightModelParams& params) : params(params) {}
+
+        void step(FlightState& state, const FlightControls& controls, const Vector& wind, float dt) const;
+
+        static Vector lookDirection(const FlightState& state);
+
+        const FlightModelParams& getParams() const { return params; }
+        FlightModelParams& getParams() { return params; }
+
+    private:
+        FlightModelParams params;
+    };
+}
@@ -3,8 +3,13 @@
 #include "ManagerOpenGLState.h"
 #include "Axes.h"
 #include "PhysicsEngineODE.h"
+#include "AftrUtilities.h"
 #include <irrKlang.h>
 #include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+#include <random>
 
 // Different WO used by this module
 #include "WO.h"
@@ -34,9 +39,26 @@
 #include "WOImGui.h"
 #include "AftrImGuiIncludes.h"
 #include "AftrGLRendererBase.h"
+#include "MGLDynamicLines.h"
+#include "Profiler.h"
+#include "WOInstanced.h"
 
 using namespace Aftr;
 
+namespace
+{
+    irrklang::vec3df toIrr(const Vector& v) { return irrklang::vec3df(v.x, v.y, v.z); }
+
+    void setPose(WO* wo, const Vector& position, float heading, float pitch, float roll)
+    {
+        wo->rotateToIdentity();
+        wo->rotateAboutGlobalX(roll);
+        wo->rotateAboutGlobalY(-pitch);
+        wo->rotateAboutGlobalZ(heading);
+        wo->setPosition(position);
+    }
+}
+
 GLViewNewModule* GLViewNewModule::New(const std::vector<std::string>& args)
 {
     GLViewNewModule* glv = new GLViewNewModule(args);
@@ -48,7 +70,6 @@ GLViewNewModule* GLViewNewModule::New(const std::vector<std::string>& args)
 GLViewNewModule::GLViewNewModule(const std::vector<std::string>& args) : GLView(args)
 {
     count = 0;
-    soundEngine = irrklang::createIrrKlangDevice();
 
     thrust = 0.0f;
     roll = 0.0f;
@@ -64,37 +85,69 @@ void GLViewNewModule::onCreate()
     if (this->pe != NULL)
     {
         this->pe->setGravityNormalizedVector(Vector(0, 0, -1.0f));
-        this->pe->setGravityScalar(0.1f);
+        this->pe->setGravityScalar(params->gravityScalar);
     }
     this->setActorChaseType(STANDARDEZNAV);
     lastPosition = initialPosition;
+    loadWind();
+    soundEngine = AudioService::get().acquire(audioDriver, audioCaptureFile, ManagerEnvironmentConfiguration::getLMM() + "/sounds");
+    if (soundEngine != nullptr)
+        soundEngine->setDopplerEffectParameters(params->dopplerFactor, params->audioMetersPerUnit);
+    voices.setRecordEvents(AudioService::get().isHeadless());
+    audioMixProfileId = Profiler::get().registerTimer("Audio: mix");
+    predictor.start(flightModel, autopilot, &wind);
+    updateWorldProfileId = Profiler::get().registerTimer("updateWorld");
 }
 
 GLViewNewModule::~GLViewNewModule()
 {
-    if (soundEngine)
+    if (!voices.getEvents().empty() && !audioCaptureFile.empty())
     {
-        soundEngine->drop();
+        // Next to the capture, so a headless run can be checked for which sounds fired when
+        if (FILE* f = fopen((audioCaptureFile + ".events.csv").c_str(), "w"))
+        {
+            fprintf(f, "time,sound,x,y,z\n");
+            for (const VoiceManager::Event& e : voices.getEvents())
+                fprintf(f, "%.4f,%s,%.2f,%.2f,%.2f\n", e.timeSec, AudioBank::getAsset(e.sound).file, e.position.x, e.position.y, e.position.z);
+            fclose(f);
+        }
     }
+    voices.clear();
+    AudioService::get().release(); // The device and bank stay open for the next GLView after a restart
 }
 
 void GLViewNewModule::updateWorld()
 {
+    ProfileScope profile(updateWorldProfileId);
     GLView::updateWorld();
+    MGLInstanced::resetFrameCounters();
 
     float deltaTime = getDeltaTime();
 
-    if (recording)
+    // Reloaded config and scenario snapshots take effect here, between ticks
+    if (std::shared_ptr<const SimParams> p = config.getParams(); p != params)
+    {
+        params = std::move(p);
+        applyParams();
+    }
+    if (std::shared_ptr<const Scenario> s = config.getScenario(); s != nullptr && s != scenario)
+    {
+        scenario = std::move(s);
+        applyScenario();
+        printf("Scenario '%s' reloaded; objects and skies change on the next restart.\n", scenario->getName());
+    }
+
+    if (recording && jet != nullptr)
     {
         recordFlightPath();
     }
 
-    if (playingBack)
+    if (playingBack && jet != nullptr)
     {
         playbackFlightPath();
     }
 
-    if (takeOff)
+    if (takeOff && !playingBack)
     {
         if (jet == nullptr)
         {
@@ -102,36 +155,100 @@ void GLViewNewModule::updateWorld()
             return;
         }
 
-        Vector lookDirection = jet->getLookDirection();
-        Vector thrustVector = lookDirection * thrust * 0.1f;
-        jet->moveRelative(thrustVector);
-
-        if (jet->getPosition().x > 30)
+        // Flight logic runs at a fixed rate independent of the render rate. The accumulator is
+        // capped so a long stall (window drag, breakpoint) doesn't trigger a burst of catch-up steps.
+        physicsAccumulator = std::min(physicsAccumulator + deltaTime, FlightModel::FixedStepSec * MaxPhysicsStepsPerFrame);
+        while (physicsAccumulator >= FlightModel::FixedStepSec)
         {
-            jet->moveRelative(Vector(0, 0, thrust * 0.05f));
+            stepFlight(FlightModel::FixedStepSec);
+            physicsAccumulator -= FlightModel::FixedStepSec;
         }
+        syncJetToFlightState();
+        score += objectiveTracker.update(*scenario, jetState, simTime, flightModel.getParams().groundLevel);
 
         checkCollision();
-        updateFlightStats();
+        updateFlightStats(deltaTime);
+
+        if (showPrediction)
+        {
+            TrajectoryPredictor::Request request;
+            request.state = jetState;
+            request.controls = FlightControls{ thrust, roll, pitch, yaw };
+            request.autopilotState = autopilotState;
+            request.autopilotTargets = autopilotTargets;
+            request.simTimeSec = simTime;
+            request.horizonSec = predictionHorizonSec;
+            predictor.submit(request, route);
+        }
     }
 
-    if (jet != nullptr)
+    if (predictor.fetch(predictedPath))
     {
-        jet->rotateAboutGlobalX(pitch);
-        jet->rotateAboutGlobalY(roll);
-        jet->rotateAboutGlobalZ(yaw);
+        rebuildPredictionRibbon();
     }
 
+    loader.pump(this->cam->getPosition(), LoadBudgetMsPerFrame);
+
+    trafficTime += deltaTime;
+    traffic.update(trafficTime);
+    updateNetwork(deltaTime);
+    skies.update(deltaTime);
+
     updateCamera(); // Update the camera position and orientation
+    updateAudio(deltaTime);
+    culler.cull(*this->cam);
+    traffic.rebuildBatches(this->cam->getPosition());
 
     pitch = 0.0f;
     roll = 0.0f;
     yaw = 0.0f;
 }
 
+void GLViewNewModule::stepFlight(float dt)
+{
+    autopilotTargets.waypoints = route.data();
+    autopilotTargets.waypointCount = route.size();
+
+    FlightControls pilot{ thrust, roll, pitch, yaw };
+    FlightControls controls = autopilot.step(autopilotState, autopilotTargets, jetState, pilot, flightModel.getParams(), dt);
+
+    simTime += dt;
+    currentWind = wind.sample(jetState.position, simTime);
+    if (jetPrediction != nullptr)
+    {
+        // The server steps this same input; updateNetwork() replays from its state when the two disagree
+        const float climbAssist = !autopilotState.engaged && jetState.position.x > 30 ? controls.thrust * params->takeoffClimbRate : 0.0f;
+        replicationClient->sendInput(jetPrediction->step(controls, currentWind, climbAssist));
+        jetState = jetPrediction->getState();
+    }
+    else
+    {
+        flightModel.step(jetState, controls, currentWind, dt);
+
+        if (!autopilotState.engaged && jetState.position.x > 30)
+        {
+            // Takeoff assist for manual flight: climb once the jet is past the end of the runway
+            jetState.position.z += controls.thrust * params->takeoffClimbRate * dt;
+        }
+    }
+
+    if (autopilotState.engaged && (autopilotState.modes & apmSPEED_HOLD))
+    {
+        thrust = controls.thrust; // Keeps the thrust slider in step with the autothrottle
+    }
+}
+
+void GLViewNewModule::syncJetToFlightState()
+{
+    // A correction from the server is drawn eased in, not as a jump
+    const Vector offset = jetPrediction != nullptr ? jetPrediction->getRenderOffset() : Vector(0, 0, 0);
+    setPose(jet, jetState.position + offset, jetState.heading, jetState.pitch, jetState.roll);
+}
+
 void GLViewNewModule::onResizeWindow(GLsizei width, GLsizei height)
 {
     GLView::onResizeWindow(width, height);
+    culler.setViewportHeight(static_cast<float>(height));
 }
 
 void GLViewNewModule::onMouseDown(const SDL_MouseButtonEvent& e)
@@ -164,25 +281,34 @@ void GLViewNewModule::onKeyDown(const SDL_KeyboardEvent& key)
     {
         if (!isCubePlaced)
         {
-            std::string shinyRedPlasticCubeModel(ManagerEnvironmentConfiguration::getSMM() + "/models/cube4x4x4redShinyPlastic_pp.wrl");
-            shinyRedPlasticCube = WO::New(shinyRedPlasticCubeModel, Vector(1, 1, 1), MESH_SHADING_TYPE::mstFLAT);
-            shinyRedPlasticCube->setPosition(Vector(10, 0, 1.1f)); // Place the cube just above the runway
-            shinyRedPlasticCube->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
-            shinyRedPlasticCube->setLabel("Shiny Red Plastic Cube");
-            worldLst->push_back(shinyRedPlasticCube);
+            shinyRedPlasticCube = cubePool.acquire(scenario->getCube()); // Where the scenario drops it, just above the runway by default
+            if (shinyRedPlasticCube == nullptr)
+                return;
             isCubePlaced = true;
+
+            Vector half(2, 2, 2); // cube4x4x4 at unit scale
+            cubeObstacleId = routePlanner.addObstacle(shinyRedPlasticCube->getPosition() - half, shinyRedPlasticCube->getPosition() + half);
         }
         else
         {
-            worldLst->eraseViaWOptr(shinyRedPlasticCube);
+            cubePool.release(shinyRedPlasticCube);
             shinyRedPlasticCube = nullptr;
             isCubePlaced = false;
+
+            routePlanner.removeObstacle(cubeObstacleId);
+            cubeObstacleId = -1;
+        }
+
+        if (routeActive)
+        {
+            replanRoute();
         }
     }
 
     if (key.keysym.sym == SDLK_c)
     {
-        soundEngine->stopAllSounds();
+        voices.remove(engineVoice); // Silences the jet; startTakeoff brings it back
+        engineVoice = -1;
     }
 
     if (key.keysym.sym == SDLK_r)
@@ -204,13 +330,19 @@ void GLViewNewModule::onKeyUp(const SDL_KeyboardEvent& key)
 
 bool GLViewNewModule::checkCollision()
 {
+    if (jet != nullptr && objectiveTracker.hitsObstacle(*scenario, jet->getPosition(), 1.0f))
+    {
+        handleCollision();
+        return true;
+    }
+
     if (shinyRedPlasticCube != nullptr && jet != nullptr)
     {
         Vector jetPos = jet->getPosition();
         Vector cubePos = shinyRedPlasticCube->getPosition();
 
         float distance = (jetPos - cubePos).length();
-        float collisionDistance = 8.0f;
+        float collisionDistance = params->collisionDistance;
 
         if (distance < collisionDistance)
         {
@@ -228,7 +360,13 @@ void GLViewNewModule::handleCollision()
     collisionCooldown = 1.0f;
     printf("Collision detected! Stopping jet.");
 
-    soundEngine->play2D((ManagerEnvironmentConfiguration::getLMM() + "/sounds/explosion.wav").c_str(), false);
+    VoiceManager::Emitter explosion;
+    explosion.sound = SoundId::EXPLOSION;
+    explosion.position = jetState.position;
+    explosion.priority = 20.0f; // Always worth a voice over the traffic
+    explosion.minDistance = 50.0f;
+    explosion.looped = false;
+    voices.add(explosion);
 
     thrust = 0.0f;
 }
@@ -240,18 +378,39 @@ void GLViewNewModule::resetFlight()
     pitch = 0.0f;
     yaw = 0.0f;
     takeOff = false;
-    jet->setPosition(initialPosition);
-    jet->rotateToIdentity();
-    soundEngine->stopAllSounds();
+    if (jet != nullptr)
+    {
+        jet->setPosition(initialPosition);
+        jet->rotateToIdentity();
+        jet->rotateAboutGlobalZ(scenario->getHeader().startHeading);
+    }
+    jetState = FlightState{};
+    jetState.position = initialPosition;
+    jetState.heading = scenario->getHeader().startHeading;
+    if (jetPrediction != nullptr)
+        jetPrediction->respawn(jetState);
+    autopilotState = AutopilotState{};
+    objectiveTracker.reset(*scenario);
+    score = 0;
+    physicsAccumulator = 0.0f;
+    voices.remove(engineVoice);
+    engineVoice = -1;
     totalDistance = 0.0f;
+    simTime = 0.0f;
     altitude = 0.0f;
     speed = 0.0f;
     lastPosition = initialPosition;
     updateCamera(); // Reset the camera
+    engineSound.reset(); // The camera jumped; don't hear that as velocity
 }
 
 void GLViewNewModule::startTakeoff()
 {
+    if (jet == nullptr)
+    {
+        printf("Jet is still loading.\n");
+        return;
+    }
     if (isCubePlaced && checkCollision())
     {
         printf("Warning: Collision detected with the obstacle!\n");
@@ -260,16 +419,26 @@ void GLViewNewModule::startTakeoff()
     {
         takeOff = true;
         thrust = 1.0f;
-        count = ++count;
 
-        if (count == 1)
-        {
-            this->objSnd = soundEngine->play3D((ManagerEnvironmentConfiguration::getLMM() + "/sounds/airplane-fly-by-01a.wav").c_str(), irrklang::vec3df(this->cam->getPosition().x, this->cam->getPosition().y, this->cam->getPosition().z), true);
-        }
+        Vector look = jet->getLookDirection();
+        jetState = FlightState{};
+        jetState.position = jet->getPosition();
+        jetState.heading = std::atan2(look.y, look.x);
+        jetState.pitch = std::asin(std::clamp(look.z, -1.0f, 1.0f));
+        if (jetPrediction != nullptr)
+            jetPrediction->respawn(jetState);
+        physicsAccumulator = 0.0f;
+        count = ++count;
 
-        if (this->objSnd != nullptr && count == 1)
+        if (!voices.isValid(engineVoice))
         {
-            this->objSnd->setPosition(irrklang::vec3df(jet->getPosition().x, jet->getPosition().y, jet->getPosition().z));
+            // Started again after 'c' or a reset removed it; updateAudio moves it with the jet from here on
+            VoiceManager::Emitter engine;
+            engine.sound = SoundId::ENGINE_LOOP;
+            engine.position = jet->getPosition();
+            engine.priority = 10.0f;
+            engine.minDistance = 15.0f;
+            engineVoice = voices.add(engine);
         }
 
         printf("Plane taking off!\n");
@@ -306,24 +475,7 @@ void GLViewNewModule::playbackFlightPath()
 void GLViewNewModule::toggleDayNight()
 {
     isDay = !isDay;
-    if (skyBox != nullptr)
-    {
-        worldLst->eraseViaWOptr(skyBox);
-    }
-
-    if (isDay)
-    {
-        skyBox = WOSkyBox::New(ManagerEnvironmentConfiguration::getSMM() + "/images/skyboxes/sky_mountains+6.jpg", this->getCameraPtrPtr());
-    }
-    else
-    {
-        skyBox = WOSkyBox::New(ManagerEnvironmentConfiguration::getSMM() + "/images/skyboxes/space_gray_matter+6.jpg", this->getCameraPtrPtr());
-    }
-
-    skyBox->setPosition(Vector(0, 0, 0));
-    skyBox->setLabel("Sky Box");
-    skyBox->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
-    worldLst->push_back(skyBox);
+    skies.transitionTo(isDay ? 12.0f : 0.0f, 3.0f);
 }
 
 Vector GLViewNewModule::calculateRotationAngles(const Vector& direction)
@@ -333,14 +485,14 @@ Vector GLViewNewModule::calculateRotationAngles(const Vector& direction)
     return Vector(pitch, yaw, 0);
 }
 
-void GLViewNewModule::updateFlightStats()
+void GLViewNewModule::updateFlightStats(float deltaTime)
 {
     altitude = jet->getPosition().z;
     Vector currentPosition = jet->getPosition();
     Vector distanceVector = currentPosition - lastPosition;
     float distanceTraveled = distanceVector.length();
     totalDistance += distanceTraveled;
-    speed = distanceTraveled / getDeltaTime();
+    speed = deltaTime > 0.0f ? distanceTraveled / deltaTime : 0.0f;
     lastPosition = currentPosition;
 }
 
@@ -352,6 +504,284 @@ float GLViewNewModule::getDeltaTime()
     return deltaTime.count();
 }
 
+void GLViewNewModule::loadWind()
+{
+    if (!windFieldFile.empty())
+        wind.getMeanField().loadFromFile(ManagerEnvironmentConfiguration::getLMM() + "/" + windFieldFile);
+
+    TurbulenceParams turbulence;
+    turbulence.sigma = Vector(turbulenceIntensity, turbulenceIntensity, turbulenceIntensity * 0.5f);
+    turbulence.seed = static_cast<uint64_t>(windSeed);
+    wind.getTurbulence().generate(turbulence);
+}
+
+void GLViewNewModule::replanRoute()
+{
+    if (jet == nullptr)
+        return; // Still loading
+    Vector start = takeOff ? jetState.position : jet->getPosition();
+    std::vector<Vector> planned;
+    if (!routePlanner.plan(start, routeGoal, planned))
+    {
+        printf("No route from (%.1f, %.1f, %.1f) to (%.1f, %.1f, %.1f).\n", start.x, start.y, start.z, routeGoal.x, routeGoal.y, routeGoal.z);
+        return;
+    }
+
+    route = std::move(planned);
+    autopilotState.activeWaypoint = 0;
+    routeActive = true;
+
+    for (WO* marker : routeMarkers)
+    {
+        culler.remove(marker);
+        worldLst->eraseViaWOptr(marker);
+    }
+    routeMarkers.clear();
+
+    WayPointParametersBase markerParams(this);
+    markerParams.frequency = 5000;
+    markerParams.useCamera = true;
+    markerParams.visible = true;
+    for (const Vector& wp : route)
+    {
+        WOWayPointSpherical* marker = WOWayPointSpherical::New(markerParams, 1.5f);
+        marker->setPosition(wp);
+        marker->setLabel("Route Waypoint");
+        worldLst->push_back(marker);
+        culler.add(marker, 2.0f);
+        routeMarkers.push_back(marker);
+    }
+}
+
+void GLViewNewModule::rebuildPredictionRibbon()
+{
+    ribbonVerts.clear();
+    ribbonColors.clear();
+    if (showPrediction && predictedPath.size() >= 2)
+    {
+        // Two rails and a rung per sample, fading from white to cyan with prediction time
+        const float halfWidth = 0.75f;
+        Vector prevLeft, prevRight;
+        for (size_t i = 0; i < predictedPath.size(); ++i)
+        {
+            const Vector& p = predictedPath[i];
+            Vector dir = (i + 1 < predictedPath.size() ? predictedPath[i + 1] : p) - (i > 0 ? predictedPath[i - 1] : p);
+            Vector side = dir.crossProduct(Vector(0, 0, 1));
+            if (side.length() < 1e-4f)
+            {
+                side = Vector(0, 1, 0);
+            }
+            side.normalize();
+            Vector left = p + side * halfWidth;
+            Vector right = p - side * halfWidth;
+
+            const float t = static_cast<float>(i) / (predictedPath.size() - 1);
+            aftrColor4ub c(static_cast<unsigned char>(255 * (1.0f - t)), 255, 255, static_cast<unsigned char>(255 * (1.0f - 0.7f * t)));
+            if (i > 0)
+            {
+                ribbonVerts.insert(ribbonVerts.end(), { prevLeft, left, prevRight, right });
+                ribbonColors.insert(ribbonColors.end(), { c, c, c, c });
+            }
+            ribbonVerts.insert(ribbonVerts.end(), { left, right });
+            ribbonColors.insert(ribbonColors.end(), { c, c });
+            prevLeft = left;
+            prevRight = right;
+        }
+    }
+    predictionRibbonModel->setLines(ribbonVerts, ribbonColors); // Rewrites the one GL buffer in place
+}
+
+void GLViewNewModule::spawnObstacleField(int count)
+{
+    for (int id : obstacleFieldIds)
+    {
+        routePlanner.removeObstacle(id);
+    }
+    obstacleFieldIds.clear();
+
+    MGLInstanced* cubes = obstacleField->getInstances();
+    cubes->clear();
+
+    // Fixed seed so the same count always produces the same field and planner results are comparable
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> xy(-180.0f, 180.0f);
+    std::uniform_real_distribution<float> z(2.0f, 50.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f * Aftr::DEGtoRAD);
+    const Vector half(2, 2, 2); // cube4x4x4 at unit scale
+    while (static_cast<int>(cubes->size()) < std::min<int>(count, cubes->getCapacity()))
+    {
+        Vector p(xy(rng), xy(rng), z(rng));
+        if (std::fabs(p.y) < 15.0f && p.x > -20.0f && p.x < 200.0f)
+            continue; // Keep the runway and climb-out corridor clear
+
+        cubes->add(InstanceTransform::fromPose(p, angle(rng), 0.0f, 0.0f, 1.0f));
+        obstacleFieldIds.push_back(routePlanner.addObstacle(p - half * 1.5f, p + half * 1.5f)); // Loose bound covers any heading
+    }
+
+    if (routeActive)
+    {
+        replanRoute();
+    }
+}
+
+void GLViewNewModule::updateAudio(float dt)
+{
+    if (soundEngine == nullptr)
+        return;
+
+    const bool running = takeOff && !playingBack && jet != nullptr;
+    const AudioFrame& f = engineSound.update(this->cam->getPosition(), this->cam->getLookDirection(), this->cam->getNormalDirection(),
+                                             jet != nullptr ? jet->getPosition() : jetState.position, jetState.velocity, thrust, running, dt);
+
+    // The device mixes on its own thread; these calls only post values to it, so nothing here waits on the mixer.
+    // Levels are sent only when they moved, since each set takes the device's lock.
+    soundEngine->setListenerPosition(toIrr(f.listener.position), toIrr(f.listener.look), toIrr(f.listener.velocity), toIrr(f.listener.up));
+    voices.move(engineVoice, f.engine.position, f.engine.velocity);
+    if (EngineSynthControls* synth = audio.getEngineSynth())
+    {
+        // The synth makes its own pitch from the spool, so the voice plays at its natural speed
+        synth->set(EngineSynthInput{ f.engine.spool, running ? thrust : 0.0f });
+        if (f.engine.levelsChanged)
+            voices.setLevels(engineVoice, 1.0f, f.engine.volume);
+    }
+    else if (f.engine.levelsChanged)
+    {
+        voices.setLevels(engineVoice, f.engine.playbackSpeed, f.engine.volume);
+    }
+    for (size_t i = 0; i < trafficVoices.size(); ++i)
+        voices.move(trafficVoices[i], traffic.getPosition(static_cast<int>(i)), traffic.getVelocity(static_cast<int>(i)));
+    voices.update(f.listener.position, dt);
+    if (AudioService::get().isHeadless())
+    {
+        ProfileScope mix(audioMixProfileId);
+        soundEngine->update();
+    }
+}
+
+void GLViewNewModule::startNetwork(const std::string& jetModel)
+{
+    if (netMode != "server" && netMode != "client")
+        return;
+
+    const bool isServer = netMode == "server";
+    NetAddress server;
+    if (!isServer && !NetAddress::parse(netServer, static_cast<uint16_t>(netPort), server))
+    {
+        printf("Replication: netServer=%s is not an address; staying offline\n", netServer.c_str());
+        return;
+    }
+    if (!netSocket.open(isServer ? static_cast<uint16_t>(netPort) : 0))
+        return;
+
+    NetEndpoint* endpoint = &netSocket;
+    if (netLossPercent > 0.0f || netLatencyMs > 0.0f)
+    {
+        NetConditions conditions;
+        conditions.lossPercent = netLossPercent;
+        conditions.latencyMs = netLatencyMs;
+        conditions.jitterMs = netLatencyMs * 0.25f;
+        netLink = std::make_unique<LinkSimulator>(netSocket, conditions);
+        endpoint = netLink.get();
+    }
+
+    if (isServer)
+    {
+        replicationServer = std::make_unique<ReplicationServer>(*endpoint);
+        replicationServer->enableClientJets(flightModel);
+        printf("Replication: serving on port %u\n", netSocket.getAddress().port);
+    }
+    else
+    {
+        replicationClient = std::make_unique<ReplicationClient>(*endpoint, server);
+        jetPrediction = std::make_unique<JetPredictor>(flightModel);
+        jetPrediction->respawn(jetState);
+        // The server sends each client at most maxRelevant aircraft, so that many jets always suffice
+        remoteJets.init(loader, *worldLst, &culler, jetModel, InterestParams{}.maxRelevant, 8.0f, "Remote Aircraft");
+        for (WO* wo : remoteJets.getObjects())
+            netLst->push_back(wo);
+        remoteJetOf.assign(NetFormat::MaxAircraftId + 1, nullptr);
+        remoteJetSeen.assign(remoteJetOf.size(), 0);
+        printf("Replication: client of %s\n", server.toString().c_str());
+    }
+    netUpdateProfileId = Profiler::get().registerTimer("Net: update");
+    netBytesCounterId = Profiler::get().registerCounter(isServer ? "Net: bytes/client/sec" : "Net: bytes/sec received");
+    netRelevantCounterId = Profiler::get().registerCounter("Net: relevant aircraft");
+    netExtrapolatedCounterId = Profiler::get().registerCounter("Net: extrapolated aircraft");
+    if (!isServer)
+        netCorrectionsCounterId = Profiler::get().registerCounter("Net: jet corrections");
+}
+
+void GLViewNewModule::updateNetwork(float dt)
+{
+    if (replicationServer != nullptr)
+    {
+        ProfileScope profile(netUpdateProfileId);
+        // The player's jet is id 0, then every traffic aircraft; interest management picks what each client gets
+        netAircraft.clear();
+        if (jet != nullptr)
+            netAircraft.push_back(NetAircraft{ 0, jetState.position, jetState.velocity, jetState.heading, jetState.pitch, jetState.roll });
+        for (int i = 0; i < traffic.getAircraftCount(); ++i)
+            netAircraft.push_back(NetAircraft{ static_cast<uint16_t>(1 + i), traffic.getPosition(i), traffic.getVelocity(i),
+                                               traffic.getHeading(i), 0.0f, traffic.getBank(i) });
+        replicationServer->update(dt, netAircraft.data(), netAircraft.size());
+
+        int relevant = 0;
+        for (size_t i = 0; i < replicationServer->getClientCount(); ++i)
+            relevant += replicationServer->getClientStats(i).relevant;
+        Profiler::get().setCounter(netBytesCounterId, static_cast<int64_t>(replicationServer->getBytesPerClientPerSecond()));
+        Profiler::get().setCounter(netRelevantCounterId, replicationServer->getClientCount() > 0 ? relevant / static_cast<int>(replicationServer->getClientCount()) : 0);
+    }
+    else if (replicationClient != nullptr)
+    {
+        ProfileScope profile(netUpdateProfileId);
+        // The server sends what is near this jet and in this camera's view
+        NetView view;
+        view.focus = jet != nullptr ? jetState.position : this->cam->getPosition();
+        view.eye = this->cam->getPosition();
+        view.look = this->cam->getLookDirection();
+        view.up = this->cam->getNormalDirection();
+        view.aspect = this->cam->getCameraAspectRatio();
+        view.verticalFov = 2.0f * std::atan(std::tan(this->cam->getCameraHorizontalFOVDeg() * Aftr::DEGtoRAD * 0.5f) / std::max(view.aspect, 1e-3f));
+        replicationClient->setView(view);
+        const uint64_t bytesBefore = replicationClient->getStats().bytes;
+        replicationClient->update(dt);
+
+        // The server flies this jet from the inputs stepFlight() sent; where it disagrees, its word stands
+        // and every input it has not yet stepped is replayed on top
+        if (!netConnected && replicationClient->isConnected() && takeOff)
+            jetPrediction->respawn(jetState); // What was flown before the server knew this client never reached it
+        netConnected = replicationClient->isConnected();
+        uint32_t seq;
+        FlightState authoritative;
+        if (replicationClient->takeJetState(seq, authoritative) && takeOff && jetPrediction->reconcile(seq, authoritative))
+            jetState = jetPrediction->getState();
+        jetPrediction->decay(dt);
+        if (takeOff && jet != nullptr)
+            syncJetToFlightState();
+        Profiler::get().setCounter(netCorrectionsCounterId, static_cast<int64_t>(jetPrediction->getStats().corrections));
+
+        std::fill(remoteJetSeen.begin(), remoteJetSeen.end(), 0);
+        for (const NetAircraft& a : replicationClient->getAircraft())
+        {
+            WO*& wo = remoteJetOf[a.id];
+            if (wo == nullptr && (wo = remoteJets.acquire(a.position)) == nullptr)
+                continue; // More aircraft than jets in the pool
+            setPose(wo, a.position, a.heading, a.pitch, a.roll);
+            remoteJetSeen[a.id] = 1;
+        }
+        for (size_t id = 0; id < remoteJetOf.size(); ++id)
+            if (remoteJetOf[id] != nullptr && !remoteJetSeen[id])
+            {
+                remoteJets.release(remoteJetOf[id]);
+                remoteJetOf[id] = nullptr;
+            }
+        Profiler::get().setCounter(netExtrapolatedCounterId, replicationClient->getStats().extrapolated);
+        Profiler::get().setCounter(netRelevantCounterId, static_cast<int64_t>(replicationClient->getAircraft().size()));
+        if (dt > 0.0f)
+            Profiler::get().setCounter(netBytesCounterId, static_cast<int64_t>((replicationClient->getStats().bytes - bytesBefore) / dt));
+    }
+}
+
 void GLViewNewModule::updateCamera()
 {
     if (jet != nullptr)
@@ -375,31 +805,43 @@ void GLViewNewModule::updateCamera()
 
 void Aftr::GLViewNewModule::loadMap()
 {
+    auto loadMapStart = std::chrono::steady_clock::now();
     this->worldLst = new WorldList();
     this->actorLst = new WorldList();
     this->netLst = new WorldList();
 
-    ManagerOpenGLState::GL_CLIPPING_PLANE = 1000.0;
-    ManagerOpenGLState::GL_NEAR_PLANE = 0.1f;
-    ManagerOpenGLState::enableFrustumCulling = false;
+    ManagerOpenGLState::enableFrustumCulling = false; // Culling is done by the module's SceneCuller instead
     Axes::isVisible = true;
     this->glRenderer->isUsingShadowMapping(false);
 
     this->cam->setPosition(15, 15, 10);
+    resolveStartupConfig();
+    loader.start(2);
 
     std::string shinyRedPlasticCube(ManagerEnvironmentConfiguration::getSMM() + "/models/cube4x4x4redShinyPlastic_pp.wrl");
-    std::string wheeledCar(ManagerEnvironmentConfiguration::getSMM() + "/models/rcx_treads.wrl");
-    std::string grass(ManagerEnvironmentConfiguration::getSMM() + "/models/grassFloor400x400_pp.wrl");
-    std::string human(ManagerEnvironmentConfiguration::getSMM() + "/models/human_chest.wrl");
     std::string jetModel(ManagerEnvironmentConfiguration::getSMM() + "/models/jet_wheels_down_PP.wrl");
-    std::string runwayTexture(ManagerEnvironmentConfiguration::getSMM() + "/models/road26x10.wrl");
 
+    loadStaticScene(); // Before the instanced batches below, which take their meshes from it
+    loadScenario();
+    params = config.getParams();
+    applyParams();
+    const ScenarioFormat::Header& sc = scenario->getHeader();
+
+    // The scenario's skies (day, night, ...), then any extra skies listed in aftr.conf's skyBoxes
+    // key (';' separated, relative to the shared mm folder)
     std::vector<std::string> skyBoxImageNames;
-    skyBoxImageNames.push_back(ManagerEnvironmentConfiguration::getSMM() + "/images/skyboxes/sky_mountains+6.jpg");
+    for (uint32_t i = 0; i < scenario->getSkyCount(); ++i)
+        skyBoxImageNames.push_back(ManagerEnvironmentConfiguration::getSMM() + "/" + scenario->getSky(i));
+    const std::string& extraSkies = extraSkyBoxes;
+    for (size_t start = 0; start < extraSkies.size();)
+    {
+        size_t end = std::min(extraSkies.find(';', start), extraSkies.size());
+        if (end > start)
+            skyBoxImageNames.push_back(ManagerEnvironmentConfiguration::getSMM() + "/" + extraSkies.substr(start, end - start));
+        start = end + 1;
+    }
 
     {
-        float ga = 0.1f;
-        ManagerLight::setGlobalAmbientLight(aftrColor4f(ga, ga, ga, 1.0f));
         WOLight* light = WOLight::New();
         light->isDirectionalLight(true);
         light->setPosition(Vector(0, 0, 100));
@@ -408,53 +850,86 @@ void Aftr::GLViewNewModule::loadMap()
         worldLst->push_back(light);
     }
 
+    skies.load(*worldLst, this->getCameraPtrPtr(), skyBoxImageNames);
+
+    for (uint32_t i = 0; i < scenario->getObjectCount(); ++i)
     {
-        WO* wo = WOSkyBox::New(skyBoxImageNames.at(0), this->getCameraPtrPtr());
-        wo->setPosition(Vector(0, 0, 0));
-        wo->setLabel("Sky Box");
+        const ScenarioFormat::Object& o = scenario->getObject(i);
+        WO* wo = WO::New(ManagerEnvironmentConfiguration::getSMM() + "/" + scenario->string(o.modelOffset),
+                         Vector(o.scale[0], o.scale[1], o.scale[2]), MESH_SHADING_TYPE::mstFLAT);
+        wo->setPosition(Vector(o.position[0], o.position[1], o.position[2]));
         wo->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
+        if (o.texRepeat > 0.0f)
+        {
+            const float texRepeat = o.texRepeat;
+            const float ambient = o.ambient;
+            wo->upon_async_model_loaded([wo, texRepeat, ambient]()
+                {
+                    ModelMeshSkin& skin = wo->getModel()->getModelDataShared()->getModelMeshes().at(0)->getSkins().at(0);
+                    skin.getMultiTextureSet().at(0).setTexRepeats(texRepeat);
+                    skin.setAmbient(aftrColor4f(ambient, ambient, ambient, 1.0f));
+                    skin.setDiffuse(aftrColor4f(1.0f, 1.0f, 1.0f, 1.0f));
+                    skin.setSpecular(aftrColor4f(0.4f, 0.4f, 0.4f, 1.0f));
+                    skin.setSpecularCoefficient(10);
+                });
+        }
+        wo->setLabel(scenario->string(o.labelOffset));
         worldLst->push_back(wo);
-        skyBox = wo;
+        if (o.cullRadius > 0.0f)
+            culler.add(wo, o.cullRadius);
     }
 
-    WO* grassPlane = WO::New(grass, Vector(1, 1, 1), MESH_SHADING_TYPE::mstFLAT);
-    grassPlane->setPosition(Vector(0, 0, 0));
-    grassPlane->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
-    grassPlane->upon_async_model_loaded([grassPlane]()
-        {
-            ModelMeshSkin& grassSkin = grassPlane->getModel()->getModelDataShared()->getModelMeshes().at(0)->getSkins().at(0);
-            grassSkin.getMultiTextureSet().at(0).setTexRepeats(5.0f);
-            grassSkin.setAmbient(aftrColor4f(0.4f, 0.4f, 0.4f, 1.0f));
-            grassSkin.setDiffuse(aftrColor4f(1.0f, 1.0f, 1.0f, 1.0f));
-            grassSkin.setSpecular(aftrColor4f(0.4f, 0.4f, 0.4f, 1.0f));
-            grassSkin.setSpecularCoefficient(10);
-        });
-    grassPlane->setLabel("Grass");
-    worldLst->push_back(grassPlane);
+    // The planner grid is sized once; a reloaded scenario keeps it
+    routePlanner.init(Vector(sc.plannerOrigin[0], sc.plannerOrigin[1], sc.plannerOrigin[2]), static_cast<int>(sc.plannerCells[0]),
+                      static_cast<int>(sc.plannerCells[1]), static_cast<int>(sc.plannerCells[2]), sc.plannerCellSize, sc.plannerClearance);
 
-    WO* runway = WO::New(runwayTexture, Vector(10, 1, 1), MESH_SHADING_TYPE::mstFLAT);
-    runway->setPosition(Vector(0, 0, 0.1f));
-    runway->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
-    runway->upon_async_model_loaded([runway]()
+    // Scenario obstacles share the cube model, one instance per obstacle scaled to its edge length
+    scenarioObstacles = WOInstanced::New(shinyRedPlasticCube, MaxScenarioObstacles, &staticScene);
+    scenarioObstacles->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
+    scenarioObstacles->setLabel("Scenario Obstacles");
+    worldLst->push_back(scenarioObstacles);
+    applyScenario();
+
+    // The player's jet loads first through the queue
+    loader.request(jetModel, Vector(1, 1, 1), 0.0f, nullptr, [this](WO* wo)
         {
-            ModelMeshSkin& runwaySkin = runway->getModel()->getModelDataShared()->getModelMeshes().at(0)->getSkins().at(0);
-            runwaySkin.getMultiTextureSet().at(0).setTexRepeats(1.0f);
-            runwaySkin.setAmbient(aftrColor4f(0.5f, 0.5f, 0.5f, 1.0f));
-            runwaySkin.setDiffuse(aftrColor4f(1.0f, 1.0f, 1.0f, 1.0f));
-            runwaySkin.setSpecular(aftrColor4f(0.4f, 0.4f, 0.4f, 1.0f));
-            runwaySkin.setSpecularCoefficient(10);
+            jet = wo;
+            jet->setPosition(initialPosition);
+            jet->rotateAboutGlobalZ(scenario->getHeader().startHeading);
+            jet->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
+            jet->setLabel("jet1");
+            actorLst->push_back(jet);
+            worldLst->push_back(jet);
+            culler.add(jet, 8.0f);
         });
-    runway->setLabel("Runway");
-    worldLst->push_back(runway);
+    cubePool.init(loader, *worldLst, &culler, shinyRedPlasticCube, 256, 4.0f, "Shiny Red Plastic Cube");
+
+    predictionRibbon = WO::New();
+    predictionRibbonModel = MGLDynamicLines::New(predictionRibbon);
+    predictionRibbon->setModel(predictionRibbonModel);
+    predictionRibbon->setLabel("Predicted Flight Path");
+    worldLst->push_back(predictionRibbon);
+    rebuildPredictionRibbon();
 
-    initialPosition = Vector(0, 0, 1.1f);
+    traffic.init(culler, *worldLst, jetModel, 200, 42, &staticScene);
+    for (int i = 0; i < traffic.getAircraftCount(); ++i)
+    {
+        VoiceManager::Emitter e;
+        e.sound = SoundId::TRAFFIC_ENGINE;
+        e.position = traffic.getPosition(i);
+        e.velocity = traffic.getVelocity(i);
+        e.priority = 0.5f;
+        e.volume = 0.6f;
+        e.minDistance = 40.0f;
+        trafficVoices.push_back(voices.add(e));
+    }
+    startNetwork(jetModel);
 
-    jet = WO::New(jetModel, Vector(1, 1, 1), MESH_SHADING_TYPE::mstFLAT);
-    jet->setPosition(initialPosition);
-    jet->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
-    jet->setLabel("jet1");
-    actorLst->push_back(jet);
-    worldLst->push_back(jet);
+    // Not registered with the culler: the batch is one WO and is drawn whole by a single call
+    obstacleField = WOInstanced::New(shinyRedPlasticCube, 4096, &staticScene);
+    obstacleField->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
+    obstacleField->setLabel("Obstacle Field");
+    worldLst->push_back(obstacleField);
 
     WOImGui* gui = WOImGui::New(nullptr);
     gui->setLabel("My Gui");
@@ -471,6 +946,7 @@ void Aftr::GLViewNewModule::loadMap()
             ImGui::Text("Altitude: %.2f", altitude);
             ImGui::Text("Speed: %.2f", speed);
             ImGui::Text("Distance Traveled: %.2f", totalDistance);
+            ImGui::Text("Wind: %.2f %.2f %.2f", currentWind.x, currentWind.y, currentWind.z);
 
             if (ImGui::Button("Reset"))
             {
@@ -499,12 +975,341 @@ void Aftr::GLViewNewModule::loadMap()
                 playbackIndex = 0;
             }
 
+            if (loader.getLoadedCount() < loader.getRequestedCount())
+            {
+                ImGui::ProgressBar(static_cast<float>(loader.getLoadedCount()) / loader.getRequestedCount(), ImVec2(-1, 0), "Loading models");
+            }
+
             if (ImGui::Button("Toggle Day/Night"))
             {
                 toggleDayNight();
             }
 
+            float timeOfDay = skies.getTimeOfDay();
+            if (ImGui::SliderFloat("Time of Day", &timeOfDay, 0.0f, 24.0f, "%.1f h"))
+            {
+                skies.setTimeOfDay(timeOfDay);
+                isDay = skies.getDaylight() >= 0.5f;
+            }
+            int sky = skies.getSelected();
+            if (ImGui::BeginCombo("Sky Box", sky >= 0 ? skies.getName(sky).c_str() : ""))
+            {
+                for (int i = 0; i < skies.size(); ++i)
+                {
+                    if (ImGui::Selectable(skies.getName(i).c_str(), i == sky))
+                        skies.select(i);
+                }
+                ImGui::EndCombo();
+            }
+
+            ImGui::End();
+
+            ImGui::Begin("Scenario");
+            ImGui::Text("%s: %d of %zu objectives", scenario->getName(), score, objectives.size());
+            for (size_t i = 0; i < objectives.size(); ++i)
+            {
+                const ObjectiveTracker::Status status = objectiveTracker.getStatus(i);
+                if (status == ObjectiveTracker::Status::DONE)
+                    ImGui::Text("[done %.0f s] %s", objectiveTracker.getCompletedAt(i), objectives[i].c_str());
+                else
+                    ImGui::Text("[%s] %s", status == ObjectiveTracker::Status::FAILED ? "failed" : "    ", objectives[i].c_str());
+            }
+            ImGui::End();
+
+            ImGui::Begin("Autopilot");
+            ImGui::Checkbox("Engaged", &autopilotState.engaged);
+            ImGui::CheckboxFlags("Attitude Hold", &autopilotState.modes, apmATTITUDE_HOLD);
+            ImGui::CheckboxFlags("Altitude Hold", &autopilotState.modes, apmALTITUDE_HOLD);
+            ImGui::CheckboxFlags("Heading Hold", &autopilotState.modes, apmHEADING_HOLD);
+            ImGui::CheckboxFlags("Speed Hold", &autopilotState.modes, apmSPEED_HOLD);
+            ImGui::CheckboxFlags("Waypoint Nav", &autopilotState.modes, apmWAYPOINT_NAV);
+            ImGui::SliderAngle("Target Roll", &autopilotTargets.roll, -30.0f, 30.0f);
+            ImGui::SliderAngle("Target Pitch", &autopilotTargets.pitch, -20.0f, 20.0f);
+            ImGui::SliderAngle("Target Heading", &autopilotTargets.heading, -180.0f, 180.0f);
+            ImGui::SliderFloat("Target Altitude", &autopilotTargets.altitude, 2.0f, 200.0f);
+            ImGui::SliderFloat("Target Airspeed", &autopilotTargets.airspeed, 0.0f, flightModel.getParams().maxAirspeed);
+            ImGui::Text("FD Roll: %.1f deg  Pitch: %.1f deg", autopilotState.commandedRoll * Aftr::RADtoDEG, autopilotState.commandedPitch * Aftr::RADtoDEG);
+            ImGui::Text("FD Heading: %.1f deg  Altitude: %.1f", autopilotState.commandedHeading * Aftr::RADtoDEG, autopilotState.commandedAltitude);
+            if (autopilotState.modes & apmWAYPOINT_NAV)
+            {
+                ImGui::Text("Waypoint %zu of %zu", autopilotState.activeWaypoint + 1, route.size());
+            }
+            ImGui::InputFloat3("Route Goal", &routeGoal.x);
+            if (ImGui::Button("Plan Route"))
+            {
+                replanRoute();
+            }
+            ImGui::Text("Planner expansions: %zu", routePlanner.getLastExpansions());
+            ImGui::End();
+
+            ImGui::Begin("Profiler");
+            if (ImGui::Checkbox("Show Predicted Path", &showPrediction) && !showPrediction)
+            {
+                predictedPath.clear();
+                rebuildPredictionRibbon();
+            }
+            ImGui::SliderFloat("Prediction Horizon (s)", &predictionHorizonSec, 10.0f, 30.0f);
+            bool cullingEnabled = culler.isEnabled();
+            if (ImGui::Checkbox("BVH Frustum Culling", &cullingEnabled))
+            {
+                culler.setEnabled(cullingEnabled);
+            }
+            ImGui::Text("Visible: %d  Culled: %d  BVH nodes tested: %zu", culler.getVisibleCount(), culler.getCulledCount(), culler.getNodesTested());
+            ImGui::Text("Traffic by LOD: %d full, %d lod1, %d lod2, %d impostor", traffic.getCountAtLevel(0), traffic.getCountAtLevel(1),
+                        traffic.getCountAtLevel(2), traffic.getCountAtLevel(3));
+            ImGui::SliderFloat("LOD Hysteresis", &traffic.getLodSelector().hysteresis, 0.0f, 0.5f);
+            ImGui::Text("Pooled cubes in use: %zu / %zu", cubePool.getInUse(), cubePool.getCapacity());
+            if (ImGui::Button("Scatter Targets"))
+            {
+                // Everything left in the pool, dropped around the runway
+                for (WO* t = nullptr; (t = cubePool.acquire(Vector(0, 0, 0))) != nullptr;)
+                {
+                    const float a = targets.size() * 2.39996f; // Golden angle spiral
+                    const float r = 20.0f + 4.0f * std::sqrt(static_cast<float>(targets.size()));
+                    t->setPosition(Vector(r * std::cos(a), r * std::sin(a), 2.0f + (targets.size() % 5) * 3.0f));
+                    targets.push_back(t);
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear Targets"))
+            {
+                for (WO* t : targets)
+                    cubePool.release(t);
+                targets.clear();
+            }
+            ImGui::SliderInt("Obstacle Cubes", &obstacleFieldCount, 0, 4096);
+            if (ImGui::Button("Spawn Obstacle Field"))
+            {
+                spawnObstacleField(obstacleFieldCount);
+            }
+            for (int i = 0; i < Profiler::get().size(); ++i)
+            {
+                Profiler::Entry e = Profiler::get().getEntry(i);
+                if (e.kind == Profiler::Kind::TIMER)
+                    ImGui::Text("%-24s %7.3f ms  avg %7.3f  max %7.3f", e.name, e.lastMs, e.avgMs, e.maxMs);
+                else
+                    ImGui::Text("%-24s %lld", e.name, static_cast<long long>(e.value));
+            }
+            if (ImGui::Button("Reset Max"))
+            {
+                Profiler::get().resetMax();
+            }
             ImGui::End();
         });
     this->worldLst->push_back(gui);
+
+    std::chrono::duration<double, std::milli> loadMapMs = std::chrono::steady_clock::now() - loadMapStart;
+    Profiler::get().addSample(Profiler::get().registerTimer("Startup: loadMap"), loadMapMs.count());
+    printf("Startup: loadMap took %.1f ms\n", loadMapMs.count());
+}
+
+void GLViewNewModule::resolveStartupConfig()
+{
+    startupConfig.add("windFieldFile", &windFieldFile, "", "Mean wind grid, relative to the local mm folder");
+    startupConfig.add("turbulenceIntensity", &turbulenceIntensity, 0.5f, 0.0f, 20.0f, "units/s", "RMS horizontal gust speed");
+    startupConfig.add("windSeed", &windSeed, 1, 0, 1 << 30, "", "Turbulence pattern seed");
+    startupConfig.add("skyBoxes", &extraSkyBoxes, "", "Extra sky images, ';' separated");
+    startupConfig.add("scenario", &scenarioFile, "", "Scenario file, relative to the local mm folder");
+    startupConfig.add("audioDriver", &audioDriver, "auto", "auto, null (no device) or capture (mix to audioCaptureFile)");
+    startupConfig.add("audioCaptureFile", &audioCaptureFile, "", "WAV written in capture mode, plus <file>.events.csv");
+    startupConfig.add("netMode", &netMode, "off", "off, server (publish aircraft) or client (show a server's aircraft)");
+    startupConfig.add("netPort", &netPort, 27960, 1, 65535, "", "UDP port the server listens on");
+    startupConfig.add("netServer", &netServer, "127.0.0.1", "Server address for netMode=client, host[:port]");
+    startupConfig.add("netLossPercent", &netLossPercent, 0.0f, 0.0f, 100.0f, "%", "Simulated loss on outgoing datagrams");
+    startupConfig.add("netLatencyMs", &netLatencyMs, 0.0f, 0.0f, 2000.0f, "ms", "Simulated one-way latency on outgoing datagrams");
+    startupConfig.resolve([](const std::string& key) { return ManagerEnvironmentConfiguration::getVariableValue(key); });
+
+    // Logged with the per-tick values' startup state so a run's output records what it ran with
+    SimParams sim;
+    ConfigRegistry simConfig;
+    SimParams::registerWith(simConfig, sim);
+    simConfig.resolve([](const std::string& key) { return ManagerEnvironmentConfiguration::getVariableValue(key); });
+    startupConfig.dump(stdout, "Startup configuration");
+    simConfig.dump(stdout, "Sim parameters (reloaded on change)");
+}
+
+void GLViewNewModule::loadScenario()
+{
+    // A compiled scenario next to the text one is preferred: it is mapped rather than parsed
+    std::string path = scenarioFile;
+    if (path.empty())
+    {
+        path = "scenarios/default.scnb";
+        if (!std::ifstream(ManagerEnvironmentConfiguration::getLMM() + "/" + path))
+            path = "scenarios/default.scn";
+    }
+
+    // Both files are watched from here on; edits are picked up by updateWorld
+    config.start(ConfigPath, ManagerEnvironmentConfiguration::getLMM() + "/" + path);
+    printf("Watching %s and %s for changes (%s)\n", ConfigPath, path.c_str(), config.isUsingInotify() ? "inotify" : "polling");
+
+    scenario = config.getScenario();
+    if (scenario == nullptr)
+    {
+        printf("Scenario %s could not be loaded; using the built-in airfield.\n", path.c_str());
+        ScenarioSource fallback;
+        fallback.name = "built-in";
+        fallback.skies = { "images/skyboxes/sky_mountains+6.jpg", "images/skyboxes/space_gray_matter+6.jpg" };
+        fallback.objects = { { "Grass", "models/grassFloor400x400_pp.wrl", { 0, 0, 0 }, { 1, 1, 1 }, 5.0f, 0.4f, 285.0f },
+                             { "Runway", "models/road26x10.wrl", { 0, 0, 0.1f }, { 10, 1, 1 }, 1.0f, 0.5f, 140.0f } };
+        auto builtIn = std::make_shared<Scenario>();
+        builtIn->openCompiled(compileScenario(fallback), "built-in");
+        scenario = builtIn;
+    }
+    printf("Scenario '%s': %u objects, %u obstacles, %u objectives\n", scenario->getName(), scenario->getObjectCount(),
+           scenario->getObstacleCount(), scenario->getObjectiveCount());
+}
+
+void GLViewNewModule::applyScenario()
+{
+    const ScenarioFormat::Header& sc = scenario->getHeader();
+    ManagerLight::setGlobalAmbientLight(aftrColor4f(sc.ambient, sc.ambient, sc.ambient, 1.0f));
+
+    initialPosition = scenario->getStart();
+    if (!takeOff)
+    {
+        jetState.position = initialPosition;
+        jetState.heading = sc.startHeading;
+        if (jet != nullptr)
+        {
+            jet->setPosition(initialPosition);
+            jet->rotateToIdentity();
+            jet->rotateAboutGlobalZ(sc.startHeading);
+        }
+    }
+
+    for (int id : scenarioObstacleIds)
+    {
+        routePlanner.removeObstacle(id);
+    }
+    scenarioObstacleIds.clear();
+    MGLInstanced* cubes = scenarioObstacles->getInstances();
+    cubes->clear();
+    for (uint32_t i = 0; i < scenario->getObstacleCount(); ++i)
+    {
+        const ScenarioFormat::Obstacle& o = scenario->getObstacle(i);
+        const Vector c(o.center[0], o.center[1], o.center[2]);
+        const Vector half(o.size * 0.5f, o.size * 0.5f, o.size * 0.5f);
+        if (cubes->add(InstanceTransform::fromPose(c, 0.0f, 0.0f, 0.0f, o.size / 4.0f)) == cubes->getCapacity()) // cube4x4x4 at unit scale
+        {
+            printf("Scenario has more than %u obstacles; the rest are ignored.\n", cubes->getCapacity());
+            break;
+        }
+        scenarioObstacleIds.push_back(routePlanner.addObstacle(c - half, c + half));
+    }
+
+    // A planned route is replanned around the new obstacles; otherwise the scenario's circuit is flown
+    if (routeActive)
+    {
+        replanRoute();
+    }
+    else
+    {
+        route = scenario->getRoute();
+        autopilotState.activeWaypoint = 0;
+    }
+
+    objectiveTracker.reset(*scenario);
+    score = 0;
+    objectives.clear();
+    for (uint32_t i = 0; i < scenario->getObjectiveCount(); ++i)
+        objectives.push_back(ObjectiveTracker::describe(scenario->getObjective(i)));
+}
+
+void GLViewNewModule::applyParams()
+{
+    ManagerOpenGLState::GL_CLIPPING_PLANE = params->clippingPlane;
+    ManagerOpenGLState::GL_NEAR_PLANE = params->nearPlane;
+    if (this->cam != nullptr)
+    {
+        this->cam->setCameraNearClippingPlaneDistance(params->nearPlane);
+        this->cam->setCameraFarClippingPlaneDistance(params->clippingPlane);
+    }
+    if (this->pe != NULL)
+    {
+        this->pe->setGravityScalar(params->gravityScalar);
+    }
+    if (soundEngine != nullptr)
+    {
+        soundEngine->setDopplerEffectParameters(params->dopplerFactor, params->audioMetersPerUnit);
+    }
+
+    if (flightModel.getParams().maxAirspeed != params->maxAirspeed)
+    {
+        flightModel.getParams().maxAirspeed = params->maxAirspeed;
+        predictor.start(flightModel, autopilot, &wind); // Restarts it: the predictor flies its own copy of the model
+    }
+    printf("Sim parameters (generation %llu): clip %.1f..%.1f, gravity %.3f, collision %.1f, max airspeed %.1f, takeoff climb %.1f\n",
+           static_cast<unsigned long long>(params->generation), params->nearPlane, params->clippingPlane, params->gravityScalar,
+           params->collisionDistance, params->maxAirspeed, params->takeoffClimbRate);
+}
+
+void GLViewNewModule::loadStaticScene()
+{
+    auto start = std::chrono::steady_clock::now();
+    const std::string bakedPath = ManagerEnvironmentConfiguration::getLMM() + "/scenes/airfield.bscene";
+    const std::string textPath = ManagerEnvironmentConfiguration::getLMM() + "/scenes/airfield.scene";
+
+    // Once mapped, every instanced batch of a baked model (the obstacle cubes, the full-detail
+    // traffic jets) uploads its vertex and index arrays from the mapping without a parse or a copy
+    std::vector<WOInstanced*> batches;
+    const bool baked = staticScene.open(bakedPath);
+    if (baked)
+    {
+        std::vector<uint32_t> perMesh(staticScene.getMeshCount(), 0);
+        for (uint32_t i = 0; i < staticScene.getPlacementCount(); ++i)
+            ++perMesh[staticScene.getPlacement(i).mesh];
+        std::vector<WOInstanced*> batchOf(staticScene.getMeshCount(), nullptr);
+        for (uint32_t m = 0; m < staticScene.getMeshCount(); ++m)
+        {
+            if (perMesh[m] == 0)
+                continue; // Only used by the module's own batches
+            const BakedFormat::Mesh& mesh = staticScene.getMesh(m);
+            batchOf[m] = WOInstanced::New(staticScene.getVertices(m), mesh.vertexCount, staticScene.getIndices(m), mesh.indexCount,
+                                          mesh.color, perMesh[m]);
+            batchOf[m]->setLabel(std::string("Static ") + staticScene.getMeshName(m));
+            batches.push_back(batchOf[m]);
+        }
+        for (uint32_t i = 0; i < staticScene.getPlacementCount(); ++i)
+        {
+            const BakedFormat::Placement& p = staticScene.getPlacement(i);
+            batchOf[p.mesh]->getInstances()->add(InstanceTransform::fromPose(Vector(p.position[0], p.position[1], p.position[2]),
+                                                                             p.heading, p.pitch, p.roll, p.scale));
+        }
+    }
+    else
+    {
+        // Unbaked: the engine parses each VRML model as on every launch before baking
+        SceneDescription scene;
+        if (!scene.load(textPath))
+            return;
+        std::vector<uint32_t> perModel(scene.models.size(), 0);
+        for (const SceneDescription::Placement& p : scene.placements)
+            ++perModel[p.model];
+        std::vector<WOInstanced*> batchOf(scene.models.size(), nullptr);
+        for (size_t m = 0; m < scene.models.size(); ++m)
+        {
+            if (perModel[m] == 0)
+                continue;
+            batchOf[m] = WOInstanced::New(ManagerEnvironmentConfiguration::getSMM() + "/" + scene.models[m].path, perModel[m]);
+            batchOf[m]->setLabel("Static " + scene.models[m].name);
+            batches.push_back(batchOf[m]);
+        }
+        for (const SceneDescription::Placement& p : scene.placements)
+        {
+            batchOf[p.model]->getInstances()->add(InstanceTransform::fromPose(Vector(p.position[0], p.position[1], p.position[2]),
+                                                                              p.heading, p.pitch, p.roll, p.scale));
+        }
+    }
+
+    for (WOInstanced* b : batches)
+    {
+        b->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
+        worldLst->push_back(b);
+    }
+
+    std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+    Profiler::get().addSample(Profiler::get().registerTimer("Startup: static scene"), ms.count());
+    printf("Startup: static scene %s in %.2f ms (%u meshes, %zu prop batches)\n", baked ? "mapped from airfield.bscene" : "read from airfield.scene",
+           ms.count(), staticScene.getMeshCount(), batches.size());
 }
@@ -1,6 +1,25 @@
 #pragma once
 
 #include "GLView.h"
+#include "WindField.h"
+#include "FlightModel.h"
+#include "Autopilot.h"
+#include "RoutePlanner.h"
+#include "TrajectoryPredictor.h"
+#include "SceneCuller.h"
+#include "TrafficManager.h"
+#include "SkyBoxSet.h"
+#include "ModelLoader.h"
+#include "WOPool.h"
+#include "BakedScene.h"
+#include "Scenario.h"
+#include "ConfigReloader.h"
+#include "ConfigRegistry.h"
+#include "AudioBank.h"
+#include "EngineSound.h"
+#include "VoiceManager.h"
+#include "AudioService.h"
+#include "Replication.h"
 #include <irrKlang.h> 
 #include <vector>
 #include <chrono>
@@ -9,6 +28,8 @@ namespace Aftr
 {
     class Camera;
     class WO;
+    class MGLDynamicLines;
+    class WOInstanced;
 
     class GLViewNewModule : public GLView
     {
@@ -28,8 +49,13 @@ namespace Aftr
         GLViewNewModule(const std::vector< std::string >& args);
         virtual void onCreate();
 
-        irrklang::ISoundEngine* soundEngine = nullptr;
-        irrklang::ISound* objSnd = nullptr;
+        irrklang::ISoundEngine* soundEngine = nullptr; // Borrowed from AudioService, which outlives every GLView
+        AudioBank& audio = AudioService::get().getBank(); // Sounds registered once per process, played by id
+        VoiceManager voices{ audio }; // Every emitter goes through here; only the most audible get irrKlang voices
+        int engineVoice = -1; // The jet's engine loop while it is flying
+        std::vector<int> trafficVoices; // One engine emitter per traffic aircraft, mostly virtual
+        int audioMixProfileId = -1; // Headless drivers mix inside updateAudio, where the cost is timed
+        EngineSound engineSound; // Listener pose and engine pitch/volume, pushed to irrKlang once a frame
         float thrust;
         float roll;
         float pitch;
@@ -56,11 +82,38 @@ namespace Aftr
         bool playingBack = false;
         size_t playbackIndex = 0;
 
-        int score = 0;
-        std::vector<std::string> objectives;
+        ConfigRegistry startupConfig; // aftr.conf keys read once at startup, resolved into the fields below
+        std::string windFieldFile;
+        float turbulenceIntensity = 0.5f;
+        int windSeed = 1;
+        std::string extraSkyBoxes;
+        std::string scenarioFile;
+        std::string audioDriver; // auto, null or capture
+        std::string audioCaptureFile;
+        std::string netMode; // off, server or client
+        int netPort = 27960;
+        std::string netServer;
+        float netLossPercent = 0.0f;
+        float netLatencyMs = 0.0f;
+
+        static constexpr const char* ConfigPath = "aftr.conf"; // Read by the engine from the working folder
+        static constexpr uint32_t MaxScenarioObstacles = 1024;
+        ConfigReloader config; // Watches aftr.conf and the scenario and publishes reparsed snapshots
+        std::shared_ptr<const SimParams> params; // Snapshot in use this tick
+        std::shared_ptr<const Scenario> scenario; // World content, start, route and objectives; stays open for the objective checks
+        std::vector<int> scenarioObstacleIds; // Planner ids of the scenario's obstacles, replaced on reload
+        ObjectiveTracker objectiveTracker;
+        int score = 0; // Objectives completed this flight
+        std::vector<std::string> objectives; // Display text for each scenario objective
+        WOInstanced* scenarioObstacles = nullptr;
 
         bool isDay = true; 
-        WO* skyBox = nullptr;
+        ModelLoader loader; // Prefetches models on worker threads and builds their WOs within a per-frame budget
+        static constexpr double LoadBudgetMsPerFrame = 4.0;
+        WOPool cubePool; // Pre-built cubes for the SPACE obstacle and scattered targets
+        std::vector<WO*> targets;
+        BakedScene staticScene; // Stays mapped: the batches upload their vertex data from it on first render
+        SkyBoxSet skies; // Every sky box, loaded once; day/night only swaps which one is visible
 
         float altitude = 0.0f; // Current altitude of the plane
         float speed = 0.0f; // Current speed of the plane
@@ -69,17 +122,84 @@ namespace Aftr
 
         std::chrono::high_resolution_clock::time_point lastUpdateTime;
 
+        WindModel wind;
+        Vector currentWind{ 0, 0, 0 }; // Wind at the jet's position, world units/sec
+        float simTime = 0.0f; // Seconds of simulated flight, drives turbulence advection
+
+        static constexpr int MaxPhysicsStepsPerFrame = 8;
+        float physicsAccumulator = 0.0f; // Unsimulated time carried between frames
+        FlightModel flightModel;
+        FlightState jetState;
+        Autopilot autopilot;
+        AutopilotState autopilotState;
+        AutopilotTargets autopilotTargets;
+        std::vector<Vector> route; // Waypoints flown by apmWAYPOINT_NAV
+
+        RoutePlanner routePlanner;
+        int cubeObstacleId = -1;
+        Vector routeGoal{ 150, 0, 20 };
+        bool routeActive = false; // Set once a planned route replaces the default circuit; obstacle changes replan it
+        std::vector<WO*> routeMarkers;
+
+        TrajectoryPredictor predictor; // Declared after wind, which it reads from its worker thread
+        bool showPrediction = true;
+        float predictionHorizonSec = 20.0f;
+        std::vector<Vector> predictedPath;
+        std::vector<Vector> ribbonVerts;
+        std::vector<aftrColor4ub> ribbonColors;
+        WO* predictionRibbon = nullptr;
+        MGLDynamicLines* predictionRibbonModel = nullptr;
+        int updateWorldProfileId = -1;
+
+        SceneCuller culler; // Frustum culls the registered geometry WOs each frame
+        TrafficManager traffic; // Instanced AI aircraft whose level of detail the culler picks
+        float trafficTime = 0.0f;
+
+        WOInstanced* obstacleField = nullptr; // Every cube in the field is drawn by one instanced call
+        int obstacleFieldCount = 500;
+        std::vector<int> obstacleFieldIds; // Planner obstacle ids of the spawned cubes
+
+        UdpEndpoint netSocket;
+        std::unique_ptr<LinkSimulator> netLink; // Between the socket and replication when loss or latency is simulated
+        std::unique_ptr<ReplicationServer> replicationServer; // netMode=server: publishes the jet and traffic, filtered per client
+        std::unique_ptr<ReplicationClient> replicationClient; // netMode=client: shows the server's aircraft
+        std::unique_ptr<JetPredictor> jetPrediction; // netMode=client: flies jetState ahead of the server's copy of it
+        bool netConnected = false;
+        std::vector<NetAircraft> netAircraft; // Outgoing states, rebuilt every frame
+        WOPool remoteJets; // Client: one jet per replicated aircraft, all of them in netLst
+        std::vector<WO*> remoteJetOf; // Aircraft id -> the pooled jet showing it
+        std::vector<uint8_t> remoteJetSeen; // Parallel to remoteJetOf; cleared every frame rather than reallocated
+        int netUpdateProfileId = -1;
+        int netBytesCounterId = -1;
+        int netExtrapolatedCounterId = -1;
+        int netRelevantCounterId = -1;
+        int netCorrectionsCounterId = -1;
+
         bool checkCollision(); 
         void handleCollision();
         void resetFlight();
         void startTakeoff();
         void recordFlightPath();
         void playbackFlightPath();
-        void toggleDayNight(); // Method to toggle day and night
-        void updateFlightStats(); // Method to update flight statistics
+        void toggleDayNight(); // Runs the clock to noon or midnight over a few seconds
+        void updateFlightStats(float deltaTime); // Method to update flight statistics
         float getDeltaTime(); // Method to get delta time
+        void stepFlight(float dt); // One fixed physics step of autopilot + flight model for the player jet
+        void syncJetToFlightState(); // Copies jetState onto the jet WO's position and orientation
+        void loadWind(); // Loads the mean-wind field and builds the turbulence volume from aftr.conf
+        void replanRoute(); // Plans from the jet to routeGoal around known obstacles and shows the result
+        void rebuildPredictionRibbon(); // Turns predictedPath into the line ribbon drawn ahead of the jet
+        void loadStaticScene(); // Maps the baked meshes for the instanced batches and places any static props
+        void resolveStartupConfig(); // Reads the startup keys into typed fields and logs every effective value
+        void loadScenario(); // Opens the configured scenario, falling back to the built-in airfield
+        void applyScenario(); // Start, obstacles, route and objectives from the current scenario snapshot
+        void applyParams(); // Pushes the current SimParams snapshot into the engine and flight model
+        void spawnObstacleField(int count); // Scatters count instanced cubes over the grass and adds them to the planner
+        void startNetwork(const std::string& jetModel); // Opens the socket and the server or client named by netMode
+        void updateNetwork(float dt); // Publishes this frame's aircraft, or moves the remote jets to the client's render time
 
         Vector calculateRotationAngles(const Vector& direction);
         void updateCamera(); // Update the camera position and orientation
+        void updateAudio(float dt); // Listener, jet engine and traffic emitters, then the voice manager's single push to irrKlang
     };
 }
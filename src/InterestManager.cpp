@@ -0,0 +1,124 @@
+#include "InterestManager.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Aftr;
+
+int32_t SpatialGrid::cellOf(float v) const
+{
+    return static_cast<int32_t>(std::floor(std::clamp(v * inverseCell, -1.0e9f, 1.0e9f)));
+}
+
+void SpatialGrid::build(const Vector* positions, size_t count, float cellSize)
+{
+    inverseCell = 1.0f / cellSize;
+    sorted.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        sorted[i] = { key(cellOf(positions[i].x), cellOf(positions[i].y)), static_cast<uint32_t>(i) };
+    std::sort(sorted.begin(), sorted.end());
+
+    columns.clear(); // Keeps its buckets from the last tick
+    for (uint32_t begin = 0; begin < sorted.size();)
+    {
+        uint32_t end = begin + 1;
+        while (end < sorted.size() && sorted[end].first == sorted[begin].first)
+            ++end;
+        columns.emplace(sorted[begin].first, std::make_pair(begin, end));
+        begin = end;
+    }
+}
+
+void InterestManager::build(const Vector* p, const uint16_t* id, size_t count)
+{
+    positions.assign(p, p + count);
+    ids.assign(id, id + count);
+    grid.build(positions.data(), count, params.cellSize);
+    visited.assign(count, 0);
+    stamp = 0;
+}
+
+float InterestManager::priorityOf(const NetView& view, const Frustum& frustum, const Vector& p) const
+{
+    float priority = 0.0f;
+    const float toFocus = (p - view.focus).length();
+    if (toFocus <= params.relevanceRadius)
+        priority = params.nearRadius / std::max(toFocus, params.nearRadius);
+
+    const float toEye = (p - view.eye).length();
+    const Vector r(params.aircraftRadius, params.aircraftRadius, params.aircraftRadius);
+    if (toEye <= params.viewRange && frustum.classify(Aabb{ p - r, p + r }) != Frustum::OUTSIDE)
+        priority = std::max(priority, params.nearRadius / std::max(toEye, params.nearRadius)) * params.viewBoost;
+
+    return priority > 0.0f ? std::max(priority, params.minPriority) : 0.0f;
+}
+
+void InterestManager::prioritize(const NetView& view, State& state)
+{
+    ++state.tick;
+    candidates.clear();
+    if (!view.valid)
+    {
+        for (uint16_t id : ids)
+            candidates.emplace_back(1.0f, id);
+    }
+    else
+    {
+        const Frustum frustum = Frustum::fromCamera(view.eye, view.look, view.up, view.verticalFov, view.aspect, 1.0f, params.viewRange);
+        ++stamp;
+        auto consider = [&](uint32_t index)
+        {
+            if (visited[index] == stamp)
+                return;
+            visited[index] = stamp;
+            const float priority = priorityOf(view, frustum, positions[index]);
+            if (priority > 0.0f)
+                candidates.emplace_back(priority, ids[index]);
+        };
+
+        const Vector reach(params.relevanceRadius, params.relevanceRadius, 0.0f);
+        grid.queryBox(view.focus - reach, view.focus + reach, consider);
+
+        // The frustum's bounding box: the eye and the four corners of its far plane
+        Vector f = view.look;
+        f.normalize();
+        Vector right = f.crossProduct(view.up);
+        right.normalize();
+        const Vector up = right.crossProduct(f);
+        const float halfHeight = std::tan(view.verticalFov * 0.5f) * params.viewRange;
+        const Vector center = view.eye + f * params.viewRange;
+        Vector lo = view.eye, hi = view.eye;
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            const Vector c = center + right * (halfHeight * view.aspect * (corner & 1 ? 1.0f : -1.0f)) + up * (halfHeight * (corner & 2 ? 1.0f : -1.0f));
+            lo = Vector(std::min(lo.x, c.x), std::min(lo.y, c.y), std::min(lo.z, c.z));
+            hi = Vector(std::max(hi.x, c.x), std::max(hi.y, c.y), std::max(hi.z, c.z));
+        }
+        grid.queryBox(lo, hi, consider);
+
+        if (candidates.size() > static_cast<size_t>(params.maxRelevant))
+        {
+            std::nth_element(candidates.begin(), candidates.begin() + params.maxRelevant, candidates.end(),
+                             [](const auto& a, const auto& b) { return a.first > b.first; });
+            candidates.resize(params.maxRelevant);
+        }
+    }
+
+    state.order.clear();
+    for (const auto& [priority, id] : candidates)
+    {
+        if (id >= state.accumulator.size())
+        {
+            state.accumulator.resize(id + 1, 0.0f);
+            state.relevantTick.resize(id + 1, 0);
+        }
+        if (state.relevantTick[id] + 1 != state.tick)
+            state.accumulator[id] = 0.0f; // Newly relevant: it starts from nothing, not from what it had long ago
+        state.relevantTick[id] = state.tick;
+        state.accumulator[id] += priority;
+        state.order.push_back(id);
+    }
+    std::sort(state.order.begin(), state.order.end(), [&state](uint16_t a, uint16_t b)
+        {
+            return state.accumulator[a] != state.accumulator[b] ? state.accumulator[a] > state.accumulator[b] : a < b;
+        });
+}
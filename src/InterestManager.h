@@ -0,0 +1,115 @@
+#pragma once
+
+#include "SceneBVH.h"
+#include "Vector.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Aftr
+{
+    // Where a replication client is: its own jet, and the camera it is looking through.
+    struct NetView
+    {
+        Vector focus{ 0, 0, 0 };
+        Vector eye{ 0, 0, 0 };
+        Vector look{ 1, 0, 0 };
+        Vector up{ 0, 0, 1 };
+        float verticalFov = 1.0f; // Radians
+        float aspect = 1.6f;
+        bool valid = false;       // A client that has not sent one yet is sent everything
+    };
+
+    struct InterestParams
+    {
+        float cellSize = 128.0f;        // Spatial grid columns, world units on a side
+        float relevanceRadius = 400.0f; // Aircraft this close to the client's jet are relevant, seen or not
+        float viewRange = 1000.0f;      // Aircraft in the camera frustum are relevant out to here
+        float nearRadius = 40.0f;       // Full priority inside this distance; it falls off as 1/distance beyond
+        float viewBoost = 2.0f;         // Priority multiplier for aircraft in the frustum
+        float minPriority = 0.05f;      // Floor for relevant aircraft, so the farthest still update
+        float aircraftRadius = 8.0f;    // Bounds used for the frustum test
+        int maxRelevant = 64;           // Only this many of the highest priorities are sent to a client
+    };
+
+    /**
+       Uniform grid of vertical columns over the aircraft positions, rebuilt every tick: keys are
+       sorted once and each column is a range of that order, so a query touches only the columns
+       its box overlaps. Columns rather than cubes because airspace is wide and shallow.
+    */
+    class SpatialGrid
+    {
+    public:
+        void build(const Vector* positions, size_t count, float cellSize);
+
+        // Calls visit(index) for every point in a column overlapping [lo, hi] in x and y.
+        template<typename Visitor>
+        void queryBox(const Vector& lo, const Vector& hi, Visitor&& visit) const;
+
+    private:
+        static uint64_t key(int32_t cx, int32_t cy) { return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy); }
+        int32_t cellOf(float v) const;
+
+        float inverseCell = 1.0f;
+        std::vector<std::pair<uint64_t, uint32_t>> sorted; // (column key, point index)
+        std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> columns; // Key -> [begin, end) of sorted
+    };
+
+    /**
+       Decides, per client and per tick, which aircraft that client is sent and in what order.
+       An aircraft is relevant if it is near the client's jet or inside its camera frustum; its
+       priority falls off with distance and is boosted in view. Each client keeps an accumulator
+       per aircraft that grows by the priority every tick it stays relevant and is zeroed when the
+       aircraft is sent, so with a fixed byte budget per snapshot a nearby aircraft goes out every
+       tick and a distant one every few, and nothing relevant starves.
+    */
+    class InterestManager
+    {
+    public:
+        // A client's accumulators, indexed by aircraft id, and this tick's sending order.
+        struct State
+        {
+            std::vector<float> accumulator;
+            std::vector<uint32_t> relevantTick; // Tick each id was last relevant
+            uint32_t tick = 0;
+            std::vector<uint16_t> order;        // Relevant ids, highest accumulated priority first
+        };
+
+        explicit InterestManager(const InterestParams& params = InterestParams{}) : params(params) {}
+
+        // Once per tick, before prioritize().
+        void build(const Vector* positions, const uint16_t* ids, size_t count);
+
+        // Accumulates this tick's priorities into state and fills state.order. The caller zeroes
+        // state.accumulator[id] for each aircraft it manages to send.
+        void prioritize(const NetView& view, State& state);
+
+        const InterestParams& getParams() const { return params; }
+
+    private:
+        float priorityOf(const NetView& view, const Frustum& frustum, const Vector& p) const;
+
+        InterestParams params;
+        SpatialGrid grid;
+        std::vector<Vector> positions; // This tick's aircraft
+        std::vector<uint16_t> ids;
+        std::vector<uint32_t> visited; // Per index, the query stamp that last saw it
+        uint32_t stamp = 0;
+        std::vector<std::pair<float, uint16_t>> candidates;
+    };
+
+    template<typename Visitor>
+    void SpatialGrid::queryBox(const Vector& lo, const Vector& hi, Visitor&& visit) const
+    {
+        const int32_t x0 = cellOf(lo.x), x1 = cellOf(hi.x), y0 = cellOf(lo.y), y1 = cellOf(hi.y);
+        for (int32_t cx = x0; cx <= x1; ++cx)
+            for (int32_t cy = y0; cy <= y1; ++cy)
+            {
+                auto it = columns.find(key(cx, cy));
+                if (it == columns.end())
+                    continue;
+                for (uint32_t i = it->second.first; i < it->second.second; ++i)
+                    visit(sorted[i].second);
+            }
+    }
+}
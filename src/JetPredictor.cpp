@@ -0,0 +1,217 @@
+#include "JetPredictor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+using namespace Aftr;
+
+namespace
+{
+    constexpr float SmallStep = 1.0f / 256.0f; // Wind and climb assist, world units/sec
+    constexpr float SnapDistance = 20.0f;      // Corrections bigger than this are not smoothed
+    constexpr float PositionTolerance = 1.0e-3f;
+    constexpr float AngleTolerance = 1.0e-4f;
+
+    void put16(uint8_t*& p, uint16_t v)
+    {
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+        p += 2;
+    }
+
+    uint16_t get16(const uint8_t*& p)
+    {
+        const uint16_t v = static_cast<uint16_t>(p[0] | (p[1] << 8));
+        p += 2;
+        return v;
+    }
+
+    void putFloat(uint8_t*& p, float f)
+    {
+        uint32_t v;
+        std::memcpy(&v, &f, sizeof v);
+        put16(p, static_cast<uint16_t>(v));
+        put16(p, static_cast<uint16_t>(v >> 16));
+    }
+
+    float getFloat(const uint8_t*& p)
+    {
+        const uint32_t lo = get16(p);
+        const uint32_t v = lo | (static_cast<uint32_t>(get16(p)) << 16);
+        float f;
+        std::memcpy(&f, &v, sizeof f);
+        return f;
+    }
+
+    int16_t toSigned(float v, float scale)
+    {
+        return static_cast<int16_t>(std::lround(std::clamp(v * scale, -32767.0f, 32767.0f)));
+    }
+
+    bool close(const FlightState& a, const FlightState& b)
+    {
+        return (a.position - b.position).length() <= PositionTolerance && (a.velocity - b.velocity).length() <= PositionTolerance &&
+               std::fabs(a.heading - b.heading) <= AngleTolerance && std::fabs(a.pitch - b.pitch) <= AngleTolerance &&
+               std::fabs(a.roll - b.roll) <= AngleTolerance && std::fabs(a.airspeed - b.airspeed) <= PositionTolerance;
+    }
+}
+
+size_t JetInput::pack(uint8_t* out) const
+{
+    uint8_t* p = out;
+    put16(p, static_cast<uint16_t>(std::lround(std::clamp(controls.thrust, 0.0f, 1.0f) * 65535.0f)));
+    put16(p, static_cast<uint16_t>(toSigned(controls.roll, 32767.0f)));
+    put16(p, static_cast<uint16_t>(toSigned(controls.pitch, 32767.0f)));
+    put16(p, static_cast<uint16_t>(toSigned(controls.yaw, 32767.0f)));
+    put16(p, static_cast<uint16_t>(toSigned(wind.x, 1.0f / SmallStep)));
+    put16(p, static_cast<uint16_t>(toSigned(wind.y, 1.0f / SmallStep)));
+    put16(p, static_cast<uint16_t>(toSigned(wind.z, 1.0f / SmallStep)));
+    put16(p, static_cast<uint16_t>(toSigned(climbAssist, 1.0f / SmallStep)));
+    *p++ = respawn ? 1 : 0;
+    if (respawn)
+    {
+        putFloat(p, spawn.position.x);
+        putFloat(p, spawn.position.y);
+        putFloat(p, spawn.position.z);
+        putFloat(p, spawn.heading);
+        putFloat(p, spawn.pitch);
+        putFloat(p, spawn.roll);
+        putFloat(p, spawn.airspeed);
+    }
+    return static_cast<size_t>(p - out);
+}
+
+size_t JetInput::unpack(const uint8_t* in, size_t size, uint32_t seq, JetInput& out)
+{
+    if (size < PackedBytes)
+        return 0;
+    const uint8_t* p = in;
+    out = JetInput{};
+    out.seq = seq;
+    out.controls.thrust = get16(p) / 65535.0f;
+    out.controls.roll = static_cast<int16_t>(get16(p)) / 32767.0f;
+    out.controls.pitch = static_cast<int16_t>(get16(p)) / 32767.0f;
+    out.controls.yaw = static_cast<int16_t>(get16(p)) / 32767.0f;
+    const float x = static_cast<int16_t>(get16(p)) * SmallStep;
+    const float y = static_cast<int16_t>(get16(p)) * SmallStep;
+    const float z = static_cast<int16_t>(get16(p)) * SmallStep;
+    out.wind = Vector(x, y, z);
+    out.climbAssist = static_cast<int16_t>(get16(p)) * SmallStep;
+    out.respawn = (*p++ & 1) != 0;
+    if (out.respawn)
+    {
+        if (size < MaxPackedBytes)
+            return 0;
+        const float sx = getFloat(p);
+        const float sy = getFloat(p);
+        const float sz = getFloat(p);
+        out.spawn.position = Vector(sx, sy, sz);
+        out.spawn.heading = getFloat(p);
+        out.spawn.pitch = getFloat(p);
+        out.spawn.roll = getFloat(p);
+        out.spawn.airspeed = getFloat(p);
+    }
+    return static_cast<size_t>(p - in);
+}
+
+JetInput JetInput::quantized() const
+{
+    uint8_t buf[MaxPackedBytes];
+    const size_t size = pack(buf);
+    JetInput q;
+    unpack(buf, size, seq, q);
+    return q;
+}
+
+void Aftr::stepJet(const FlightModel& model, FlightState& state, const JetInput& input)
+{
+    if (input.respawn)
+        state = input.spawn;
+    model.step(state, input.controls, input.wind, FlightModel::FixedStepSec);
+    state.position.z += input.climbAssist * FlightModel::FixedStepSec;
+}
+
+void JetPredictor::reset(const FlightState& s)
+{
+    state = s;
+    ackedSeq = nextSeq - 1;
+    respawnPending = false;
+    renderOffset = Vector(0, 0, 0);
+}
+
+void JetPredictor::respawn(const FlightState& s)
+{
+    reset(s);
+    spawn = s;
+    respawnPending = true;
+}
+
+const JetInput& JetPredictor::step(const FlightControls& controls, const Vector& wind, float climbAssist)
+{
+    JetInput in;
+    in.seq = nextSeq++;
+    in.controls = controls;
+    in.wind = wind;
+    in.climbAssist = climbAssist;
+    if (respawnPending)
+    {
+        in.respawn = true;
+        in.spawn = spawn;
+        respawnPending = false;
+    }
+
+    Slot& slot = ring[in.seq % Capacity];
+    slot.input = in.quantized();
+    stepJet(model, state, slot.input);
+    slot.after = state;
+    return slot.input;
+}
+
+bool JetPredictor::reconcile(uint32_t seq, const FlightState& authoritative)
+{
+    if (seq <= ackedSeq || seq >= nextSeq)
+        return false; // Stale, duplicated, or from before a reset
+    ackedSeq = seq;
+    if (nextSeq - seq > Capacity)
+    {
+        // The inputs since seq have been overwritten, so there is nothing to replay; take the server's word
+        state = authoritative;
+        renderOffset = Vector(0, 0, 0);
+        ++stats.snaps;
+        return true;
+    }
+
+    Slot& acked = ring[seq % Capacity];
+    if (close(acked.after, authoritative))
+        return false;
+
+    const auto start = std::chrono::steady_clock::now();
+    const Vector drawnBefore = state.position + renderOffset;
+    FlightState s = authoritative;
+    acked.after = s;
+    for (uint32_t q = seq + 1; q < nextSeq; ++q)
+    {
+        Slot& slot = ring[q % Capacity];
+        stepJet(model, s, slot.input);
+        slot.after = s;
+    }
+    state = s;
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    renderOffset = drawnBefore - state.position;
+    if (renderOffset.length() > SnapDistance)
+        renderOffset = Vector(0, 0, 0);
+    ++stats.corrections;
+    stats.replayedTicks += nextSeq - 1 - seq;
+    stats.lastReplayMs = ms;
+    stats.maxReplayMs = std::max(stats.maxReplayMs, ms);
+    return true;
+}
+
+void JetPredictor::decay(float dt)
+{
+    renderOffset = renderOffset * std::exp(-dt / std::max(smoothingSec, 1.0e-3f));
+    if (renderOffset.length() < 1.0e-3f)
+        renderOffset = Vector(0, 0, 0);
+}
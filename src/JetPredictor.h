@@ -0,0 +1,97 @@
+#pragma once
+
+#include "FlightModel.h"
+#include "Vector.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Aftr
+{
+    /**
+       One fixed physics tick of the player's jet as it travels to the authoritative server: the
+       controls after the autopilot, the wind the client sampled and the takeoff-assist climb.
+       Every value is on its wire grid (quantized()) before the client steps with it, so the
+       server, stepping the same input through stepJet(), lands on the same bits.
+    */
+    struct JetInput
+    {
+        uint32_t seq = 0;
+        FlightControls controls;
+        Vector wind{ 0, 0, 0 };
+        float climbAssist = 0.0f; // Added to z per second after the flight model step
+        bool respawn = false;     // Start from spawn before stepping
+        FlightState spawn;        // Only what step() does not derive: position, angles and airspeed
+
+        static constexpr size_t PackedBytes = 17;
+        static constexpr size_t MaxPackedBytes = PackedBytes + 7 * 4; // With a respawn
+
+        size_t pack(uint8_t* out) const; // Everything but seq; returns the bytes written
+        static size_t unpack(const uint8_t* in, size_t size, uint32_t seq, JetInput& out); // 0 if size is short
+        JetInput quantized() const;
+    };
+
+    // The step both ends run: respawn if asked, one FixedStepSec of the flight model, the climb assist.
+    void stepJet(const FlightModel& model, FlightState& state, const JetInput& input);
+
+    /**
+       Client-side prediction for the player's jet. Each tick's input is stepped locally at once
+       and recorded, with the state it produced, in a fixed ring of Capacity ticks. When the
+       server's state after some input arrives it is compared with the state recorded for that
+       input; on a mismatch the jet is put back to the server's state and every newer input is
+       replayed on top of it. FlightState is a few floats and a step is a handful of flops, so a
+       30-tick replay costs microseconds. The jump a correction causes is kept as a render offset
+       that decays over smoothingSec instead of snapping the drawn jet.
+    */
+    class JetPredictor
+    {
+    public:
+        static constexpr uint32_t Capacity = 64; // Ticks of unacknowledged input, ~530 ms of round trip at 120 Hz
+
+        struct Stats
+        {
+            uint64_t corrections = 0;
+            uint64_t replayedTicks = 0;
+            uint64_t snaps = 0;      // Corrections older than the ring, taken without replay
+            double lastReplayMs = 0.0;
+            double maxReplayMs = 0.0;
+        };
+
+        explicit JetPredictor(const FlightModel& model) : model(model) {}
+
+        void reset(const FlightState& s); // Forgets every input; local only
+        void respawn(const FlightState& s); // reset(), and the next input carries s to the server as is
+
+        // Quantizes the input, steps the predicted state with it and records both. Returns the input to send.
+        const JetInput& step(const FlightControls& controls, const Vector& wind, float climbAssist);
+
+        // The server's state after input seq. Returns true if the prediction had to be corrected.
+        bool reconcile(uint32_t seq, const FlightState& authoritative);
+
+        void decay(float dt); // Shrinks the render offset
+        float smoothingSec = 0.1f;
+
+        const FlightState& getState() const { return state; }
+        Vector getRenderOffset() const { return renderOffset; } // Add to the state's position when drawing
+        uint32_t getPendingCount() const { return nextSeq - 1 - ackedSeq; }
+        uint32_t getLastSeq() const { return nextSeq - 1; }
+        const Stats& getStats() const { return stats; }
+
+    private:
+        struct Slot
+        {
+            JetInput input;
+            FlightState after;
+        };
+
+        const FlightModel& model;
+        FlightState state;
+        std::array<Slot, Capacity> ring;
+        uint32_t nextSeq = 1;
+        uint32_t ackedSeq = 0;
+        bool respawnPending = false;
+        FlightState spawn;
+        Vector renderOffset{ 0, 0, 0 };
+        Stats stats;
+    };
+}
@@ -0,0 +1,170 @@
+#include "LoadQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+using namespace Aftr;
+
+namespace
+{
+    bool readWhole(const std::string& path, std::string& out)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+        in.seekg(0, std::ios::end);
+        out.resize(static_cast<size_t>(std::max<std::streamoff>(0, in.tellg())));
+        in.seekg(0, std::ios::beg);
+        in.read(out.data(), static_cast<std::streamsize>(out.size()));
+        return static_cast<bool>(in) || in.eof();
+    }
+}
+
+LoadQueue::~LoadQueue()
+{
+    stop();
+}
+
+void LoadQueue::start(unsigned threads)
+{
+    if (running)
+        return;
+    running = true; // Jobs queued before start() are kept
+    for (unsigned i = 0; i < std::max(1u, threads); ++i)
+        workers.emplace_back(&LoadQueue::run, this);
+}
+
+void LoadQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        pending.clear();
+    }
+    wake.notify_all();
+    for (std::thread& t : workers)
+        t.join();
+    workers.clear();
+}
+
+uint32_t LoadQueue::enqueue(const std::string& path, float priority)
+{
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextId++;
+        pending.push_back(Job{ id, path, priority });
+        std::push_heap(pending.begin(), pending.end(), HeapOrder{});
+    }
+    wake.notify_one();
+    return id;
+}
+
+void LoadQueue::reprioritize(const std::function<float(uint32_t id, float priority)>& newPriority)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Job& j : pending)
+        j.priority = newPriority(j.id, j.priority);
+    std::make_heap(pending.begin(), pending.end(), HeapOrder{});
+    for (Result& r : completed)
+        r.priority = newPriority(r.id, r.priority);
+    std::make_heap(completed.begin(), completed.end(), HeapOrder{});
+}
+
+bool LoadQueue::popCompleted(Result& out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (completed.empty())
+        return false;
+    std::pop_heap(completed.begin(), completed.end(), HeapOrder{});
+    out = std::move(completed.back());
+    completed.pop_back();
+    return true;
+}
+
+size_t LoadQueue::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size() + inFlight;
+}
+
+size_t LoadQueue::getCompletedCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return completed.size();
+}
+
+void LoadQueue::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this]() { return !running || !pending.empty(); });
+        if (!running)
+            break;
+
+        std::pop_heap(pending.begin(), pending.end(), HeapOrder{});
+        Job job = std::move(pending.back());
+        pending.pop_back();
+        ++inFlight;
+        lock.unlock();
+
+        Result r = prefetch(job);
+
+        lock.lock();
+        --inFlight;
+        completed.push_back(std::move(r));
+        std::push_heap(completed.begin(), completed.end(), HeapOrder{});
+    }
+}
+
+LoadQueue::Result LoadQueue::prefetch(const Job& job)
+{
+    auto start = std::chrono::steady_clock::now();
+    Result r;
+    r.id = job.id;
+    r.path = job.path;
+    r.priority = job.priority;
+
+    std::string contents;
+    r.ok = readWhole(job.path, contents);
+    r.bytes = contents.size();
+    if (r.ok && std::filesystem::path(job.path).extension() == ".wrl")
+    {
+        r.dependencies = findTextureReferences(job.path, contents);
+        std::string texture;
+        for (const std::string& dep : r.dependencies)
+        {
+            if (readWhole(dep, texture))
+                r.bytes += texture.size();
+        }
+    }
+
+    std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+    r.readMs = ms.count();
+    return r;
+}
+
+std::vector<std::string> LoadQueue::findTextureReferences(const std::string& wrlPath, const std::string& contents)
+{
+    // ImageTexture { url "file.jpg" } and url [ "a.jpg" "b.jpg" ]; only the first quoted name per url is used by the engine
+    std::vector<std::string> out;
+    const std::filesystem::path dir = std::filesystem::path(wrlPath).parent_path();
+    for (size_t pos = contents.find("url"); pos != std::string::npos; pos = contents.find("url", pos + 3))
+    {
+        const size_t open = contents.find('"', pos);
+        const size_t lineEnd = contents.find('\n', pos);
+        if (open == std::string::npos || (lineEnd != std::string::npos && open > lineEnd))
+            continue;
+        const size_t close = contents.find('"', open + 1);
+        if (close == std::string::npos)
+            break;
+
+        const std::string name = contents.substr(open + 1, close - open - 1);
+        const std::string resolved = (dir / name).lexically_normal().string();
+        if (!name.empty() && std::find(out.begin(), out.end(), resolved) == out.end())
+            out.push_back(resolved);
+    }
+    return out;
+}
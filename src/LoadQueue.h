@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       Thread pool that prefetches asset files off the main thread in priority order. A job
+       reads its file and, for VRML models, every texture the model references through an
+       ImageTexture url, so the OS cache is warm by the time the engine parses the model and
+       decodes its textures on the main thread. Lower priority values run first and pending
+       jobs can be re-prioritized, e.g. by distance to the camera, while they wait.
+    */
+    class LoadQueue
+    {
+    public:
+        struct Result
+        {
+            uint32_t id = 0;
+            std::string path;
+            float priority = 0.0f;
+            bool ok = false;
+            size_t bytes = 0;     // File plus its dependencies
+            double readMs = 0.0;  // Wall time the worker spent reading
+            std::vector<std::string> dependencies; // Textures found in the file, as resolved paths
+        };
+
+        LoadQueue() = default;
+        LoadQueue(const LoadQueue&) = delete;
+        LoadQueue& operator=(const LoadQueue&) = delete;
+        ~LoadQueue();
+
+        void start(unsigned threads);
+        void stop(); // Drops pending jobs and joins the workers
+
+        uint32_t enqueue(const std::string& path, float priority);
+        void reprioritize(const std::function<float(uint32_t id, float priority)>& newPriority);
+
+        // Completed jobs come out lowest priority value first.
+        bool popCompleted(Result& out);
+
+        size_t getPendingCount() const;   // Queued or being read
+        size_t getCompletedCount() const; // Waiting in popCompleted
+
+        // Texture urls referenced by a VRML file, resolved against the file's directory.
+        static std::vector<std::string> findTextureReferences(const std::string& wrlPath, const std::string& contents);
+
+    private:
+        struct Job
+        {
+            uint32_t id;
+            std::string path;
+            float priority;
+        };
+        struct HeapOrder
+        {
+            template<typename T>
+            bool operator()(const T& a, const T& b) const { return a.priority > b.priority; } // Min-heap on priority
+        };
+
+        void run();
+        static Result prefetch(const Job& job);
+
+        mutable std::mutex mutex;
+        std::condition_variable wake;
+        std::vector<std::thread> workers;
+        std::vector<Job> pending;      // Heap by HeapOrder
+        std::vector<Result> completed; // Heap by HeapOrder
+        size_t inFlight = 0;
+        uint32_t nextId = 1;
+        bool running = false;
+    };
+}
@@ -0,0 +1,24 @@
+#include "LodSelector.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Aftr;
+
+uint8_t LodSelector::select(uint8_t current, float pixels) const
+{
+    const uint8_t last = static_cast<uint8_t>(minPixels.size());
+    uint8_t level = current == Culled ? last : std::min(current, last);
+
+    // Objects coming back into view start coarse and refine, matching what a steady view converges to
+    while (level > 0 && pixels >= minPixels[level - 1] * (1.0f + hysteresis))
+        --level;
+    while (level < last && pixels < minPixels[level] * (1.0f - hysteresis))
+        ++level;
+    return level;
+}
+
+float LodSelector::projectedPixels(float radius, float distance, float viewportHeightPx, float verticalFovRad)
+{
+    const float d = std::max(distance, radius); // Inside the sphere it fills the view
+    return 2.0f * radius / (d * std::tan(verticalFovRad * 0.5f)) * viewportHeightPx * 0.5f;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       Picks a level of detail from an object's projected size in pixels. Level 0 is the full
+       mesh; each later level is coarser and the last one has no lower bound (the impostor).
+       A level is left for a coarser one only once the object is hysteresis below that level's
+       threshold, and a finer level is only taken once it is hysteresis above the finer one's,
+       so an object sitting right at a threshold doesn't flip every frame.
+    */
+    struct LodSelector
+    {
+        static constexpr uint8_t Culled = 0xFF;
+
+        std::vector<float> minPixels; // minPixels[i] is the smallest size level i is drawn at; one fewer entry than levels
+        float hysteresis = 0.15f;     // Fraction of a threshold
+
+        uint8_t levelCount() const { return static_cast<uint8_t>(minPixels.size() + 1); }
+        uint8_t select(uint8_t current, float pixels) const;
+
+        // Diameter in pixels of a sphere of the given radius at distance from the eye.
+        static float projectedPixels(float radius, float distance, float viewportHeightPx, float verticalFovRad);
+    };
+}
@@ -0,0 +1,131 @@
+#include "MGLDynamicLines.h"
+#include "AftrOpenGLIncludes.h"
+#include "Camera.h"
+#include "WOInstanced.h"
+#include <algorithm>
+#include <cstddef>
+
+using namespace Aftr;
+
+namespace
+{
+    const char* vertexShaderSrc = R"(
+        #version 430 core
+        layout( location = 0 ) in vec3 aPos;
+        layout( location = 1 ) in vec4 aColor;
+        uniform mat4 uViewProj;
+        out vec4 vColor;
+        void main()
+        {
+            vColor = aColor;
+            gl_Position = uViewProj * vec4( aPos, 1.0 );
+        }
+    )";
+
+    const char* fragmentShaderSrc = R"(
+        #version 430 core
+        in vec4 vColor;
+        out vec4 fragColor;
+        void main()
+        {
+            fragColor = vColor;
+        }
+    )";
+}
+
+MGLDynamicLines* MGLDynamicLines::New(WO* parentWO)
+{
+    return new MGLDynamicLines(parentWO);
+}
+
+MGLDynamicLines::MGLDynamicLines(WO* parentWO) : MGL(parentWO)
+{
+}
+
+MGLDynamicLines::~MGLDynamicLines()
+{
+    if (vbo != 0)
+        glDeleteBuffers(1, &vbo);
+    if (vao != 0)
+        glDeleteVertexArrays(1, &vao);
+    if (program != 0)
+        glDeleteProgram(program);
+}
+
+void MGLDynamicLines::setLines(const std::vector<Vector>& verts, const std::vector<aftrColor4ub>& colors)
+{
+    vertices.resize(std::min(verts.size(), colors.size()) & ~size_t(1)); // Keeps its capacity between calls
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        LineVertex& v = vertices[i];
+        v.position[0] = verts[i].x;
+        v.position[1] = verts[i].y;
+        v.position[2] = verts[i].z;
+        v.color[0] = colors[i].r;
+        v.color[1] = colors[i].g;
+        v.color[2] = colors[i].b;
+        v.color[3] = colors[i].a;
+    }
+    dirty = true;
+}
+
+bool MGLDynamicLines::createGLResources()
+{
+    program = MGLInstanced::buildProgram(vertexShaderSrc, fragmentShaderSrc, "MGLDynamicLines");
+    if (program == 0)
+    {
+        programFailed = true;
+        return false;
+    }
+    viewProjLoc = glGetUniformLocation(program, "uViewProj");
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex), reinterpret_cast<void*>(offsetof(LineVertex, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(LineVertex), reinterpret_cast<void*>(offsetof(LineVertex, color)));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void MGLDynamicLines::render(const Camera& cam)
+{
+    if (program == 0 && (programFailed || !createGLResources()))
+        return;
+
+    if (dirty)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        if (vertices.size() > bufferCapacity)
+        {
+            // Grows with headroom so a slightly longer path next time does not reallocate again
+            bufferCapacity = static_cast<uint32_t>(std::max<size_t>(vertices.size(), bufferCapacity * 2));
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bufferCapacity) * sizeof(LineVertex), nullptr, GL_DYNAMIC_DRAW);
+        }
+        if (!vertices.empty())
+            glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertices.size() * sizeof(LineVertex)), vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        dirty = false;
+    }
+    if (vertices.empty())
+        return;
+
+    float viewProj[16];
+    MGLInstanced::viewProjection(cam, viewProj);
+
+    const GLboolean blendWasOn = glIsEnabled(GL_BLEND);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(program);
+    glUniformMatrix4fv(viewProjLoc, 1, GL_FALSE, viewProj);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(vertices.size()));
+    glBindVertexArray(0);
+    glUseProgram(0);
+    if (!blendWasOn)
+        glDisable(GL_BLEND);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "MGL.h"
+#include <cstdint>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       Model for a line list whose vertices change while the sim runs, like the predicted flight
+       path. The GL buffer is created on the first render and rewritten in place with
+       glBufferSubData whenever setLines() hands it new vertices; it is only reallocated when a
+       list outgrows it, so steady updates create no geometry and no GL objects.
+    */
+    class MGLDynamicLines : public MGL
+    {
+    public:
+        static MGLDynamicLines* New(WO* parentWO);
+        virtual ~MGLDynamicLines();
+        virtual void render(const Camera& cam) override;
+
+        // Pairs of vertices, one line each, with a color per vertex. Drawn from the next render on.
+        void setLines(const std::vector<Vector>& verts, const std::vector<aftrColor4ub>& colors);
+
+    protected:
+        MGLDynamicLines(WO* parentWO);
+        bool createGLResources();
+
+        struct LineVertex
+        {
+            float position[3];
+            uint8_t color[4];
+        };
+
+        std::vector<LineVertex> vertices;
+        bool dirty = false;
+        uint32_t bufferCapacity = 0; // Vertices the GL buffer holds
+        uint32_t vao = 0, vbo = 0, program = 0;
+        bool programFailed = false; // Logged once; the lines then stay undrawn instead of retrying every frame
+        int32_t viewProjLoc = -1;
+    };
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Aftr
+{
+    // Read-only memory mapping of a whole file (mmap on POSIX, a file mapping on Windows).
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { close(); }
+
+        bool open(const std::string& path);
+        void close();
+
+        const uint8_t* data() const { return bytes; }
+        size_t size() const { return length; }
+        bool isOpen() const { return bytes != nullptr; }
+
+    private:
+        const uint8_t* bytes = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    };
+}
@@ -0,0 +1,232 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace Aftr;
+
+namespace
+{
+    // Splits VRML text into tokens; braces and brackets are tokens of their own and commas and
+    // comments are whitespace.
+    std::vector<std::string> tokenize(std::istream& in)
+    {
+        std::vector<std::string> tokens;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            const size_t hash = line.find('#');
+            if (hash != std::string::npos)
+                line.erase(hash);
+
+            std::string cur;
+            for (char c : line)
+            {
+                if (c == '{' || c == '}' || c == '[' || c == ']' || c == ',' || std::isspace(static_cast<unsigned char>(c)))
+                {
+                    if (!cur.empty())
+                        tokens.push_back(cur);
+                    cur.clear();
+                    if (c == '{' || c == '}' || c == '[' || c == ']')
+                        tokens.emplace_back(1, c);
+                }
+                else
+                    cur += c;
+            }
+            if (!cur.empty())
+                tokens.push_back(cur);
+        }
+        return tokens;
+    }
+}
+
+void IndexedMesh::bounds(Vector& lo, Vector& hi) const
+{
+    lo = hi = points.empty() ? Vector(0, 0, 0) : points.front();
+    for (const Vector& p : points)
+    {
+        lo = Vector(std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z));
+        hi = Vector(std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z));
+    }
+}
+
+bool MeshSimplifier::readVrml(const std::string& path, IndexedMesh& out)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        printf("MeshSimplifier: cannot open %s\n", path.c_str());
+        return false;
+    }
+
+    const std::vector<std::string> t = tokenize(in);
+    out = IndexedMesh{};
+    bool haveColor = false;
+    uint32_t base = 0; // First vertex of the most recent Coordinate node
+    for (size_t i = 0; i < t.size(); ++i)
+    {
+        if (t[i] == "diffuseColor" && !haveColor && i + 3 < t.size())
+        {
+            for (int k = 0; k < 3; ++k)
+                out.color[k] = std::strtof(t[i + 1 + k].c_str(), nullptr);
+            haveColor = true;
+        }
+        else if (t[i] == "Coordinate" && i + 3 < t.size() && t[i + 1] == "{" && t[i + 2] == "point" && t[i + 3] == "[")
+        {
+            base = static_cast<uint32_t>(out.points.size());
+            std::vector<float> v;
+            for (i += 4; i < t.size() && t[i] != "]"; ++i)
+                v.push_back(std::strtof(t[i].c_str(), nullptr));
+            for (size_t k = 0; k + 2 < v.size(); k += 3)
+                out.points.emplace_back(v[k], v[k + 1], v[k + 2]);
+        }
+        else if (t[i] == "coordIndex" && i + 1 < t.size() && t[i + 1] == "[")
+        {
+            std::vector<uint32_t> poly;
+            for (i += 2; i < t.size(); ++i)
+            {
+                const bool end = t[i] == "]";
+                const long idx = end ? -1 : std::strtol(t[i].c_str(), nullptr, 10);
+                if (idx >= 0)
+                    poly.push_back(base + static_cast<uint32_t>(idx));
+                else
+                {
+                    for (size_t k = 1; k + 1 < poly.size(); ++k)
+                        out.triangles.insert(out.triangles.end(), { poly[0], poly[k], poly[k + 1] });
+                    poly.clear();
+                }
+                if (end)
+                    break;
+            }
+        }
+    }
+
+    for (uint32_t idx : out.triangles)
+    {
+        if (idx >= out.points.size())
+        {
+            printf("MeshSimplifier: %s has a coordIndex past its points\n", path.c_str());
+            return false;
+        }
+    }
+    return !out.triangles.empty();
+}
+
+bool MeshSimplifier::writeVrml(const std::string& path, const IndexedMesh& mesh)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        printf("MeshSimplifier: cannot write %s\n", path.c_str());
+        return false;
+    }
+
+    out << "#VRML V2.0 utf8\n"
+        << "# Generated by LodBuilder\n"
+        << "Shape {\n"
+        << "  appearance Appearance { material Material { diffuseColor " << mesh.color[0] << " " << mesh.color[1] << " " << mesh.color[2] << " } }\n"
+        << "  geometry IndexedFaceSet {\n"
+        << "    solid FALSE\n"
+        << "    coord Coordinate { point [\n";
+    for (const Vector& p : mesh.points)
+        out << "      " << p.x << " " << p.y << " " << p.z << ",\n";
+    out << "    ] }\n"
+        << "    coordIndex [\n";
+    for (size_t i = 0; i < mesh.triangles.size(); i += 3)
+        out << "      " << mesh.triangles[i] << ", " << mesh.triangles[i + 1] << ", " << mesh.triangles[i + 2] << ", -1,\n";
+    out << "    ]\n"
+        << "  }\n"
+        << "}\n";
+    return static_cast<bool>(out);
+}
+
+IndexedMesh MeshSimplifier::clusterVertices(const IndexedMesh& mesh, float cellSize)
+{
+    Vector lo, hi;
+    mesh.bounds(lo, hi);
+    const float inv = 1.0f / std::max(cellSize, 1e-6f);
+
+    // 21 bits per axis is plenty for any cell size worth clustering at
+    auto cellKey = [&](const Vector& p)
+    {
+        const uint64_t x = static_cast<uint64_t>((p.x - lo.x) * inv) & 0x1FFFFF;
+        const uint64_t y = static_cast<uint64_t>((p.y - lo.y) * inv) & 0x1FFFFF;
+        const uint64_t z = static_cast<uint64_t>((p.z - lo.z) * inv) & 0x1FFFFF;
+        return x | (y << 21) | (z << 42);
+    };
+
+    IndexedMesh out;
+    std::copy(mesh.color, mesh.color + 3, out.color);
+
+    std::unordered_map<uint64_t, uint32_t> cellToVertex;
+    std::vector<uint32_t> remap(mesh.points.size());
+    std::vector<uint32_t> members;
+    for (size_t i = 0; i < mesh.points.size(); ++i)
+    {
+        auto inserted = cellToVertex.emplace(cellKey(mesh.points[i]), static_cast<uint32_t>(out.points.size()));
+        if (inserted.second)
+        {
+            out.points.emplace_back(0, 0, 0);
+            members.push_back(0);
+        }
+        const uint32_t v = inserted.first->second;
+        remap[i] = v;
+        out.points[v] += mesh.points[i];
+        ++members[v];
+    }
+    for (size_t v = 0; v < out.points.size(); ++v)
+        out.points[v] = out.points[v] / static_cast<float>(members[v]);
+
+    std::unordered_set<uint64_t> seen;
+    for (size_t i = 0; i + 2 < mesh.triangles.size(); i += 3)
+    {
+        uint32_t a = remap[mesh.triangles[i]], b = remap[mesh.triangles[i + 1]], c = remap[mesh.triangles[i + 2]];
+        if (a == b || b == c || a == c)
+            continue;
+
+        // Winding-independent key (exact below 2M clusters); two triangles over the same three clusters are one face
+        uint32_t s[3] = { a, b, c };
+        std::sort(s, s + 3);
+        const uint64_t key = static_cast<uint64_t>(s[0]) | (static_cast<uint64_t>(s[1]) << 21) | (static_cast<uint64_t>(s[2]) << 42);
+        if (!seen.insert(key).second)
+            continue;
+        out.triangles.insert(out.triangles.end(), { a, b, c });
+    }
+
+    // Drop clusters no surviving triangle references
+    std::vector<uint32_t> compact(out.points.size(), UINT32_MAX);
+    std::vector<Vector> kept;
+    for (uint32_t& idx : out.triangles)
+    {
+        if (compact[idx] == UINT32_MAX)
+        {
+            compact[idx] = static_cast<uint32_t>(kept.size());
+            kept.push_back(out.points[idx]);
+        }
+        idx = compact[idx];
+    }
+    out.points.swap(kept);
+    return out;
+}
+
+IndexedMesh MeshSimplifier::makeImpostorCard(const IndexedMesh& mesh)
+{
+    Vector lo, hi;
+    mesh.bounds(lo, hi);
+    const Vector c = (lo + hi) * 0.5f;
+    const float halfWidth = std::max(hi.x - lo.x, hi.y - lo.y) * 0.5f;
+    const float halfHeight = std::max((hi.z - lo.z) * 0.5f, halfWidth * 0.25f); // Keep thin models visible edge-on
+
+    IndexedMesh card;
+    std::copy(mesh.color, mesh.color + 3, card.color);
+    // Centred on the model origin rather than the box centre so it stays put when turned about it
+    card.points = { Vector(0, -halfWidth, c.z - halfHeight), Vector(0, halfWidth, c.z - halfHeight),
+                    Vector(0, halfWidth, c.z + halfHeight), Vector(0, -halfWidth, c.z + halfHeight) };
+    card.triangles = { 0, 1, 2, 0, 2, 3 };
+    return card;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Vector.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    // Triangle soup with shared vertices, as read from / written to a VRML IndexedFaceSet.
+    struct IndexedMesh
+    {
+        std::vector<Vector> points;
+        std::vector<uint32_t> triangles; // Three indices per triangle
+        float color[3] = { 0.7f, 0.7f, 0.7f }; // First diffuseColor found in the source file
+
+        size_t triangleCount() const { return triangles.size() / 3; }
+        void bounds(Vector& lo, Vector& hi) const;
+    };
+
+    /**
+       Offline helpers behind tools/LodBuilder, which bakes the level-of-detail meshes and the
+       impostor card used for traffic aircraft. Only the subset of VRML 2.0 the module's models
+       use is understood: every Coordinate/coordIndex pair in the file is appended to one mesh
+       (polygons are fan triangulated) and Transform nodes are ignored, which matches the
+       pre-transformed (_pp) models shipped with the engine.
+    */
+    namespace MeshSimplifier
+    {
+        bool readVrml(const std::string& path, IndexedMesh& out);
+        bool writeVrml(const std::string& path, const IndexedMesh& mesh);
+
+        // Vertex clustering (Rossignac-Borrel): vertices in the same cellSize grid cell collapse
+        // to their mean, and triangles that degenerate or duplicate another are dropped.
+        IndexedMesh clusterVertices(const IndexedMesh& mesh, float cellSize);
+
+        // Flat card in the local Y-Z plane facing +X, sized to the mesh's span and height. Drawn
+        // turned toward the camera it stands in for the aircraft at a few pixels on screen.
+        IndexedMesh makeImpostorCard(const IndexedMesh& mesh);
+    }
+}
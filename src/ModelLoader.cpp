@@ -0,0 +1,128 @@
+#include "ModelLoader.h"
+#include "WO.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace Aftr;
+
+ModelLoader::ModelLoader()
+{
+    prefetchTimerId = Profiler::get().registerTimer("Load: prefetch (worker)");
+    createTimerId = Profiler::get().registerTimer("Load: create WO (main)");
+    pumpTimerId = Profiler::get().registerTimer("Load: pump");
+    bytesCounterId = Profiler::get().registerCounter("Load: bytes prefetched");
+    pendingCounterId = Profiler::get().registerCounter("Load: models pending");
+}
+
+ModelLoader::~ModelLoader()
+{
+    queue.stop();
+    for (auto& p : prototypes)
+        delete p.second;
+}
+
+void ModelLoader::start(unsigned threads)
+{
+    queue.start(threads);
+}
+
+void ModelLoader::request(const std::string& path, const Vector& scale, float priority, const Vector* position, ReadyFn onReady)
+{
+    ++requestedCount;
+    Request r{ scale, priority, position != nullptr, position ? *position : Vector(0, 0, 0), std::move(onReady) };
+
+    // A path that is already cached skips the queue entirely; one already in flight just gains a requester.
+    uint32_t id;
+    auto it = inFlight.find(path);
+    if (it != inFlight.end())
+        id = it->second;
+    else if (isCached(path))
+        id = 0;
+    else
+    {
+        id = queue.enqueue(path, priority);
+        inFlight.emplace(path, id);
+    }
+
+    if (id == 0)
+    {
+        if (r.onReady)
+            r.onReady(spawn(path, r.scale));
+        ++loadedCount;
+        return;
+    }
+    waiting[id].push_back(std::move(r));
+}
+
+WO* ModelLoader::spawn(const std::string& path, const Vector& scale)
+{
+    if (!isCached(path))
+        createPrototype(path);
+    return WO::New(path, scale, MESH_SHADING_TYPE::mstFLAT);
+}
+
+WO* ModelLoader::createPrototype(const std::string& path)
+{
+    ProfileScope scope(createTimerId);
+    WO* proto = WO::New(path, Vector(1, 1, 1), MESH_SHADING_TYPE::mstFLAT);
+    proto->isVisible = false;
+    prototypes.emplace(path, proto);
+    return proto;
+}
+
+void ModelLoader::pump(const Vector& eye, double budgetMs)
+{
+    ProfileScope pumpScope(pumpTimerId);
+    auto start = std::chrono::steady_clock::now();
+
+    // Positioned requests get nearer as the camera moves; the job takes its most urgent requester.
+    queue.reprioritize([this, &eye](uint32_t id, float old)
+        {
+            auto it = waiting.find(id);
+            if (it == waiting.end())
+                return old;
+            float best = old;
+            bool first = true;
+            for (const Request& r : it->second)
+            {
+                const float p = r.priority + (r.hasPosition ? (r.position - eye).length() * 0.001f : 0.0f);
+                best = first ? p : std::min(best, p);
+                first = false;
+            }
+            return best;
+        });
+
+    LoadQueue::Result done;
+    while (queue.popCompleted(done))
+    {
+        Profiler::get().addSample(prefetchTimerId, done.readMs);
+        Profiler::get().addToCounter(bytesCounterId, static_cast<int64_t>(done.bytes));
+        if (!done.ok)
+            printf("ModelLoader: could not read %s; the engine will report the failure when it parses it\n", done.path.c_str());
+
+        if (!isCached(done.path)) // spawn() may have built it synchronously while the prefetch ran
+            createPrototype(done.path);
+        inFlight.erase(done.path);
+        auto it = waiting.find(done.id);
+        if (it != waiting.end())
+        {
+            for (Request& r : it->second)
+            {
+                if (r.onReady)
+                {
+                    ProfileScope scope(createTimerId);
+                    r.onReady(WO::New(done.path, r.scale, MESH_SHADING_TYPE::mstFLAT));
+                }
+                ++loadedCount;
+            }
+            waiting.erase(it);
+        }
+
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        if (ms.count() >= budgetMs)
+            break; // The rest waits for the next frame
+    }
+
+    Profiler::get().setCounter(pendingCounterId, static_cast<int64_t>(requestedCount - loadedCount));
+}
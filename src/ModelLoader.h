@@ -0,0 +1,71 @@
+#pragma once
+
+#include "LoadQueue.h"
+#include "Vector.h"
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Aftr
+{
+    class WO;
+
+    /**
+       Loads models for the module without stalling a frame on disk. request() queues a model on
+       the LoadQueue thread pool, which prefetches the file and its textures; pump(), called once
+       per frame, then builds the WOs on the main thread (the engine needs the GL context for that)
+       in priority order until its time budget is spent.
+
+       Every path that has finished loading keeps a hidden, pinned prototype WO so the engine's
+       shared model data stays resident; spawn() of a cached path never touches the disk or the
+       VRML parser. Load timings and progress go to the profiler.
+    */
+    class ModelLoader
+    {
+    public:
+        using ReadyFn = std::function<void(WO*)>;
+
+        ModelLoader();
+        ~ModelLoader();
+
+        void start(unsigned threads);
+
+        // priority: lower loads first. With a position, distance to the eye (in km) is added each pump.
+        // onReady may be empty to only warm the cache.
+        void request(const std::string& path, const Vector& scale, float priority, const Vector* position, ReadyFn onReady);
+
+        WO* spawn(const std::string& path, const Vector& scale); // Synchronous; cheap once the path is cached
+        bool isCached(const std::string& path) const { return prototypes.count(path) != 0; }
+
+        void pump(const Vector& eye, double budgetMs);
+
+        size_t getRequestedCount() const { return requestedCount; }
+        size_t getLoadedCount() const { return loadedCount; }
+
+    private:
+        struct Request
+        {
+            Vector scale;
+            float priority;
+            bool hasPosition;
+            Vector position;
+            ReadyFn onReady;
+        };
+
+        WO* createPrototype(const std::string& path);
+
+        LoadQueue queue;
+        std::unordered_map<uint32_t, std::vector<Request>> waiting; // Queue job id -> requests for its path
+        std::unordered_map<std::string, uint32_t> inFlight;         // Path -> queue job id
+        std::unordered_map<std::string, WO*> prototypes;
+        size_t requestedCount = 0;
+        size_t loadedCount = 0;
+
+        int prefetchTimerId = -1;
+        int createTimerId = -1;
+        int pumpTimerId = -1;
+        int bytesCounterId = -1;
+        int pendingCounterId = -1;
+    };
+}
@@ -0,0 +1,268 @@
+#include "NetTransport.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace Aftr;
+
+namespace
+{
+#ifdef _WIN32
+    // Winsock is started with the first socket and left running for the process
+    bool startSockets()
+    {
+        static const bool started = []
+        {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        return started;
+    }
+    using SocketHandle = SOCKET;
+    void closeSocket(SocketHandle s) { closesocket(s); }
+#else
+    bool startSockets() { return true; }
+    using SocketHandle = int;
+    void closeSocket(SocketHandle s) { ::close(s); }
+#endif
+
+    sockaddr_in toSockaddr(const NetAddress& a)
+    {
+        sockaddr_in sa{};
+        sa.sin_family = AF_INET;
+        sa.sin_addr.s_addr = htonl(a.ip);
+        sa.sin_port = htons(a.port);
+        return sa;
+    }
+}
+
+std::string NetAddress::toString() const
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u:%u", ip >> 24, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF, port);
+    return text;
+}
+
+bool NetAddress::parse(const std::string& text, uint16_t defaultPort, NetAddress& out)
+{
+    const size_t colon = text.rfind(':');
+    const std::string host = text.substr(0, colon);
+    NetAddress a;
+    a.port = defaultPort;
+    if (colon != std::string::npos)
+    {
+        char* end = nullptr;
+        const unsigned long port = std::strtoul(text.c_str() + colon + 1, &end, 10);
+        if (*end != '\0' || port == 0 || port > 65535)
+            return false;
+        a.port = static_cast<uint16_t>(port);
+    }
+
+    if (host == "localhost")
+        a.ip = Loopback;
+    else
+    {
+        unsigned b[4];
+        char tail;
+        if (sscanf(host.c_str(), "%u.%u.%u.%u%c", &b[0], &b[1], &b[2], &b[3], &tail) != 4 || b[0] > 255 || b[1] > 255 || b[2] > 255 || b[3] > 255)
+            return false;
+        a.ip = (b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3];
+    }
+    out = a;
+    return true;
+}
+
+bool UdpEndpoint::open(uint16_t port, bool loopbackOnly)
+{
+    close();
+    if (!startSockets())
+        return false;
+
+    SocketHandle s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef _WIN32
+    if (s == INVALID_SOCKET)
+        return false;
+    u_long nonBlocking = 1;
+    const bool configured = ioctlsocket(s, FIONBIO, &nonBlocking) == 0;
+#else
+    if (s < 0)
+        return false;
+    const bool configured = fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+
+    sockaddr_in sa = toSockaddr(NetAddress{ loopbackOnly ? NetAddress::Loopback : 0u, port });
+    socklen_t length = sizeof(sa);
+    if (!configured || bind(s, reinterpret_cast<const sockaddr*>(&sa), sizeof(sa)) != 0 ||
+        getsockname(s, reinterpret_cast<sockaddr*>(&sa), &length) != 0)
+    {
+        printf("UdpEndpoint: cannot bind port %u\n", port);
+        closeSocket(s);
+        return false;
+    }
+
+    handle = static_cast<intptr_t>(s);
+    address.ip = loopbackOnly ? NetAddress::Loopback : ntohl(sa.sin_addr.s_addr);
+    address.port = ntohs(sa.sin_port);
+    return true;
+}
+
+void UdpEndpoint::close()
+{
+    if (handle != InvalidHandle)
+        closeSocket(static_cast<SocketHandle>(handle));
+    handle = InvalidHandle;
+    address = NetAddress{};
+}
+
+bool UdpEndpoint::send(const NetAddress& to, const uint8_t* data, size_t size)
+{
+    if (handle == InvalidHandle)
+        return false;
+    const sockaddr_in sa = toSockaddr(to);
+    return sendto(static_cast<SocketHandle>(handle), reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+                  reinterpret_cast<const sockaddr*>(&sa), sizeof(sa)) == static_cast<int>(size);
+}
+
+int UdpEndpoint::receive(NetAddress& from, uint8_t* buffer, size_t capacity)
+{
+    if (handle == InvalidHandle)
+        return -1;
+    sockaddr_in sa{};
+    socklen_t length = sizeof(sa);
+    // Errors (nothing waiting, or an ICMP port-unreachable from a peer that left) read as "nothing waiting"
+    const auto n = recvfrom(static_cast<SocketHandle>(handle), reinterpret_cast<char*>(buffer), static_cast<int>(capacity), 0,
+                            reinterpret_cast<sockaddr*>(&sa), &length);
+    if (n < 0)
+        return -1;
+    from.ip = ntohl(sa.sin_addr.s_addr);
+    from.port = ntohs(sa.sin_port);
+    return static_cast<int>(n);
+}
+
+class LoopbackNetwork::Endpoint : public NetEndpoint
+{
+public:
+    Endpoint(LoopbackNetwork& network, uint16_t port) : network(network), address{ NetAddress::Loopback, port } {}
+    ~Endpoint() override { network.close(address.port); }
+
+    bool send(const NetAddress& to, const uint8_t* data, size_t size) override
+    {
+        network.deliver(address, to, data, size);
+        return true;
+    }
+    int receive(NetAddress& from, uint8_t* buffer, size_t capacity) override { return network.take(address.port, from, buffer, capacity); }
+    NetAddress getAddress() const override { return address; }
+
+private:
+    LoopbackNetwork& network;
+    NetAddress address;
+};
+
+std::unique_ptr<NetEndpoint> LoopbackNetwork::open(uint16_t port)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (port == 0)
+    {
+        while (queues.count(nextPort) != 0)
+            nextPort = nextPort == 65535 ? 49152 : nextPort + 1;
+        port = nextPort++;
+    }
+    else if (queues.count(port) != 0)
+        return nullptr;
+    queues[port];
+    return std::make_unique<Endpoint>(*this, port);
+}
+
+void LoopbackNetwork::deliver(const NetAddress& from, const NetAddress& to, const uint8_t* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = queues.find(to.port);
+    if (it != queues.end() && to.ip == NetAddress::Loopback) // Like UDP, nobody listening means the datagram is lost
+        it->second.push_back(Datagram{ from, std::vector<uint8_t>(data, data + size) });
+}
+
+int LoopbackNetwork::take(uint16_t port, NetAddress& from, uint8_t* buffer, size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::deque<Datagram>& q = queues[port];
+    if (q.empty())
+        return -1;
+    const size_t n = std::min(capacity, q.front().bytes.size());
+    memcpy(buffer, q.front().bytes.data(), n);
+    from = q.front().from;
+    q.pop_front();
+    return static_cast<int>(n);
+}
+
+void LoopbackNetwork::close(uint16_t port)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    queues.erase(port);
+}
+
+LinkSimulator::LinkSimulator(NetEndpoint& inner, const NetConditions& conditions, ClockFn clock)
+    : inner(inner), conditions(conditions), clock(std::move(clock)), rng(conditions.seed != 0 ? conditions.seed : 1)
+{
+    if (!this->clock)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        this->clock = [start] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    }
+}
+
+float LinkSimulator::random01()
+{
+    // xorshift32: the same seed drops the same datagrams on every platform
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return static_cast<float>(rng >> 8) * (1.0f / 16777216.0f);
+}
+
+bool LinkSimulator::send(const NetAddress& to, const uint8_t* data, size_t size)
+{
+    flush();
+    if (random01() * 100.0f < conditions.lossPercent)
+    {
+        ++dropped;
+        return true; // Lost on the wire, not a local failure
+    }
+    const double delay = (conditions.latencyMs + random01() * conditions.jitterMs) * 0.001;
+    if (delay <= 0.0)
+        return inner.send(to, data, size);
+    pending.push(Pending{ clock() + delay, sent++, to, std::vector<uint8_t>(data, data + size) });
+    return true;
+}
+
+int LinkSimulator::receive(NetAddress& from, uint8_t* buffer, size_t capacity)
+{
+    flush();
+    return inner.receive(from, buffer, capacity);
+}
+
+void LinkSimulator::flush()
+{
+    const double now = clock();
+    while (!pending.empty() && pending.top().due <= now)
+    {
+        const Pending& p = pending.top();
+        inner.send(p.to, p.bytes.data(), p.bytes.size());
+        pending.pop();
+    }
+}
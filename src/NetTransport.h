@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    // IPv4 address and port, both in host byte order.
+    struct NetAddress
+    {
+        uint32_t ip = 0;
+        uint16_t port = 0;
+
+        bool operator==(const NetAddress& o) const { return ip == o.ip && port == o.port; }
+        bool operator!=(const NetAddress& o) const { return !(*this == o); }
+        bool operator<(const NetAddress& o) const { return ip != o.ip ? ip < o.ip : port < o.port; }
+        std::string toString() const;
+
+        static constexpr uint32_t Loopback = 0x7F000001;
+        // "a.b.c.d:port" or "localhost:port"; a missing port takes defaultPort. No name lookup.
+        static bool parse(const std::string& text, uint16_t defaultPort, NetAddress& out);
+    };
+
+    /**
+       Unreliable datagram endpoint. Replication only ever talks to this interface, so the same
+       server and client run over a real UDP socket, an in-process LoopbackNetwork, or either of
+       those behind a LinkSimulator. Nothing blocks: receive() returns -1 when no datagram is
+       waiting.
+    */
+    class NetEndpoint
+    {
+    public:
+        virtual ~NetEndpoint() = default;
+        virtual bool send(const NetAddress& to, const uint8_t* data, size_t size) = 0;
+        // Bytes copied into buffer, or -1 when nothing is waiting. Longer datagrams are truncated.
+        virtual int receive(NetAddress& from, uint8_t* buffer, size_t capacity) = 0;
+        virtual NetAddress getAddress() const = 0;
+    };
+
+    // Non-blocking IPv4 UDP socket.
+    class UdpEndpoint : public NetEndpoint
+    {
+    public:
+        UdpEndpoint() = default;
+        UdpEndpoint(const UdpEndpoint&) = delete;
+        UdpEndpoint& operator=(const UdpEndpoint&) = delete;
+        ~UdpEndpoint() override { close(); }
+
+        // port 0 picks an ephemeral port. loopbackOnly binds 127.0.0.1 instead of every interface.
+        bool open(uint16_t port, bool loopbackOnly = false);
+        void close();
+        bool isOpen() const { return handle != InvalidHandle; }
+
+        bool send(const NetAddress& to, const uint8_t* data, size_t size) override;
+        int receive(NetAddress& from, uint8_t* buffer, size_t capacity) override;
+        NetAddress getAddress() const override { return address; }
+
+    private:
+        static constexpr intptr_t InvalidHandle = -1;
+        intptr_t handle = InvalidHandle; // SOCKET on Windows, a file descriptor elsewhere
+        NetAddress address;
+    };
+
+    /**
+       In-process stand-in for the loopback interface: endpoints opened on one LoopbackNetwork
+       deliver to each other's queues by port, in send order. Endpoints must not outlive the
+       network. Safe to use from several threads.
+    */
+    class LoopbackNetwork
+    {
+    public:
+        std::unique_ptr<NetEndpoint> open(uint16_t port = 0); // nullptr when the port is taken
+
+    private:
+        class Endpoint;
+        struct Datagram
+        {
+            NetAddress from;
+            std::vector<uint8_t> bytes;
+        };
+
+        void deliver(const NetAddress& from, const NetAddress& to, const uint8_t* data, size_t size);
+        int take(uint16_t port, NetAddress& from, uint8_t* buffer, size_t capacity);
+        void close(uint16_t port);
+
+        std::mutex mutex;
+        std::map<uint16_t, std::deque<Datagram>> queues;
+        uint16_t nextPort = 49152;
+    };
+
+    struct NetConditions
+    {
+        float lossPercent = 0.0f; // Chance each outgoing datagram is dropped
+        float latencyMs = 0.0f;   // One way
+        float jitterMs = 0.0f;    // Extra delay, uniform in [0, jitterMs]; can reorder datagrams
+        uint32_t seed = 1;
+    };
+
+    /**
+       Wraps an endpoint and applies loss, latency and jitter to what it sends, so replication
+       can be exercised against a bad link on a single machine. Delayed datagrams go out from
+       send() and receive(), whichever is called first after they are due. The clock defaults to
+       steady_clock; tests pass their own to run the link in simulated time.
+    */
+    class LinkSimulator : public NetEndpoint
+    {
+    public:
+        using ClockFn = std::function<double()>; // Seconds
+
+        LinkSimulator(NetEndpoint& inner, const NetConditions& conditions, ClockFn clock = nullptr);
+
+        bool send(const NetAddress& to, const uint8_t* data, size_t size) override;
+        int receive(NetAddress& from, uint8_t* buffer, size_t capacity) override;
+        NetAddress getAddress() const override { return inner.getAddress(); }
+
+        void flush(); // Sends everything that is due
+        void setConditions(const NetConditions& c) { conditions = c; }
+        uint64_t getDropped() const { return dropped; }
+
+    private:
+        struct Pending
+        {
+            double due;
+            uint64_t order;
+            NetAddress to;
+            std::vector<uint8_t> bytes;
+            bool operator>(const Pending& o) const { return due != o.due ? due > o.due : order > o.order; }
+        };
+
+        float random01();
+
+        NetEndpoint& inner;
+        NetConditions conditions;
+        ClockFn clock;
+        uint32_t rng;
+        uint64_t sent = 0;
+        uint64_t dropped = 0;
+        std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+    };
+}
@@ -0,0 +1,69 @@
+#include "Profiler.h"
+
+using namespace Aftr;
+
+Profiler& Profiler::get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+int Profiler::registerStat(const char* name, Kind kind)
+{
+    std::lock_guard<std::mutex> lock(registerMutex);
+    const int n = count.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; ++i)
+    {
+        if (slots[i].name == name)
+            return i;
+    }
+    if (n >= MaxStats)
+        return -1;
+
+    slots[n].name = name;
+    slots[n].kind = kind;
+    count.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+void Profiler::addSample(int id, double ms)
+{
+    if (id < 0 || id >= size())
+        return;
+
+    Slot& s = slots[id];
+    s.lastMs.store(ms, std::memory_order_relaxed);
+    const double avg = s.avgMs.load(std::memory_order_relaxed);
+    s.avgMs.store(avg == 0.0 ? ms : avg + (ms - avg) * 0.05, std::memory_order_relaxed);
+    double prevMax = s.maxMs.load(std::memory_order_relaxed);
+    while (ms > prevMax && !s.maxMs.compare_exchange_weak(prevMax, ms, std::memory_order_relaxed))
+    {
+    }
+    s.value.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Profiler::setCounter(int id, int64_t v)
+{
+    if (id >= 0 && id < size())
+        slots[id].value.store(v, std::memory_order_relaxed);
+}
+
+void Profiler::addToCounter(int id, int64_t delta)
+{
+    if (id >= 0 && id < size())
+        slots[id].value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+void Profiler::resetMax()
+{
+    const int n = size();
+    for (int i = 0; i < n; ++i)
+        slots[i].maxMs.store(0.0, std::memory_order_relaxed);
+}
+
+Profiler::Entry Profiler::getEntry(int id) const
+{
+    const Slot& s = slots[id];
+    return Entry{ s.name.c_str(), s.kind, s.lastMs.load(std::memory_order_relaxed), s.avgMs.load(std::memory_order_relaxed),
+                  s.maxMs.load(std::memory_order_relaxed), s.value.load(std::memory_order_relaxed) };
+}
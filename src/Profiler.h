@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace Aftr
+{
+    /**
+       Lightweight in-process profiler shared by the module's subsystems and shown in the ImGui
+       "Profiler" panel. Stats are registered once by name and then updated through an integer
+       id with relaxed atomics, so sampling from the render thread or from worker threads never
+       locks or allocates.
+    */
+    class Profiler
+    {
+    public:
+        enum class Kind : uint8_t { TIMER, COUNTER };
+
+        struct Entry
+        {
+            const char* name;
+            Kind kind;
+            double lastMs;
+            double avgMs; // Exponential moving average
+            double maxMs; // Since the last resetMax()
+            int64_t value; // Counters only
+        };
+
+        static constexpr int MaxStats = 64;
+
+        static Profiler& get();
+
+        // Returns the existing id if the name was already registered, -1 if the table is full.
+        int registerTimer(const char* name) { return registerStat(name, Kind::TIMER); }
+        int registerCounter(const char* name) { return registerStat(name, Kind::COUNTER); }
+
+        void addSample(int id, double ms);
+        void setCounter(int id, int64_t value);
+        void addToCounter(int id, int64_t delta);
+        void resetMax();
+
+        int size() const { return count.load(std::memory_order_acquire); }
+        Entry getEntry(int id) const;
+
+    private:
+        struct Slot
+        {
+            std::string name;
+            Kind kind = Kind::TIMER;
+            std::atomic<double> lastMs{ 0.0 };
+            std::atomic<double> avgMs{ 0.0 };
+            std::atomic<double> maxMs{ 0.0 };
+            std::atomic<int64_t> value{ 0 };
+        };
+
+        int registerStat(const char* name, Kind kind);
+
+        Slot slots[MaxStats];
+        std::atomic<int> count{ 0 };
+        std::mutex registerMutex;
+    };
+
+    // Times its own lifetime into a profiler timer.
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(int id) : id(id), start(std::chrono::steady_clock::now()) {}
+        ~ProfileScope()
+        {
+            std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+            Profiler::get().addSample(id, ms.count());
+        }
+
+    private:
+        int id;
+        std::chrono::steady_clock::time_point start;
+    };
+}
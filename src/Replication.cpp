@@ -0,0 +1,789 @@
+#include "Replication.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <cstdio>
+
+using namespace Aftr;
+using namespace Aftr::NetFormat;
+
+namespace
+{
+    constexpr float TwoPi = 6.28318530717958f;
+    constexpr int AngleSteps = 1 << AngleBits;
+    constexpr int Widths[ComponentCount] = { PositionBits, PositionBits, PositionBits, VelocityBits, VelocityBits, VelocityBits,
+                                             AngleBits, AngleBits, AngleBits };
+    constexpr int FullBits = 3 * PositionBits + 3 * VelocityBits + 3 * AngleBits;
+    constexpr int DeltaClassBits[4] = { 4, 8, 12, 22 }; // Wide enough for any position delta
+    constexpr size_t ControlBytes = 7; // magic, type, tick
+    constexpr size_t ViewBytes = ControlBytes + 14 * 4; // focus, eye, look, up, fov, aspect
+    constexpr size_t InputHeaderBytes = ControlBytes + 1; // The tick field is the first input's seq; then the input count
+    constexpr size_t JetStateBytes = ControlBytes + 10 * 4; // The tick field is the input seq; position, velocity, angles, airspeed
+
+    bool isAngle(int component) { return component >= 6; }
+
+    int32_t quantize(float v, float step, int bits)
+    {
+        const int32_t limit = 1 << (bits - 1);
+        return static_cast<int32_t>(std::clamp(std::lround(v / step), static_cast<long>(-limit), static_cast<long>(limit - 1)));
+    }
+
+    int32_t quantizeAngle(float radians)
+    {
+        return static_cast<int32_t>(std::lround(radians * (AngleSteps / TwoPi))) & (AngleSteps - 1);
+    }
+
+    float angleOf(int32_t q)
+    {
+        const int32_t signedSteps = q >= AngleSteps / 2 ? q - AngleSteps : q;
+        return signedSteps * (TwoPi / AngleSteps);
+    }
+
+    // Angles take the short way round, so crossing +-pi is a small delta
+    int32_t componentDelta(int component, int32_t value, int32_t base)
+    {
+        const int32_t d = value - base;
+        return isAngle(component) ? ((d + AngleSteps / 2) & (AngleSteps - 1)) - AngleSteps / 2 : d;
+    }
+
+    int32_t applyDelta(int component, int32_t base, int32_t d)
+    {
+        return isAngle(component) ? (base + d) & (AngleSteps - 1) : base + d;
+    }
+
+    uint32_t zigzag(int32_t v) { return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31); }
+    int32_t unzigzag(uint32_t v) { return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1); }
+
+    // A zero delta is one bit; anything else is a flag, a 2-bit width class and the zigzagged value minus one
+    int deltaClass(uint32_t zz)
+    {
+        int k = 0;
+        while (k < 3 && (zz - 1) >> DeltaClassBits[k] != 0)
+            ++k;
+        return k;
+    }
+
+    int deltaBits(int32_t d) { return d == 0 ? 1 : 3 + DeltaClassBits[deltaClass(zigzag(d))]; }
+
+    class BitWriter
+    {
+    public:
+        BitWriter(uint8_t* out, size_t capacity) : out(out), capacityBits(capacity * 8) { std::fill(out, out + capacity, uint8_t(0)); }
+
+        void write(uint32_t value, int bits)
+        {
+            for (int i = 0; i < bits; ++i, ++position)
+                if ((value >> i) & 1u)
+                    out[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+        }
+        size_t remainingBits() const { return capacityBits - position; }
+        size_t bytes() const { return (position + 7) / 8; }
+
+    private:
+        uint8_t* out;
+        size_t capacityBits;
+        size_t position = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* in, size_t size) : in(in), sizeBits(size * 8) {}
+
+        uint32_t read(int bits)
+        {
+            if (position + bits > sizeBits)
+            {
+                overflow = true;
+                return 0;
+            }
+            uint32_t value = 0;
+            for (int i = 0; i < bits; ++i, ++position)
+                value |= static_cast<uint32_t>((in[position >> 3] >> (position & 7)) & 1u) << i;
+            return value;
+        }
+        bool hasOverflowed() const { return overflow; }
+
+    private:
+        const uint8_t* in;
+        size_t sizeBits;
+        size_t position = 0;
+        bool overflow = false;
+    };
+
+    void putHeader(uint8_t* p, PacketType type, uint32_t tick)
+    {
+        p[0] = static_cast<uint8_t>(Magic & 0xFF);
+        p[1] = static_cast<uint8_t>(Magic >> 8);
+        p[2] = static_cast<uint8_t>(type);
+        for (int i = 0; i < 4; ++i)
+            p[3 + i] = static_cast<uint8_t>(tick >> (8 * i));
+    }
+
+    void putFloats(uint8_t* p, const float* v, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            uint32_t bits;
+            memcpy(&bits, &v[i], 4);
+            for (int b = 0; b < 4; ++b)
+                p[4 * i + b] = static_cast<uint8_t>(bits >> (8 * b));
+        }
+    }
+
+    void getFloats(const uint8_t* p, float* v, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            uint32_t bits = 0;
+            for (int b = 0; b < 4; ++b)
+                bits |= static_cast<uint32_t>(p[4 * i + b]) << (8 * b);
+            memcpy(&v[i], &bits, 4);
+        }
+    }
+
+    bool getHeader(const uint8_t* p, size_t size, PacketType& type, uint32_t& tick)
+    {
+        if (size < 3 || (p[0] | (p[1] << 8)) != Magic)
+            return false;
+        type = static_cast<PacketType>(p[2]);
+        tick = 0;
+        if (size >= ControlBytes)
+            for (int i = 0; i < 4; ++i)
+                tick |= static_cast<uint32_t>(p[3 + i]) << (8 * i);
+        return true;
+    }
+}
+
+QuantizedAircraft QuantizedAircraft::from(const NetAircraft& a)
+{
+    QuantizedAircraft q;
+    for (int i = 0; i < 3; ++i)
+    {
+        q.c[i] = quantize(a.position[i], PositionStep, PositionBits);
+        q.c[3 + i] = quantize(a.velocity[i], VelocityStep, VelocityBits);
+    }
+    q.c[6] = quantizeAngle(a.heading);
+    q.c[7] = quantizeAngle(a.pitch);
+    q.c[8] = quantizeAngle(a.roll);
+    return q;
+}
+
+NetAircraft QuantizedAircraft::toAircraft(uint16_t id) const
+{
+    NetAircraft a;
+    a.id = id;
+    for (int i = 0; i < 3; ++i)
+    {
+        a.position[i] = c[i] * PositionStep;
+        a.velocity[i] = c[3 + i] * VelocityStep;
+    }
+    a.heading = angleOf(c[6]);
+    a.pitch = angleOf(c[7]);
+    a.roll = angleOf(c[8]);
+    return a;
+}
+
+bool QuantizedAircraft::operator==(const QuantizedAircraft& o) const
+{
+    return std::equal(std::begin(c), std::end(c), std::begin(o.c));
+}
+
+ReplicationServer::ReplicationServer(NetEndpoint& endpoint, const ReplicationParams& params)
+    : endpoint(endpoint), params(params), entryOf(MaxAircraftId + 1, -1), interest(params.interest)
+{
+}
+
+bool ReplicationServer::getClientJet(size_t i, FlightState& out) const
+{
+    if (!clients[i].jet.active)
+        return false;
+    out = clients[i].jet.state;
+    return true;
+}
+
+double ReplicationServer::getBytesPerClientPerSecond() const
+{
+    double sum = 0.0;
+    for (const Client& c : clients)
+        sum += c.stats.bytesPerSecond;
+    return clients.empty() ? 0.0 : sum / clients.size();
+}
+
+void ReplicationServer::update(float dt, const NetAircraft* aircraft, size_t count)
+{
+    time += dt;
+    receive();
+    clients.erase(std::remove_if(clients.begin(), clients.end(), [this](const Client& c)
+        {
+            if (time - c.lastHeard <= params.clientTimeoutSec)
+                return false;
+            printf("Replication: %s timed out\n", c.address.toString().c_str());
+            return true;
+        }), clients.end());
+    for (Client& c : clients)
+        c.stats.connectedSec += dt;
+
+    const float interval = 1.0f / params.snapshotHz;
+    accumulator += dt;
+    if (accumulator < interval)
+        return;
+    accumulator = std::min(accumulator - interval, interval); // A stall sends one snapshot, not a burst
+
+    ++tick;
+    for (const Entry& e : current)
+        entryOf[e.id] = -1;
+    current.clear();
+    positions.clear();
+    ids.clear();
+    auto publish = [this](const NetAircraft& a)
+    {
+        if (a.id > MaxAircraftId || entryOf[a.id] >= 0)
+            return;
+        entryOf[a.id] = static_cast<int>(current.size());
+        current.push_back(Entry{ a.id, QuantizedAircraft::from(a) });
+        positions.push_back(a.position);
+        ids.push_back(a.id);
+    };
+    for (const Client& c : clients)
+        if (c.jet.active && c.jet.slot >= 0)
+        {
+            NetAircraft a;
+            a.id = static_cast<uint16_t>(FirstClientJetId + c.jet.slot);
+            a.position = c.jet.state.position;
+            a.velocity = c.jet.state.velocity;
+            a.heading = c.jet.state.heading;
+            a.pitch = c.jet.state.pitch;
+            a.roll = c.jet.state.roll;
+            publish(a);
+        }
+    for (size_t i = 0; i < count; ++i)
+        publish(aircraft[i]);
+    interest.build(positions.data(), ids.data(), ids.size());
+
+    const double budgetPerTick = params.budgetBytesPerSec / static_cast<double>(params.snapshotHz);
+    for (Client& c : clients)
+    {
+        c.tokens = std::min(c.tokens + budgetPerTick, static_cast<double>(MaxPacketBytes + UdpOverheadBytes));
+        interest.prioritize(c.view, c.interest);
+        const uint64_t before = c.stats.bytes;
+        sendSnapshot(c);
+        if (c.jet.active)
+            sendJetState(c);
+        // One-second moving average, updated every tick
+        const double alpha = 1.0 / params.snapshotHz;
+        c.stats.bytesPerSecond += ((c.stats.bytes - before) * params.snapshotHz - c.stats.bytesPerSecond) * std::min(alpha, 1.0);
+    }
+}
+
+ReplicationServer::Client* ReplicationServer::find(const NetAddress& a)
+{
+    for (Client& c : clients)
+        if (c.address == a)
+            return &c;
+    return nullptr;
+}
+
+void ReplicationServer::receive()
+{
+    uint8_t buffer[MaxPacketBytes];
+    NetAddress from;
+    int n;
+    while ((n = endpoint.receive(from, buffer, sizeof(buffer))) >= 0)
+    {
+        PacketType type;
+        uint32_t ackedTick;
+        if (!getHeader(buffer, static_cast<size_t>(n), type, ackedTick))
+            continue;
+
+        Client* c = find(from);
+        if (type == PacketType::HELLO)
+        {
+            if (c == nullptr)
+            {
+                std::array<bool, MaxClientJets> taken{};
+                for (const Client& other : clients)
+                    if (other.jet.slot >= 0)
+                        taken[other.jet.slot] = true;
+                clients.emplace_back();
+                c = &clients.back();
+                c->address = from;
+                c->stats.address = from;
+                c->jet.slot = static_cast<int>(std::find(taken.begin(), taken.end(), false) - taken.begin());
+                if (c->jet.slot == MaxClientJets)
+                    c->jet.slot = -1;
+                printf("Replication: %s joined\n", from.toString().c_str());
+            }
+            c->baselines.clear(); // A client that restarted has none of them any more
+        }
+        else if (c != nullptr && type == PacketType::ACK && static_cast<size_t>(n) >= ControlBytes)
+            onAck(*c, ackedTick);
+        else if (c != nullptr && type == PacketType::VIEW && static_cast<size_t>(n) >= ViewBytes)
+        {
+            float v[14];
+            getFloats(buffer + ControlBytes, v, 14);
+            c->view.focus = Vector(v[0], v[1], v[2]);
+            c->view.eye = Vector(v[3], v[4], v[5]);
+            c->view.look = Vector(v[6], v[7], v[8]);
+            c->view.up = Vector(v[9], v[10], v[11]);
+            c->view.verticalFov = v[12];
+            c->view.aspect = v[13];
+            c->view.valid = std::all_of(v, v + 14, [](float f) { return std::isfinite(f); });
+        }
+        else if (c != nullptr && type == PacketType::INPUT && jetModel != nullptr)
+            onInput(*c, buffer, static_cast<size_t>(n));
+        else if (c != nullptr && type == PacketType::BYE)
+        {
+            printf("Replication: %s left\n", from.toString().c_str());
+            clients.erase(clients.begin() + (c - clients.data()));
+            continue;
+        }
+        if (c != nullptr)
+            c->lastHeard = time;
+    }
+}
+
+void ReplicationServer::onAck(Client& c, uint32_t ackedTick)
+{
+    const Sent& s = c.sent[ackedTick % BaselineWindow];
+    if (s.tick != ackedTick || tick - ackedTick >= BaselineWindow)
+        return;
+    for (const Entry& e : s.entries)
+    {
+        if (e.id >= c.baselines.size())
+            c.baselines.resize(e.id + 1);
+        Baseline& b = c.baselines[e.id];
+        if (!b.valid || static_cast<int32_t>(ackedTick - b.tick) > 0) // Acks can arrive out of order
+            b = Baseline{ ackedTick, true, e.q };
+    }
+}
+
+void ReplicationServer::onInput(Client& c, const uint8_t* data, size_t size)
+{
+    if (size < InputHeaderBytes)
+        return;
+    ClientJet& jet = c.jet;
+    PacketType type;
+    uint32_t first;
+    getHeader(data, size, type, first);
+    const uint8_t* p = data + InputHeaderBytes;
+    size_t left = size - InputHeaderBytes;
+    for (uint8_t i = 0; i < data[ControlBytes]; ++i)
+    {
+        JetInput in;
+        const size_t used = JetInput::unpack(p, left, first + i, in);
+        if (used == 0)
+            break;
+        p += used;
+        left -= used;
+        if (static_cast<int32_t>(in.seq - jet.seq) <= 0)
+            continue; // Stepped already
+        if (in.seq - jet.seq > jet.pending.size())
+        {
+            // Too far ahead to buffer: what came between is gone for good (or, on a first input, never mattered)
+            if (jet.active)
+                c.stats.inputsLost += in.seq - jet.seq - 1;
+            jet.seq = in.seq - 1;
+        }
+        jet.pending[in.seq % jet.pending.size()] = in;
+        if (static_cast<int32_t>(in.seq - jet.newestSeq) > 0)
+            jet.newestSeq = in.seq;
+    }
+
+    // Inputs are stepped in order as they arrive. One missing while RedundantInputs newer ones have
+    // arrived was in every packet that could have carried it, so the one before it stands in.
+    while (static_cast<int32_t>(jet.newestSeq - jet.seq) > 0)
+    {
+        const uint32_t next = jet.seq + 1;
+        JetInput in = jet.pending[next % jet.pending.size()];
+        if (in.seq != next)
+        {
+            if (jet.newestSeq - next < static_cast<uint32_t>(RedundantInputs))
+                break; // It may still come
+            in = jet.last;
+            in.seq = next;
+            in.respawn = false;
+            ++c.stats.inputsLost;
+        }
+        stepJet(*jetModel, jet.state, in);
+        jet.last = in;
+        jet.seq = next;
+        jet.active = true;
+    }
+    c.stats.inputSeq = jet.seq;
+}
+
+void ReplicationServer::sendJetState(Client& c)
+{
+    uint8_t packet[JetStateBytes];
+    putHeader(packet, PacketType::JET_STATE, c.jet.seq);
+    const FlightState& s = c.jet.state;
+    const float v[10] = { s.position.x, s.position.y, s.position.z, s.velocity.x, s.velocity.y, s.velocity.z,
+                          s.heading, s.pitch, s.roll, s.airspeed };
+    putFloats(packet + ControlBytes, v, 10);
+    endpoint.send(c.address, packet, sizeof(packet));
+    ++c.stats.packets;
+    c.stats.bytes += sizeof(packet) + UdpOverheadBytes;
+    c.tokens -= static_cast<double>(sizeof(packet) + UdpOverheadBytes);
+}
+
+void ReplicationServer::sendSnapshot(Client& c)
+{
+    uint8_t packet[MaxPacketBytes];
+    putHeader(packet, PacketType::SNAPSHOT, tick);
+    Sent& record = c.sent[tick % BaselineWindow];
+    record.tick = tick;
+    record.entries.clear();
+
+    // The budget decides how much of the priority order fits; the header always goes, as a keepalive
+    const size_t payload = static_cast<size_t>(std::clamp(c.tokens - UdpOverheadBytes, static_cast<double>(SnapshotHeaderBytes),
+                                                          static_cast<double>(MaxPacketBytes)));
+    BitWriter w(packet + SnapshotHeaderBytes, payload - SnapshotHeaderBytes);
+    uint16_t written = 0;
+    const int ownJet = c.jet.slot >= 0 ? FirstClientJetId + c.jet.slot : -1;
+    for (uint16_t id : c.interest.order)
+    {
+        if (id == ownJet)
+        {
+            c.interest.accumulator[id] = 0.0f; // The client has it from sendJetState(), exactly
+            continue;
+        }
+        const Entry& e = current[entryOf[id]];
+        const Baseline* base = nullptr;
+        if (e.id < c.baselines.size() && c.baselines[e.id].valid && tick - c.baselines[e.id].tick < BaselineWindow)
+            base = &c.baselines[e.id];
+
+        int32_t deltas[ComponentCount] = {};
+        int cost = IdBits + 1 + FullBits;
+        if (base != nullptr)
+        {
+            int deltaCost = IdBits + 1 + BaselineAgeBits;
+            for (int i = 0; i < ComponentCount; ++i)
+            {
+                deltas[i] = componentDelta(i, e.q.c[i], base->q.c[i]);
+                deltaCost += deltaBits(deltas[i]);
+            }
+            if (deltaCost < cost)
+                cost = deltaCost;
+            else
+                base = nullptr;
+        }
+        if (w.remainingBits() < static_cast<size_t>(cost))
+            break; // The rest keep their accumulated priority and lead the next snapshot
+
+        w.write(e.id, IdBits);
+        w.write(base != nullptr ? 1 : 0, 1);
+        if (base != nullptr)
+        {
+            w.write(tick - base->tick, BaselineAgeBits);
+            for (int i = 0; i < ComponentCount; ++i)
+            {
+                if (deltas[i] == 0)
+                {
+                    w.write(0, 1);
+                    continue;
+                }
+                const uint32_t zz = zigzag(deltas[i]);
+                const int k2 = deltaClass(zz);
+                w.write(1, 1);
+                w.write(static_cast<uint32_t>(k2), 2);
+                w.write(zz - 1, DeltaClassBits[k2]);
+            }
+        }
+        else
+        {
+            for (int i = 0; i < ComponentCount; ++i)
+                w.write(static_cast<uint32_t>(isAngle(i) ? e.q.c[i] : e.q.c[i] + (1 << (Widths[i] - 1))), Widths[i]);
+            ++c.stats.fullStates;
+        }
+        record.entries.push_back(e);
+        c.interest.accumulator[e.id] = 0.0f;
+        ++written;
+    }
+
+    packet[7] = static_cast<uint8_t>(written & 0xFF);
+    packet[8] = static_cast<uint8_t>(written >> 8);
+    const size_t size = SnapshotHeaderBytes + w.bytes();
+    endpoint.send(c.address, packet, size);
+    ++c.stats.packets;
+    c.stats.bytes += size + UdpOverheadBytes;
+    c.stats.aircraftSent += written;
+    c.stats.relevant = static_cast<int>(c.interest.order.size());
+    c.stats.sent = written;
+    c.tokens -= static_cast<double>(size + UdpOverheadBytes);
+}
+
+const ReplicationClient::Sample* ReplicationClient::Track::find(uint32_t t) const
+{
+    for (int i = count - 1; i >= 0; --i)
+        if (samples[i].tick == t)
+            return &samples[i];
+    return nullptr;
+}
+
+void ReplicationClient::Track::insert(uint32_t t, const QuantizedAircraft& q)
+{
+    int at = count;
+    while (at > 0 && static_cast<int32_t>(samples[at - 1].tick - t) > 0)
+        --at;
+    if (at > 0 && samples[at - 1].tick == t)
+        return; // Duplicate
+    if (count == HistorySize)
+    {
+        if (at == 0)
+            return; // Older than everything kept
+        std::move(samples.begin() + 1, samples.begin() + at, samples.begin()); // Drop the oldest
+        --at;
+        --count;
+    }
+    std::move_backward(samples.begin() + at, samples.begin() + count, samples.begin() + count + 1);
+    samples[at] = Sample{ t, q };
+    ++count;
+}
+
+ReplicationClient::ReplicationClient(NetEndpoint& endpoint, const NetAddress& server, const ReplicationParams& params)
+    : endpoint(endpoint), server(server), params(params), trackOf(MaxAircraftId + 1, -1)
+{
+}
+
+ReplicationClient::~ReplicationClient()
+{
+    sendControl(PacketType::BYE);
+}
+
+void ReplicationClient::sendControl(PacketType type, uint32_t t)
+{
+    uint8_t packet[ControlBytes];
+    putHeader(packet, type, t);
+    endpoint.send(server, packet, sizeof(packet));
+}
+
+void ReplicationClient::sendInput(const JetInput& input)
+{
+    inputs[input.seq % inputs.size()] = input;
+    newestInput = input.seq;
+    inputsQueued = true;
+}
+
+bool ReplicationClient::takeJetState(uint32_t& seq, FlightState& out)
+{
+    if (!jetStateFresh)
+        return false;
+    jetStateFresh = false;
+    seq = jetStateSeq;
+    out = jetState;
+    return true;
+}
+
+void ReplicationClient::update(float dt)
+{
+    time += dt;
+    receive();
+    if (!isConnected() && time - lastHelloTime >= params.helloIntervalSec)
+    {
+        sendControl(PacketType::HELLO);
+        lastHelloTime = time;
+    }
+    if (view.valid && time - lastViewTime >= 1.0 / params.viewHz)
+    {
+        uint8_t packet[ViewBytes];
+        putHeader(packet, PacketType::VIEW, 0);
+        const float v[14] = { view.focus.x, view.focus.y, view.focus.z, view.eye.x, view.eye.y, view.eye.z, view.look.x, view.look.y,
+                              view.look.z, view.up.x, view.up.y, view.up.z, view.verticalFov, view.aspect };
+        putFloats(packet + ControlBytes, v, 14);
+        endpoint.send(server, packet, sizeof(packet));
+        lastViewTime = time;
+    }
+    if (inputsQueued)
+    {
+        // The newest inputs, oldest first, as far back as they run unbroken
+        uint32_t first = newestInput;
+        while (newestInput - first + 1 < inputs.size() && inputs[(first - 1) % inputs.size()].seq == first - 1 && first > 1)
+            --first;
+        uint8_t packet[InputHeaderBytes + RedundantInputs * JetInput::MaxPackedBytes];
+        putHeader(packet, PacketType::INPUT, first);
+        packet[ControlBytes] = static_cast<uint8_t>(newestInput - first + 1);
+        size_t size = InputHeaderBytes;
+        for (uint32_t seq = first; seq != newestInput + 1; ++seq)
+            size += inputs[seq % inputs.size()].pack(packet + size);
+        endpoint.send(server, packet, size);
+        inputsQueued = false;
+    }
+
+    for (size_t i = 0; i < tracks.size();)
+    {
+        if (time - tracks[i].lastHeard <= params.trackTimeoutSec)
+        {
+            ++i;
+            continue;
+        }
+        trackOf[tracks[i].id] = -1;
+        tracks[i] = tracks.back();
+        trackOf[tracks[i].id] = static_cast<int>(i);
+        tracks.pop_back();
+    }
+    if (!hasSnapshot)
+        return;
+
+    // Where the server's clock should be now, less the interpolation delay. Small errors are slewed
+    // out over a few frames; a big one (first snapshot, long stall) is a jump.
+    const double target = newestTick / static_cast<double>(params.snapshotHz) + (time - lastSnapshotTime) - params.interpolationDelaySec;
+    renderTime += dt;
+    const double error = target - renderTime;
+    if (std::fabs(error) > 0.25)
+        renderTime = target;
+    else
+        renderTime += error * std::min(1.0, dt * 4.0);
+
+    aircraft.clear();
+    stats.extrapolated = 0;
+    for (const Track& t : tracks)
+    {
+        bool extrapolated = false;
+        aircraft.push_back(sample(t, extrapolated));
+        stats.extrapolated += extrapolated ? 1 : 0;
+    }
+}
+
+void ReplicationClient::receive()
+{
+    uint8_t buffer[MaxPacketBytes];
+    NetAddress from;
+    int n;
+    while ((n = endpoint.receive(from, buffer, sizeof(buffer))) >= 0)
+    {
+        PacketType type;
+        uint32_t t;
+        if (from != server || !getHeader(buffer, static_cast<size_t>(n), type, t))
+            continue;
+        if (type == PacketType::JET_STATE && static_cast<size_t>(n) >= JetStateBytes)
+        {
+            ++stats.packets;
+            stats.bytes += n + UdpOverheadBytes;
+            if (hasJetState && static_cast<int32_t>(t - jetStateSeq) <= 0)
+                continue; // Arrived out of order
+            float v[10];
+            getFloats(buffer + ControlBytes, v, 10);
+            jetState.position = Vector(v[0], v[1], v[2]);
+            jetState.velocity = Vector(v[3], v[4], v[5]);
+            jetState.heading = v[6];
+            jetState.pitch = v[7];
+            jetState.roll = v[8];
+            jetState.airspeed = v[9];
+            jetStateSeq = t;
+            hasJetState = true;
+            jetStateFresh = true;
+            continue;
+        }
+        if (type != PacketType::SNAPSHOT || static_cast<size_t>(n) < SnapshotHeaderBytes)
+            continue;
+        ++stats.packets;
+        stats.bytes += n + UdpOverheadBytes;
+        // Only a snapshot decoded in full is acked: the server must never pick a baseline the client lacks
+        if (onSnapshot(buffer, static_cast<size_t>(n)))
+            sendControl(PacketType::ACK, t);
+    }
+}
+
+bool ReplicationClient::onSnapshot(const uint8_t* data, size_t size)
+{
+    PacketType type;
+    uint32_t t;
+    getHeader(data, size, type, t);
+    const uint16_t count = static_cast<uint16_t>(data[7] | (data[8] << 8));
+
+    if (!hasSnapshot || static_cast<int32_t>(t - newestTick) > 0)
+    {
+        if (hasSnapshot)
+            stats.lost += t - newestTick - 1;
+        else
+            renderTime = t / static_cast<double>(params.snapshotHz) - params.interpolationDelaySec;
+        hasSnapshot = true;
+        newestTick = t;
+        lastSnapshotTime = time;
+    }
+
+    BitReader r(data + SnapshotHeaderBytes, size - SnapshotHeaderBytes);
+    bool complete = true;
+    for (uint16_t a = 0; a < count; ++a)
+    {
+        const uint16_t id = static_cast<uint16_t>(r.read(IdBits));
+        QuantizedAircraft q;
+        bool decodable = true;
+        if (r.read(1) != 0)
+        {
+            const uint32_t age = r.read(BaselineAgeBits);
+            const int index = trackOf[id];
+            const Sample* base = index >= 0 ? tracks[index].find(t - age) : nullptr;
+            decodable = base != nullptr;
+            for (int i = 0; i < ComponentCount; ++i)
+            {
+                int32_t d = 0;
+                if (r.read(1) != 0)
+                {
+                    const int k = static_cast<int>(r.read(2));
+                    d = unzigzag(r.read(DeltaClassBits[k]) + 1);
+                }
+                q.c[i] = decodable ? applyDelta(i, base->q.c[i], d) : 0;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < ComponentCount; ++i)
+            {
+                const int32_t raw = static_cast<int32_t>(r.read(Widths[i]));
+                q.c[i] = isAngle(i) ? raw : raw - (1 << (Widths[i] - 1));
+            }
+        }
+        if (r.hasOverflowed())
+            return false;
+        if (!decodable)
+        {
+            ++stats.undecodable;
+            complete = false;
+            continue;
+        }
+
+        if (trackOf[id] < 0)
+        {
+            trackOf[id] = static_cast<int>(tracks.size());
+            tracks.emplace_back();
+            tracks.back().id = id;
+        }
+        Track& track = tracks[trackOf[id]];
+        track.insert(t, q);
+        track.lastHeard = time;
+    }
+    return complete;
+}
+
+NetAircraft ReplicationClient::sample(const Track& t, bool& extrapolated) const
+{
+    const double hz = params.snapshotHz;
+    int next = 0;
+    while (next < t.count && t.samples[next].tick / hz <= renderTime)
+        ++next;
+
+    if (next == 0)
+        return t.samples[0].q.toAircraft(t.id);
+    const Sample& a = t.samples[next - 1];
+    NetAircraft out = a.q.toAircraft(t.id);
+    if (next == t.count)
+    {
+        // Past the newest snapshot: carry on along its velocity, for a while
+        const float ahead = static_cast<float>(std::min(renderTime - a.tick / hz, static_cast<double>(params.maxExtrapolationSec)));
+        out.position += out.velocity * ahead;
+        extrapolated = ahead > 0.0f;
+        return out;
+    }
+
+    const Sample& b = t.samples[next];
+    const NetAircraft to = b.q.toAircraft(t.id);
+    const float alpha = static_cast<float>((renderTime - a.tick / hz) / ((b.tick - a.tick) / hz));
+    out.position += (to.position - out.position) * alpha;
+    out.velocity += (to.velocity - out.velocity) * alpha;
+    out.heading = wrapRadians(out.heading + wrapRadians(to.heading - out.heading) * alpha);
+    out.pitch = wrapRadians(out.pitch + wrapRadians(to.pitch - out.pitch) * alpha);
+    out.roll = wrapRadians(out.roll + wrapRadians(to.roll - out.roll) * alpha);
+    return out;
+}
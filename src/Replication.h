@@ -0,0 +1,268 @@
+#pragma once
+
+#include "InterestManager.h"
+#include "JetPredictor.h"
+#include "NetTransport.h"
+#include "Vector.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Aftr
+{
+    // One replicated aircraft. Angles are radians, as in FlightState.
+    struct NetAircraft
+    {
+        uint16_t id = 0;
+        Vector position{ 0, 0, 0 };
+        Vector velocity{ 0, 0, 0 }; // World units/sec; what the client dead-reckons with
+        float heading = 0.0f;
+        float pitch = 0.0f;
+        float roll = 0.0f;
+    };
+
+    // Wire format shared by ReplicationServer and ReplicationClient. Multi-byte header fields are little-endian.
+    namespace NetFormat
+    {
+        constexpr uint16_t Magic = 0xAF52;
+        enum class PacketType : uint8_t { HELLO = 1, SNAPSHOT, ACK, BYE, VIEW, INPUT, JET_STATE };
+
+        constexpr size_t MaxPacketBytes = 1200;  // Stays under a 1280-byte path MTU with IP and UDP headers
+        constexpr size_t UdpOverheadBytes = 28;  // IPv4 + UDP headers, counted in every bandwidth figure
+        constexpr size_t SnapshotHeaderBytes = 9; // magic, type, tick (4), aircraft count (2)
+
+        constexpr int IdBits = 12;
+        constexpr uint16_t MaxAircraftId = (1 << IdBits) - 1;
+        constexpr int BaselineAgeBits = 5;
+        constexpr uint32_t BaselineWindow = 1 << BaselineAgeBits; // Ticks a delta can reach back; also the client's history
+
+        // Position, velocity and the three angles, in that order
+        constexpr int ComponentCount = 9;
+        constexpr float PositionStep = 1.0f / 64.0f; // World units
+        constexpr float VelocityStep = 1.0f / 64.0f; // World units/sec
+        constexpr int PositionBits = 20;             // +-8192 world units
+        constexpr int VelocityBits = 14;             // +-128 world units/sec
+        constexpr int AngleBits = 12;                // 0.09 degrees
+
+        constexpr int BudgetAircraft = 64;
+        constexpr int BudgetBytesPerSec = 16000;     // Per client at BudgetAircraft aircraft, headers included
+
+        constexpr int RedundantInputs = 8;           // Each INPUT packet repeats this many of the newest jet inputs
+        constexpr int MaxClientJets = 64;
+        constexpr uint16_t FirstClientJetId = MaxAircraftId + 1 - MaxClientJets; // Clients' jets, as other clients see them
+    }
+
+    // NetAircraft on the quantization grid. Deltas between two of these are what travels.
+    struct QuantizedAircraft
+    {
+        int32_t c[NetFormat::ComponentCount] = {};
+
+        static QuantizedAircraft from(const NetAircraft& a);
+        NetAircraft toAircraft(uint16_t id) const;
+        bool operator==(const QuantizedAircraft& o) const;
+    };
+
+    struct ReplicationParams
+    {
+        float snapshotHz = 20.0f;
+        float clientTimeoutSec = 5.0f;         // Server forgets a client it has not heard from for this long
+        float interpolationDelaySec = 0.1f;    // Client renders this far behind the newest snapshot
+        float maxExtrapolationSec = 1.0f;      // Dead reckoning past an aircraft's newest state stops here
+        float trackTimeoutSec = 2.0f;          // Client drops an aircraft missing from snapshots this long
+        float helloIntervalSec = 0.5f;
+        float viewHz = 10.0f;                  // How often a client reports its NetView
+        int budgetBytesPerSec = NetFormat::BudgetBytesPerSec; // Per client, headers included
+        InterestParams interest;
+    };
+
+    /**
+       Sends quantized aircraft snapshots to every client that has said HELLO, at snapshotHz.
+       Each aircraft is delta-encoded against the newest state of it the client has acked,
+       component by component in a variable-width bit code, so a steady aircraft costs a few
+       bytes and a parked one a few bits. An aircraft with no usable baseline (new, or its
+       baseline older than BaselineWindow ticks) is sent whole.
+
+       Which aircraft a client gets is up to the InterestManager: only those near the client's
+       jet or in its camera frustum, most urgent first. Each snapshot is filled in that order up
+       to the client's byte budget (a token bucket at budgetBytesPerSec, never over
+       MaxPacketBytes), so a client's bandwidth is flat however many aircraft share the sky.
+    */
+    class ReplicationServer
+    {
+    public:
+        struct ClientStats
+        {
+            NetAddress address;
+            uint64_t packets = 0;
+            uint64_t bytes = 0;       // Including UdpOverheadBytes per packet
+            uint64_t aircraftSent = 0;
+            uint64_t fullStates = 0;  // Aircraft sent without a baseline
+            double connectedSec = 0.0;
+            double bytesPerSecond = 0.0; // Over roughly the last second
+            int relevant = 0;            // Aircraft the interest manager picked for the last snapshot
+            int sent = 0;                // Of those, how many fit in it
+            uint32_t inputSeq = 0;       // Newest jet input stepped
+            uint64_t inputsLost = 0;     // Jet inputs that never arrived and were stood in for by the one before
+        };
+
+        explicit ReplicationServer(NetEndpoint& endpoint, const ReplicationParams& params = ReplicationParams{});
+
+        // Reads client packets, then sends a snapshot of aircraft to every client when one is due.
+        void update(float dt, const NetAircraft* aircraft, size_t count);
+
+        // Flies a jet for every client from the JetInputs it sends, with model, and sends each client
+        // its jet's state after every snapshot. Other clients see it as aircraft FirstClientJetId + slot.
+        void enableClientJets(const FlightModel& model) { jetModel = &model; }
+        bool getClientJet(size_t i, FlightState& out) const; // False until that client's first input
+
+        size_t getClientCount() const { return clients.size(); }
+        const ClientStats& getClientStats(size_t i) const { return clients[i].stats; }
+        double getBytesPerClientPerSecond() const; // Mean of the clients' bytesPerSecond
+        uint32_t getTick() const { return tick; }
+
+    private:
+        struct Baseline
+        {
+            uint32_t tick = 0;
+            bool valid = false;
+            QuantizedAircraft q;
+        };
+        struct Entry
+        {
+            uint16_t id;
+            QuantizedAircraft q;
+        };
+        struct Sent
+        {
+            uint32_t tick = 0;
+            std::vector<Entry> entries; // What the snapshot carried, for promoting to baselines on ack
+        };
+        struct ClientJet
+        {
+            int slot = -1;            // Of MaxClientJets, or -1 if there was none free
+            bool active = false;      // Has stepped an input
+            FlightState state;
+            uint32_t seq = 0;         // Newest input stepped
+            uint32_t newestSeq = 0;   // Newest input received
+            JetInput last;
+            std::array<JetInput, 2 * NetFormat::RedundantInputs> pending; // Received ahead of seq, by seq
+        };
+        struct Client
+        {
+            NetAddress address;
+            double lastHeard = 0.0;
+            std::vector<Baseline> baselines; // Indexed by aircraft id
+            std::array<Sent, NetFormat::BaselineWindow> sent;
+            NetView view;
+            InterestManager::State interest;
+            double tokens = static_cast<double>(NetFormat::MaxPacketBytes); // Bytes the budget allows right now
+            ClientJet jet;
+            ClientStats stats;
+        };
+
+        void receive();
+        void onAck(Client& c, uint32_t ackedTick);
+        void onInput(Client& c, const uint8_t* data, size_t size);
+        void sendSnapshot(Client& c);
+        void sendJetState(Client& c);
+        Client* find(const NetAddress& a);
+
+        NetEndpoint& endpoint;
+        ReplicationParams params;
+        double time = 0.0;
+        float accumulator = 0.0f;
+        uint32_t tick = 0;
+        std::vector<Entry> current; // This tick's aircraft, quantized once for every client
+        std::vector<int> entryOf;   // Aircraft id -> index into current, or -1
+        std::vector<Vector> positions;
+        std::vector<uint16_t> ids;
+        InterestManager interest;
+        std::vector<Client> clients;
+        const FlightModel* jetModel = nullptr;
+    };
+
+    /**
+       Receives snapshots, acks them, and presents the server's aircraft interpolationDelaySec in
+       the past so there are normally two snapshots to interpolate between. When loss or a late
+       packet leaves none newer than the render time, an aircraft is dead-reckoned along its last
+       velocity for up to maxExtrapolationSec. The render clock follows the snapshot ticks and
+       slews gently toward them rather than jumping with every packet's arrival jitter.
+
+       A client flying its own jet against the server hands it each tick's JetInput; they go out
+       on every update, each packet repeating the last RedundantInputs of them so a lost packet
+       costs nothing. The server's state of that jet comes back through takeJetState().
+    */
+    class ReplicationClient
+    {
+    public:
+        struct Stats
+        {
+            uint64_t packets = 0;
+            uint64_t bytes = 0;       // Including UdpOverheadBytes per packet
+            uint64_t lost = 0;        // Snapshot ticks that never arrived (or have not yet)
+            uint64_t undecodable = 0; // Aircraft whose baseline was no longer in the history
+            int extrapolated = 0;     // Aircraft being dead-reckoned at the current render time
+        };
+
+        ReplicationClient(NetEndpoint& endpoint, const NetAddress& server, const ReplicationParams& params = ReplicationParams{});
+        ~ReplicationClient(); // Tells the server it is leaving
+
+        // Reads snapshots, sends acks (and HELLO until connected, and the view), then resamples every aircraft.
+        void update(float dt);
+        void setView(const NetView& v) { view = v; view.valid = true; }
+        void sendInput(const JetInput& input); // Queued for the next update(); seq must ascend by one
+        bool takeJetState(uint32_t& seq, FlightState& out); // The newest not yet taken, if any
+
+        bool isConnected() const { return hasSnapshot && time - lastSnapshotTime < params.clientTimeoutSec; }
+        const std::vector<NetAircraft>& getAircraft() const { return aircraft; } // At the render time, in no particular order
+        const Stats& getStats() const { return stats; }
+        double getRenderTime() const { return renderTime; } // Server seconds (tick / snapshotHz)
+
+    private:
+        static constexpr int HistorySize = NetFormat::BaselineWindow;
+
+        struct Sample
+        {
+            uint32_t tick;
+            QuantizedAircraft q;
+        };
+        struct Track
+        {
+            uint16_t id = 0;
+            double lastHeard = 0.0;
+            std::array<Sample, HistorySize> samples; // Ascending tick
+            int count = 0;
+
+            const Sample* find(uint32_t tick) const;
+            void insert(uint32_t tick, const QuantizedAircraft& q);
+        };
+
+        void receive();
+        bool onSnapshot(const uint8_t* data, size_t size); // False if any aircraft could not be decoded
+        void sendControl(NetFormat::PacketType type, uint32_t tick = 0);
+        NetAircraft sample(const Track& t, bool& extrapolated) const;
+
+        NetEndpoint& endpoint;
+        NetAddress server;
+        ReplicationParams params;
+        double time = 0.0;
+        double lastHelloTime = -1.0e9;
+        double lastViewTime = -1.0e9;
+        NetView view;
+        double lastSnapshotTime = 0.0;
+        bool hasSnapshot = false;
+        uint32_t newestTick = 0;
+        double renderTime = 0.0;
+        std::array<JetInput, NetFormat::RedundantInputs> inputs; // The newest, by seq
+        uint32_t newestInput = 0;
+        bool inputsQueued = false;
+        bool hasJetState = false;
+        bool jetStateFresh = false;             // Not yet taken
+        uint32_t jetStateSeq = 0;
+        FlightState jetState;
+        std::vector<Track> tracks;
+        std::vector<int> trackOf; // Aircraft id -> index into tracks, or -1
+        std::vector<NetAircraft> aircraft;
+        Stats stats;
+    };
+}
@@ -0,0 +1,356 @@
+#include "RoutePlanner.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace Aftr;
+
+namespace
+{
+    constexpr float Inf = std::numeric_limits<float>::infinity();
+
+    struct Dir
+    {
+        int dx, dy, dz;
+        float length;
+    };
+
+    struct DirTable
+    {
+        Dir dirs[26];
+        DirTable()
+        {
+            int n = 0;
+            for (int dz = -1; dz <= 1; ++dz)
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx)
+                        if (dx || dy || dz)
+                            dirs[n++] = { dx, dy, dz, std::sqrt(static_cast<float>(dx * dx + dy * dy + dz * dz)) };
+        }
+    };
+    const DirTable dirTable;
+}
+
+void OccupancyGrid::init(const Vector& o, int x, int y, int z, float size)
+{
+    origin = o;
+    nx = std::max(x, 1);
+    ny = std::max(y, 1);
+    nz = std::max(z, 1);
+    cellSize = size;
+    occupancy.assign(static_cast<size_t>(nx) * ny * nz, 0);
+}
+
+void OccupancyGrid::forEachCell(const Vector& lo, const Vector& hi, int delta, std::vector<int>& changed)
+{
+    auto toIndex = [this](float v, float o, int n) { return std::clamp(static_cast<int>(std::floor((v - o) / cellSize)), 0, n - 1); };
+    const int x0 = toIndex(lo.x, origin.x, nx), x1 = toIndex(hi.x, origin.x, nx);
+    const int y0 = toIndex(lo.y, origin.y, ny), y1 = toIndex(hi.y, origin.y, ny);
+    const int z0 = toIndex(lo.z, origin.z, nz), z1 = toIndex(hi.z, origin.z, nz);
+
+    for (int z = z0; z <= z1; ++z)
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+            {
+                const int c = x + nx * (y + ny * z);
+                const bool was = occupancy[c] != 0;
+                if (delta > 0)
+                    ++occupancy[c];
+                else if (occupancy[c] > 0)
+                    --occupancy[c];
+                if (was != (occupancy[c] != 0))
+                    changed.push_back(c);
+            }
+}
+
+void OccupancyGrid::addBox(const Vector& lo, const Vector& hi, std::vector<int>& changed)
+{
+    forEachCell(lo, hi, 1, changed);
+}
+
+void OccupancyGrid::removeBox(const Vector& lo, const Vector& hi, std::vector<int>& changed)
+{
+    forEachCell(lo, hi, -1, changed);
+}
+
+int OccupancyGrid::cellOf(const Vector& p) const
+{
+    const int x = static_cast<int>(std::floor((p.x - origin.x) / cellSize));
+    const int y = static_cast<int>(std::floor((p.y - origin.y) / cellSize));
+    const int z = static_cast<int>(std::floor((p.z - origin.z) / cellSize));
+    if (x < 0 || y < 0 || z < 0 || x >= nx || y >= ny || z >= nz)
+        return -1;
+    return x + nx * (y + ny * z);
+}
+
+Vector OccupancyGrid::centerOf(int cell) const
+{
+    const int x = cell % nx, y = (cell / nx) % ny, z = cell / (nx * ny);
+    return origin + Vector((x + 0.5f) * cellSize, (y + 0.5f) * cellSize, (z + 0.5f) * cellSize);
+}
+
+bool OccupancyGrid::isBlockedAt(const Vector& p) const
+{
+    const int c = cellOf(p);
+    return c < 0 || isBlocked(c);
+}
+
+bool OccupancyGrid::lineOfSight(const Vector& a, const Vector& b) const
+{
+    const Vector d = b - a;
+    const int steps = std::max(1, static_cast<int>(std::ceil(d.length() / (cellSize * 0.25f))));
+    for (int i = 0; i <= steps; ++i)
+        if (isBlockedAt(a + d * (static_cast<float>(i) / steps)))
+            return false;
+    return true;
+}
+
+void RoutePlanner::init(const Vector& origin, int nx, int ny, int nz, float cellSize, float obstacleClearance)
+{
+    grid.init(origin, nx, ny, nz, cellSize);
+    clearance = obstacleClearance;
+    obstacles.clear();
+    const size_t n = static_cast<size_t>(grid.cellCount());
+    g.assign(n, Inf);
+    rhs.assign(n, Inf);
+    queuedKey.assign(n, Key{ Inf, Inf });
+    queued.assign(n, 0);
+    heap.clear();
+    startCell = goalCell = lastStartCell = -1;
+}
+
+int RoutePlanner::addObstacle(const Vector& lo, const Vector& hi)
+{
+    const Vector pad(clearance, clearance, clearance);
+    const int id = nextObstacleId++;
+    obstacles[id] = { lo - pad, hi + pad };
+
+    changedScratch.clear();
+    grid.addBox(lo - pad, hi + pad, changedScratch);
+    onCellsChanged(changedScratch);
+    return id;
+}
+
+void RoutePlanner::removeObstacle(int id)
+{
+    auto it = obstacles.find(id);
+    if (it == obstacles.end())
+        return;
+
+    changedScratch.clear();
+    grid.removeBox(it->second.first, it->second.second, changedScratch);
+    obstacles.erase(it);
+    onCellsChanged(changedScratch);
+}
+
+bool RoutePlanner::plan(const Vector& start, const Vector& goal, std::vector<Vector>& outRoute)
+{
+    outRoute.clear();
+    const int s = grid.cellOf(start);
+    const int gc = grid.cellOf(goal);
+    if (s < 0 || gc < 0 || grid.isBlocked(s) || grid.isBlocked(gc))
+        return false;
+
+    lastExpansions = 0;
+    startCell = s;
+    if (gc != goalCell)
+    {
+        resetSearch(gc);
+        lastStartCell = s;
+    }
+    else if (s != lastStartCell)
+    {
+        km += heuristic(lastStartCell, s);
+        lastStartCell = s;
+    }
+
+    computeShortestPath();
+    if (g[s] == Inf)
+        return false;
+
+    // Walk the cost-to-go field from the aircraft toward the goal.
+    std::vector<Vector> points{ start };
+    int cur = s;
+    for (int guard = 0; cur != goalCell && guard < grid.cellCount(); ++guard)
+    {
+        int best = -1;
+        float bestCost = Inf;
+        for (int d = 0; d < 26; ++d)
+        {
+            const int n = neighbor(cur, d);
+            if (n < 0)
+                continue;
+            const float c = edgeCost(cur, n, d) + g[n];
+            if (c < bestCost)
+            {
+                bestCost = c;
+                best = n;
+            }
+        }
+        if (best < 0)
+            return false;
+        cur = best;
+        points.push_back(grid.centerOf(cur));
+    }
+    points.back() = goal;
+
+    // String pulling: keep a point only where the straight line from the last kept point is blocked.
+    size_t anchor = 0;
+    for (size_t i = 2; i < points.size(); ++i)
+    {
+        if (!grid.lineOfSight(points[anchor], points[i]))
+        {
+            outRoute.push_back(points[i - 1]);
+            anchor = i - 1;
+        }
+    }
+    outRoute.push_back(points.back());
+    return true;
+}
+
+void RoutePlanner::resetSearch(int newGoal)
+{
+    std::fill(g.begin(), g.end(), Inf);
+    std::fill(rhs.begin(), rhs.end(), Inf);
+    std::fill(queued.begin(), queued.end(), 0);
+    heap.clear();
+    km = 0.0f;
+    goalCell = newGoal;
+    rhs[goalCell] = 0.0f;
+    push(goalCell, calculateKey(goalCell));
+}
+
+float RoutePlanner::heuristic(int a, int b) const
+{
+    return (grid.centerOf(a) - grid.centerOf(b)).length();
+}
+
+RoutePlanner::Key RoutePlanner::calculateKey(int cell) const
+{
+    const float m = std::min(g[cell], rhs[cell]);
+    return Key{ m + heuristic(startCell, cell) + km, m };
+}
+
+int RoutePlanner::neighbor(int cell, int dir) const
+{
+    const int nx = grid.getNX(), ny = grid.getNY(), nz = grid.getNZ();
+    const Dir& d = dirTable.dirs[dir];
+    const int x = cell % nx + d.dx, y = (cell / nx) % ny + d.dy, z = cell / (nx * ny) + d.dz;
+    if (x < 0 || y < 0 || z < 0 || x >= nx || y >= ny || z >= nz)
+        return -1;
+    return x + nx * (y + ny * z);
+}
+
+float RoutePlanner::edgeCost(int from, int to, int dir) const
+{
+    if (grid.isBlocked(from) || grid.isBlocked(to))
+        return Inf;
+    return dirTable.dirs[dir].length * grid.getCellSize();
+}
+
+void RoutePlanner::push(int cell, const Key& key)
+{
+    queued[cell] = 1;
+    queuedKey[cell] = key;
+    heap.push_back({ key, cell });
+    std::push_heap(heap.begin(), heap.end(), HeapOrder{});
+
+    // Removal is lazy, so drop stale entries once they dominate the heap.
+    if (heap.size() > 4 * static_cast<size_t>(grid.cellCount()) + 64)
+    {
+        heap.erase(std::remove_if(heap.begin(), heap.end(), [this](const HeapEntry& e)
+            { return !queued[e.cell] || queuedKey[e.cell] < e.key || e.key < queuedKey[e.cell]; }), heap.end());
+        std::make_heap(heap.begin(), heap.end(), HeapOrder{});
+    }
+}
+
+bool RoutePlanner::topKey(Key& key)
+{
+    while (!heap.empty())
+    {
+        const HeapEntry& e = heap.front();
+        if (queued[e.cell] && !(e.key < queuedKey[e.cell]) && !(queuedKey[e.cell] < e.key))
+        {
+            key = e.key;
+            return true;
+        }
+        std::pop_heap(heap.begin(), heap.end(), HeapOrder{});
+        heap.pop_back();
+    }
+    return false;
+}
+
+void RoutePlanner::updateVertex(int u)
+{
+    if (u != goalCell)
+    {
+        float best = Inf;
+        for (int d = 0; d < 26; ++d)
+        {
+            const int n = neighbor(u, d);
+            if (n >= 0 && g[n] != Inf)
+                best = std::min(best, edgeCost(u, n, d) + g[n]);
+        }
+        rhs[u] = best;
+    }
+    queued[u] = 0;
+    if (g[u] != rhs[u])
+        push(u, calculateKey(u));
+}
+
+void RoutePlanner::computeShortestPath()
+{
+    Key top;
+    while (topKey(top) && (top < calculateKey(startCell) || rhs[startCell] != g[startCell]))
+    {
+        const int u = heap.front().cell;
+        std::pop_heap(heap.begin(), heap.end(), HeapOrder{});
+        heap.pop_back();
+        queued[u] = 0;
+        ++lastExpansions;
+
+        const Key kNew = calculateKey(u);
+        if (top < kNew)
+        {
+            push(u, kNew);
+        }
+        else if (g[u] > rhs[u])
+        {
+            g[u] = rhs[u];
+            for (int d = 0; d < 26; ++d)
+            {
+                const int n = neighbor(u, d);
+                if (n >= 0)
+                    updateVertex(n);
+            }
+        }
+        else
+        {
+            g[u] = Inf;
+            updateVertex(u);
+            for (int d = 0; d < 26; ++d)
+            {
+                const int n = neighbor(u, d);
+                if (n >= 0)
+                    updateVertex(n);
+            }
+        }
+    }
+}
+
+void RoutePlanner::onCellsChanged(const std::vector<int>& cells)
+{
+    if (goalCell < 0)
+        return;
+
+    for (int c : cells)
+    {
+        updateVertex(c);
+        for (int d = 0; d < 26; ++d)
+        {
+            const int n = neighbor(c, d);
+            if (n >= 0)
+                updateVertex(n);
+        }
+    }
+}
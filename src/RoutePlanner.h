@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Vector.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       Regular 3D occupancy grid over the flyable volume. Cells hold a reference count rather
+       than a flag so overlapping obstacles can be added and removed independently.
+    */
+    class OccupancyGrid
+    {
+    public:
+        void init(const Vector& origin, int nx, int ny, int nz, float cellSize);
+
+        // Marks every cell overlapping the box; returns the cells whose blocked state changed.
+        void addBox(const Vector& lo, const Vector& hi, std::vector<int>& changed);
+        void removeBox(const Vector& lo, const Vector& hi, std::vector<int>& changed);
+
+        bool isBlocked(int cell) const { return occupancy[cell] != 0; }
+        bool isBlockedAt(const Vector& p) const;
+        bool lineOfSight(const Vector& a, const Vector& b) const;
+
+        int cellOf(const Vector& p) const;
+        Vector centerOf(int cell) const;
+        int cellCount() const { return nx * ny * nz; }
+        int getNX() const { return nx; }
+        int getNY() const { return ny; }
+        int getNZ() const { return nz; }
+        float getCellSize() const { return cellSize; }
+
+    private:
+        void forEachCell(const Vector& lo, const Vector& hi, int delta, std::vector<int>& changed);
+
+        Vector origin{ 0, 0, 0 };
+        float cellSize = 1.0f;
+        int nx = 0, ny = 0, nz = 0;
+        std::vector<uint16_t> occupancy;
+    };
+
+    /**
+       Incremental route planner (D* Lite) on a 26-connected occupancy grid. The search runs
+       from the goal toward the aircraft, so when obstacles change or the aircraft moves only
+       the affected part of the search is repaired instead of planning from scratch. Routes are
+       shortened afterwards by line-of-sight string pulling (Theta*-style post-smoothing).
+    */
+    class RoutePlanner
+    {
+    public:
+        void init(const Vector& origin, int nx, int ny, int nz, float cellSize, float clearance);
+
+        // Obstacles are boxes inflated by the clearance given to init(). Returns an id for removal.
+        int addObstacle(const Vector& lo, const Vector& hi);
+        void removeObstacle(int id);
+
+        // Plans from start to goal. Reuses the previous search when the goal is unchanged.
+        bool plan(const Vector& start, const Vector& goal, std::vector<Vector>& outRoute);
+
+        const OccupancyGrid& getGrid() const { return grid; }
+        size_t getLastExpansions() const { return lastExpansions; }
+
+    private:
+        struct Key
+        {
+            float k1, k2;
+            bool operator<(const Key& o) const { return k1 < o.k1 || (k1 == o.k1 && k2 < o.k2); }
+        };
+        struct HeapEntry
+        {
+            Key key;
+            int cell;
+        };
+        struct HeapOrder
+        {
+            // std heaps are max-heaps; invert so the smallest key is on top
+            bool operator()(const HeapEntry& a, const HeapEntry& b) const { return b.key < a.key; }
+        };
+
+        void resetSearch(int goalCell);
+        float heuristic(int a, int b) const;
+        Key calculateKey(int cell) const;
+        void updateVertex(int cell);
+        void computeShortestPath();
+        void onCellsChanged(const std::vector<int>& cells);
+        void push(int cell, const Key& key);
+        bool topKey(Key& key);
+        int neighbor(int cell, int dir) const;
+        float edgeCost(int from, int to, int dir) const;
+
+        OccupancyGrid grid;
+        float clearance = 0.0f;
+        std::map<int, std::pair<Vector, Vector>> obstacles;
+        int nextObstacleId = 1;
+
+        std::vector<float> g, rhs;
+        std::vector<Key> queuedKey;
+        std::vector<uint8_t> queued;
+        std::vector<HeapEntry> heap;
+        std::vector<int> changedScratch;
+        int startCell = -1, goalCell = -1, lastStartCell = -1;
+        float km = 0.0f;
+        size_t lastExpansions = 0;
+    };
+}
@@ -0,0 +1,391 @@
+#include "Scenario.h"
+#include "FlightModel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace Aftr;
+
+namespace
+{
+    constexpr float DegToRad = 3.14159265358979f / 180.0f;
+}
+
+bool ScenarioSource::parse(const std::string& text, const std::string& sourceName)
+{
+    *this = ScenarioSource{};
+    std::istringstream in(text);
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo)
+    {
+        const size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+        std::istringstream ss(line);
+        std::string keyword;
+        if (!(ss >> keyword))
+            continue;
+
+        auto bad = [&](const char* expected)
+        {
+            printf("%s:%d: expected '%s'\n", sourceName.c_str(), lineNo, expected);
+            return false;
+        };
+
+        if (keyword == "scenario")
+        {
+            if (!(ss >> name))
+                return bad("scenario <name>");
+        }
+        else if (keyword == "duration")
+        {
+            if (!(ss >> durationSec) || durationSec <= 0.0f)
+                return bad("duration <seconds>");
+        }
+        else if (keyword == "light")
+        {
+            if (!(ss >> ambient))
+                return bad("light <ambient>");
+        }
+        else if (keyword == "sky")
+        {
+            std::string image;
+            if (!(ss >> image))
+                return bad("sky <image>");
+            skies.push_back(image);
+        }
+        else if (keyword == "object")
+        {
+            Object o;
+            if (!(ss >> o.label >> o.model >> o.position[0] >> o.position[1] >> o.position[2]))
+                return bad("object <label> <model> x y z [sx sy sz [texRepeat ambient cullRadius]]");
+            if (ss >> o.scale[0])
+            {
+                if (!(ss >> o.scale[1] >> o.scale[2]))
+                    return bad("object <label> <model> x y z [sx sy sz [texRepeat ambient cullRadius]]");
+                ss >> o.texRepeat >> o.ambient >> o.cullRadius; // Optional trailing fields keep their defaults
+            }
+            objects.push_back(o);
+        }
+        else if (keyword == "planner")
+        {
+            // Counts go through a signed type: extracting "-5" into a uint32_t wraps instead of failing
+            int64_t cells[3];
+            if (!(ss >> plannerOrigin[0] >> plannerOrigin[1] >> plannerOrigin[2] >> cells[0] >> cells[1] >> cells[2] >> plannerCellSize >>
+                  plannerClearance) || plannerCellSize <= 0.0f)
+                return bad("planner ox oy oz nx ny nz cellSize clearance");
+            for (int k = 0; k < 3; ++k)
+                plannerCells[k] = cells[k] > 0 && cells[k] <= int64_t(ScenarioFormat::MaxPlannerCells) ? static_cast<uint32_t>(cells[k]) : 0;
+            if (!ScenarioFormat::plannerCellsValid(plannerCells))
+                return bad("planner counts nx ny nz above zero, at most 16777216 cells in all");
+        }
+        else if (keyword == "start")
+        {
+            if (!(ss >> start[0] >> start[1] >> start[2]))
+                return bad("start x y z [heading airspeed]");
+            float heading = 0.0f;
+            startAirspeed = 0.0f;
+            ss >> heading >> startAirspeed;
+            startHeading = heading * DegToRad;
+        }
+        else if (keyword == "cube")
+        {
+            if (!(ss >> cube[0] >> cube[1] >> cube[2]))
+                return bad("cube x y z");
+        }
+        else if (keyword == "obstacle")
+        {
+            std::array<float, 4> o;
+            if (!(ss >> o[0] >> o[1] >> o[2] >> o[3]) || o[3] <= 0.0f)
+                return bad("obstacle x y z size");
+            obstacles.push_back(o);
+        }
+        else if (keyword == "waypoint")
+        {
+            std::array<float, 3> w;
+            if (!(ss >> w[0] >> w[1] >> w[2]))
+                return bad("waypoint x y z");
+            waypoints.push_back(w);
+        }
+        else if (keyword == "objective")
+        {
+            std::string kind;
+            Objective o{};
+            if (!(ss >> kind >> o.position[0] >> o.position[1] >> o.position[2] >> o.radius) || (kind != "reach" && kind != "land"))
+                return bad("objective reach|land x y z radius [timeLimit]");
+            o.kind = kind == "reach" ? ScenarioFormat::okREACH : ScenarioFormat::okLAND;
+            ss >> o.timeLimitSec;
+            objectives.push_back(o);
+        }
+        else
+        {
+            printf("%s:%d: unknown keyword '%s'\n", sourceName.c_str(), lineNo, keyword.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ScenarioSource::load(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        printf("ScenarioSource: cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+    return parse(text.str(), path);
+}
+
+std::string Aftr::compileScenario(const ScenarioSource& s)
+{
+    using namespace ScenarioFormat;
+
+    std::string strings;
+    auto addString = [&strings](const std::string& str)
+    {
+        const uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(str);
+        strings.push_back('\0');
+        return offset;
+    };
+
+    Header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, Magic, sizeof(Magic));
+    h.version = Version;
+    h.nameOffset = addString(s.name);
+
+    std::vector<Object> objects;
+    for (const ScenarioSource::Object& o : s.objects)
+    {
+        Object b;
+        b.labelOffset = addString(o.label);
+        b.modelOffset = addString(o.model);
+        std::copy(o.position, o.position + 3, b.position);
+        std::copy(o.scale, o.scale + 3, b.scale);
+        b.texRepeat = o.texRepeat;
+        b.ambient = o.ambient;
+        b.cullRadius = o.cullRadius;
+        objects.push_back(b);
+    }
+    std::vector<uint32_t> skies;
+    for (const std::string& sky : s.skies)
+        skies.push_back(addString(sky));
+    std::vector<Obstacle> obstacles;
+    for (const auto& o : s.obstacles)
+        obstacles.push_back(Obstacle{ { o[0], o[1], o[2] }, o[3] });
+    std::vector<Waypoint> waypoints;
+    for (const auto& w : s.waypoints)
+        waypoints.push_back(Waypoint{ { w[0], w[1], w[2] } });
+    std::vector<Objective> objectives;
+    for (const ScenarioSource::Objective& o : s.objectives)
+        objectives.push_back(Objective{ o.kind, { o.position[0], o.position[1], o.position[2] }, o.radius, o.timeLimitSec });
+
+    h.objectCount = static_cast<uint32_t>(objects.size());
+    h.obstacleCount = static_cast<uint32_t>(obstacles.size());
+    h.waypointCount = static_cast<uint32_t>(waypoints.size());
+    h.objectiveCount = static_cast<uint32_t>(objectives.size());
+    h.skyCount = static_cast<uint32_t>(skies.size());
+    h.stringBytes = static_cast<uint32_t>(strings.size());
+    h.ambient = s.ambient;
+    std::copy(s.start, s.start + 3, h.start);
+    h.startHeading = s.startHeading;
+    h.startAirspeed = s.startAirspeed;
+    std::copy(s.cube, s.cube + 3, h.cube);
+    std::copy(s.plannerOrigin, s.plannerOrigin + 3, h.plannerOrigin);
+    std::copy(s.plannerCells, s.plannerCells + 3, h.plannerCells);
+    h.plannerCellSize = s.plannerCellSize;
+    h.plannerClearance = s.plannerClearance;
+    h.durationSec = s.durationSec;
+
+    // Layout: header, then every table (all 4-byte aligned records), strings last
+    h.objectOffset = sizeof(Header);
+    h.obstacleOffset = h.objectOffset + objects.size() * sizeof(Object);
+    h.waypointOffset = h.obstacleOffset + obstacles.size() * sizeof(Obstacle);
+    h.objectiveOffset = h.waypointOffset + waypoints.size() * sizeof(Waypoint);
+    h.skyOffset = h.objectiveOffset + objectives.size() * sizeof(Objective);
+    h.stringOffset = h.skyOffset + skies.size() * sizeof(uint32_t);
+    h.fileSize = h.stringOffset + strings.size();
+
+    std::string out;
+    out.reserve(h.fileSize);
+    auto append = [&out](const void* p, size_t bytes) { out.append(static_cast<const char*>(p), bytes); };
+    append(&h, sizeof(h));
+    append(objects.data(), objects.size() * sizeof(Object));
+    append(obstacles.data(), obstacles.size() * sizeof(Obstacle));
+    append(waypoints.data(), waypoints.size() * sizeof(Waypoint));
+    append(objectives.data(), objectives.size() * sizeof(Objective));
+    append(skies.data(), skies.size() * sizeof(uint32_t));
+    out.append(strings);
+    return out;
+}
+
+bool Scenario::open(const std::string& path)
+{
+    close();
+    if (!file.open(path))
+    {
+        printf("Scenario: cannot open %s\n", path.c_str());
+        return false;
+    }
+    if (file.size() >= sizeof(ScenarioFormat::Magic) && std::memcmp(file.data(), ScenarioFormat::Magic, sizeof(ScenarioFormat::Magic)) == 0)
+        return validate(path);
+
+    // Text source: compile it in memory and read it through the same view
+    std::string text(reinterpret_cast<const char*>(file.data()), file.size());
+    file.close();
+    ScenarioSource source;
+    if (!source.parse(text, path))
+        return false;
+    return openCompiled(compileScenario(source), path);
+}
+
+bool Scenario::openCompiled(std::string bytes, const std::string& sourceName)
+{
+    close();
+    compiled = std::move(bytes);
+    return validate(sourceName);
+}
+
+void Scenario::close()
+{
+    file.close();
+    compiled.clear();
+    header = nullptr;
+}
+
+bool Scenario::validate(const std::string& sourceName)
+{
+    using namespace ScenarioFormat;
+
+    auto fail = [&](const char* why)
+    {
+        printf("Scenario: %s: %s\n", sourceName.c_str(), why);
+        close();
+        return false;
+    };
+
+    const size_t size = file.isOpen() ? file.size() : compiled.size();
+    if (size < sizeof(Header))
+        return fail("truncated header");
+    const Header* h = reinterpret_cast<const Header*>(data());
+    if (std::memcmp(h->magic, Magic, sizeof(Magic)) != 0)
+        return fail("not a compiled scenario");
+    if (h->version != Version)
+        return fail("compiled with a different format version; recompile it");
+    if (h->fileSize != size)
+        return fail("size does not match its header");
+
+    auto inRange = [size](uint64_t offset, uint64_t bytes) { return offset <= size && bytes <= size - offset && offset % 4 == 0; };
+    if (!inRange(h->objectOffset, uint64_t(h->objectCount) * sizeof(Object)) ||
+        !inRange(h->obstacleOffset, uint64_t(h->obstacleCount) * sizeof(Obstacle)) ||
+        !inRange(h->waypointOffset, uint64_t(h->waypointCount) * sizeof(Waypoint)) ||
+        !inRange(h->objectiveOffset, uint64_t(h->objectiveCount) * sizeof(Objective)) ||
+        !inRange(h->skyOffset, uint64_t(h->skyCount) * sizeof(uint32_t)) || h->stringOffset > size || h->stringBytes > size - h->stringOffset)
+        return fail("table out of range");
+    if (h->stringBytes == 0 || data()[h->stringOffset + h->stringBytes - 1] != '\0' || h->nameOffset >= h->stringBytes)
+        return fail("string table is not terminated");
+
+    header = h;
+    for (uint32_t i = 0; i < h->objectCount; ++i)
+    {
+        if (getObject(i).labelOffset >= h->stringBytes || getObject(i).modelOffset >= h->stringBytes)
+            return fail("object name out of range");
+    }
+    for (uint32_t i = 0; i < h->skyCount; ++i)
+    {
+        if (table<uint32_t>(h->skyOffset)[i] >= h->stringBytes)
+            return fail("sky name out of range");
+    }
+    for (uint32_t i = 0; i < h->objectiveCount; ++i)
+    {
+        if (getObjective(i).kind > okLAND)
+            return fail("unknown objective kind");
+    }
+    if (!plannerCellsValid(h->plannerCells) || !(h->plannerCellSize > 0.0f))
+        return fail("planner grid is empty or too large");
+    return true;
+}
+
+std::vector<Vector> Scenario::getRoute() const
+{
+    std::vector<Vector> route;
+    route.reserve(getWaypointCount());
+    for (uint32_t i = 0; i < getWaypointCount(); ++i)
+    {
+        const float* p = getWaypoint(i).position;
+        route.push_back(Vector(p[0], p[1], p[2]));
+    }
+    return route;
+}
+
+void ObjectiveTracker::reset(const Scenario& scenario)
+{
+    status.assign(scenario.getObjectiveCount(), Status::PENDING);
+    completedAt.assign(scenario.getObjectiveCount(), 0.0f);
+    completed = failed = 0;
+}
+
+int ObjectiveTracker::update(const Scenario& scenario, const FlightState& flight, float timeSec, float groundLevel)
+{
+    int newlyCompleted = 0;
+    for (size_t i = 0; i < status.size(); ++i)
+    {
+        if (status[i] != Status::PENDING)
+            continue;
+        const ScenarioFormat::Objective& o = scenario.getObjective(static_cast<uint32_t>(i));
+        const Vector d = flight.position - Vector(o.position[0], o.position[1], o.position[2]);
+
+        bool met = false;
+        if (o.kind == ScenarioFormat::okREACH)
+            met = d.length() <= o.radius;
+        else // Landing is judged in the ground plane: down on the ground and nearly stopped
+            met = std::sqrt(d.x * d.x + d.y * d.y) <= o.radius && flight.position.z <= groundLevel + 0.05f && flight.airspeed < 0.5f;
+
+        if (met)
+        {
+            status[i] = Status::DONE;
+            completedAt[i] = timeSec;
+            ++completed;
+            ++newlyCompleted;
+        }
+        else if (o.timeLimitSec > 0.0f && timeSec > o.timeLimitSec)
+        {
+            status[i] = Status::FAILED;
+            ++failed;
+        }
+    }
+    return newlyCompleted;
+}
+
+bool ObjectiveTracker::hitsObstacle(const Scenario& scenario, const Vector& position, float margin) const
+{
+    for (uint32_t i = 0; i < scenario.getObstacleCount(); ++i)
+    {
+        const ScenarioFormat::Obstacle& o = scenario.getObstacle(i);
+        const float reach = o.size * 0.5f + margin;
+        if (std::fabs(position.x - o.center[0]) <= reach && std::fabs(position.y - o.center[1]) <= reach && std::fabs(position.z - o.center[2]) <= reach)
+            return true;
+    }
+    return false;
+}
+
+std::string ObjectiveTracker::describe(const ScenarioFormat::Objective& o)
+{
+    char text[128];
+    std::snprintf(text, sizeof(text), "%s (%.0f, %.0f, %.0f) within %.0f", o.kind == ScenarioFormat::okREACH ? "Reach" : "Land at",
+                  o.position[0], o.position[1], o.position[2], o.radius);
+    std::string s = text;
+    if (o.timeLimitSec > 0.0f)
+    {
+        std::snprintf(text, sizeof(text), " by %.0f s", o.timeLimitSec);
+        s += text;
+    }
+    return s;
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "Vector.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    struct FlightState;
+
+    /**
+       Everything loadMap used to hard-code, as a text file ScenarioTool compiles into a compact
+       binary. Lines may come in any order; later singletons (light, start, ...) override earlier:
+
+          # comment
+          scenario <name>
+          duration <seconds>                                  (headless run length)
+          light <global ambient>
+          sky <image path relative to the shared mm folder>   (first is day, second night)
+          object <label> <model path> x y z [sx sy sz [texRepeat ambient cullRadius]]
+          planner ox oy oz nx ny nz cellSize clearance        (RoutePlanner grid)
+          start x y z [heading airspeed]                      (heading in degrees)
+          cube x y z                                          (where SPACE drops the cube)
+          obstacle x y z size                                 (axis aligned cube)
+          waypoint x y z                                      (route flown by waypoint nav)
+          objective reach|land x y z radius [timeLimit]
+    */
+    struct ScenarioSource
+    {
+        struct Object
+        {
+            std::string label;
+            std::string model;
+            float position[3] = { 0, 0, 0 };
+            float scale[3] = { 1, 1, 1 };
+            float texRepeat = 0.0f; // 0 leaves the model's skin alone
+            float ambient = 0.0f;
+            float cullRadius = 0.0f; // 0 keeps the object out of the culler
+        };
+
+        std::string name = "unnamed";
+        float durationSec = 120.0f;
+        float ambient = 0.1f;
+        std::vector<std::string> skies;
+        std::vector<Object> objects;
+        float plannerOrigin[3] = { -200, -200, 0 };
+        uint32_t plannerCells[3] = { 100, 100, 16 };
+        float plannerCellSize = 4.0f;
+        float plannerClearance = 3.0f;
+        float start[3] = { 0, 0, 1.1f };
+        float startHeading = 0.0f; // Radians
+        float startAirspeed = 0.0f;
+        float cube[3] = { 10, 0, 1.1f };
+        std::vector<std::array<float, 4>> obstacles; // Center x y z, edge length
+        std::vector<std::array<float, 3>> waypoints;
+        struct Objective
+        {
+            uint32_t kind;
+            float position[3];
+            float radius;
+            float timeLimitSec; // 0 for no limit
+        };
+        std::vector<Objective> objectives;
+
+        bool parse(const std::string& text, const std::string& sourceName); // Prints the offending line and returns false on a malformed file
+        bool load(const std::string& path);
+    };
+
+    namespace ScenarioFormat
+    {
+        constexpr char Magic[8] = { 'A', 'F', 'T', 'R', 'S', 'C', 'N', 'O' };
+        constexpr uint32_t Version = 1;
+        constexpr uint64_t MaxPlannerCells = 1u << 24; // nx * ny * nz; keeps OccupancyGrid's int cell indices from overflowing
+
+        inline bool plannerCellsValid(const uint32_t cells[3])
+        {
+            return cells[0] > 0 && cells[1] > 0 && cells[2] > 0 && uint64_t(cells[0]) * cells[1] * cells[2] <= MaxPlannerCells;
+        }
+
+        enum ObjectiveKind : uint32_t
+        {
+            okREACH = 0, // Pass within radius of the point
+            okLAND = 1   // Come to rest on the ground within radius of the point
+        };
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t nameOffset;
+            uint32_t objectCount;
+            uint32_t obstacleCount;
+            uint32_t waypointCount;
+            uint32_t objectiveCount;
+            uint32_t skyCount;
+            uint32_t stringBytes;
+            float ambient;
+            float start[3];
+            float startHeading;
+            float startAirspeed;
+            float cube[3];
+            float plannerOrigin[3];
+            uint32_t plannerCells[3];
+            float plannerCellSize;
+            float plannerClearance;
+            float durationSec;
+            uint64_t objectOffset;
+            uint64_t obstacleOffset;
+            uint64_t waypointOffset;
+            uint64_t objectiveOffset;
+            uint64_t skyOffset; // uint32 string offsets
+            uint64_t stringOffset;
+            uint64_t fileSize;
+        };
+
+        struct Object
+        {
+            uint32_t labelOffset;
+            uint32_t modelOffset;
+            float position[3];
+            float scale[3];
+            float texRepeat;
+            float ambient;
+            float cullRadius;
+        };
+
+        struct Obstacle
+        {
+            float center[3];
+            float size;
+        };
+
+        struct Waypoint
+        {
+            float position[3];
+        };
+
+        struct Objective
+        {
+            uint32_t kind;
+            float position[3];
+            float radius;
+            float timeLimitSec;
+        };
+
+        static_assert(sizeof(Header) == 168, "Header layout is part of the file format");
+        static_assert(sizeof(Object) == 44, "Object layout is part of the file format");
+        static_assert(sizeof(Obstacle) == 16, "Obstacle layout is part of the file format");
+        static_assert(sizeof(Waypoint) == 12, "Waypoint layout is part of the file format");
+        static_assert(sizeof(Objective) == 24, "Objective layout is part of the file format");
+    }
+
+    // Lays the source out in the binary format, ready to write to disk or open in memory.
+    std::string compileScenario(const ScenarioSource& source);
+
+    /**
+       Zero-copy view of a compiled scenario. open() maps a .scnb file, or parses and compiles a
+       text one in memory, so both forms are read through the same validated accessors.
+    */
+    class Scenario
+    {
+    public:
+        bool open(const std::string& path);
+        bool openCompiled(std::string bytes, const std::string& sourceName); // Takes ownership of compiled bytes
+        void close();
+        bool isOpen() const { return header != nullptr; }
+
+        const ScenarioFormat::Header& getHeader() const { return *header; }
+        const char* getName() const { return string(header->nameOffset); }
+        uint32_t getObjectCount() const { return header ? header->objectCount : 0; }
+        uint32_t getObstacleCount() const { return header ? header->obstacleCount : 0; }
+        uint32_t getWaypointCount() const { return header ? header->waypointCount : 0; }
+        uint32_t getObjectiveCount() const { return header ? header->objectiveCount : 0; }
+        uint32_t getSkyCount() const { return header ? header->skyCount : 0; }
+        const ScenarioFormat::Object& getObject(uint32_t i) const { return table<ScenarioFormat::Object>(header->objectOffset)[i]; }
+        const ScenarioFormat::Obstacle& getObstacle(uint32_t i) const { return table<ScenarioFormat::Obstacle>(header->obstacleOffset)[i]; }
+        const ScenarioFormat::Waypoint& getWaypoint(uint32_t i) const { return table<ScenarioFormat::Waypoint>(header->waypointOffset)[i]; }
+        const ScenarioFormat::Objective& getObjective(uint32_t i) const { return table<ScenarioFormat::Objective>(header->objectiveOffset)[i]; }
+        const char* getSky(uint32_t i) const { return string(table<uint32_t>(header->skyOffset)[i]); }
+        const char* string(uint32_t offset) const { return reinterpret_cast<const char*>(data() + header->stringOffset + offset); }
+
+        Vector getStart() const { return Vector(header->start[0], header->start[1], header->start[2]); }
+        Vector getCube() const { return Vector(header->cube[0], header->cube[1], header->cube[2]); }
+        std::vector<Vector> getRoute() const; // Waypoints as a route for AutopilotTargets
+
+    private:
+        bool validate(const std::string& sourceName);
+        const uint8_t* data() const { return file.data() != nullptr ? file.data() : reinterpret_cast<const uint8_t*>(compiled.data()); }
+        template<typename T> const T* table(uint64_t offset) const { return reinterpret_cast<const T*>(data() + offset); }
+
+        MappedFile file;
+        std::string compiled; // Backing bytes when the scenario was compiled in memory
+        const ScenarioFormat::Header* header = nullptr;
+    };
+
+    /**
+       Scores a flight against a scenario's objectives. Engine free so the module, the headless
+       runner and the tests all judge a run the same way.
+    */
+    class ObjectiveTracker
+    {
+    public:
+        enum class Status : uint8_t { PENDING, DONE, FAILED };
+
+        void reset(const Scenario& scenario);
+        // Returns how many objectives completed on this call.
+        int update(const Scenario& scenario, const FlightState& flight, float timeSec, float groundLevel);
+        bool hitsObstacle(const Scenario& scenario, const Vector& position, float margin) const;
+
+        Status getStatus(size_t i) const { return status[i]; }
+        size_t getCount() const { return status.size(); }
+        int getCompleted() const { return completed; }
+        int getFailed() const { return failed; }
+        bool isFinished() const { return completed + failed == static_cast<int>(status.size()); }
+        float getCompletedAt(size_t i) const { return completedAt[i]; }
+
+        static std::string describe(const ScenarioFormat::Objective& o);
+
+    private:
+        std::vector<Status> status;
+        std::vector<float> completedAt;
+        int completed = 0;
+        int failed = 0;
+    };
+}
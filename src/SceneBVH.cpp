@@ -0,0 +1,293 @@
+#include "SceneBVH.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define AFTR_BVH_USE_SSE 1
+#endif
+
+using namespace Aftr;
+
+Aabb Aabb::merge(const Aabb& a, const Aabb& b)
+{
+    return Aabb{ Vector(std::min(a.lo.x, b.lo.x), std::min(a.lo.y, b.lo.y), std::min(a.lo.z, b.lo.z)),
+                 Vector(std::max(a.hi.x, b.hi.x), std::max(a.hi.y, b.hi.y), std::max(a.hi.z, b.hi.z)) };
+}
+
+Frustum Frustum::fromCamera(const Vector& position, const Vector& look, const Vector& up,
+                            float verticalFovRad, float aspect, float nearDist, float farDist)
+{
+    Vector f = look;
+    f.normalize();
+    Vector r = f.crossProduct(up);
+    r.normalize();
+    Vector u = r.crossProduct(f);
+
+    const float tv = std::tan(verticalFovRad * 0.5f);
+    const float th = tv * aspect;
+
+    // Inward normals of the side planes are built from the forward axis tilted by the half angles.
+    Vector normals[6] = {
+        f,                    // near
+        -f,                   // far
+        (f * th + r),         // left:  points right, into the frustum
+        (f * th - r),         // right
+        (f * tv + u),         // bottom
+        (f * tv - u)          // top
+    };
+    const Vector points[6] = { position + f * nearDist, position + f * farDist, position, position, position, position };
+
+    Frustum out;
+    for (int i = 0; i < 8; ++i)
+    {
+        if (i < 6)
+        {
+            Vector n = normals[i];
+            n.normalize();
+            out.nx[i] = n.x;
+            out.ny[i] = n.y;
+            out.nz[i] = n.z;
+            out.d[i] = -n.dotProduct(points[i]);
+        }
+        else
+        {
+            // Padding planes that every box is inside of
+            out.nx[i] = out.ny[i] = out.nz[i] = 0.0f;
+            out.d[i] = 1.0f;
+        }
+    }
+    return out;
+}
+
+Frustum::Result Frustum::classify(const Aabb& box) const
+{
+    const float cx = (box.lo.x + box.hi.x) * 0.5f, cy = (box.lo.y + box.hi.y) * 0.5f, cz = (box.lo.z + box.hi.z) * 0.5f;
+    const float ex = (box.hi.x - box.lo.x) * 0.5f, ey = (box.hi.y - box.lo.y) * 0.5f, ez = (box.hi.z - box.lo.z) * 0.5f;
+
+#ifdef AFTR_BVH_USE_SSE
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 vcx = _mm_set1_ps(cx), vcy = _mm_set1_ps(cy), vcz = _mm_set1_ps(cz);
+    const __m128 vex = _mm_set1_ps(ex), vey = _mm_set1_ps(ey), vez = _mm_set1_ps(ez);
+    int outside = 0, straddle = 0;
+    for (int i = 0; i < 8; i += 4)
+    {
+        const __m128 px = _mm_load_ps(nx + i), py = _mm_load_ps(ny + i), pz = _mm_load_ps(nz + i), pd = _mm_load_ps(d + i);
+        const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, vcx), _mm_mul_ps(py, vcy)), _mm_add_ps(_mm_mul_ps(pz, vcz), pd));
+        const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, px), vex), _mm_mul_ps(_mm_andnot_ps(signMask, py), vey)),
+                                         _mm_mul_ps(_mm_andnot_ps(signMask, pz), vez));
+        outside |= _mm_movemask_ps(_mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), radius)));
+        straddle |= _mm_movemask_ps(_mm_cmplt_ps(dist, radius));
+    }
+    if (outside)
+        return OUTSIDE;
+    return straddle ? INTERSECTS : INSIDE;
+#else
+    bool straddle = false;
+    for (int i = 0; i < 8; ++i)
+    {
+        const float dist = nx[i] * cx + ny[i] * cy + nz[i] * cz + d[i];
+        const float radius = std::fabs(nx[i]) * ex + std::fabs(ny[i]) * ey + std::fabs(nz[i]) * ez;
+        if (dist < -radius)
+            return OUTSIDE;
+        if (dist < radius)
+            straddle = true;
+    }
+    return straddle ? INTERSECTS : INSIDE;
+#endif
+}
+
+int SceneBVH::allocateNode()
+{
+    if (freeList == Null)
+    {
+        nodes.emplace_back();
+        return static_cast<int>(nodes.size()) - 1;
+    }
+    const int id = freeList;
+    freeList = nodes[id].parent;
+    nodes[id] = Node{};
+    return id;
+}
+
+void SceneBVH::freeNode(int id)
+{
+    nodes[id].parent = freeList;
+    nodes[id].height = -1;
+    freeList = id;
+}
+
+int SceneBVH::createProxy(const Aabb& box, int userData)
+{
+    const int id = allocateNode();
+    const Vector pad(margin, margin, margin);
+    nodes[id].box = Aabb{ box.lo - pad, box.hi + pad };
+    nodes[id].userData = userData;
+    nodes[id].height = 0;
+    insertLeaf(id);
+    return id;
+}
+
+void SceneBVH::destroyProxy(int proxy)
+{
+    removeLeaf(proxy);
+    freeNode(proxy);
+}
+
+bool SceneBVH::moveProxy(int proxy, const Aabb& box)
+{
+    if (nodes[proxy].box.contains(box))
+        return false;
+
+    removeLeaf(proxy);
+    const Vector pad(margin, margin, margin);
+    nodes[proxy].box = Aabb{ box.lo - pad, box.hi + pad };
+    insertLeaf(proxy);
+    return true;
+}
+
+void SceneBVH::insertLeaf(int leaf)
+{
+    if (root == Null)
+    {
+        root = leaf;
+        nodes[root].parent = Null;
+        return;
+    }
+
+    // Descend toward the sibling that minimizes the surface-area cost of the insertion.
+    const Aabb leafBox = nodes[leaf].box;
+    int index = root;
+    while (!nodes[index].isLeaf())
+    {
+        const int c1 = nodes[index].child1, c2 = nodes[index].child2;
+        const float area = nodes[index].box.surfaceArea();
+        const float combined = Aabb::merge(nodes[index].box, leafBox).surfaceArea();
+        const float cost = 2.0f * combined;
+        const float inherited = 2.0f * (combined - area);
+
+        auto childCost = [&](int c)
+        {
+            const float merged = Aabb::merge(leafBox, nodes[c].box).surfaceArea();
+            return nodes[c].isLeaf() ? merged + inherited : (merged - nodes[c].box.surfaceArea()) + inherited;
+        };
+        const float cost1 = childCost(c1), cost2 = childCost(c2);
+        if (cost < cost1 && cost < cost2)
+            break;
+        index = cost1 < cost2 ? c1 : c2;
+    }
+
+    const int sibling = index;
+    const int oldParent = nodes[sibling].parent;
+    const int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = Aabb::merge(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == Null)
+        root = newParent;
+    else if (nodes[oldParent].child1 == sibling)
+        nodes[oldParent].child1 = newParent;
+    else
+        nodes[oldParent].child2 = newParent;
+
+    for (index = nodes[leaf].parent; index != Null; index = nodes[index].parent)
+    {
+        index = balance(index);
+        const int c1 = nodes[index].child1, c2 = nodes[index].child2;
+        nodes[index].height = 1 + std::max(nodes[c1].height, nodes[c2].height);
+        nodes[index].box = Aabb::merge(nodes[c1].box, nodes[c2].box);
+    }
+}
+
+void SceneBVH::removeLeaf(int leaf)
+{
+    if (leaf == root)
+    {
+        root = Null;
+        return;
+    }
+
+    const int parent = nodes[leaf].parent;
+    const int grandParent = nodes[parent].parent;
+    const int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent == Null)
+    {
+        root = sibling;
+        nodes[sibling].parent = Null;
+        freeNode(parent);
+        return;
+    }
+
+    if (nodes[grandParent].child1 == parent)
+        nodes[grandParent].child1 = sibling;
+    else
+        nodes[grandParent].child2 = sibling;
+    nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    for (int index = grandParent; index != Null; index = nodes[index].parent)
+    {
+        index = balance(index);
+        const int c1 = nodes[index].child1, c2 = nodes[index].child2;
+        nodes[index].box = Aabb::merge(nodes[c1].box, nodes[c2].box);
+        nodes[index].height = 1 + std::max(nodes[c1].height, nodes[c2].height);
+    }
+}
+
+// Performs a left or right rotation if node A is imbalanced. Returns the new subtree root.
+int SceneBVH::balance(int iA)
+{
+    Node& A = nodes[iA];
+    if (A.isLeaf() || A.height < 2)
+        return iA;
+
+    const int iB = A.child1, iC = A.child2;
+    const int diff = nodes[iC].height - nodes[iB].height;
+
+    auto rotate = [this](int iA, int iUp, int iOther)
+    {
+        // iUp is promoted above iA; iOther is A's remaining child.
+        Node& A = nodes[iA];
+        Node& U = nodes[iUp];
+        const int iF = U.child1, iG = U.child2;
+
+        U.child1 = iA;
+        U.parent = A.parent;
+        A.parent = iUp;
+
+        if (U.parent == Null)
+            root = iUp;
+        else if (nodes[U.parent].child1 == iA)
+            nodes[U.parent].child1 = iUp;
+        else
+            nodes[U.parent].child2 = iUp;
+
+        // Keep the taller grandchild up, push the shorter one down under A.
+        const bool keepF = nodes[iF].height > nodes[iG].height;
+        const int iKeep = keepF ? iF : iG, iDown = keepF ? iG : iF;
+        U.child2 = iKeep;
+        if (A.child1 == iUp)
+            A.child1 = iDown;
+        else
+            A.child2 = iDown;
+        nodes[iDown].parent = iA;
+
+        A.box = Aabb::merge(nodes[iOther].box, nodes[iDown].box);
+        A.height = 1 + std::max(nodes[iOther].height, nodes[iDown].height);
+        U.box = Aabb::merge(A.box, nodes[iKeep].box);
+        U.height = 1 + std::max(A.height, nodes[iKeep].height);
+        return iUp;
+    };
+
+    if (diff > 1)
+        return rotate(iA, iC, iB);
+    if (diff < -1)
+        return rotate(iA, iB, iC);
+    return iA;
+}
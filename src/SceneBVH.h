@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Aftr
+{
+    struct Aabb
+    {
+        Vector lo{ 0, 0, 0 };
+        Vector hi{ 0, 0, 0 };
+
+        bool contains(const Aabb& o) const
+        {
+            return lo.x <= o.lo.x && lo.y <= o.lo.y && lo.z <= o.lo.z && hi.x >= o.hi.x && hi.y >= o.hi.y && hi.z >= o.hi.z;
+        }
+        float surfaceArea() const
+        {
+            Vector d = hi - lo;
+            return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+        static Aabb merge(const Aabb& a, const Aabb& b);
+    };
+
+    /**
+       View frustum as inward-facing planes stored structure-of-arrays and padded to eight so
+       an AABB is classified against four planes per SSE instruction.
+    */
+    struct Frustum
+    {
+        enum Result : uint8_t { OUTSIDE, INTERSECTS, INSIDE };
+
+        alignas(16) float nx[8];
+        alignas(16) float ny[8];
+        alignas(16) float nz[8];
+        alignas(16) float d[8];
+
+        static Frustum fromCamera(const Vector& position, const Vector& look, const Vector& up,
+                                  float verticalFovRad, float aspect, float nearDist, float farDist);
+        Result classify(const Aabb& box) const;
+    };
+
+    /**
+       Dynamic AABB tree (in the style of Box2D's b2DynamicTree) over scene objects. Leaves store
+       a fattened box so small movements don't touch the tree; moveProxy() only reinserts a leaf
+       once the object leaves its fat box. Frustum queries descend hierarchically and stop
+       testing planes below any node that is entirely inside the frustum.
+    */
+    class SceneBVH
+    {
+    public:
+        explicit SceneBVH(float fatMargin = 2.0f) : margin(fatMargin) {}
+
+        int createProxy(const Aabb& box, int userData);
+        void destroyProxy(int proxy);
+        bool moveProxy(int proxy, const Aabb& box); // Returns true if the leaf was reinserted
+        void setUserData(int proxy, int userData) { nodes[proxy].userData = userData; }
+        int getUserData(int proxy) const { return nodes[proxy].userData; }
+
+        // visit(userData) is called for every leaf whose fat box is not outside the frustum.
+        template<typename Visitor>
+        void queryFrustum(const Frustum& frustum, Visitor&& visit);
+
+        size_t getLastNodesTested() const { return lastNodesTested; }
+        int getHeight() const { return root == Null ? 0 : nodes[root].height; }
+
+    private:
+        static constexpr int Null = -1;
+
+        struct Node
+        {
+            Aabb box;
+            int parent = Null; // Doubles as the free-list link for unused nodes
+            int child1 = Null;
+            int child2 = Null;
+            int height = -1;   // Leaves are 0, free nodes -1
+            int userData = -1;
+            bool isLeaf() const { return child1 == Null; }
+        };
+
+        int allocateNode();
+        void freeNode(int node);
+        void insertLeaf(int leaf);
+        void removeLeaf(int leaf);
+        int balance(int node);
+
+        std::vector<Node> nodes;
+        std::vector<int> stack;
+        int root = Null;
+        int freeList = Null;
+        float margin;
+        size_t lastNodesTested = 0;
+    };
+
+    template<typename Visitor>
+    void SceneBVH::queryFrustum(const Frustum& frustum, Visitor&& visit)
+    {
+        lastNodesTested = 0;
+        if (root == Null)
+            return;
+
+        // Entries are node << 1 | insideFlag; inside subtrees are emitted without further plane tests.
+        stack.clear();
+        stack.push_back(root << 1);
+        while (!stack.empty())
+        {
+            const int entry = stack.back();
+            stack.pop_back();
+            const int id = entry >> 1;
+            const Node& n = nodes[id];
+
+            bool inside = (entry & 1) != 0;
+            if (!inside)
+            {
+                ++lastNodesTested;
+                const Frustum::Result r = frustum.classify(n.box);
+                if (r == Frustum::OUTSIDE)
+                    continue;
+                inside = r == Frustum::INSIDE;
+            }
+
+            if (n.isLeaf())
+                visit(n.userData);
+            else
+            {
+                stack.push_back((n.child1 << 1) | (inside ? 1 : 0));
+                stack.push_back((n.child2 << 1) | (inside ? 1 : 0));
+            }
+        }
+    }
+}
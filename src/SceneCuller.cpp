@@ -0,0 +1,175 @@
+#include "SceneCuller.h"
+#include "Profiler.h"
+#include "WO.h"
+#include "Model.h"
+#include "Camera.h"
+#include "ManagerOpenGLState.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Aftr;
+
+SceneCuller::SceneCuller()
+{
+    profileId = Profiler::get().registerTimer("Frustum Cull");
+    visibleCounterId = Profiler::get().registerCounter("Cull: visible WOs");
+    culledCounterId = Profiler::get().registerCounter("Cull: culled WOs");
+}
+
+int SceneCuller::add(WO* wo, float fallbackRadius, bool active)
+{
+    int handle;
+    if (!freeEntries.empty())
+    {
+        handle = freeEntries.back();
+        freeEntries.pop_back();
+    }
+    else
+    {
+        handle = static_cast<int>(entries.size());
+        entries.push_back(Entry{});
+    }
+    Entry& e = entries[handle];
+    e = Entry{ wo, -1, fallbackRadius, active };
+    e.proxy = bvh.createProxy(boundsOf(e), handle);
+    if (active)
+        ++activeCount;
+    return handle;
+}
+
+void SceneCuller::remove(WO* wo)
+{
+    auto it = std::find_if(entries.begin(), entries.end(), [wo](const Entry& e) { return e.wo == wo; });
+    if (it == entries.end())
+        return;
+
+    bvh.destroyProxy(it->proxy);
+    if (it->active)
+        --activeCount;
+    *it = Entry{ nullptr, -1, 0.0f, false };
+    freeEntries.push_back(static_cast<int>(it - entries.begin()));
+}
+
+void SceneCuller::setActive(int handle, bool active)
+{
+    Entry& e = entries[handle];
+    if (e.wo == nullptr || e.active == active)
+        return;
+
+    e.active = active;
+    activeCount += active ? 1 : -1;
+    if (!active)
+        e.wo->isVisible = false;
+}
+
+int SceneCuller::addInstance(const Vector& position, float radius, const LodSelector* lod)
+{
+    const int handle = static_cast<int>(instances.size());
+    Instance inst{ position, radius, lod, -1 };
+    inst.proxy = bvh.createProxy(Aabb{ position - Vector(radius, radius, radius), position + Vector(radius, radius, radius) }, ~handle);
+    instances.push_back(inst);
+    return handle;
+}
+
+void SceneCuller::moveInstance(int handle, const Vector& position)
+{
+    Instance& inst = instances[handle];
+    inst.position = position;
+    const Vector r(inst.radius, inst.radius, inst.radius);
+    bvh.moveProxy(inst.proxy, Aabb{ position - r, position + r });
+}
+
+void SceneCuller::clearInstances()
+{
+    for (const Instance& inst : instances)
+        bvh.destroyProxy(inst.proxy);
+    instances.clear();
+}
+
+void SceneCuller::selectLod(Instance& inst, const Vector& eye, float verticalFov)
+{
+    const float px = LodSelector::projectedPixels(inst.radius, (inst.position - eye).length(), viewportHeight, verticalFov);
+    inst.level = inst.lod->select(inst.level, px);
+    inst.seenFrame = frame;
+}
+
+void SceneCuller::setEnabled(bool enable)
+{
+    enabled = enable;
+    if (!enabled)
+    {
+        for (Entry& e : entries)
+        {
+            if (e.active)
+                e.wo->isVisible = true;
+        }
+        visibleCount = activeCount + static_cast<int>(instances.size());
+    }
+}
+
+Aabb SceneCuller::boundsOf(const Entry& e) const
+{
+    // A sphere around the model's bounding box keeps the bound valid under any rotation.
+    float r = e.fallbackRadius;
+    if (Model* m = e.wo->getModel())
+        r = std::max(r, m->getBoundingBox().getlxlylz().length() * 0.5f);
+
+    const Vector c = e.wo->getPosition();
+    return Aabb{ c - Vector(r, r, r), c + Vector(r, r, r) };
+}
+
+void SceneCuller::cull(const Camera& cam)
+{
+    ++frame;
+    const Vector eye = cam.getPosition();
+    const float aspect = cam.getCameraAspectRatio();
+    const float hFov = cam.getCameraHorizontalFOVDeg() * Aftr::DEGtoRAD;
+    const float vFov = 2.0f * std::atan(std::tan(hFov * 0.5f) / std::max(aspect, 1e-3f));
+
+    if (!enabled)
+    {
+        // Level of detail still applies with culling off; everything just counts as in view
+        for (Instance& inst : instances)
+            selectLod(inst, eye, vFov);
+        return;
+    }
+
+    ProfileScope scope(profileId);
+
+    for (const Entry& e : entries)
+    {
+        if (e.active)
+            bvh.moveProxy(e.proxy, boundsOf(e));
+    }
+
+    const Frustum frustum = Frustum::fromCamera(eye, cam.getLookDirection(), cam.getNormalDirection(), vFov, aspect,
+                                                ManagerOpenGLState::GL_NEAR_PLANE, ManagerOpenGLState::GL_CLIPPING_PLANE);
+
+    inView.assign(entries.size(), 0);
+    bvh.queryFrustum(frustum, [&](int index)
+        {
+            if (index >= 0)
+                inView[index] = 1;
+            else
+                selectLod(instances[~index], eye, vFov);
+        });
+
+    visibleCount = 0;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (!entries[i].active)
+            continue;
+        entries[i].wo->isVisible = inView[i] != 0;
+        visibleCount += inView[i];
+    }
+    for (Instance& inst : instances)
+    {
+        if (inst.seenFrame != frame)
+            inst.level = LodSelector::Culled;
+        else
+            ++visibleCount;
+    }
+
+    Profiler::get().setCounter(visibleCounterId, visibleCount);
+    Profiler::get().setCounter(culledCounterId, getCulledCount());
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "SceneBVH.h"
+#include "LodSelector.h"
+#include <vector>
+
+namespace Aftr
+{
+    class Camera;
+    class WO;
+
+    /**
+       Culls registered WOs against the camera frustum using a SceneBVH and toggles their
+       isVisible flag. Only geometry that can leave the view should be registered; the sky box,
+       lights and GUI stay outside the culler. Bounds are refit every frame from each WO's
+       position, which is cheap because the tree only changes when an object leaves its fat box.
+
+       Instances are bounded points that aren't WOs, such as one aircraft inside an instanced
+       batch. They share the tree with the WOs and get their level of detail picked in the same
+       query that culls them, so selection only runs for what is actually in view.
+    */
+    class SceneCuller
+    {
+    public:
+        SceneCuller();
+
+        // fallbackRadius bounds the WO until its (possibly async loaded) model reports a size.
+        // Returns a handle that stays valid until the WO is removed.
+        int add(WO* wo, float fallbackRadius, bool active = true);
+        void remove(WO* wo);
+
+        // An inactive WO keeps its slot and proxy but is skipped by cull() and left invisible;
+        // toggling it neither allocates nor searches, so pooled objects can flip it freely.
+        void setActive(int handle, bool active);
+
+        int addInstance(const Vector& position, float radius, const LodSelector* lod);
+        void moveInstance(int handle, const Vector& position);
+        void clearInstances();
+        uint8_t getInstanceLod(int handle) const { return instances[handle].level; } // LodSelector::Culled when out of view
+
+        void setViewportHeight(float pixels) { viewportHeight = pixels; }
+        void setEnabled(bool enabled);
+        bool isEnabled() const { return enabled; }
+
+        void cull(const Camera& cam);
+
+        int getVisibleCount() const { return visibleCount; }
+        int getCulledCount() const { return activeCount + static_cast<int>(instances.size()) - visibleCount; }
+        size_t getNodesTested() const { return bvh.getLastNodesTested(); }
+
+    private:
+        struct Entry
+        {
+            WO* wo; // nullptr for a free slot
+            int proxy;
+            float fallbackRadius;
+            bool active;
+        };
+
+        struct Instance
+        {
+            Vector position;
+            float radius;
+            const LodSelector* lod;
+            int proxy;
+            uint8_t level = LodSelector::Culled;
+            uint32_t seenFrame = 0;
+        };
+
+        Aabb boundsOf(const Entry& e) const;
+        void selectLod(Instance& inst, const Vector& eye, float verticalFov);
+
+        SceneBVH bvh;
+        std::vector<Entry> entries;
+        std::vector<int> freeEntries; // Slots of removed WOs, reused so handles never move
+        int activeCount = 0;
+        std::vector<Instance> instances; // BVH user data ~handle, WO entries use their index
+        std::vector<unsigned char> inView;
+        uint32_t frame = 0;
+        float viewportHeight = 1080.0f;
+        bool enabled = true;
+        int visibleCount = 0;
+        int profileId = -1;
+        int visibleCounterId = -1;
+        int culledCounterId = -1;
+    };
+}
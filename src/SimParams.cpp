@@ -0,0 +1,34 @@
+#include "SimParams.h"
+#include "ConfigRegistry.h"
+
+using namespace Aftr;
+
+void SimParams::registerWith(ConfigRegistry& r, SimParams& p)
+{
+    const SimParams d; // Defaults are the member initializers
+    r.add("clippingPlane", &p.clippingPlane, d.clippingPlane, 10.0f, 100000.0f, "units", "Far clipping plane");
+    r.add("nearPlane", &p.nearPlane, d.nearPlane, 0.001f, 10.0f, "units", "Near clipping plane");
+    r.add("gravityScalar", &p.gravityScalar, d.gravityScalar, 0.0f, 10.0f, "units/s^2", "Physics engine gravity");
+    r.add("collisionDistance", &p.collisionDistance, d.collisionDistance, 0.0f, 100.0f, "units", "Jet to placed cube collision range");
+    r.add("maxAirspeed", &p.maxAirspeed, d.maxAirspeed, 0.5f, 100.0f, "units/s", "Flight model airspeed at full thrust");
+    r.add("takeoffClimbRate", &p.takeoffClimbRate, d.takeoffClimbRate, 0.0f, 50.0f, "units/s", "Manual takeoff assist climb at full thrust");
+    r.add("dopplerFactor", &p.dopplerFactor, d.dopplerFactor, 0.0f, 10.0f, "", "Doppler shift strength, 1 = real world");
+    r.add("audioMetersPerUnit", &p.audioMetersPerUnit, d.audioMetersPerUnit, 0.01f, 1000.0f, "m/unit", "World scale used for the Doppler shift");
+}
+
+bool SimParams::parse(const std::string& confText, SimParams& out)
+{
+    SimParams p;
+    p.generation = out.generation;
+    ConfigRegistry registry;
+    registerWith(registry, p);
+    const std::map<std::string, std::string> values = ConfigRegistry::parseConf(confText);
+    if (!registry.resolve([&values](const std::string& key)
+        {
+            auto it = values.find(key);
+            return it != values.end() ? it->second : std::string();
+        }))
+        return false;
+    out = p;
+    return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Aftr
+{
+    class ConfigRegistry;
+
+    /**
+       Tuning values the sim reads every tick, as one immutable snapshot. ConfigReloader builds a
+       new snapshot whenever aftr.conf changes and the module swaps it in at the start of a tick,
+       so every value in a tick comes from the same version of the file. Defaults are the values
+       these used to be hard-coded to; aftr.conf keys are the member names (case-insensitive).
+    */
+    struct SimParams
+    {
+        float clippingPlane = 1000.0f;  // Far plane, world units
+        float nearPlane = 0.1f;
+        float gravityScalar = 0.1f;     // Physics engine gravity
+        float collisionDistance = 8.0f; // Jet to SPACE cube, world units
+        float maxAirspeed = 6.0f;       // Flight model airspeed at full thrust
+        float takeoffClimbRate = 3.0f;  // Manual takeoff assist climb per unit thrust, units/sec
+        float dopplerFactor = 1.0f;     // irrKlang Doppler scale, 1 = real world
+        float audioMetersPerUnit = 15.0f; // Scales world velocities to m/s for the Doppler shift
+        uint64_t generation = 0;        // Bumped on every published reload
+
+        // Binds every field to its aftr.conf key, default, range and unit.
+        static void registerWith(ConfigRegistry& registry, SimParams& p);
+
+        // Reads key=value lines of an aftr.conf; unknown keys and comments are ignored, missing keys
+        // take their defaults. Returns false, leaving out untouched, if a value does not parse.
+        static bool parse(const std::string& confText, SimParams& out);
+    };
+}
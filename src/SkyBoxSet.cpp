@@ -0,0 +1,133 @@
+#include "SkyBoxSet.h"
+#include "WOSkyBox.h"
+#include "WorldList.h"
+#include "Model.h"
+#include "ModelDataShared.h"
+#include "ModelMesh.h"
+#include "ModelMeshSkin.h"
+#include "ManagerLight.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+
+using namespace Aftr;
+
+namespace
+{
+    constexpr float DayAmbient = 0.1f; // The module's original global ambient
+    constexpr float NightAmbient = 0.02f;
+
+    float wrapHours(float h)
+    {
+        h = std::fmod(h, 24.0f);
+        return h < 0.0f ? h + 24.0f : h;
+    }
+}
+
+void SkyBoxSet::load(WorldList& worldLst, Camera** cam, const std::vector<std::string>& images)
+{
+    const int loadId = Profiler::get().registerTimer("Sky box load (all)");
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& image : images)
+    {
+        WO* sky = WOSkyBox::New(image, cam);
+        sky->setPosition(Vector(0, 0, 0));
+        sky->setLabel("Sky Box");
+        sky->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
+        sky->isVisible = false;
+        worldLst.push_back(sky);
+        skies.push_back(sky);
+        names.push_back(std::filesystem::path(image).stem().string());
+    }
+    std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+    Profiler::get().addSample(loadId, ms.count());
+    printf("SkyBoxSet: loaded %zu sky boxes in %.1f ms\n", skies.size(), ms.count());
+
+    setTimeOfDay(hours);
+}
+
+void SkyBoxSet::select(int index)
+{
+    if (index < 0 || index >= size() || index == selected)
+        return;
+    if (selected >= 0)
+        skies[selected]->isVisible = false;
+    skies[index]->isVisible = true;
+    selected = index;
+    followTimeOfDay = false;
+    applyLighting();
+}
+
+void SkyBoxSet::setTimeOfDay(float h)
+{
+    hours = wrapHours(h);
+    transitionRate = 0.0f;
+    followTimeOfDay = true;
+    applyLighting();
+}
+
+void SkyBoxSet::transitionTo(float h, float secondsToArrive)
+{
+    targetHours = wrapHours(h);
+    const float ahead = wrapHours(targetHours - hours);
+    transitionRate = ahead / std::max(secondsToArrive, 1e-3f);
+    followTimeOfDay = true;
+}
+
+void SkyBoxSet::update(float dt)
+{
+    if (transitionRate <= 0.0f)
+        return;
+
+    const float remaining = wrapHours(targetHours - hours);
+    const float step = transitionRate * dt;
+    if (step >= remaining)
+    {
+        hours = targetHours;
+        transitionRate = 0.0f;
+    }
+    else
+        hours = wrapHours(hours + step);
+    applyLighting();
+}
+
+void SkyBoxSet::applyLighting()
+{
+    // Sun elevation peaks at noon and is lowest at midnight; the clamp keeps a short twilight
+    // around 06:00 and 18:00 instead of an instant switch.
+    const float elevation = std::sin((hours - 6.0f) / 12.0f * 3.14159265f);
+    daylight = std::clamp(elevation * 3.0f + 0.5f, 0.0f, 1.0f);
+
+    if (followTimeOfDay && skies.size() >= 2)
+    {
+        const int want = daylight >= 0.5f ? 0 : 1;
+        if (want != selected)
+        {
+            if (selected >= 0)
+                skies[selected]->isVisible = false;
+            skies[want]->isVisible = true;
+            selected = want;
+        }
+    }
+    else if (selected < 0 && !skies.empty())
+    {
+        skies[0]->isVisible = true;
+        selected = 0;
+    }
+
+    const float ga = NightAmbient + (DayAmbient - NightAmbient) * daylight;
+    ManagerLight::setGlobalAmbientLight(aftrColor4f(ga, ga, ga, 1.0f));
+
+    // Darken the visible sky toward the swap point so the cut happens at its dimmest. A sky
+    // picked by hand is shown untinted.
+    Model* m = selected >= 0 ? skies[selected]->getModel() : nullptr;
+    if (m != nullptr && m->getModelDataShared() != nullptr)
+    {
+        const float fade = followTimeOfDay ? 0.35f + 0.65f * std::fabs(daylight - 0.5f) * 2.0f : 1.0f;
+        for (auto* mesh : m->getModelDataShared()->getModelMeshes())
+            for (ModelMeshSkin& skin : mesh->getSkins())
+                skin.setAmbient(aftrColor4f(fade, fade, fade, 1.0f));
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    class Camera;
+    class WO;
+    class WorldList;
+
+    /**
+       Every sky box the module uses, decoded and uploaded once in loadMap and kept in the world
+       list; switching skies only flips isVisible, so toggling day and night no longer re-reads
+       six JPEGs on the render thread.
+
+       Time of day (hours, 0-24) drives the change: daylight follows the sun's elevation and
+       scales the global ambient light and a tint on the visible sky. The day and night skies
+       swap at dusk and dawn where daylight crosses one half, which hides the cut in the fade
+       (sky boxes have no cross-fade of their own).
+    */
+    class SkyBoxSet
+    {
+    public:
+        // The first image is the day sky, the second the night sky; any others are only shown via select().
+        void load(WorldList& worldLst, Camera** cam, const std::vector<std::string>& images);
+
+        void select(int index); // Shows one sky and stops following the time of day until the next setTimeOfDay
+        int getSelected() const { return selected; }
+        int size() const { return static_cast<int>(skies.size()); }
+        const std::string& getName(int index) const { return names[index]; }
+
+        void setTimeOfDay(float hours);
+        void transitionTo(float hours, float secondsToArrive); // Moves the clock forward to hours over the given time
+        void update(float dt);
+        float getTimeOfDay() const { return hours; }
+        float getDaylight() const { return daylight; } // 0 at night, 1 in full day
+        bool isTransitioning() const { return transitionRate > 0.0f; }
+
+    private:
+        void applyLighting();
+
+        std::vector<WO*> skies;
+        std::vector<std::string> names;
+        int selected = -1;
+        bool followTimeOfDay = true;
+        float hours = 12.0f;
+        float daylight = 1.0f;
+        float targetHours = 12.0f;
+        float transitionRate = 0.0f; // Clock hours per real second while transitioning
+    };
+}
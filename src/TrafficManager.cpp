@@ -0,0 +1,113 @@
+#include "TrafficManager.h"
+#include "SceneCuller.h"
+#include "WOInstanced.h"
+#include "WorldList.h"
+#include "Profiler.h"
+#include "ManagerEnvironmentConfiguration.h"
+#include <cmath>
+#include <filesystem>
+#include <random>
+
+using namespace Aftr;
+
+namespace
+{
+    constexpr float AircraftRadius = 8.0f; // Bounds the jet model at unit scale
+    constexpr float PatternBank = 0.35f;
+}
+
+void TrafficManager::init(SceneCuller& c, WorldList& worldLst, const std::string& fullModelPath, int count, uint32_t seed,
+                          const BakedScene* baked)
+{
+    culler = &c;
+
+    // Full mesh, two clustered levels, impostor. Thresholds are projected diameters in pixels.
+    lod.minPixels = { 160.0f, 60.0f, 16.0f };
+
+    const std::string stem = std::filesystem::path(fullModelPath).stem().string();
+    const std::string local = ManagerEnvironmentConfiguration::getLMM() + "/models/" + stem;
+    std::vector<std::string> paths = { fullModelPath };
+    for (int level = 1; level < lod.levelCount(); ++level)
+    {
+        const bool impostor = level == lod.levelCount() - 1;
+        const std::string path = local + (impostor ? std::string("_impostor.wrl") : "_lod" + std::to_string(level) + ".wrl");
+        if (std::filesystem::exists(path))
+            paths.push_back(path);
+        else
+        {
+            printf("TrafficManager: %s not found (run LodBuilder), using the next finer model\n", path.c_str());
+            paths.push_back(paths.back());
+        }
+    }
+
+    for (int level = 0; level < lod.levelCount(); ++level)
+    {
+        WOInstanced* batch = WOInstanced::New(paths[level], static_cast<uint32_t>(count), baked);
+        batch->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
+        batch->setLabel("Traffic LOD " + std::to_string(level));
+        worldLst.push_back(batch);
+        batches.push_back(batch);
+        const std::string name = "Traffic LOD " + std::to_string(level);
+        counterIds[level] = Profiler::get().registerCounter(level == lod.levelCount() - 1 ? "Traffic impostors" : name.c_str());
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> centre(-1500.0f, 1500.0f);
+    std::uniform_real_distribution<float> radius(150.0f, 500.0f);
+    std::uniform_real_distribution<float> altitude(80.0f, 400.0f);
+    std::uniform_real_distribution<float> speed(15.0f, 40.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f * Aftr::DEGtoRAD);
+    aircraft.resize(count);
+    for (Aircraft& a : aircraft)
+    {
+        a.center = Vector(centre(rng), centre(rng), 0);
+        a.radius = radius(rng);
+        a.altitude = altitude(rng);
+        a.angularSpeed = speed(rng) / a.radius * (rng() % 2 ? 1.0f : -1.0f);
+        a.phase = angle(rng);
+        a.bank = a.angularSpeed > 0 ? PatternBank : -PatternBank; // Positive roll turns left, as in FlightModel
+        a.instance = culler->addInstance(a.center, AircraftRadius, &lod);
+    }
+    update(0.0f);
+}
+
+void TrafficManager::update(float simTimeSec)
+{
+    for (Aircraft& a : aircraft)
+    {
+        const float theta = a.phase + a.angularSpeed * simTimeSec;
+        a.position = a.center + Vector(a.radius * std::cos(theta), a.radius * std::sin(theta), a.altitude);
+        a.velocity = Vector(-std::sin(theta), std::cos(theta), 0) * (a.radius * a.angularSpeed);
+        a.heading = theta + (a.angularSpeed > 0 ? 0.5f : -0.5f) * 180.0f * Aftr::DEGtoRAD;
+        culler->moveInstance(a.instance, a.position);
+    }
+}
+
+void TrafficManager::rebuildBatches(const Vector& eye)
+{
+    for (WOInstanced* b : batches)
+        b->getInstances()->clear();
+    std::fill(countAtLevel, countAtLevel + MaxLevels, 0);
+
+    const int impostor = lod.levelCount() - 1;
+    for (const Aircraft& a : aircraft)
+    {
+        const uint8_t level = culler->getInstanceLod(a.instance);
+        if (level == LodSelector::Culled)
+            continue;
+
+        if (level == impostor)
+        {
+            // Turn the card's +X face toward the eye
+            const Vector toEye = eye - a.position;
+            const float horizontal = std::sqrt(toEye.x * toEye.x + toEye.y * toEye.y);
+            batches[level]->getInstances()->add(InstanceTransform::fromPose(a.position, std::atan2(toEye.y, toEye.x), std::atan2(toEye.z, horizontal), 0.0f, 1.0f));
+        }
+        else
+            batches[level]->getInstances()->add(InstanceTransform::fromPose(a.position, a.heading, 0.0f, a.bank, 1.0f));
+        ++countAtLevel[level];
+    }
+
+    for (int level = 0; level < lod.levelCount(); ++level)
+        Profiler::get().setCounter(counterIds[level], countAtLevel[level]);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "LodSelector.h"
+#include "Vector.h"
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    class BakedScene;
+    class SceneCuller;
+    class WorldList;
+    class WOInstanced;
+
+    /**
+       Background AI aircraft flying holding patterns around the airfield. No aircraft is a WO:
+       each level of detail (full mesh, the LodBuilder simplifications, the impostor card) is one
+       instanced batch and every frame each aircraft is written into the batch for the level the
+       culler picked for it. Levels whose baked file is missing reuse the next finer model.
+    */
+    class TrafficManager
+    {
+    public:
+        // Loads "<stem>_lod1.wrl" .. and "<stem>_impostor.wrl" from the module's mm/models/ next to fullModelPath's name.
+        void init(SceneCuller& culler, WorldList& worldLst, const std::string& fullModelPath, int count, uint32_t seed,
+                  const BakedScene* baked = nullptr);
+
+        void update(float simTimeSec); // Moves every aircraft and its culler instance; call before culling
+        void rebuildBatches(const Vector& eye); // Refills the batches from the culler's levels; call after culling
+
+        LodSelector& getLodSelector() { return lod; }
+        int getCountAtLevel(int level) const { return countAtLevel[level]; }
+        int getLevelCount() const { return static_cast<int>(batches.size()); }
+        int getAircraftCount() const { return static_cast<int>(aircraft.size()); }
+        const Vector& getPosition(int i) const { return aircraft[i].position; }
+        const Vector& getVelocity(int i) const { return aircraft[i].velocity; }
+        float getHeading(int i) const { return aircraft[i].heading; }
+        float getBank(int i) const { return aircraft[i].bank; }
+
+    private:
+        struct Aircraft
+        {
+            Vector center;
+            float radius;
+            float altitude;
+            float angularSpeed; // Radians/sec, negative for left-hand patterns
+            float phase;
+            Vector position;
+            Vector velocity; // World units/sec, for the engine sound's Doppler shift
+            float heading = 0.0f;
+            float bank = 0.0f;
+            int instance = -1;
+        };
+
+        static constexpr int MaxLevels = 4;
+
+        SceneCuller* culler = nullptr;
+        LodSelector lod;
+        std::vector<Aircraft> aircraft;
+        std::vector<WOInstanced*> batches; // Index is the level of detail; the last one is the impostor
+        int countAtLevel[MaxLevels] = {};
+        int counterIds[MaxLevels] = { -1, -1, -1, -1 };
+    };
+}
@@ -0,0 +1,111 @@
+#include "TrajectoryPredictor.h"
+#include "Profiler.h"
+#include <algorithm>
+
+using namespace Aftr;
+
+TrajectoryPredictor::~TrajectoryPredictor()
+{
+    stop();
+}
+
+void TrajectoryPredictor::start(const FlightModel& m, const Autopilot& ap, const WindModel* w)
+{
+    stop();
+    model = m;
+    autopilot = ap;
+    wind = w;
+    profileId = Profiler::get().registerTimer("Trajectory Prediction");
+    running = true;
+    worker = std::thread(&TrajectoryPredictor::run, this);
+}
+
+void TrajectoryPredictor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    if (worker.joinable())
+        worker.join();
+}
+
+bool TrajectoryPredictor::submit(const Request& request, const std::vector<Vector>& route)
+{
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return false;
+
+    pending = request;
+    pendingRoute.assign(route.begin(), route.end()); // Capacity is reused after the first few frames
+    hasPending = true;
+    lock.unlock();
+    wake.notify_one();
+    return true;
+}
+
+bool TrajectoryPredictor::fetch(std::vector<Vector>& outPoints)
+{
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock() || !hasResult)
+        return false;
+
+    outPoints.swap(result);
+    hasResult = false;
+    return true;
+}
+
+void TrajectoryPredictor::run()
+{
+    Request req;
+    std::vector<Vector> route;
+    std::vector<Vector> points;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this]() { return !running || hasPending; });
+        if (!running)
+            break;
+
+        req = pending;
+        route.swap(pendingRoute);
+        hasPending = false;
+        lock.unlock();
+
+        {
+            ProfileScope scope(profileId);
+            predict(req, route, points);
+        }
+
+        lock.lock();
+        result.swap(points);
+        hasResult = true;
+    }
+}
+
+void TrajectoryPredictor::predict(const Request& req, const std::vector<Vector>& route, std::vector<Vector>& out) const
+{
+    const float dt = FlightModel::FixedStepSec;
+    FlightState state = req.state;
+    AutopilotState ap = req.autopilotState;
+    AutopilotTargets targets = req.autopilotTargets;
+    targets.waypoints = route.data();
+    targets.waypointCount = route.size();
+
+    out.clear();
+    out.push_back(state.position);
+
+    const int steps = static_cast<int>(req.horizonSec / dt);
+    const int stepsPerSample = std::max(1, static_cast<int>(req.sampleIntervalSec / dt));
+    float t = req.simTimeSec;
+    for (int i = 1; i <= steps; ++i)
+    {
+        FlightControls c = autopilot.step(ap, targets, state, req.controls, model.getParams(), dt);
+        t += dt;
+        model.step(state, c, wind ? wind->sample(state.position, t) : Vector(0, 0, 0), dt);
+        if (i % stepsPerSample == 0)
+            out.push_back(state.position);
+    }
+}
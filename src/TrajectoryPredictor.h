@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Autopilot.h"
+#include "FlightModel.h"
+#include "WindField.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       Predicts the jet's flight path on a background thread by forward-integrating the flight
+       model (and the autopilot, when engaged) with the current controls. The render thread only
+       ever try-locks: submit() drops the request and fetch() reports nothing new if the worker
+       holds the lock, so updateWorld never waits and keeps showing the previous prediction.
+    */
+    class TrajectoryPredictor
+    {
+    public:
+        struct Request
+        {
+            FlightState state;
+            FlightControls controls;
+            AutopilotState autopilotState;
+            AutopilotTargets autopilotTargets;
+            float simTimeSec = 0.0f;
+            float horizonSec = 20.0f;
+            float sampleIntervalSec = 0.25f;
+        };
+
+        TrajectoryPredictor() = default;
+        ~TrajectoryPredictor();
+
+        // wind must outlive the predictor; model and autopilot are copied.
+        void start(const FlightModel& model, const Autopilot& autopilot, const WindModel* wind);
+        void stop();
+
+        // route is copied so the worker never reads the caller's waypoint storage.
+        bool submit(const Request& request, const std::vector<Vector>& route);
+
+        // Swaps the newest finished prediction into outPoints. Returns false if nothing new is ready.
+        bool fetch(std::vector<Vector>& outPoints);
+
+    private:
+        void run();
+        void predict(const Request& req, const std::vector<Vector>& route, std::vector<Vector>& out) const;
+
+        FlightModel model;
+        Autopilot autopilot;
+        const WindModel* wind = nullptr;
+
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool running = false;
+        bool hasPending = false;
+        bool hasResult = false;
+        Request pending;
+        std::vector<Vector> pendingRoute;
+        std::vector<Vector> result;
+        int profileId = -1;
+    };
+}
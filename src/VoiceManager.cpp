@@ -0,0 +1,219 @@
+#include "VoiceManager.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Aftr;
+
+namespace
+{
+    irrklang::vec3df toIrr(const Vector& v) { return irrklang::vec3df(v.x, v.y, v.z); }
+}
+
+VoiceManager::VoiceManager(AudioBank& bank, const VoiceManagerParams& params) : bank(bank), params(params)
+{
+    updateTimerId = Profiler::get().registerTimer("Audio: voice update");
+    realCounterId = Profiler::get().registerCounter("Audio: real voices");
+    virtualCounterId = Profiler::get().registerCounter("Audio: virtual voices");
+    startsCounterId = Profiler::get().registerCounter("Audio: voice starts");
+}
+
+int VoiceManager::add(const Emitter& e)
+{
+    int id;
+    if (!freeIds.empty())
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+    else
+    {
+        id = static_cast<int>(slots.size());
+        slots.emplace_back();
+    }
+    Slot& s = slots[id];
+    s = Slot{};
+    s.e = e;
+    s.active = true;
+    if (irrklang::ISoundSource* source = bank.getSource(e.sound))
+        s.lengthSec = std::max(0, static_cast<int>(source->getPlayLength())) / 1000.0f;
+    if (!e.looped && s.lengthSec <= 0.0f)
+        s.lengthSec = params.defaultOneShotSec;
+    dirty = true;
+    if (recordEvents)
+        events.push_back(Event{ clockSec, e.sound, e.position });
+    return id;
+}
+
+void VoiceManager::remove(int id)
+{
+    if (isValid(id))
+        release(id);
+}
+
+void VoiceManager::release(int id)
+{
+    stopVoice(slots[id]);
+    slots[id].active = false;
+    freeIds.push_back(id);
+}
+
+void VoiceManager::clear()
+{
+    for (Slot& s : slots)
+        stopVoice(s);
+    slots.clear();
+    freeIds.clear();
+    realCount = virtualCount = 0;
+}
+
+void VoiceManager::move(int id, const Vector& position, const Vector& velocity)
+{
+    if (!isValid(id))
+        return;
+    slots[id].e.position = position;
+    slots[id].e.velocity = velocity;
+}
+
+void VoiceManager::setLevels(int id, float playbackSpeed, float volume)
+{
+    if (!isValid(id))
+        return;
+    Emitter& e = slots[id].e;
+    e.playbackSpeed = playbackSpeed;
+    e.volume = volume;
+    slots[id].levelsDirty = true;
+}
+
+void VoiceManager::restart(int id)
+{
+    if (!isValid(id))
+        return;
+    Slot& s = slots[id];
+    s.playheadSec = 0.0f;
+    if (s.voice != nullptr)
+        s.voice->setPlayPosition(0);
+}
+
+float VoiceManager::audibility(const Emitter& e, const Vector& listener) const
+{
+    // irrKlang's inverse-distance model: full gain inside minDistance, then minDistance / distance
+    const float d = (e.position - listener).length();
+    const float minD = std::max(e.minDistance, 0.001f);
+    const float gain = d <= minD ? 1.0f : minD / (minD + params.rolloff * (d - minD));
+    return e.priority * e.volume * gain;
+}
+
+void VoiceManager::startVoice(Slot& s)
+{
+    s.real = true;
+    s.levelsDirty = false;
+    Profiler::get().addToCounter(startsCounterId, 1);
+    // Paused until it is placed, so it never sounds for a moment at the wrong spot or level
+    s.voice = bank.play3D(s.e.sound, toIrr(s.e.position), s.e.looped, true, true);
+    if (s.voice == nullptr)
+        return;
+    if (s.lengthSec <= 0.0f)
+        s.lengthSec = static_cast<int>(s.voice->getPlayLength()) > 0 ? s.voice->getPlayLength() / 1000.0f : 0.0f; // Emitters added before the bank loaded
+    s.voice->setMinDistance(s.e.minDistance);
+    s.voice->setVolume(s.e.volume);
+    s.voice->setPlaybackSpeed(s.e.playbackSpeed);
+    s.voice->setVelocity(toIrr(s.e.velocity));
+    if (s.playheadSec > 0.0f && s.lengthSec > 0.0f)
+        s.voice->setPlayPosition(static_cast<irrklang::ik_u32>(std::fmod(s.playheadSec, s.lengthSec) * 1000.0f));
+    s.voice->setIsPaused(false);
+}
+
+void VoiceManager::stopVoice(Slot& s)
+{
+    if (s.voice != nullptr)
+    {
+        s.voice->stop();
+        s.voice->drop();
+        s.voice = nullptr;
+    }
+    s.real = false;
+}
+
+void VoiceManager::evaluate(const Vector& listener)
+{
+    ranked.clear();
+    for (int id = 0; id < static_cast<int>(slots.size()); ++id)
+    {
+        Slot& s = slots[id];
+        if (!s.active)
+            continue;
+        s.score = audibility(s.e, listener);
+        if (s.score >= params.audibleThreshold)
+            ranked.push_back(id);
+    }
+
+    // Playing voices rank with a bonus so two emitters at similar range don't trade the slot every evaluation
+    auto rank = [this](int id) { return slots[id].score * (slots[id].real ? params.hysteresis : 1.0f); };
+    const size_t keep = std::min(ranked.size(), static_cast<size_t>(std::max(params.maxRealVoices, 0)));
+    std::nth_element(ranked.begin(), ranked.begin() + keep, ranked.end(), [&rank](int a, int b) { return rank(a) > rank(b); });
+
+    // Demote first so the slots are free before anything new starts
+    winners.assign(slots.size(), false);
+    for (size_t i = 0; i < keep; ++i)
+        winners[ranked[i]] = true;
+    for (int id = 0; id < static_cast<int>(slots.size()); ++id)
+        if (slots[id].real && !winners[id])
+            stopVoice(slots[id]);
+    for (size_t i = 0; i < keep; ++i)
+        if (!slots[ranked[i]].real)
+            startVoice(slots[ranked[i]]);
+}
+
+void VoiceManager::update(const Vector& listener, float dt)
+{
+    ProfileScope profile(updateTimerId);
+    clockSec += dt;
+
+    for (int id = 0; id < static_cast<int>(slots.size()); ++id)
+    {
+        Slot& s = slots[id];
+        if (!s.active)
+            continue;
+        s.playheadSec += dt * s.e.playbackSpeed;
+        const bool finished = !s.e.looped && (s.voice != nullptr ? s.voice->isFinished() : s.playheadSec >= s.lengthSec);
+        if (finished)
+        {
+            release(id);
+            dirty = true; // A slot may have opened up
+        }
+    }
+
+    sinceEvaluate += dt;
+    if (dirty || (params.evaluateHz > 0.0f && sinceEvaluate >= 1.0f / params.evaluateHz))
+    {
+        evaluate(listener);
+        sinceEvaluate = 0.0f;
+        dirty = false;
+    }
+
+    realCount = virtualCount = 0;
+    for (Slot& s : slots)
+    {
+        if (!s.active)
+            continue;
+        if (!s.real)
+        {
+            ++virtualCount;
+            continue;
+        }
+        ++realCount;
+        if (s.voice == nullptr)
+            continue;
+        s.voice->setPosition(toIrr(s.e.position));
+        s.voice->setVelocity(toIrr(s.e.velocity));
+        if (s.levelsDirty)
+        {
+            s.voice->setVolume(s.e.volume);
+            s.voice->setPlaybackSpeed(s.e.playbackSpeed);
+            s.levelsDirty = false;
+        }
+    }
+    Profiler::get().setCounter(realCounterId, realCount);
+    Profiler::get().setCounter(virtualCounterId, virtualCount);
+}
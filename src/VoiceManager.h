@@ -0,0 +1,121 @@
+#pragma once
+
+#include "AudioBank.h"
+#include "Vector.h"
+#include <vector>
+
+namespace Aftr
+{
+    struct VoiceManagerParams
+    {
+        int maxRealVoices = 16;        // irrKlang sounds allowed to play at once
+        float evaluateHz = 4.0f;       // How often emitters are re-ranked; positions still update every frame
+        float hysteresis = 1.25f;      // A playing voice keeps its slot until a rival is this much more audible
+        float audibleThreshold = 0.01f; // Estimated gain below which an emitter never gets a real voice
+        float rolloff = 1.0f;          // Matches the engine's rolloff factor
+        float defaultOneShotSec = 2.0f; // Length assumed for a one-shot whose source length is unknown
+    };
+
+    /**
+       Budgets irrKlang voices across any number of sound emitters. Every emitter is tracked
+       with its position, priority and a running playhead, but only the maxRealVoices most
+       audible ones (priority x volume x inverse-distance rolloff, estimated the way irrKlang
+       attenuates) hold a real ISound. The rest are virtual: they cost a few floats per frame,
+       and when one becomes audible enough to win a slot its sound starts at the playhead it
+       would have reached. Ranking runs at evaluateHz, or at once when an emitter is added, so
+       a new one-shot is not delayed.
+
+       Without a sound engine the selection still runs (real voices simply have no ISound),
+       which is what the tests exercise.
+    */
+    class VoiceManager
+    {
+    public:
+        struct Emitter
+        {
+            SoundId sound = SoundId::ENGINE_LOOP;
+            Vector position{ 0, 0, 0 };
+            Vector velocity{ 0, 0, 0 };
+            float priority = 1.0f;
+            float volume = 1.0f;
+            float playbackSpeed = 1.0f;
+            float minDistance = 10.0f; // Full volume inside this range, world units
+            bool looped = true;        // Otherwise a one-shot, freed when it finishes
+        };
+
+        // An emitter added while event recording is on, stamped with the manager's clock.
+        struct Event
+        {
+            float timeSec;
+            SoundId sound;
+            Vector position;
+        };
+
+        explicit VoiceManager(AudioBank& bank, const VoiceManagerParams& params = VoiceManagerParams{});
+        ~VoiceManager() { clear(); }
+        VoiceManager(const VoiceManager&) = delete;
+        VoiceManager& operator=(const VoiceManager&) = delete;
+
+        // Returns a handle for moving the emitter; one-shots free themselves, so ignore theirs.
+        int add(const Emitter& e);
+        void remove(int id);
+        void clear();
+
+        void move(int id, const Vector& position, const Vector& velocity);
+        void setLevels(int id, float playbackSpeed, float volume);
+        void restart(int id); // Rewinds the playhead, e.g. a looped engine started again
+
+        // Advances playheads, re-ranks when due and pushes every real voice's position.
+        void update(const Vector& listener, float dt);
+
+        // Logs every add(), for headless runs and tests to check which sounds fired when.
+        void setRecordEvents(bool on) { recordEvents = on; }
+        const std::vector<Event>& getEvents() const { return events; }
+        float getClock() const { return clockSec; } // Sum of the dt passed to update()
+
+        int getRealCount() const { return realCount; }
+        int getVirtualCount() const { return virtualCount; }
+        bool isReal(int id) const { return isValid(id) && slots[id].real; }
+        bool isValid(int id) const { return id >= 0 && id < static_cast<int>(slots.size()) && slots[id].active; }
+        VoiceManagerParams& getParams() { return params; }
+
+        // Estimated gain at the listener, before the engine's own master volume.
+        float audibility(const Emitter& e, const Vector& listener) const;
+
+    private:
+        struct Slot
+        {
+            Emitter e;
+            irrklang::ISound* voice = nullptr;
+            float playheadSec = 0.0f;
+            float lengthSec = 0.0f; // 0 when unknown
+            float score = 0.0f;
+            bool active = false;
+            bool real = false;
+            bool levelsDirty = false;
+        };
+
+        void evaluate(const Vector& listener);
+        void startVoice(Slot& s);
+        void stopVoice(Slot& s);
+        void release(int id);
+
+        AudioBank& bank;
+        VoiceManagerParams params;
+        std::vector<Slot> slots;
+        std::vector<int> freeIds;
+        std::vector<int> ranked; // Scratch for evaluate()
+        std::vector<bool> winners;
+        std::vector<Event> events;
+        bool recordEvents = false;
+        float clockSec = 0.0f;
+        float sinceEvaluate = 0.0f;
+        bool dirty = false;
+        int realCount = 0;
+        int virtualCount = 0;
+        int updateTimerId = -1;
+        int realCounterId = -1;
+        int virtualCounterId = -1;
+        int startsCounterId = -1;
+    };
+}
@@ -0,0 +1,480 @@
+#include "WOInstanced.h"
+#include "AftrOpenGLIncludes.h"
+#include "BakedScene.h"
+#include "Camera.h"
+#include "Model.h"
+#include "ModelDataShared.h"
+#include "ModelMesh.h"
+#include "ModelMeshSkin.h"
+#include "ManagerOpenGLState.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace Aftr;
+
+namespace
+{
+    const char* vertexShaderSrc = R"(
+        #version 430 core
+        layout( location = 0 ) in vec3 aPos;
+        layout( location = 1 ) in vec3 aNormal;
+        layout( location = 2 ) in mat4 aModel; // Occupies locations 2..5, one column each
+        uniform mat4 uViewProj;
+        out vec3 vNormal;
+        void main()
+        {
+            vNormal = mat3( aModel ) * aNormal;
+            gl_Position = uViewProj * aModel * vec4( aPos, 1.0 );
+        }
+    )";
+
+    const char* fragmentShaderSrc = R"(
+        #version 430 core
+        in vec3 vNormal;
+        uniform vec4 uColor;
+        uniform vec3 uLightDir;
+        out vec4 fragColor;
+        void main()
+        {
+            float diffuse = max( dot( normalize( vNormal ), -uLightDir ), 0.0 );
+            fragColor = vec4( uColor.rgb * ( 0.35 + 0.65 * diffuse ), uColor.a );
+        }
+    )";
+
+    GLuint compile(GLenum type, const char* src, const char* owner, bool& ok)
+    {
+        GLuint s = glCreateShader(type);
+        glShaderSource(s, 1, &src, nullptr);
+        glCompileShader(s);
+        GLint status = 0;
+        glGetShaderiv(s, GL_COMPILE_STATUS, &status);
+        if (!status)
+        {
+            char log[1024];
+            glGetShaderInfoLog(s, sizeof(log), nullptr, log);
+            printf("%s: shader compile failed:\n%s\n", owner, log);
+            ok = false;
+        }
+        return s;
+    }
+}
+
+uint32_t MGLInstanced::buildProgram(const char* vertexSrc, const char* fragmentSrc, const char* owner)
+{
+    bool ok = true;
+    GLuint program = glCreateProgram();
+    GLuint vs = compile(GL_VERTEX_SHADER, vertexSrc, owner, ok);
+    GLuint fs = compile(GL_FRAGMENT_SHADER, fragmentSrc, owner, ok);
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        printf("%s: shader link failed:\n%s\n", owner, log);
+        ok = false;
+    }
+    if (!ok)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void MGLInstanced::viewProjection(const Camera& cam, float* out)
+{
+    Vector f = cam.getLookDirection();
+    f.normalize();
+    Vector s = f.crossProduct(cam.getNormalDirection());
+    s.normalize();
+    Vector u = s.crossProduct(f);
+    const Vector e = cam.getPosition();
+    const float view[16] = { s.x, u.x, -f.x, 0, s.y, u.y, -f.y, 0, s.z, u.z, -f.z, 0,
+                             -s.dotProduct(e), -u.dotProduct(e), f.dotProduct(e), 1 };
+
+    const float aspect = std::max(cam.getCameraAspectRatio(), 1e-3f);
+    const float hFov = cam.getCameraHorizontalFOVDeg() * Aftr::DEGtoRAD;
+    const float ty = std::tan(hFov * 0.5f) / aspect;
+    const float n = ManagerOpenGLState::GL_NEAR_PLANE, fa = ManagerOpenGLState::GL_CLIPPING_PLANE;
+    const float proj[16] = { 1.0f / (ty * aspect), 0, 0, 0, 0, 1.0f / ty, 0, 0,
+                             0, 0, -(fa + n) / (fa - n), -1, 0, 0, -2.0f * fa * n / (fa - n), 0 };
+
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k)
+                sum += proj[k * 4 + r] * view[c * 4 + k];
+            out[c * 4 + r] = sum;
+        }
+}
+
+InstanceTransform InstanceTransform::fromPose(const Vector& p, float heading, float pitch, float roll, float scale)
+{
+    // R = Rz(heading) * Ry(-pitch) * Rx(roll), the same order GLViewNewModule applies to the jet
+    const float ch = std::cos(heading), sh = std::sin(heading);
+    const float cp = std::cos(-pitch), sp = std::sin(-pitch);
+    const float cr = std::cos(roll), sr = std::sin(roll);
+
+    InstanceTransform t;
+    t.m[0] = ch * cp * scale;  t.m[1] = sh * cp * scale;  t.m[2] = -sp * scale;     t.m[3] = 0;
+    t.m[4] = (ch * sp * sr - sh * cr) * scale; t.m[5] = (sh * sp * sr + ch * cr) * scale; t.m[6] = cp * sr * scale; t.m[7] = 0;
+    t.m[8] = (ch * sp * cr + sh * sr) * scale; t.m[9] = (sh * sp * cr - ch * sr) * scale; t.m[10] = cp * cr * scale; t.m[11] = 0;
+    t.m[12] = p.x; t.m[13] = p.y; t.m[14] = p.z; t.m[15] = 1;
+    return t;
+}
+
+void MGLInstanced::resetFrameCounters()
+{
+    // Registered on the first call; the per-frame path then only sets two counters by id
+    static const int drawCallId = Profiler::get().registerCounter("Draw calls: instanced");
+    static const int equivalentDrawId = Profiler::get().registerCounter("Draw calls: one WO each");
+    Profiler::get().setCounter(drawCallId, 0);
+    Profiler::get().setCounter(equivalentDrawId, 0);
+}
+
+MGLInstanced* MGLInstanced::New(WO* parentWO, const std::string& modelPath, uint32_t capacity)
+{
+    MGLInstanced* mgl = new MGLInstanced(parentWO, capacity);
+    mgl->onCreate(modelPath);
+    return mgl;
+}
+
+MGLInstanced* MGLInstanced::New(WO* parentWO, const float* vertices, uint32_t vertexCount, const uint32_t* indices,
+                                uint32_t indexCount, const float rgba[4], uint32_t capacity)
+{
+    MGLInstanced* mgl = new MGLInstanced(parentWO, capacity);
+    mgl->onCreate(std::string());
+    mgl->vertexSource = vertices;
+    mgl->sourceVertexCount = vertexCount;
+    mgl->indexSource = indices;
+    mgl->sourceIndexCount = indexCount;
+    std::copy(rgba, rgba + 4, mgl->color);
+    return mgl;
+}
+
+MGLInstanced::MGLInstanced(WO* parentWO, uint32_t capacity) : MGL(parentWO), capacity(capacity)
+{
+}
+
+void MGLInstanced::onCreate(const std::string& modelPath)
+{
+    instances.reserve(capacity);
+    dirtyRegions.reserve(capacity);
+    drawCallCounterId = Profiler::get().registerCounter("Draw calls: instanced");
+    equivalentDrawCounterId = Profiler::get().registerCounter("Draw calls: one WO each");
+
+    if (modelPath.empty())
+        return; // Mesh supplied by the caller
+
+    prototype = WO::New(modelPath, Vector(1, 1, 1), MESH_SHADING_TYPE::mstFLAT);
+    prototype->upon_async_model_loaded([this]() { captureMesh(); });
+}
+
+MGLInstanced::~MGLInstanced()
+{
+    for (void*& f : fences)
+    {
+        if (f != nullptr)
+            glDeleteSync(static_cast<GLsync>(f));
+    }
+    if (mapped != nullptr)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    GLuint buffers[3] = { vbo, ibo, instanceBuffer };
+    glDeleteBuffers(3, buffers);
+    if (vao != 0)
+        glDeleteVertexArrays(1, &vao);
+    if (program != 0)
+        glDeleteProgram(program);
+    delete prototype;
+}
+
+void MGLInstanced::captureMesh()
+{
+    ModelDataShared* data = prototype->getModel()->getModelDataShared();
+    const std::vector<Vector>& verts = data->getCompositeVertexList();
+    const std::vector<unsigned int>& indices = data->getCompositeIndexList();
+
+    // Smooth normals from the composite triangle list; the composite lists carry positions only.
+    std::vector<Vector> normals(verts.size(), Vector(0, 0, 0));
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const Vector& a = verts[indices[i]];
+        const Vector& b = verts[indices[i + 1]];
+        const Vector& c = verts[indices[i + 2]];
+        const Vector n = (b - a).crossProduct(c - a);
+        normals[indices[i]] += n;
+        normals[indices[i + 1]] += n;
+        normals[indices[i + 2]] += n;
+    }
+
+    meshVerts.clear();
+    meshVerts.reserve(verts.size() * 6);
+    for (size_t i = 0; i < verts.size(); ++i)
+    {
+        Vector n = normals[i];
+        if (n.length() > 0.0f)
+            n.normalize();
+        meshVerts.insert(meshVerts.end(), { verts[i].x, verts[i].y, verts[i].z, n.x, n.y, n.z });
+    }
+    meshIndices.assign(indices.begin(), indices.end());
+    vertexSource = meshVerts.data();
+    sourceVertexCount = static_cast<uint32_t>(verts.size());
+    indexSource = meshIndices.data();
+    sourceIndexCount = static_cast<uint32_t>(meshIndices.size());
+
+    const auto& meshes = data->getModelMeshes();
+    if (!meshes.empty() && !meshes.at(0)->getSkins().empty())
+    {
+        const aftrColor4f d = meshes.at(0)->getSkins().at(0).getDiffuse();
+        color[0] = d.r;
+        color[1] = d.g;
+        color[2] = d.b;
+        color[3] = d.a;
+    }
+}
+
+bool MGLInstanced::createGLResources()
+{
+    program = buildProgram(vertexShaderSrc, fragmentShaderSrc, "MGLInstanced");
+    if (program == 0)
+    {
+        programFailed = true;
+        return false;
+    }
+    viewProjLoc = glGetUniformLocation(program, "uViewProj");
+    colorLoc = glGetUniformLocation(program, "uColor");
+    lightDirLoc = glGetUniformLocation(program, "uLightDir");
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sourceVertexCount) * 6 * sizeof(float), vertexSource, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), reinterpret_cast<void*>(0));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), reinterpret_cast<void*>(3 * sizeof(float)));
+
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(sourceIndexCount) * sizeof(uint32_t), indexSource, GL_STATIC_DRAW);
+    indexCount = sourceIndexCount;
+
+    glGenBuffers(1, &instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    const GLsizeiptr regionBytes = static_cast<GLsizeiptr>(capacity) * sizeof(InstanceTransform);
+    persistent = GLEW_ARB_buffer_storage != 0;
+    if (persistent)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, regionBytes * Regions, nullptr, flags);
+        mapped = static_cast<InstanceTransform*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, regionBytes * Regions, flags));
+        persistent = mapped != nullptr;
+        if (!persistent)
+        {
+            // glBufferStorage made this buffer immutable, so glBufferData on it would fail; start from a fresh one
+            glDeleteBuffers(1, &instanceBuffer);
+            glGenBuffers(1, &instanceBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        }
+    }
+    if (!persistent)
+        glBufferData(GL_ARRAY_BUFFER, regionBytes, nullptr, GL_DYNAMIC_DRAW);
+
+    for (GLuint col = 0; col < 4; ++col)
+    {
+        glEnableVertexAttribArray(2 + col);
+        glVertexAttribPointer(2 + col, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), reinterpret_cast<void*>(col * 4 * sizeof(float)));
+        glVertexAttribDivisor(2 + col, 1);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Everything currently in the batch must reach every region once.
+    std::fill(dirtyRegions.begin(), dirtyRegions.end(), static_cast<uint8_t>((1u << Regions) - 1));
+    dirtyLo = 0;
+    dirtyHi = size();
+    return true;
+}
+
+uint32_t MGLInstanced::add(const InstanceTransform& xform)
+{
+    if (instances.size() >= capacity)
+        return capacity;
+    instances.push_back(xform);
+    dirtyRegions.push_back(0);
+    const uint32_t index = size() - 1;
+    set(index, xform);
+    return index;
+}
+
+void MGLInstanced::set(uint32_t index, const InstanceTransform& xform)
+{
+    instances[index] = xform;
+    dirtyRegions[index] = static_cast<uint8_t>((1u << Regions) - 1);
+    if (dirtyLo >= dirtyHi)
+    {
+        dirtyLo = index;
+        dirtyHi = index + 1;
+    }
+    else
+    {
+        dirtyLo = std::min(dirtyLo, index);
+        dirtyHi = std::max(dirtyHi, index + 1);
+    }
+}
+
+void MGLInstanced::removeLast()
+{
+    if (!instances.empty())
+    {
+        instances.pop_back();
+        dirtyRegions.pop_back();
+        dirtyHi = std::min(dirtyHi, size());
+    }
+}
+
+void MGLInstanced::clear()
+{
+    instances.clear();
+    dirtyRegions.clear();
+    dirtyLo = dirtyHi = 0;
+}
+
+void MGLInstanced::uploadDirty(uint32_t region)
+{
+    if (dirtyLo >= dirtyHi)
+        return;
+
+    const uint8_t bit = static_cast<uint8_t>(1u << region);
+    uint32_t stillLo = dirtyHi, stillHi = dirtyLo;
+    if (persistent)
+    {
+        InstanceTransform* dst = mapped + static_cast<size_t>(region) * capacity;
+        for (uint32_t i = dirtyLo; i < dirtyHi; ++i)
+        {
+            if (dirtyRegions[i] & bit)
+            {
+                dst[i] = instances[i];
+                dirtyRegions[i] &= ~bit;
+            }
+            if (dirtyRegions[i])
+            {
+                stillLo = std::min(stillLo, i);
+                stillHi = std::max(stillHi, i + 1);
+            }
+        }
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(dirtyLo) * sizeof(InstanceTransform),
+                        static_cast<GLsizeiptr>(dirtyHi - dirtyLo) * sizeof(InstanceTransform), instances.data() + dirtyLo);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        std::fill(dirtyRegions.begin() + dirtyLo, dirtyRegions.begin() + dirtyHi, 0);
+    }
+    dirtyLo = stillLo;
+    dirtyHi = stillHi;
+}
+
+void MGLInstanced::render(const Camera& cam)
+{
+    Profiler::get().addToCounter(equivalentDrawCounterId, size());
+    if (vertexSource == nullptr || instances.empty())
+        return;
+    if (program == 0 && (programFailed || !createGLResources()))
+        return;
+
+    const uint32_t region = persistent ? frame % Regions : 0;
+    if (persistent && fences[region] != nullptr)
+    {
+        // Only waits if the GPU is still reading this region from three frames ago.
+        glClientWaitSync(static_cast<GLsync>(fences[region]), GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        glDeleteSync(static_cast<GLsync>(fences[region]));
+        fences[region] = nullptr;
+    }
+    uploadDirty(region);
+
+    float viewProj[16];
+    viewProjection(cam, viewProj);
+
+    glUseProgram(program);
+    glUniformMatrix4fv(viewProjLoc, 1, GL_FALSE, viewProj);
+    glUniform4fv(colorLoc, 1, color);
+    glUniform3f(lightDirLoc, -0.577f, -0.577f, -0.577f);
+
+    glBindVertexArray(vao);
+    if (persistent)
+    {
+        // Point the per-instance attributes at this frame's region of the ring.
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        const size_t base = static_cast<size_t>(region) * capacity * sizeof(InstanceTransform);
+        for (GLuint col = 0; col < 4; ++col)
+            glVertexAttribPointer(2 + col, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), reinterpret_cast<void*>(base + col * 4 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(indexCount), GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(size()));
+    glBindVertexArray(0);
+    glUseProgram(0);
+
+    if (persistent)
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++frame;
+    Profiler::get().addToCounter(drawCallCounterId, 1);
+}
+
+WOInstanced* WOInstanced::New(const std::string& modelPath, uint32_t capacity, const BakedScene* baked)
+{
+    const uint32_t m = baked != nullptr ? baked->findMesh(modelPath) : BakedScene::NotFound;
+    if (m != BakedScene::NotFound)
+        return New(baked->getVertices(m), baked->getMesh(m).vertexCount, baked->getIndices(m), baked->getMesh(m).indexCount,
+                   baked->getMesh(m).color, capacity);
+
+    WOInstanced* wo = new WOInstanced();
+    wo->onCreate(modelPath, capacity);
+    return wo;
+}
+
+WOInstanced::WOInstanced() : IFace(this), WO()
+{
+}
+
+WOInstanced::~WOInstanced()
+{
+}
+
+WOInstanced* WOInstanced::New(const float* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                              const float color[4], uint32_t capacity)
+{
+    WOInstanced* wo = new WOInstanced();
+    wo->onCreate(MGLInstanced::New(wo, vertices, vertexCount, indices, indexCount, color, capacity));
+    return wo;
+}
+
+void WOInstanced::onCreate(const std::string& modelPath, uint32_t capacity)
+{
+    WO::onCreate();
+    this->model = MGLInstanced::New(this, modelPath, capacity);
+}
+
+void WOInstanced::onCreate(MGLInstanced* instancedModel)
+{
+    WO::onCreate();
+    this->model = instancedModel;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "WO.h"
+#include "MGL.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    class BakedScene;
+
+    // Column-major 4x4 transform as uploaded to the per-instance vertex attributes.
+    struct InstanceTransform
+    {
+        float m[16];
+        static InstanceTransform fromPose(const Vector& position, float heading, float pitch, float roll, float scale);
+    };
+
+    /**
+       Model that draws N copies of one mesh with a single glDrawElementsInstanced call.
+
+       The mesh is captured from a hidden prototype WO once its (async) load completes. Instance
+       transforms live in a persistently mapped, triple-buffered GL buffer (glBufferStorage with
+       GL_MAP_PERSISTENT_BIT); each frame only instances marked dirty are copied into the region
+       the GPU is no longer reading, guarded by a fence per region. Contexts without
+       ARB_buffer_storage fall back to glBufferSubData of the dirty range.
+    */
+    class MGLInstanced : public MGL
+    {
+    public:
+        static MGLInstanced* New(WO* parentWO, const std::string& modelPath, uint32_t capacity);
+
+        // Mesh given directly as interleaved position + normal floats and uint32 triangles, e.g.
+        // straight out of a memory-mapped BakedScene. The memory must stay valid until the first
+        // render, when it is uploaded.
+        static MGLInstanced* New(WO* parentWO, const float* vertices, uint32_t vertexCount, const uint32_t* indices,
+                                 uint32_t indexCount, const float color[4], uint32_t capacity);
+        virtual ~MGLInstanced();
+        virtual void render(const Camera& cam) override;
+
+        uint32_t add(const InstanceTransform& xform); // Returns the instance index, or capacity if full
+        void set(uint32_t index, const InstanceTransform& xform);
+        void removeLast();
+        void clear();
+        uint32_t size() const { return static_cast<uint32_t>(instances.size()); }
+        uint32_t getCapacity() const { return capacity; }
+        bool isMeshReady() const { return indexCount > 0; }
+
+        // Zeroes the per-frame draw call counters; call once per frame before rendering.
+        static void resetFrameCounters();
+
+        // Column-major view-projection built from the camera pose, matching the frustum the culler uses.
+        static void viewProjection(const Camera& cam, float* out);
+
+        // Compiles and links a GLSL program. Returns 0, after printing the info log under owner's
+        // name, if either stage fails to compile or the program fails to link.
+        static uint32_t buildProgram(const char* vertexSrc, const char* fragmentSrc, const char* owner);
+
+    protected:
+        MGLInstanced(WO* parentWO, uint32_t capacity);
+        void onCreate(const std::string& modelPath);
+        void captureMesh();
+        bool createGLResources();
+        void uploadDirty(uint32_t region);
+
+        static constexpr uint32_t Regions = 3;
+
+        WO* prototype = nullptr;
+        uint32_t capacity = 0;
+        std::vector<InstanceTransform> instances;
+        std::vector<uint8_t> dirtyRegions; // Bitmask per instance of regions that still need this transform
+        uint32_t dirtyLo = 0, dirtyHi = 0; // Range of instances with any dirty bit set
+
+        std::vector<float> meshVerts; // Interleaved position + normal captured from the prototype
+        std::vector<uint32_t> meshIndices;
+        const float* vertexSource = nullptr; // meshVerts or caller-owned memory; null until the mesh is known
+        const uint32_t* indexSource = nullptr;
+        uint32_t sourceVertexCount = 0;
+        uint32_t sourceIndexCount = 0;
+        float color[4] = { 0.8f, 0.1f, 0.1f, 1.0f };
+
+        uint32_t vao = 0, vbo = 0, ibo = 0, instanceBuffer = 0, program = 0;
+        bool programFailed = false; // Logged once; the batch then stays undrawn instead of retrying every frame
+        int32_t viewProjLoc = -1, colorLoc = -1, lightDirLoc = -1;
+        uint32_t indexCount = 0;
+        bool persistent = false;
+        InstanceTransform* mapped = nullptr;
+        void* fences[Regions] = { nullptr, nullptr, nullptr };
+        uint32_t frame = 0;
+        int drawCallCounterId = -1;
+        int equivalentDrawCounterId = -1;
+    };
+
+    // World object wrapper so an instanced batch can be pushed into worldLst like any other WO.
+    class WOInstanced : public WO
+    {
+    public:
+        // With a baked scene that holds modelPath's mesh, the batch draws it from the mapping and
+        // the model is never parsed
+        static WOInstanced* New(const std::string& modelPath, uint32_t capacity, const BakedScene* baked = nullptr);
+        static WOInstanced* New(const float* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                                const float color[4], uint32_t capacity);
+        virtual ~WOInstanced();
+        MGLInstanced* getInstances() { return static_cast<MGLInstanced*>(this->model); }
+
+    protected:
+        WOInstanced();
+        virtual void onCreate(const std::string& modelPath, uint32_t capacity);
+        virtual void onCreate(MGLInstanced* instancedModel);
+    };
+}
@@ -0,0 +1,80 @@
+#include "WOPool.h"
+#include "WO.h"
+#include "WorldList.h"
+#include "ModelLoader.h"
+#include "SceneCuller.h"
+#include "Profiler.h"
+
+using namespace Aftr;
+
+namespace
+{
+    const Vector ParkedPosition(0, 0, -10000); // Below the world, in case something draws it anyway
+}
+
+void WOPool::init(ModelLoader& loader, WorldList& worldLst, SceneCuller* c, const std::string& modelPath,
+                  size_t count, float radius, const std::string& label)
+{
+    culler = c;
+    cullRadius = radius;
+    inUseCounterId = Profiler::get().registerCounter(("Pool in use: " + label).c_str());
+
+    all.reserve(count);
+    freeList.reserve(count);
+    inUse.assign(count, 0);
+    cullHandles.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        WO* wo = loader.spawn(modelPath, Vector(1, 1, 1));
+        wo->setPosition(ParkedPosition);
+        wo->renderOrderType = RENDER_ORDER_TYPE::roOPAQUE;
+        wo->setLabel(label);
+        wo->isVisible = false;
+        worldLst.push_back(wo);
+        indexOf.emplace(wo, static_cast<unsigned>(all.size()));
+        all.push_back(wo);
+        if (culler != nullptr)
+            cullHandles.push_back(culler->add(wo, cullRadius, false));
+    }
+    // Hand out the first-created objects first
+    for (size_t i = count; i-- > 0;)
+        freeList.push_back(static_cast<unsigned>(i));
+}
+
+WO* WOPool::acquire(const Vector& position)
+{
+    if (freeList.empty())
+        return nullptr;
+
+    const unsigned index = freeList.back();
+    freeList.pop_back();
+    inUse[index] = 1;
+    WO* wo = all[index];
+    wo->setPosition(position);
+    wo->isVisible = true;
+    if (culler != nullptr)
+        culler->setActive(cullHandles[index], true);
+    Profiler::get().setCounter(inUseCounterId, static_cast<int64_t>(getInUse()));
+    return wo;
+}
+
+void WOPool::release(WO* wo)
+{
+    auto it = indexOf.find(wo);
+    if (it == indexOf.end() || !inUse[it->second])
+        return;
+
+    inUse[it->second] = 0;
+    if (culler != nullptr)
+        culler->setActive(cullHandles[it->second], false);
+    wo->isVisible = false;
+    wo->setPosition(ParkedPosition);
+    freeList.push_back(it->second);
+    Profiler::get().setCounter(inUseCounterId, static_cast<int64_t>(getInUse()));
+}
+
+void WOPool::releaseAll()
+{
+    for (WO* wo : all)
+        release(wo);
+}
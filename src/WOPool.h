@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Vector.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Aftr
+{
+    class ModelLoader;
+    class SceneCuller;
+    class WO;
+    class WorldList;
+
+    /**
+       Fixed set of WOs of one model, created and added to the world list once. acquire() and
+       release() only reposition an object and flip isVisible, so spawning and despawning never
+       allocate, parse a model or edit the world list. Every object is registered with the culler
+       once in init(), inactive; acquire() and release() only flip that flag, otherwise the
+       culler would make parked objects visible.
+    */
+    class WOPool
+    {
+    public:
+        void init(ModelLoader& loader, WorldList& worldLst, SceneCuller* culler, const std::string& modelPath,
+                  size_t count, float cullRadius, const std::string& label);
+
+        WO* acquire(const Vector& position); // nullptr when every object is in use
+        void release(WO* wo);
+        void releaseAll();
+
+        size_t getCapacity() const { return all.size(); }
+        size_t getInUse() const { return all.size() - freeList.size(); }
+        const std::vector<WO*>& getObjects() const { return all; }
+
+    private:
+        std::vector<WO*> all;
+        std::vector<unsigned> freeList; // Indices into all
+        std::vector<unsigned char> inUse; // Parallel to all; guards against double release
+        std::vector<int> cullHandles;     // Parallel to all
+        std::unordered_map<WO*, unsigned> indexOf;
+        SceneCuller* culler = nullptr;
+        float cullRadius = 1.0f;
+        int inUseCounterId = -1;
+    };
+}
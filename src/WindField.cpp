@@ -0,0 +1,219 @@
+#include "WindField.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace Aftr;
+
+namespace
+{
+    // splitmix64 is used instead of std::mt19937 + std::normal_distribution because the
+    // standard distributions are implementation defined and would break cross-platform
+    // reproducibility of a seeded run.
+    struct SplitMix64
+    {
+        uint64_t state;
+        uint64_t next()
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+        double uniform() { return ((next() >> 11) + 0.5) * (1.0 / 9007199254740992.0); } // (0,1)
+        double gaussian()
+        {
+            // Box-Muller. The draws are sequenced explicitly: operand evaluation order is unspecified,
+            // and pairing them differently on another compiler would change the turbulence for a seed.
+            const double u1 = uniform();
+            const double u2 = uniform();
+            return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+        }
+    };
+
+    // Periodic first-order low-pass along one line of the volume, y[i] = a*y[i-1] + x[i].
+    // y[0] is solved in closed form so the result wraps seamlessly.
+    void filterLine(float* line, int n, size_t stride, float a, std::vector<float>& scratch)
+    {
+        scratch.resize(n);
+        for (int i = 0; i < n; ++i)
+            scratch[i] = line[i * stride];
+
+        double y0 = 0.0, ak = 1.0;
+        for (int k = 0; k < n; ++k)
+        {
+            y0 += ak * scratch[(n - k) % n];
+            ak *= a;
+        }
+        y0 /= (1.0 - ak);
+
+        float y = static_cast<float>(y0);
+        line[0] = y;
+        for (int i = 1; i < n; ++i)
+        {
+            y = a * y + scratch[i];
+            line[i * stride] = y;
+        }
+    }
+
+    Vector lerp(const Vector& a, const Vector& b, float t)
+    {
+        return a + (b - a) * t;
+    }
+}
+
+bool WindField::loadFromFile(const std::string& path)
+{
+    std::ifstream fin(path);
+    if (!fin)
+    {
+        printf("WindField: could not open '%s', using uniform wind.\n", path.c_str());
+        return false;
+    }
+
+    int dx = 0, dy = 0, dz = 0;
+    Vector org{ 0, 0, 0 }, spc{ 1, 1, 1 };
+    std::vector<Vector> values;
+
+    std::string line;
+    while (std::getline(fin, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream ss(line);
+        std::string key;
+        ss >> key;
+        if (key == "dims")
+            ss >> dx >> dy >> dz;
+        else if (key == "origin")
+            ss >> org.x >> org.y >> org.z;
+        else if (key == "spacing")
+            ss >> spc.x >> spc.y >> spc.z;
+        else
+        {
+            Vector v;
+            std::istringstream vs(line);
+            if (vs >> v.x >> v.y >> v.z)
+                values.push_back(v);
+        }
+    }
+
+    if (dx < 1 || dy < 1 || dz < 1 || values.size() != static_cast<size_t>(dx) * dy * dz ||
+        spc.x <= 0 || spc.y <= 0 || spc.z <= 0)
+    {
+        printf("WindField: malformed wind file '%s' (dims %dx%dx%d, %zu samples).\n", path.c_str(), dx, dy, dz, values.size());
+        return false;
+    }
+
+    nx = dx; ny = dy; nz = dz;
+    origin = org;
+    spacing = spc;
+    cells = std::move(values);
+    return true;
+}
+
+void WindField::setUniform(const Vector& wind)
+{
+    uniform = wind;
+    cells.clear();
+    nx = ny = nz = 0;
+}
+
+Vector WindField::sample(const Vector& position) const
+{
+    if (cells.empty())
+        return uniform;
+
+    float g[3] = { (position.x - origin.x) / spacing.x, (position.y - origin.y) / spacing.y, (position.z - origin.z) / spacing.z };
+    const int n[3] = { nx, ny, nz };
+    int i0[3], i1[3];
+    float t[3];
+    for (int a = 0; a < 3; ++a)
+    {
+        float c = std::clamp(g[a], 0.0f, static_cast<float>(n[a] - 1));
+        i0[a] = std::min(static_cast<int>(c), n[a] - 1);
+        i1[a] = std::min(i0[a] + 1, n[a] - 1);
+        t[a] = c - static_cast<float>(i0[a]);
+    }
+
+    Vector x00 = lerp(at(i0[0], i0[1], i0[2]), at(i1[0], i0[1], i0[2]), t[0]);
+    Vector x10 = lerp(at(i0[0], i1[1], i0[2]), at(i1[0], i1[1], i0[2]), t[0]);
+    Vector x01 = lerp(at(i0[0], i0[1], i1[2]), at(i1[0], i0[1], i1[2]), t[0]);
+    Vector x11 = lerp(at(i0[0], i1[1], i1[2]), at(i1[0], i1[1], i1[2]), t[0]);
+    return lerp(lerp(x00, x10, t[1]), lerp(x01, x11, t[1]), t[2]);
+}
+
+void TurbulenceVolume::generate(const TurbulenceParams& p)
+{
+    params = p;
+    size = 1 << std::clamp(p.log2Size, 1, 8);
+    mask = size - 1;
+    invCellSize = 1.0f / std::max(p.cellSize, 1e-3f);
+
+    const size_t count = static_cast<size_t>(size) * size * size;
+    std::vector<float> comp(count);
+    std::vector<float> scratch;
+    voxels.assign(count, Vector(0, 0, 0));
+
+    SplitMix64 rng{ p.seed };
+    for (int c = 0; c < 3; ++c)
+    {
+        for (auto& v : comp)
+            v = static_cast<float>(rng.gaussian());
+
+        const float a = std::exp(-p.cellSize / std::max(p.lengthScale[c], 1e-3f));
+        const size_t sx = 1, sy = size, sz = static_cast<size_t>(size) * size;
+        for (int k = 0; k < size; ++k)
+            for (int j = 0; j < size; ++j)
+                filterLine(&comp[k * sz + j * sy], size, sx, a, scratch);
+        for (int k = 0; k < size; ++k)
+            for (int i = 0; i < size; ++i)
+                filterLine(&comp[k * sz + i], size, sy, a, scratch);
+        for (int j = 0; j < size; ++j)
+            for (int i = 0; i < size; ++i)
+                filterLine(&comp[j * sy + i], size, sz, a, scratch);
+
+        double mean = 0.0, sq = 0.0;
+        for (float v : comp)
+            mean += v;
+        mean /= count;
+        for (float v : comp)
+            sq += (v - mean) * (v - mean);
+        const double rms = std::sqrt(sq / count);
+        const float scale = rms > 0.0 ? static_cast<float>(p.sigma[c] / rms) : 0.0f;
+
+        for (size_t i = 0; i < count; ++i)
+            voxels[i][c] = static_cast<float>(comp[i] - mean) * scale;
+    }
+}
+
+Vector TurbulenceVolume::sample(const Vector& position) const
+{
+    if (voxels.empty())
+        return Vector(0, 0, 0);
+
+    const float gx = position.x * invCellSize, gy = position.y * invCellSize, gz = position.z * invCellSize;
+    const float fx = std::floor(gx), fy = std::floor(gy), fz = std::floor(gz);
+    const float tx = gx - fx, ty = gy - fy, tz = gz - fz;
+    const int x0 = static_cast<int>(fx) & mask, y0 = static_cast<int>(fy) & mask, z0 = static_cast<int>(fz) & mask;
+    const int x1 = (x0 + 1) & mask, y1 = (y0 + 1) & mask, z1 = (z0 + 1) & mask;
+
+    auto v = [this](int i, int j, int k) -> const Vector& { return voxels[(static_cast<size_t>(k) * size + j) * size + i]; };
+    Vector a = lerp(lerp(v(x0, y0, z0), v(x1, y0, z0), tx), lerp(v(x0, y1, z0), v(x1, y1, z0), tx), ty);
+    Vector b = lerp(lerp(v(x0, y0, z1), v(x1, y0, z1), tx), lerp(v(x0, y1, z1), v(x1, y1, z1), tx), ty);
+    return lerp(a, b, tz);
+}
+
+Vector WindModel::sample(const Vector& position, float simTimeSec) const
+{
+    Vector mean = meanField.sample(position);
+    return mean + turbulence.sample(position - mean * simTimeSec);
+}
+
+void WindModel::sampleBatch(const Vector* positions, size_t count, float simTimeSec, Vector* outWind) const
+{
+    for (size_t i = 0; i < count; ++i)
+        outWind[i] = sample(positions[i], simTimeSec);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Vector.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aftr
+{
+    /**
+       Gridded 3D mean-wind field. Velocities are stored in world units per second on a
+       regular lattice and sampled with trilinear interpolation; positions outside the
+       lattice are clamped to its boundary. With no file loaded the field is uniform.
+
+       Text file format (lines beginning with '#' are comments):
+          dims    nx ny nz
+          origin  x y z
+          spacing dx dy dz
+          u v w          <- nx*ny*nz rows, x varies fastest, then y, then z
+    */
+    class WindField
+    {
+    public:
+        bool loadFromFile(const std::string& path);
+        void setUniform(const Vector& wind);
+
+        Vector sample(const Vector& position) const;
+        bool isGridded() const { return !cells.empty(); }
+
+    private:
+        const Vector& at(int i, int j, int k) const { return cells[(static_cast<size_t>(k) * ny + j) * nx + i]; }
+
+        int nx = 0, ny = 0, nz = 0;
+        Vector origin{ 0, 0, 0 };
+        Vector spacing{ 1, 1, 1 };
+        Vector uniform{ 0, 0, 0 };
+        std::vector<Vector> cells;
+    };
+
+    struct TurbulenceParams
+    {
+        Vector sigma{ 0.5f, 0.5f, 0.25f };         // RMS gust intensity per axis (u, v, w), world units/sec
+        Vector lengthScale{ 60.0f, 60.0f, 20.0f }; // Dryden correlation length per axis, world units
+        float cellSize = 4.0f;                     // World units per noise voxel
+        int log2Size = 5;                          // Volume is (1 << log2Size)^3 voxels and tiles seamlessly
+        uint64_t seed = 1;
+    };
+
+    /**
+       Dryden-style turbulence precomputed into a tileable noise volume. White noise from a
+       seeded generator is shaped by a periodic first-order filter whose correlation length
+       matches the Dryden spectrum of each gust component, then renormalized to the requested
+       RMS intensity. At runtime the volume is advected with the mean wind (frozen turbulence),
+       so sampling an aircraft is a wrapped table lookup. Output is identical for a given seed
+       on every platform since no std:: distributions are involved.
+    */
+    class TurbulenceVolume
+    {
+    public:
+        void generate(const TurbulenceParams& params);
+        Vector sample(const Vector& position) const;
+        bool isGenerated() const { return !voxels.empty(); }
+        const TurbulenceParams& getParams() const { return params; }
+
+    private:
+        TurbulenceParams params;
+        int size = 0;
+        int mask = 0;
+        float invCellSize = 1.0f;
+        std::vector<Vector> voxels;
+    };
+
+    /**
+       Mean wind plus turbulence. All sampling is const and allocation free, so one instance
+       can be shared by every aircraft in the scene.
+    */
+    class WindModel
+    {
+    public:
+        WindField& getMeanField() { return meanField; }
+        TurbulenceVolume& getTurbulence() { return turbulence; }
+
+        Vector sample(const Vector& position, float simTimeSec) const;
+        void sampleBatch(const Vector* positions, size_t count, float simTimeSec, Vector* outWind) const;
+
+    private:
+        WindField meanField;
+        TurbulenceVolume turbulence;
+    };
+}
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include "AudioCapture.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+using namespace Aftr;
+namespace
+{
+   // Stereo mix of silence with a 440 Hz tone starting at each of the given times, 0.1 s long
+   std::vector<int16_t> tones( int rate, float lengthSec, std::initializer_list<float> starts )
+   {
+      std::vector<int16_t> mix( static_cast<size_t>( rate * lengthSec ) * 2, 0 );
+      for( float t0 : starts )
+         for( int i = 0; i < rate / 10; ++i )
+         {
+            const size_t frame = static_cast<size_t>( t0 * rate ) + i;
+            const int16_t v = static_cast<int16_t>( 12000 * std::sin( 2.0 * 3.14159265 * 440.0 * i / rate ) );
+            mix[frame * 2] = mix[frame * 2 + 1] = v;
+         }
+      return mix;
+   }
+
+   TEST( AudioCapture, mixer_thread_blocks_arrive_in_order_and_onsets_are_found )
+   {
+      const int rate = 44100;
+      const std::vector<int16_t> mix = tones( rate, 2.0f, { 0.25f, 1.5f } );
+
+      AudioCapture capture( 1u << 18 );
+      std::thread mixer( [&] {
+         const size_t block = 512 * 2; // Samples per callback, like a driver period
+         for( size_t at = 0; at < mix.size(); at += block )
+            capture.OnAudioDataReady( mix.data() + at, static_cast<int>( std::min( block, mix.size() - at ) * sizeof( int16_t ) ), rate );
+      } );
+      std::vector<int16_t> got;
+      while( got.size() < mix.size() )
+         capture.drain( got );
+      mixer.join();
+
+      EXPECT_EQ( got, mix );
+      EXPECT_EQ( capture.getSampleRate(), rate );
+      EXPECT_EQ( capture.getFramesDropped(), 0u );
+
+      const std::vector<float> onsets = AudioCapture::findOnsets( got, rate );
+      ASSERT_EQ( onsets.size(), 2u );
+      EXPECT_NEAR( onsets[0], 0.25f, 0.011f );
+      EXPECT_NEAR( onsets[1], 1.5f, 0.011f );
+   }
+
+   TEST( AudioCapture, full_ring_drops_instead_of_blocking_and_wav_is_valid )
+   {
+      const int rate = 22050;
+      AudioCapture capture( 1024 );
+      const std::vector<int16_t> mix = tones( rate, 0.5f, { 0.1f } );
+      capture.OnAudioDataReady( mix.data(), static_cast<int>( mix.size() * sizeof( int16_t ) ), rate );
+      EXPECT_EQ( capture.getFramesCaptured(), 1024u );
+      EXPECT_EQ( capture.getFramesDropped(), mix.size() / 2 - 1024 );
+
+      std::vector<int16_t> drained;
+      capture.drain( drained );
+
+      ASSERT_TRUE( capture.startWav( "AudioCapture_test.wav" ) );
+      capture.OnAudioDataReady( mix.data(), 1000 * 4, rate );
+      capture.stopWav();
+      EXPECT_EQ( capture.getFramesWritten(), 1000u );
+
+      std::ifstream in( "AudioCapture_test.wav", std::ios::binary );
+      std::string bytes( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+      ASSERT_EQ( bytes.size(), 44u + 4000u );
+      EXPECT_EQ( bytes.substr( 0, 4 ), "RIFF" );
+      EXPECT_EQ( bytes.substr( 8, 8 ), "WAVEfmt " );
+      uint32_t sampleRate = 0, dataBytes = 0;
+      std::memcpy( &sampleRate, bytes.data() + 24, 4 );
+      std::memcpy( &dataBytes, bytes.data() + 40, 4 );
+      EXPECT_EQ( sampleRate, 22050u );
+      EXPECT_EQ( dataBytes, 4000u );
+      std::remove( "AudioCapture_test.wav" );
+   }
+}
@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+#include "AudioPack.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+using namespace Aftr;
+namespace
+{
+   void writeFile( const std::string& path, const std::string& bytes )
+   {
+      std::ofstream( path, std::ios::binary ).write( bytes.data(), bytes.size() );
+   }
+
+   TEST( AudioPack, files_come_back_page_aligned_and_byte_identical )
+   {
+      const std::string a( 5000, 'a' );
+      const std::string b = "RIFF....WAVE";
+      writeFile( "AudioPack_test_a.ogg", a );
+      writeFile( "AudioPack_test_b.wav", b );
+      ASSERT_TRUE( bakeAudioPack( ".", { "AudioPack_test_a.ogg", "AudioPack_test_b.wav" }, "AudioPack_test.apak" ) );
+
+      AudioPack pack;
+      ASSERT_TRUE( pack.open( "AudioPack_test.apak" ) );
+      EXPECT_EQ( pack.getEntryCount(), 2u );
+      const AudioPackFormat::Entry* e = pack.find( "../mm/sounds/AudioPack_test_b.wav" ); // Folders are ignored
+      ASSERT_NE( e, nullptr );
+      EXPECT_EQ( e->dataOffset % AudioPackFormat::PageSize, 0u );
+      EXPECT_EQ( std::string( reinterpret_cast<const char*>( pack.getData( *e ) ), e->size ), b );
+      EXPECT_EQ( pack.find( "missing.wav" ), nullptr );
+
+      // Truncated: the header's size no longer matches
+      std::ifstream in( "AudioPack_test.apak", std::ios::binary );
+      std::string bytes( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+      writeFile( "AudioPack_test_bad.apak", bytes.substr( 0, bytes.size() - 10 ) );
+      AudioPack bad;
+      EXPECT_FALSE( bad.open( "AudioPack_test_bad.apak" ) );
+
+      // Rebaking replaces the file rather than truncating it, so the open pack still reads its own bytes
+      ASSERT_TRUE( bakeAudioPack( ".", { "AudioPack_test_b.wav" }, "AudioPack_test.apak" ) );
+      EXPECT_EQ( std::string( reinterpret_cast<const char*>( pack.getData( *e ) ), e->size ), b );
+      EXPECT_FALSE( std::ifstream( "AudioPack_test.apak.tmp" ).good() );
+      AudioPack rebaked;
+      ASSERT_TRUE( rebaked.open( "AudioPack_test.apak" ) );
+      EXPECT_EQ( rebaked.getEntryCount(), 1u );
+      rebaked.close();
+      ASSERT_TRUE( bakeAudioPack( ".", { "AudioPack_test_a.ogg", "AudioPack_test_b.wav" }, "AudioPack_test.apak" ) );
+
+      std::remove( "AudioPack_test_bad.apak" );
+      std::remove( "AudioPack_test_b.wav" );
+   }
+
+   TEST( AudioPack, entries_are_found_by_relative_path )
+   {
+      std::filesystem::create_directories( "AudioPack_test_dir/jet" );
+      std::filesystem::create_directories( "AudioPack_test_dir/prop" );
+      writeFile( "AudioPack_test_dir/jet/engine.wav", "jet" );
+      writeFile( "AudioPack_test_dir/prop/engine.wav", "prop" );
+      writeFile( "AudioPack_test_dir/engine.wav", "top" );
+      ASSERT_TRUE( bakeAudioPack( "AudioPack_test_dir", { "jet/engine.wav", "prop\\engine.wav", "engine.wav" }, "AudioPack_test_dir.apak" ) );
+      EXPECT_FALSE( bakeAudioPack( "AudioPack_test_dir", { "jet/engine.wav", "jet\\engine.wav" }, "AudioPack_test_dup.apak" ) );
+
+      AudioPack pack;
+      ASSERT_TRUE( pack.open( "AudioPack_test_dir.apak" ) );
+      auto contents = [&pack]( const std::string& name )
+      {
+         const AudioPackFormat::Entry* e = pack.find( name );
+         return e != nullptr ? std::string( reinterpret_cast<const char*>( pack.getData( *e ) ), e->size ) : std::string( "none" );
+      };
+      EXPECT_EQ( contents( "jet/engine.wav" ), "jet" );
+      EXPECT_EQ( contents( "../mm/sounds/prop/engine.wav" ), "prop" );
+      EXPECT_EQ( contents( "..\\mm\\sounds\\jet\\engine.wav" ), "jet" );
+      EXPECT_EQ( contents( "sounds/engine.wav" ), "top" );
+      EXPECT_EQ( contents( "jet/turbine.wav" ), "none" );
+      EXPECT_EQ( contents( "ngine.wav" ), "none" ); // Only whole path components match
+      pack.close();
+
+      std::filesystem::remove_all( "AudioPack_test_dir" );
+      std::remove( "AudioPack_test_dir.apak" );
+   }
+
+   TEST( AudioPack, factory_serves_pack_entries_and_falls_back_to_disk )
+   {
+      const std::string a( 5000, 'a' );
+      writeFile( "AudioPack_test_a.ogg", a );
+      writeFile( "AudioPack_test_loose.wav", "loose" );
+      ASSERT_TRUE( bakeAudioPack( ".", { "AudioPack_test_a.ogg" }, "AudioPack_test.apak" ) );
+      std::remove( "AudioPack_test_a.ogg" ); // Only the pack has it now
+
+      AudioPackFileFactory* factory = new AudioPackFileFactory();
+      ASSERT_TRUE( factory->open( "AudioPack_test.apak" ) );
+      irrklang::IFileReader* r = factory->createFileReader( "sounds/AudioPack_test_a.ogg" );
+      ASSERT_NE( r, nullptr );
+      factory->drop(); // The reader keeps it, and the mapping, alive
+
+      char buf[16];
+      EXPECT_EQ( r->getSize(), 5000 );
+      EXPECT_TRUE( r->seek( 4995 ) );
+      EXPECT_EQ( r->read( buf, sizeof( buf ) ), 5 );
+      EXPECT_EQ( r->getPos(), 5000 );
+      EXPECT_FALSE( r->seek( 1, true ) );
+      EXPECT_TRUE( r->seek( -10, true ) );
+      EXPECT_EQ( r->read( buf, 4 ), 4 );
+      EXPECT_EQ( std::string( buf, 4 ), "aaaa" );
+      r->drop();
+
+      factory = new AudioPackFileFactory();
+      ASSERT_TRUE( factory->open( "AudioPack_test.apak" ) );
+      irrklang::IFileReader* loose = factory->createFileReader( "AudioPack_test_loose.wav" );
+      ASSERT_NE( loose, nullptr );
+      EXPECT_EQ( loose->read( buf, sizeof( buf ) ), 5 );
+      loose->drop();
+      EXPECT_EQ( factory->createFileReader( "AudioPack_test_none.wav" ), nullptr );
+      EXPECT_EQ( factory->getPackOpens(), 0u );
+      EXPECT_EQ( factory->getDiskOpens(), 1u );
+      factory->drop();
+
+      std::remove( "AudioPack_test_loose.wav" );
+      std::remove( "AudioPack_test.apak" );
+   }
+}
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "Autopilot.h"
+#include <cmath>
+
+using namespace Aftr;
+namespace
+{
+   TEST( Autopilot, holds_altitude_heading_and_speed )
+   {
+      FlightModel model;
+      Autopilot ap;
+
+      FlightState flight;
+      flight.position = Vector{ 0, 0, 10 };
+      flight.airspeed = 3.0f;
+
+      AutopilotState state;
+      state.modes = apmALTITUDE_HOLD | apmHEADING_HOLD | apmSPEED_HOLD;
+      state.engaged = true;
+
+      AutopilotTargets targets;
+      targets.altitude = 30.0f;
+      targets.heading = 1.0f;
+      targets.airspeed = 5.0f;
+
+      const float dt = FlightModel::FixedStepSec;
+      for( int i = 0; i < static_cast<int>( 60.0f / dt ); ++i )
+      {
+         FlightControls c = ap.step( state, targets, flight, FlightControls{}, model.getParams(), dt );
+         model.step( flight, c, Vector{ 0, 0, 0 }, dt );
+      }
+
+      EXPECT_NEAR( flight.position.z, 30.0f, 0.5f );
+      EXPECT_NEAR( flight.heading, 1.0f, 0.02f );
+      EXPECT_NEAR( flight.airspeed, 5.0f, 0.05f );
+   }
+
+   TEST( Autopilot, flight_director_computes_commands_while_disengaged )
+   {
+      Autopilot ap;
+      AutopilotState state;
+      state.modes = apmALTITUDE_HOLD;
+
+      FlightState flight;
+      flight.position = Vector{ 0, 0, 10 };
+      FlightControls pilot{ 0.7f, 0.1f, -0.2f, 0.0f };
+
+      FlightControls c = ap.step( state, AutopilotTargets{}, flight, pilot, FlightModelParams{}, 0.01f );
+      EXPECT_EQ( c.thrust, pilot.thrust );
+      EXPECT_EQ( c.pitch, pilot.pitch );
+      EXPECT_GT( state.commandedPitch, 0.0f );
+   }
+
+   TEST( Autopilot, does_not_wind_up_while_disengaged )
+   {
+      Autopilot ap;
+      AutopilotState state, fresh;
+      state.modes = fresh.modes = apmALTITUDE_HOLD | apmHEADING_HOLD;
+
+      // A minute of the pilot flying far off the targets with the flight director running
+      FlightState flight;
+      flight.position = Vector{ 0, 0, 10 };
+      AutopilotTargets targets;
+      targets.heading = 2.0f;
+      for( int i = 0; i < 6000; ++i )
+         ap.step( state, targets, flight, FlightControls{}, FlightModelParams{}, 0.01f );
+      EXPECT_EQ( state.altitude.integral, 0.0f );
+
+      // Engaging then commands exactly what an autopilot engaged from the start would
+      state.engaged = fresh.engaged = true;
+      const FlightControls c = ap.step( state, targets, flight, FlightControls{}, FlightModelParams{}, 0.01f );
+      const FlightControls expected = ap.step( fresh, targets, flight, FlightControls{}, FlightModelParams{}, 0.01f );
+      EXPECT_EQ( c.roll, expected.roll );
+      EXPECT_EQ( c.pitch, expected.pitch );
+   }
+}
@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+#include "BakedScene.h"
+#include <cstdio>
+#include <fstream>
+
+using namespace Aftr;
+namespace
+{
+   TEST( BakedScene, bake_and_map_round_trip )
+   {
+      {
+         std::ofstream( "BakedScene_test_quad.wrl" ) << "#VRML V2.0 utf8\n"
+            "Shape { appearance Appearance { material Material { diffuseColor 0.5 0.25 1 } }\n"
+            "  geometry IndexedFaceSet { coord Coordinate { point [ 0 0 0, 2 0 0, 2 2 0, 0 2 0 ] } coordIndex [ 0 1 2 3 -1 ] } }\n";
+         std::ofstream( "BakedScene_test.scene" ) << "# two quads\n"
+            "model quad BakedScene_test_quad.wrl\n"
+            "place quad 1 2 3\n"
+            "place quad -5 0 0 90 0 0 2\n";
+      }
+
+      SceneDescription scene;
+      ASSERT_TRUE( scene.load( "BakedScene_test.scene" ) );
+      ASSERT_EQ( scene.placements.size(), 2u );
+      ASSERT_TRUE( bakeScene( scene, ".", "BakedScene_test.bscene" ) );
+
+      BakedScene baked;
+      ASSERT_TRUE( baked.open( "BakedScene_test.bscene" ) );
+      ASSERT_EQ( baked.getMeshCount(), 1u );
+      EXPECT_STREQ( baked.getMeshName( 0 ), "quad" );
+      EXPECT_EQ( baked.getMesh( 0 ).vertexCount, 4u );
+      EXPECT_EQ( baked.getMesh( 0 ).indexCount, 6u );
+      EXPECT_FLOAT_EQ( baked.getMesh( 0 ).color[1], 0.25f );
+      EXPECT_EQ( reinterpret_cast<uintptr_t>( baked.getVertices( 0 ) ) % 16, 0u );
+
+      // Position then an upward normal for the flat quad
+      const float* v = baked.getVertices( 0 );
+      EXPECT_FLOAT_EQ( v[6 * 2 + 0], 2.0f );
+      EXPECT_FLOAT_EQ( v[6 * 2 + 5], 1.0f );
+      EXPECT_EQ( baked.getIndices( 0 )[5], 3u );
+      EXPECT_EQ( baked.findMesh( "BakedScene_test_quad.wrl" ), 0u );
+      EXPECT_EQ( baked.findMesh( "/shared/mm/BakedScene_test_quad.wrl" ), 0u ); // As loadMap names it
+      EXPECT_EQ( baked.findMesh( "/shared/mm/OtherBakedScene_test_quad.wrl" ), BakedScene::NotFound );
+
+      ASSERT_EQ( baked.getPlacementCount(), 2u );
+      EXPECT_FLOAT_EQ( baked.getPlacement( 0 ).position[2], 3.0f );
+      EXPECT_NEAR( baked.getPlacement( 1 ).heading, 1.5707963f, 1e-5f );
+      EXPECT_FLOAT_EQ( baked.getPlacement( 1 ).scale, 2.0f );
+      baked.close();
+
+      // Rebaking replaces the file rather than truncating it, so the open blob still reads its own bytes
+      ASSERT_TRUE( baked.open( "BakedScene_test.bscene" ) );
+      const float* mapped = baked.getVertices( 0 );
+      scene.placements.clear();
+      ASSERT_TRUE( bakeScene( scene, ".", "BakedScene_test.bscene" ) );
+      EXPECT_FLOAT_EQ( mapped[6 * 2 + 0], 2.0f );
+      EXPECT_FALSE( std::ifstream( "BakedScene_test.bscene.tmp" ).good() );
+      baked.close();
+
+      std::string bytes;
+      {
+         std::ifstream in( "BakedScene_test.bscene", std::ios::binary );
+         bytes.assign( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+      }
+      auto rejects = [&baked]( const std::string& corrupt )
+      {
+         std::ofstream( "BakedScene_test.bscene", std::ios::binary ).write( corrupt.data(), corrupt.size() );
+         return !baked.open( "BakedScene_test.bscene" );
+      };
+      const BakedFormat::Header& h = *reinterpret_cast<const BakedFormat::Header*>( bytes.data() );
+      const BakedFormat::Mesh& m = *reinterpret_cast<const BakedFormat::Mesh*>( bytes.data() + h.meshTableOffset );
+
+      // A truncated file, a string table without its terminator and an index past the vertices
+      // are rejected rather than read past the end of their data
+      EXPECT_TRUE( rejects( bytes.substr( 0, bytes.size() - 8 ) ) );
+      std::string corrupt = bytes;
+      corrupt[h.stringOffset + h.stringBytes - 1] = 'x';
+      EXPECT_TRUE( rejects( corrupt ) );
+      corrupt = bytes;
+      reinterpret_cast<uint32_t*>( &corrupt[m.indexOffset] )[2] = m.vertexCount;
+      EXPECT_TRUE( rejects( corrupt ) );
+      EXPECT_FALSE( rejects( bytes ) );
+      baked.close();
+
+      std::remove( "BakedScene_test_quad.wrl" );
+      std::remove( "BakedScene_test.scene" );
+      std::remove( "BakedScene_test.bscene" );
+   }
+}
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+#include "ConfigRegistry.h"
+#include <cstdio>
+
+using namespace Aftr;
+namespace
+{
+   TEST( ConfigRegistry, resolves_typed_slots_once )
+   {
+      float gravity = -1.0f;
+      int seed = -1;
+      bool verbose = true;
+      std::string file = "unset";
+      ConfigRegistry r;
+      r.add( "gravityScalar", &gravity, 0.1f, 0.0f, 10.0f, "units/s^2", "Gravity" );
+      r.add( "windSeed", &seed, 1, 0, 100, "", "Seed" );
+      r.add( "verbose", &verbose, false, "Chatty logging" );
+      r.add( "windFieldFile", &file, "", "Wind grid" );
+
+      // Registration alone leaves every slot at its default
+      EXPECT_FLOAT_EQ( gravity, 0.1f );
+      EXPECT_EQ( seed, 1 );
+      EXPECT_FALSE( verbose );
+      EXPECT_EQ( file, "" );
+
+      auto values = ConfigRegistry::parseConf( "GravityScalar = 0.25 # lighter\nwindseed=500\nVerbose=yes\nwindFieldFile= wind/a.txt \n" );
+      int lookups = 0;
+      EXPECT_TRUE( r.resolve( [&]( const std::string& key )
+         {
+            ++lookups;
+            auto it = values.find( key );
+            return it != values.end() ? it->second : std::string();
+         } ) );
+      EXPECT_EQ( lookups, 4 );
+      EXPECT_FLOAT_EQ( gravity, 0.25f );
+      EXPECT_EQ( seed, 100 ); // Clamped into range
+      EXPECT_TRUE( verbose );
+      EXPECT_EQ( file, "wind/a.txt" );
+      r.dump( stdout, "test" );
+   }
+
+   TEST( ConfigRegistry, malformed_values_keep_defaults )
+   {
+      float gravity = 0.0f;
+      int seed = 0;
+      ConfigRegistry r;
+      r.add( "gravityScalar", &gravity, 0.1f, 0.0f, 10.0f, "units/s^2", "Gravity" );
+      r.add( "windSeed", &seed, 1, 0, 100, "", "Seed" );
+      EXPECT_FALSE( r.resolve( []( const std::string& key ) { return key == "gravityscalar" ? "heavy" : "2.5"; } ) );
+      EXPECT_FLOAT_EQ( gravity, 0.1f );
+      EXPECT_EQ( seed, 1 ); // Not an integer
+   }
+}
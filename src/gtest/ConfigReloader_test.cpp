@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+#include "ConfigReloader.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+using namespace Aftr;
+namespace
+{
+   TEST( SimParams, parses_known_keys_and_keeps_defaults )
+   {
+      SimParams p;
+      ASSERT_TRUE( SimParams::parse( "# comment\nwidth=800\nGravityScalar = 0.25\ncollisionDistance=12 # metres\n", p ) );
+      EXPECT_FLOAT_EQ( p.gravityScalar, 0.25f );
+      EXPECT_FLOAT_EQ( p.collisionDistance, 12.0f );
+      EXPECT_FLOAT_EQ( p.clippingPlane, 1000.0f );
+
+      SimParams q;
+      EXPECT_FALSE( SimParams::parse( "gravityScalar=heavy\n", q ) );
+      EXPECT_FLOAT_EQ( q.gravityScalar, 0.1f );
+   }
+
+   TEST( ConfigReloader, publishes_a_new_snapshot_when_the_file_changes )
+   {
+      std::ofstream( "ConfigReloader_test.conf" ) << "clippingPlane=500\n";
+      std::ofstream( "ConfigReloader_test.scn" ) << "scenario first\n";
+
+      ConfigReloader reloader;
+      reloader.start( "ConfigReloader_test.conf", "ConfigReloader_test.scn" );
+      std::shared_ptr<const SimParams> first = reloader.getParams();
+      EXPECT_FLOAT_EQ( first->clippingPlane, 500.0f );
+      ASSERT_NE( reloader.getScenario(), nullptr );
+      EXPECT_STREQ( reloader.getScenario()->getName(), "first" );
+
+      std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+      std::ofstream( "ConfigReloader_test.conf" ) << "clippingPlane=750\n";
+      std::ofstream( "ConfigReloader_test.scn" ) << "scenario second\n";
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 3 );
+      while( ( reloader.getParams() == first || std::string( reloader.getScenario()->getName() ) != "second" ) &&
+             std::chrono::steady_clock::now() < deadline )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+
+      EXPECT_FLOAT_EQ( reloader.getParams()->clippingPlane, 750.0f );
+      EXPECT_GT( reloader.getParams()->generation, first->generation );
+      EXPECT_FLOAT_EQ( first->clippingPlane, 500.0f ); // A held snapshot never changes underneath its reader
+      EXPECT_STREQ( reloader.getScenario()->getName(), "second" );
+
+      // A broken scenario keeps the running one
+      std::ofstream( "ConfigReloader_test.scn" ) << "scenario third\nteleport 1 2 3\n";
+      EXPECT_FALSE( reloader.reloadScenario() );
+      EXPECT_STREQ( reloader.getScenario()->getName(), "second" );
+
+      reloader.stop();
+      std::remove( "ConfigReloader_test.conf" );
+      std::remove( "ConfigReloader_test.scn" );
+   }
+}
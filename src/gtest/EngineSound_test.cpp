@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "EngineSound.h"
+#include <cmath>
+
+using namespace Aftr;
+namespace
+{
+   TEST( EngineSound, pitch_and_volume_ease_toward_thrust )
+   {
+      EngineSound sound;
+      const EngineSoundParams& p = sound.getParams();
+      const Vector zero{ 0, 0, 0 };
+      const Vector look{ 1, 0, 0 };
+      const Vector up{ 0, 0, 1 };
+
+      AudioFrame f = sound.update( zero, look, up, zero, zero, 1.0f, true, 1.0f / 60.0f );
+      EXPECT_GT( f.engine.playbackSpeed, p.idleSpeed );
+      EXPECT_LT( f.engine.playbackSpeed, p.idleSpeed + 0.2f * ( p.fullSpeed - p.idleSpeed ) ); // No step to full pitch
+      EXPECT_TRUE( f.engine.levelsChanged );
+
+      for( int i = 0; i < 600; ++i )
+         f = sound.update( zero, look, up, zero, zero, 1.0f, true, 1.0f / 60.0f );
+      EXPECT_NEAR( f.engine.playbackSpeed, p.fullSpeed, 1e-3f );
+      EXPECT_NEAR( f.engine.volume, p.fullVolume, 1e-3f );
+      EXPECT_FALSE( f.engine.levelsChanged ); // Settled: nothing new to send
+
+      for( int i = 0; i < 600; ++i )
+         f = sound.update( zero, look, up, zero, zero, 1.0f, false, 1.0f / 60.0f );
+      EXPECT_NEAR( f.engine.volume, 0.0f, 1e-3f );
+      EXPECT_NEAR( f.engine.playbackSpeed, p.idleSpeed, 1e-3f );
+   }
+
+   TEST( EngineSound, listener_velocity_comes_from_camera_motion )
+   {
+      EngineSound sound;
+      const Vector look{ 1, 0, 0 };
+      const Vector up{ 0, 0, 1 };
+      const Vector jetVel{ 5, 0, 0 };
+      const float dt = 0.1f;
+
+      AudioFrame f = sound.update( Vector{ 0, 0, 0 }, look, up, Vector{ 10, 0, 0 }, jetVel, 1.0f, true, dt );
+      EXPECT_FLOAT_EQ( f.listener.velocity.length(), 0.0f ); // No history yet
+      EXPECT_FLOAT_EQ( f.engine.velocity.x, 5.0f );
+
+      f = sound.update( Vector{ 0.5f, 0, 0 }, look, up, Vector{ 10.5f, 0, 0 }, jetVel, 1.0f, true, dt );
+      EXPECT_NEAR( f.listener.velocity.x, 5.0f, 1e-4f );
+
+      // A camera snap is clamped rather than reported as a huge velocity
+      f = sound.update( Vector{ 1000, 0, 0 }, look, up, Vector{ 10.5f, 0, 0 }, jetVel, 1.0f, true, dt );
+      EXPECT_NEAR( f.listener.velocity.length(), sound.getParams().maxSpeed, 1e-3f );
+
+      sound.reset();
+      f = sound.update( Vector{ 0, 0, 0 }, look, up, Vector{ 10.5f, 0, 0 }, jetVel, 1.0f, true, dt );
+      EXPECT_FLOAT_EQ( f.listener.velocity.length(), 0.0f );
+   }
+}
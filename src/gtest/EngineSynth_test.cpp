@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "EngineSynth.h"
+#include <cmath>
+#include <vector>
+
+using namespace Aftr;
+namespace
+{
+   std::vector<float> renderSeconds( EngineSynth& synth, float seconds )
+   {
+      std::vector<float> out( static_cast<size_t>( seconds * synth.getPreset().sampleRate ) / EngineSynth::BlockFrames * EngineSynth::BlockFrames );
+      for( size_t at = 0; at < out.size(); at += EngineSynth::BlockFrames )
+         synth.renderBlock( out.data() + at );
+      return out;
+   }
+
+   int zeroCrossings( const std::vector<float>& s, size_t from )
+   {
+      int n = 0;
+      for( size_t i = from + 1; i < s.size(); ++i )
+         n += ( s[i - 1] < 0.0f ) != ( s[i] < 0.0f );
+      return n;
+   }
+
+   TEST( EngineSynth, simd_and_scalar_paths_agree )
+   {
+      EngineSynthControls controls;
+      EngineSynthPreset preset;
+      EngineSynth simd( preset, &controls );
+      EngineSynth scalar( preset, &controls );
+      scalar.setUseSimd( false );
+
+      float a[EngineSynth::BlockFrames], b[EngineSynth::BlockFrames];
+      float worst = 0.0f;
+      for( int block = 0; block < 400; ++block )
+      {
+         controls.set( EngineSynthInput{ block / 400.0f, block < 200 ? 0.2f : 1.0f } );
+         simd.renderBlock( a );
+         scalar.renderBlock( b );
+         for( int i = 0; i < EngineSynth::BlockFrames; ++i )
+            worst = std::max( worst, std::abs( a[i] - b[i] ) );
+      }
+      EXPECT_LT( worst, 1e-3f );
+   }
+
+   TEST( EngineSynth, whine_pitch_follows_spool_and_roar_follows_thrust )
+   {
+      EngineSynthControls controls;
+      EngineSynthPreset preset;
+      preset.rumbleLevel = 0.0f;
+      preset.noiseLevel = 0.0f;
+      preset.detune = 0.0f;
+
+      EngineSynth idle( preset, &controls );
+      controls.set( EngineSynthInput{ 0.0f, 0.0f } );
+      const int idleCrossings = zeroCrossings( renderSeconds( idle, 1.0f ), 4096 );
+      EngineSynth full( preset, &controls );
+      controls.set( EngineSynthInput{ 1.0f, 0.0f } );
+      const int fullCrossings = zeroCrossings( renderSeconds( full, 1.0f ), 4096 );
+      EXPECT_NEAR( static_cast<float>( fullCrossings ) / idleCrossings, preset.fullShaftHz / preset.idleShaftHz, 0.1f );
+
+      EngineSynthPreset roarOnly;
+      roarOnly.whineLevel = roarOnly.rumbleLevel = 0.0f;
+      auto rms = [&]( float thrust ) {
+         EngineSynth s( roarOnly, &controls );
+         controls.set( EngineSynthInput{ 0.5f, thrust } );
+         const std::vector<float> out = renderSeconds( s, 0.5f );
+         double sum = 0.0;
+         for( float v : out )
+            sum += v * v;
+         return std::sqrt( sum / out.size() );
+      };
+      EXPECT_GT( rms( 1.0f ), 2.0 * rms( 0.0f ) );
+   }
+
+   TEST( EngineSynth, throttle_steps_ramp_instead_of_clicking )
+   {
+      EngineSynthControls controls;
+      EngineSynthPreset preset;
+      preset.noiseLevel = 0.0f; // Noise is allowed to jump sample to sample
+      EngineSynth synth( preset, &controls );
+      controls.set( EngineSynthInput{ 0.0f, 0.0f } );
+      renderSeconds( synth, 0.2f );
+
+      controls.set( EngineSynthInput{ 1.0f, 1.0f } );
+      const std::vector<float> out = renderSeconds( synth, 0.05f );
+      float largestStep = 0.0f;
+      for( size_t i = 1; i < out.size(); ++i )
+         largestStep = std::max( largestStep, std::abs( out[i] - out[i - 1] ) );
+      // The whine's own slope at full power is ~2*pi*f/rate per unit amplitude; a click would be far larger
+      EXPECT_LT( largestStep, 0.5f );
+   }
+}
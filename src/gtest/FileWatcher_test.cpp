@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+#include "FileWatcher.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+using namespace Aftr;
+namespace
+{
+   struct Changes
+   {
+      std::mutex m;
+      std::condition_variable cv;
+      std::vector<std::string> paths;
+
+      bool waitFor( size_t n )
+      {
+         std::unique_lock<std::mutex> lock( m );
+         return cv.wait_for( lock, std::chrono::seconds( 3 ), [&] { return paths.size() >= n; } );
+      }
+   };
+
+   TEST( FileWatcher, reports_in_place_writes_and_replacements_once )
+   {
+      std::ofstream( "FileWatcher_test_a.conf" ) << "a=1\n";
+      std::ofstream( "FileWatcher_test_b.conf" ) << "b=1\n";
+
+      Changes changes;
+      FileWatcher watcher;
+      watcher.watch( "FileWatcher_test_a.conf" );
+      watcher.start( [&]( const std::string& path )
+         {
+            std::lock_guard<std::mutex> lock( changes.m );
+            changes.paths.push_back( path );
+            changes.cv.notify_all();
+         }, 20, 50 );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+
+      // Several writes in a burst settle into one report; the unwatched file is never reported
+      for( int i = 0; i < 3; ++i )
+         std::ofstream( "FileWatcher_test_a.conf" ) << "a=" << i + 2 << "\n";
+      std::ofstream( "FileWatcher_test_b.conf" ) << "b=2\n";
+      ASSERT_TRUE( changes.waitFor( 1 ) );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+      {
+         std::lock_guard<std::mutex> lock( changes.m );
+         ASSERT_EQ( changes.paths.size(), 1u );
+         EXPECT_EQ( changes.paths[0], "FileWatcher_test_a.conf" );
+      }
+
+      // Editors that save by renaming a temp over the original are seen too
+      std::ofstream( "FileWatcher_test_a.conf.tmp" ) << "a=9\n";
+      std::rename( "FileWatcher_test_a.conf.tmp", "FileWatcher_test_a.conf" );
+      EXPECT_TRUE( changes.waitFor( 2 ) );
+
+      watcher.stop();
+      std::remove( "FileWatcher_test_a.conf" );
+      std::remove( "FileWatcher_test_b.conf" );
+   }
+}
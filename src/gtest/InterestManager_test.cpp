@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include "InterestManager.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace Aftr;
+namespace
+{
+   float lcg( uint32_t& s )
+   {
+      s = s * 1664525u + 1013904223u;
+      return ( s >> 8 ) * ( 1.0f / 16777216.0f );
+   }
+
+   TEST( InterestManager, grid_box_query_finds_every_point_in_overlapping_columns )
+   {
+      uint32_t seed = 7;
+      std::vector<Vector> points;
+      for( int i = 0; i < 2000; ++i )
+         points.push_back( Vector{ lcg( seed ) * 4000.0f - 2000.0f, lcg( seed ) * 4000.0f - 2000.0f, lcg( seed ) * 300.0f } );
+      SpatialGrid grid;
+      grid.build( points.data(), points.size(), 100.0f );
+
+      for( int q = 0; q < 50; ++q )
+      {
+         const Vector c{ lcg( seed ) * 4000.0f - 2000.0f, lcg( seed ) * 4000.0f - 2000.0f, 0.0f };
+         const Vector r{ 50.0f + lcg( seed ) * 400.0f, 50.0f + lcg( seed ) * 400.0f, 0.0f };
+         std::vector<uint32_t> found;
+         grid.queryBox( c - r, c + r, [&found]( uint32_t i ) { found.push_back( i ); } );
+
+         // Every point in the box is found, once; the extras are only from the columns' rounding
+         std::sort( found.begin(), found.end() );
+         EXPECT_TRUE( std::adjacent_find( found.begin(), found.end() ) == found.end() );
+         for( uint32_t i = 0; i < points.size(); ++i )
+         {
+            const Vector& p = points[i];
+            const bool inside = std::abs( p.x - c.x ) <= r.x && std::abs( p.y - c.y ) <= r.y;
+            const bool listed = std::binary_search( found.begin(), found.end(), i );
+            if( inside )
+            {
+               EXPECT_TRUE( listed ) << i;
+            }
+            if( listed )
+            {
+               EXPECT_TRUE( std::abs( p.x - c.x ) <= r.x + 100.0f && std::abs( p.y - c.y ) <= r.y + 100.0f ) << i;
+            }
+         }
+      }
+   }
+
+   TEST( InterestManager, near_aircraft_update_more_often_and_none_starve )
+   {
+      // A line of aircraft ahead of the client along +x, one far behind it, one far ahead in view
+      std::vector<Vector> positions;
+      std::vector<uint16_t> ids;
+      for( int i = 0; i < 20; ++i )
+      {
+         positions.push_back( Vector{ 20.0f + 19.0f * i, 0.0f, 50.0f } );
+         ids.push_back( static_cast<uint16_t>( i ) );
+      }
+      positions.push_back( Vector{ -1200.0f, 0.0f, 50.0f } ); // id 20: behind, and beyond view range either way
+      ids.push_back( 20 );
+      positions.push_back( Vector{ 900.0f, 0.0f, 50.0f } );  // id 21: outside the radius but in the frustum
+      ids.push_back( 21 );
+
+      InterestManager interest;
+      interest.build( positions.data(), ids.data(), positions.size() );
+      NetView view;
+      view.focus = Vector{ 0, 0, 50 };
+      view.eye = Vector{ -20, 0, 55 };
+      view.valid = true;
+
+      InterestManager::State state;
+      std::vector<int> sends( ids.size(), 0 );
+      const int perTick = 4;
+      for( int tick = 0; tick < 400; ++tick )
+      {
+         interest.prioritize( view, state );
+         EXPECT_EQ( state.order.size(), 21u );
+         EXPECT_TRUE( std::find( state.order.begin(), state.order.end(), 20 ) == state.order.end() );
+         for( int k = 0; k < perTick && k < static_cast<int>( state.order.size() ); ++k )
+         {
+            ++sends[state.order[k]];
+            state.accumulator[state.order[k]] = 0.0f;
+         }
+      }
+
+      EXPECT_EQ( sends[20], 0 );
+      for( int i = 0; i < 22; ++i )
+      {
+         if( i != 20 )
+         {
+            EXPECT_GE( sends[i], 10 ) << i; // Every relevant aircraft goes out at least every 40 ticks
+         }
+      }
+      EXPECT_GT( sends[0], 3 * sends[19] );
+      EXPECT_GT( sends[1], sends[10] );
+
+      // Looking the other way, the far aircraft ahead drops out; the one behind is beyond viewRange
+      view.look = Vector{ -1, 0, 0 };
+      interest.prioritize( view, state );
+      EXPECT_TRUE( std::find( state.order.begin(), state.order.end(), 21 ) == state.order.end() );
+      EXPECT_TRUE( std::find( state.order.begin(), state.order.end(), 20 ) == state.order.end() );
+
+      // maxRelevant keeps only the highest priorities
+      InterestParams few;
+      few.maxRelevant = 5;
+      InterestManager capped( few );
+      capped.build( positions.data(), ids.data(), positions.size() );
+      view.look = Vector{ 1, 0, 0 };
+      InterestManager::State cappedState;
+      capped.prioritize( view, cappedState );
+      ASSERT_EQ( cappedState.order.size(), 5u );
+      for( uint16_t id : cappedState.order )
+         EXPECT_LT( id, 5 );
+   }
+}
@@ -0,0 +1,188 @@
+#include "gtest/gtest.h"
+#include "JetPredictor.h"
+#include "Replication.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Aftr;
+namespace
+{
+   // A pilot who keeps weaving: full thrust, stick moving on slow sines, a crosswind
+   FlightControls weave( uint32_t tick )
+   {
+      FlightControls c;
+      c.thrust = 1.0f;
+      c.roll = 0.6f * std::sin( tick * 0.013f );
+      c.pitch = 0.3f * std::sin( tick * 0.007f + 1.0f );
+      c.yaw = 0.2f * std::cos( tick * 0.011f );
+      return c;
+   }
+
+   const Vector Crosswind{ 0.4f, -0.3f, 0.0f };
+
+   FlightState spawnState()
+   {
+      FlightState s;
+      s.position = Vector{ 10.0f, 20.0f, 40.0f };
+      s.heading = 0.5f;
+      return s;
+   }
+
+   void expectSame( const FlightState& a, const FlightState& b )
+   {
+      EXPECT_EQ( a.position.x, b.position.x );
+      EXPECT_EQ( a.position.y, b.position.y );
+      EXPECT_EQ( a.position.z, b.position.z );
+      EXPECT_EQ( a.heading, b.heading );
+      EXPECT_EQ( a.pitch, b.pitch );
+      EXPECT_EQ( a.roll, b.roll );
+      EXPECT_EQ( a.airspeed, b.airspeed );
+   }
+
+   TEST( JetPredictor, replays_pending_inputs_onto_a_correction )
+   {
+      const FlightModel model;
+      JetPredictor predictor( model );
+      predictor.respawn( spawnState() );
+
+      // The server steps the same inputs, but takes a knock at tick 50 the client never saw
+      FlightState server;
+      std::vector<JetInput> sent;
+      for( uint32_t t = 0; t < 100; ++t )
+      {
+         sent.push_back( predictor.step( weave( t ), Crosswind, 0.0f ) );
+         EXPECT_EQ( sent.back().seq, t + 1 );
+      }
+      ASSERT_TRUE( sent.front().respawn );
+      JetInput roundTrip;
+      uint8_t buf[JetInput::MaxPackedBytes];
+      ASSERT_EQ( sent.front().pack( buf ), JetInput::MaxPackedBytes );
+      ASSERT_EQ( JetInput::unpack( buf, sizeof( buf ), 1, roundTrip ), JetInput::MaxPackedBytes );
+      EXPECT_EQ( roundTrip.spawn.position.y, 20.0f );
+      EXPECT_EQ( sent[1].pack( buf ), JetInput::PackedBytes );
+
+      std::vector<FlightState> after;
+      for( const JetInput& in : sent )
+      {
+         stepJet( model, server, in );
+         if( in.seq == 50 )
+            server.position.z += 2.0f;
+         after.push_back( server );
+      }
+
+      // Acks up to the knock agree with what was predicted; the first one past it does not
+      EXPECT_FALSE( predictor.reconcile( 40, after[39] ) );
+      EXPECT_EQ( predictor.getPendingCount(), 60u );
+      EXPECT_TRUE( predictor.reconcile( 70, after[69] ) );
+      expectSame( predictor.getState(), after.back() );
+      EXPECT_EQ( predictor.getStats().replayedTicks, 30u );
+      EXPECT_NEAR( predictor.getRenderOffset().z, -2.0f, 0.01f ); // Drawn where it was, then eased across
+
+      for( int i = 0; i < 60; ++i )
+         predictor.decay( 1.0f / 60.0f );
+      EXPECT_EQ( predictor.getRenderOffset().length(), 0.0f );
+      EXPECT_FALSE( predictor.reconcile( 70, after[69] ) ); // Duplicates are ignored
+      EXPECT_FALSE( predictor.reconcile( 100, after[99] ) );
+   }
+
+   TEST( JetPredictor, replays_30_ticks_well_under_a_millisecond )
+   {
+      const FlightModel model;
+      JetPredictor predictor( model );
+      predictor.reset( spawnState() );
+      std::vector<double> replayMs;
+      for( uint32_t t = 0; t < 4000; ++t )
+      {
+         predictor.step( weave( t ), Crosswind, 0.0f );
+         if( t >= 30 && t % 10 == 0 )
+         {
+            FlightState wrong = predictor.getState();
+            wrong.position.x += 1.0f; // Any mismatch forces the whole replay
+            ASSERT_TRUE( predictor.reconcile( t + 1 - 30, wrong ) );
+            replayMs.push_back( predictor.getStats().lastReplayMs );
+         }
+      }
+      std::sort( replayMs.begin(), replayMs.end() );
+      const double median = replayMs[replayMs.size() / 2];
+      EXPECT_LT( median, 0.1 );
+      printf( "30-tick replay: median %.4f ms, worst %.4f ms\n", median, replayMs.back() );
+   }
+
+   TEST( JetPredictor, flies_against_the_server_over_a_lossy_link )
+   {
+      double now = 0.0;
+      auto clock = [&now]() { return now; };
+      LoopbackNetwork net;
+      std::unique_ptr<NetEndpoint> serverSocket = net.open( 4000 ), clientSocket = net.open(), watcherSocket = net.open();
+      NetConditions bad;
+      bad.lossPercent = 10.0f;
+      bad.latencyMs = 60.0f;
+      bad.jitterMs = 20.0f;
+      LinkSimulator serverLink( *serverSocket, bad, clock ), clientLink( *clientSocket, bad, clock );
+
+      // The server's jet is a little faster than the client believes, so predictions keep needing correction
+      FlightModelParams serverParams;
+      serverParams.maxAirspeed = 6.3f;
+      const FlightModel serverModel( serverParams ), clientModel;
+      ReplicationServer server( serverLink );
+      server.enableClientJets( serverModel );
+      ReplicationClient client( clientLink, serverSocket->getAddress() ), watcher( *watcherSocket, serverSocket->getAddress() );
+
+      JetPredictor predictor( clientModel );
+      predictor.respawn( spawnState() );
+      const float frame = 1.0f / 60.0f;
+      uint32_t worstLag = 0;
+      for( int f = 0; f < 60 * 10; ++f )
+      {
+         now = f / 60.0;
+         for( int tick = 0; tick < 2; ++tick )
+            client.sendInput( predictor.step( weave( predictor.getLastSeq() ), Crosswind, 0.0f ) );
+         client.update( frame );
+         watcher.update( frame );
+         server.update( frame, nullptr, 0 );
+
+         uint32_t seq;
+         FlightState authoritative;
+         if( client.takeJetState( seq, authoritative ) )
+            predictor.reconcile( seq, authoritative );
+         predictor.decay( frame );
+         if( f > 60 ) // Once connected
+            worstLag = std::max( worstLag, predictor.getPendingCount() );
+      }
+
+      // Let the last inputs land, then the client agrees with the server on every one of them
+      for( int f = 0; f < 60; ++f )
+      {
+         now += frame;
+         client.update( frame );
+         server.update( frame, nullptr, 0 );
+         uint32_t seq;
+         FlightState authoritative;
+         if( client.takeJetState( seq, authoritative ) )
+            predictor.reconcile( seq, authoritative );
+      }
+      ASSERT_EQ( server.getClientCount(), 2u );
+      const size_t pilot = server.getClientStats( 0 ).inputSeq > 0 ? 0 : 1; // The watcher sends no inputs
+      const ReplicationServer::ClientStats& flying = server.getClientStats( pilot );
+      EXPECT_EQ( flying.inputSeq, predictor.getLastSeq() );
+      EXPECT_EQ( predictor.getPendingCount(), 0u );
+      FlightState serverJet;
+      ASSERT_TRUE( server.getClientJet( pilot, serverJet ) );
+      expectSame( predictor.getState(), serverJet );
+
+      const JetPredictor::Stats& stats = predictor.getStats();
+      EXPECT_GT( stats.corrections, 10u );
+      EXPECT_EQ( stats.snaps, 0u );
+      EXPECT_LT( stats.maxReplayMs, 1.0 );
+      EXPECT_LT( flying.inputsLost, 5u ); // Redundancy covers 10% loss
+      EXPECT_LT( worstLag, JetPredictor::Capacity ); // Round trip, snapshot interval and lost states, but never past the ring
+
+      // The watcher sees the jet as an ordinary aircraft; the pilot is not sent their own
+      ASSERT_EQ( watcher.getAircraft().size(), 1u );
+      EXPECT_GE( watcher.getAircraft()[0].id, NetFormat::FirstClientJetId );
+      EXPECT_TRUE( client.getAircraft().empty() );
+      printf( "Prediction over 10%% loss, 60 ms: %llu corrections, %.1f ticks replayed each, worst %.4f ms\n",
+              static_cast<unsigned long long>( stats.corrections ), stats.replayedTicks / static_cast<double>( stats.corrections ),
+              stats.maxReplayMs );
+   }
+}
@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+#include "LoadQueue.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+using namespace Aftr;
+namespace
+{
+   void waitForAll( const LoadQueue& q, size_t count )
+   {
+      for( int i = 0; i < 2000 && ( q.getPendingCount() > 0 || q.getCompletedCount() < count ); ++i )
+         std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+   }
+
+   TEST( LoadQueue, completes_in_priority_order_and_reports_texture_dependencies )
+   {
+      {
+         std::ofstream( "LoadQueue_test_model.wrl" ) << "Shape { appearance Appearance { texture ImageTexture { url \"LoadQueue_test_tex.jpg\" } } }\n";
+         std::ofstream( "LoadQueue_test_tex.jpg" ) << std::string( 1000, 'x' );
+      }
+
+      LoadQueue q;
+      uint32_t far = q.enqueue( "LoadQueue_test_model.wrl", 50.0f );
+      uint32_t missing = q.enqueue( "LoadQueue_test_missing.wrl", 20.0f );
+      uint32_t near = q.enqueue( "LoadQueue_test_tex.jpg", 10.0f );
+
+      // The model becomes most urgent before any worker runs
+      q.reprioritize( [far]( uint32_t id, float p ) { return id == far ? 1.0f : p; } );
+      q.start( 2 );
+      waitForAll( q, 3 );
+
+      LoadQueue::Result r;
+      ASSERT_TRUE( q.popCompleted( r ) );
+      EXPECT_EQ( r.id, far );
+      EXPECT_TRUE( r.ok );
+      ASSERT_EQ( r.dependencies.size(), 1u );
+      EXPECT_EQ( r.bytes, std::string( "Shape { appearance Appearance { texture ImageTexture { url \"LoadQueue_test_tex.jpg\" } } }\n" ).size() + 1000 );
+
+      ASSERT_TRUE( q.popCompleted( r ) );
+      EXPECT_EQ( r.id, near );
+      ASSERT_TRUE( q.popCompleted( r ) );
+      EXPECT_EQ( r.id, missing );
+      EXPECT_FALSE( r.ok );
+      EXPECT_FALSE( q.popCompleted( r ) );
+
+      q.stop();
+      std::remove( "LoadQueue_test_model.wrl" );
+      std::remove( "LoadQueue_test_tex.jpg" );
+   }
+}
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+#include "MeshSimplifier.h"
+#include "LodSelector.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace Aftr;
+namespace
+{
+   // Latitude/longitude sphere; fine enough that clustering has plenty to remove
+   IndexedMesh makeSphere( int rings, int segments, float radius )
+   {
+      IndexedMesh m;
+      for( int r = 0; r <= rings; ++r )
+         for( int s = 0; s < segments; ++s )
+         {
+            float th = 3.14159265f * r / rings, ph = 6.2831853f * s / segments;
+            m.points.push_back( Vector{ radius * std::sin( th ) * std::cos( ph ), radius * std::sin( th ) * std::sin( ph ), radius * std::cos( th ) } );
+         }
+      for( int r = 0; r < rings; ++r )
+         for( int s = 0; s < segments; ++s )
+         {
+            uint32_t a = r * segments + s, b = r * segments + ( s + 1 ) % segments;
+            uint32_t c = a + segments, d = b + segments;
+            m.triangles.insert( m.triangles.end(), { a, c, b, b, c, d } );
+         }
+      return m;
+   }
+
+   TEST( MeshSimplifier, clustering_reduces_and_stays_near_surface )
+   {
+      IndexedMesh sphere = makeSphere( 64, 128, 10.0f );
+      IndexedMesh lod = MeshSimplifier::clusterVertices( sphere, 2.0f );
+
+      EXPECT_LT( lod.triangleCount(), sphere.triangleCount() / 10 );
+      EXPECT_GT( lod.triangleCount(), 100u );
+      for( const Vector& p : lod.points )
+         EXPECT_NEAR( p.length(), 10.0f, 2.0f );
+      for( uint32_t idx : lod.triangles )
+         ASSERT_LT( idx, lod.points.size() );
+   }
+
+   TEST( MeshSimplifier, vrml_round_trip )
+   {
+      IndexedMesh sphere = makeSphere( 8, 12, 1.0f );
+      sphere.color[0] = 0.25f;
+      const char* path = "MeshSimplifier_test_round_trip.wrl";
+      ASSERT_TRUE( MeshSimplifier::writeVrml( path, sphere ) );
+
+      IndexedMesh back;
+      ASSERT_TRUE( MeshSimplifier::readVrml( path, back ) );
+      std::remove( path );
+      EXPECT_EQ( back.points.size(), sphere.points.size() );
+      EXPECT_EQ( back.triangles, sphere.triangles );
+      EXPECT_FLOAT_EQ( back.color[0], 0.25f );
+   }
+
+   TEST( MeshSimplifier, reads_quads_and_skips_texture_coordinates )
+   {
+      const char* path = "MeshSimplifier_test_quads.wrl";
+      {
+         std::ofstream f( path );
+         f << "#VRML V2.0 utf8\n"
+              "Shape { geometry IndexedFaceSet {\n"
+              "  coord Coordinate { point [ 0 0 0, 1 0 0, 1 1 0, 0 1 0 ] } # a unit quad\n"
+              "  texCoord TextureCoordinate { point [ 0 0, 1 0, 1 1, 0 1 ] }\n"
+              "  coordIndex [ 0, 1, 2, 3, -1 ]\n"
+              "  texCoordIndex [ 0, 1, 2, 3, -1 ]\n"
+              "} }\n";
+      }
+      IndexedMesh m;
+      ASSERT_TRUE( MeshSimplifier::readVrml( path, m ) );
+      std::remove( path );
+      EXPECT_EQ( m.points.size(), 4u );
+      EXPECT_EQ( m.triangleCount(), 2u );
+   }
+
+   TEST( LodSelector, hysteresis_prevents_flicker_at_a_threshold )
+   {
+      LodSelector sel;
+      sel.minPixels = { 200.0f, 60.0f, 12.0f }; // full, lod1, lod2, impostor
+      ASSERT_EQ( sel.levelCount(), 4 );
+
+      EXPECT_EQ( sel.select( LodSelector::Culled, 500.0f ), 0 );
+      EXPECT_EQ( sel.select( LodSelector::Culled, 5.0f ), 3 );
+
+      // Oscillating +-10% around the lod0/lod1 threshold keeps whichever level is current
+      uint8_t level = 0;
+      for( int i = 0; i < 20; ++i )
+      {
+         level = sel.select( level, i % 2 ? 220.0f : 180.0f );
+         EXPECT_EQ( level, 0 );
+      }
+      level = 1;
+      for( int i = 0; i < 20; ++i )
+      {
+         level = sel.select( level, i % 2 ? 220.0f : 180.0f );
+         EXPECT_EQ( level, 1 );
+      }
+
+      // Leaving the band switches
+      EXPECT_EQ( sel.select( 0, 160.0f ), 1 );
+      EXPECT_EQ( sel.select( 1, 240.0f ), 0 );
+   }
+
+   TEST( LodSelector, projected_size_halves_with_distance )
+   {
+      float near = LodSelector::projectedPixels( 5.0f, 100.0f, 1080.0f, 1.0f );
+      float far = LodSelector::projectedPixels( 5.0f, 200.0f, 1080.0f, 1.0f );
+      EXPECT_NEAR( near / far, 2.0f, 1e-4f );
+      EXPECT_NEAR( near, 10.0f / ( 100.0f * std::tan( 0.5f ) ) * 540.0f, 1e-2f );
+   }
+}
@@ -0,0 +1,200 @@
+#include "gtest/gtest.h"
+#include "Replication.h"
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+using namespace Aftr;
+namespace
+{
+   // Aircraft i flies a circle of its own; positions at time t are exact, so the client can be checked against them.
+   std::vector<NetAircraft> circling( int count, double t )
+   {
+      std::vector<NetAircraft> out( count );
+      for( int i = 0; i < count; ++i )
+      {
+         const float radius = 60.0f + 3.0f * i;
+         const float rate = ( i % 2 == 0 ? 6.0f : -6.0f ) / radius; // 6 units/sec, alternating directions
+         const float angle = static_cast<float>( rate * t ) + 0.1f * i;
+         NetAircraft& a = out[i];
+         a.id = static_cast<uint16_t>( i );
+         a.position = Vector{ radius * std::cos( angle ), radius * std::sin( angle ), 40.0f + i };
+         a.velocity = Vector{ -radius * rate * std::sin( angle ), radius * rate * std::cos( angle ), 0.0f };
+         a.heading = std::atan2( a.velocity.y, a.velocity.x );
+         a.roll = rate > 0 ? 0.3f : -0.3f;
+      }
+      return out;
+   }
+
+   TEST( Replication, tracks_64_aircraft_over_a_lossy_link_within_budget )
+   {
+      double now = 0.0;
+      auto clock = [&now]() { return now; };
+      LoopbackNetwork net;
+      std::unique_ptr<NetEndpoint> serverSocket = net.open( 4000 ), clientSocket = net.open();
+      NetConditions bad;
+      bad.lossPercent = 10.0f;
+      bad.latencyMs = 40.0f;
+      bad.jitterMs = 20.0f;
+      LinkSimulator serverLink( *serverSocket, bad, clock ), clientLink( *clientSocket, bad, clock );
+
+      ReplicationServer server( serverLink );
+      ReplicationClient client( clientLink, serverSocket->getAddress() );
+
+      const int count = NetFormat::BudgetAircraft;
+      const float frame = 1.0f / 60.0f;
+      uint64_t bytesAtWarmup = 0;
+      float worst = 0.0f;
+      int checked = 0;
+      for( int f = 0; f < 60 * 20; ++f )
+      {
+         now = f / 60.0;
+         if( f % 3 == 0 ) // Snapshots are due every 50 ms; ticks are published at exactly tick / 20 seconds
+            server.update( 0.05f, circling( count, ( server.getTick() + 1 ) / 20.0 ).data(), count );
+         client.update( frame );
+
+         if( f == 60 * 5 )
+         {
+            ASSERT_EQ( server.getClientCount(), 1u );
+            bytesAtWarmup = server.getClientStats( 0 ).bytes;
+         }
+         if( f > 60 * 5 && client.isConnected() )
+         {
+            ASSERT_EQ( client.getAircraft().size(), static_cast<size_t>( count ) );
+            const std::vector<NetAircraft> truth = circling( count, client.getRenderTime() );
+            for( const NetAircraft& a : client.getAircraft() )
+               worst = std::max( worst, ( a.position - truth[a.id].position ).length() );
+            ++checked;
+         }
+      }
+
+      EXPECT_GT( checked, 60 * 14 );
+      EXPECT_LT( worst, 0.15f ); // Quantization, interpolation chords and dead reckoning through lost snapshots
+      EXPECT_GT( client.getStats().lost, 0u );
+      EXPECT_EQ( client.getStats().undecodable, 0u );
+
+      const double bytesPerSec = ( server.getClientStats( 0 ).bytes - bytesAtWarmup ) / 15.0;
+      EXPECT_LT( bytesPerSec, NetFormat::BudgetBytesPerSec );
+      // Deltas are what keeps it there: whole states would cost well over the budget
+      EXPECT_LT( server.getClientStats( 0 ).fullStates, server.getClientStats( 0 ).aircraftSent / 10 );
+      printf( "64 aircraft: %.0f bytes/sec, worst error %.3f units\n", bytesPerSec, worst );
+   }
+
+   TEST( Replication, snapshots_stay_under_the_mtu_and_rotate_aircraft_that_do_not_fit )
+   {
+      LoopbackNetwork net;
+      std::unique_ptr<NetEndpoint> serverSocket = net.open(), clientSocket = net.open();
+      ReplicationServer server( *serverSocket );
+      ReplicationClient client( *clientSocket, serverSocket->getAddress() );
+
+      client.update( 0.0f ); // HELLO
+      const int count = 300;
+      for( int i = 0; i < 12; ++i )
+      {
+         std::vector<NetAircraft> all = circling( count, i * 0.05 );
+         server.update( 0.05f, all.data(), all.size() );
+         client.update( 0.05f );
+         EXPECT_LE( server.getClientStats( 0 ).bytes / server.getClientStats( 0 ).packets,
+                    NetFormat::MaxPacketBytes + NetFormat::UdpOverheadBytes );
+      }
+      // Over a dozen ticks every aircraft has arrived, whole states first and deltas once acked
+      EXPECT_EQ( client.getAircraft().size(), static_cast<size_t>( count ) );
+      EXPECT_GT( server.getClientStats( 0 ).aircraftSent, server.getClientStats( 0 ).fullStates );
+   }
+
+   TEST( Replication, runs_over_udp_loopback )
+   {
+      NetAddress parsed;
+      EXPECT_TRUE( NetAddress::parse( "127.0.0.1:4000", 1, parsed ) );
+      EXPECT_EQ( parsed.toString(), "127.0.0.1:4000" );
+      EXPECT_TRUE( NetAddress::parse( "localhost", 1234, parsed ) );
+      EXPECT_EQ( parsed, ( NetAddress{ NetAddress::Loopback, 1234 } ) );
+      EXPECT_FALSE( NetAddress::parse( "127.0.0:4000", 1, parsed ) );
+
+      UdpEndpoint serverSocket, clientSocket;
+      if( !serverSocket.open( 0, true ) || !clientSocket.open( 0, true ) )
+         GTEST_SKIP() << "No UDP sockets in this environment";
+
+      ReplicationServer server( serverSocket );
+      ReplicationClient client( clientSocket, serverSocket.getAddress() );
+      std::vector<NetAircraft> aircraft = circling( 8, 0.0 );
+      for( int i = 0; i < 200 && client.getAircraft().size() < aircraft.size(); ++i )
+      {
+         client.update( 0.05f );
+         server.update( 0.05f, aircraft.data(), aircraft.size() );
+         std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+      }
+      ASSERT_EQ( client.getAircraft().size(), aircraft.size() );
+      EXPECT_TRUE( client.isConnected() );
+   }
+
+   TEST( Replication, interest_limits_each_client_to_its_airspace_within_budget )
+   {
+      // 1024 aircraft on a 32 x 32 lattice 150 units apart, each on a small circle of its own
+      auto sky = []( double t )
+      {
+         std::vector<NetAircraft> out( 1024 );
+         for( int i = 0; i < 1024; ++i )
+         {
+            const float angle = static_cast<float>( 0.2 * t ) + i;
+            out[i].id = static_cast<uint16_t>( i );
+            out[i].position = Vector{ ( i % 32 ) * 150.0f + 20.0f * std::cos( angle ), ( i / 32 ) * 150.0f + 20.0f * std::sin( angle ), 60.0f };
+            out[i].velocity = Vector{ -4.0f * std::sin( angle ), 4.0f * std::cos( angle ), 0.0f };
+         }
+         return out;
+      };
+
+      LoopbackNetwork net;
+      std::unique_ptr<NetEndpoint> serverSocket = net.open();
+      ReplicationServer server( *serverSocket );
+      std::vector<std::unique_ptr<NetEndpoint>> sockets;
+      std::vector<std::unique_ptr<ReplicationClient>> clients;
+      std::vector<NetView> views;
+      for( int c = 0; c < 4; ++c )
+      {
+         NetView v;
+         v.focus = Vector{ 600.0f + 3000.0f * ( c % 2 ), 600.0f + 3000.0f * ( c / 2 ), 60.0f };
+         v.eye = v.focus - Vector{ 30.0f, 0.0f, -10.0f };
+         v.look = c < 2 ? Vector{ 1, 0, 0 } : Vector{ 0, 1, 0 };
+         views.push_back( v );
+         sockets.push_back( net.open() );
+         clients.push_back( std::make_unique<ReplicationClient>( *sockets.back(), serverSocket->getAddress() ) );
+         clients.back()->setView( v );
+      }
+
+      for( int i = 0; i < 20 * 8; ++i )
+      {
+         for( auto& c : clients )
+            c->update( 0.05f );
+         std::vector<NetAircraft> all = sky( ( server.getTick() + 1 ) / 20.0 );
+         server.update( 0.05f, all.data(), all.size() );
+      }
+
+      const ReplicationParams params;
+      ASSERT_EQ( server.getClientCount(), 4u );
+      for( size_t i = 0; i < server.getClientCount(); ++i )
+      {
+         const ReplicationServer::ClientStats& s = server.getClientStats( i );
+         EXPECT_LE( s.bytesPerSecond, params.budgetBytesPerSec * 1.05 );
+         EXPECT_LE( s.relevant, params.interest.maxRelevant );
+         EXPECT_GT( s.relevant, 20 );
+      }
+      EXPECT_LE( server.getBytesPerClientPerSecond(), params.budgetBytesPerSec );
+
+      for( size_t c = 0; c < clients.size(); ++c )
+      {
+         const NetView& v = views[c];
+         EXPECT_GT( clients[c]->getAircraft().size(), 20u );
+         for( const NetAircraft& a : clients[c]->getAircraft() )
+         {
+            // Near the client's jet, or ahead of its camera and within view range (with slack for the drop-out delay)
+            const Vector toEye = a.position - v.eye;
+            const bool near = ( a.position - v.focus ).length() <= params.interest.relevanceRadius + 50.0f;
+            const bool ahead = toEye.dotProduct( v.look ) > 0.0f && toEye.length() <= params.interest.viewRange + 50.0f;
+            EXPECT_TRUE( near || ahead ) << "client " << c << " aircraft " << a.id;
+         }
+      }
+      printf( "1024 aircraft, 4 clients: %.0f bytes/client/sec, %d relevant to the first\n", server.getBytesPerClientPerSecond(),
+              server.getClientStats( 0 ).relevant );
+   }
+}
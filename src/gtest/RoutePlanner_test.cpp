@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+#include "RoutePlanner.h"
+#include <vector>
+
+using namespace Aftr;
+namespace
+{
+   TEST( RoutePlanner, routes_around_obstacles_and_replans_incrementally )
+   {
+      RoutePlanner planner;
+      planner.init( Vector{ -100, -100, 0 }, 50, 50, 10, 4.0f, 2.0f );
+
+      // A wall across the direct path with a gap at the +y end
+      planner.addObstacle( Vector{ 20, -100, 0 }, Vector{ 24, 60, 40 } );
+
+      const Vector start{ 0, 0, 10 }, goal{ 60, 0, 10 };
+      std::vector<Vector> route;
+      ASSERT_TRUE( planner.plan( start, goal, route ) );
+      const size_t fullExpansions = planner.getLastExpansions();
+      ASSERT_FALSE( route.empty() );
+      EXPECT_TRUE( route.back() == goal );
+
+      Vector prev = start;
+      for( const Vector& wp : route )
+      {
+         EXPECT_TRUE( planner.getGrid().lineOfSight( prev, wp ) );
+         prev = wp;
+      }
+
+      // A small obstacle near the goal should only repair part of the search
+      int id = planner.addObstacle( Vector{ 40, 60, 0 }, Vector{ 44, 64, 20 } );
+      ASSERT_TRUE( planner.plan( start, goal, route ) );
+      EXPECT_LT( planner.getLastExpansions(), fullExpansions / 2 );
+
+      planner.removeObstacle( id );
+      EXPECT_TRUE( planner.plan( start, goal, route ) );
+
+      // Sealing the gap makes the goal unreachable at this altitude band
+      planner.addObstacle( Vector{ 20, 60, 0 }, Vector{ 24, 100, 40 } );
+      EXPECT_FALSE( planner.plan( start, goal, route ) );
+   }
+}
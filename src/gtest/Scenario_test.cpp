@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+#include "Scenario.h"
+#include "FlightModel.h"
+#include <cstdio>
+#include <fstream>
+
+using namespace Aftr;
+namespace
+{
+   const char* source =
+      "scenario test-run # trailing comment\n"
+      "light 0.25\n"
+      "sky images/day.jpg\n"
+      "object Grass models/grass.wrl 0 0 0 1 1 1 5 0.4 285\n"
+      "object Marker models/cube.wrl 1 2 3\n"
+      "start 0 0 1.1 90 2\n"
+      "obstacle 50 0 10 8\n"
+      "waypoint 60 0 20\n"
+      "waypoint 0 0 20\n"
+      "objective reach 60 0 20 5\n"
+      "objective land 0 0 1.1 10 30\n";
+
+   TEST( Scenario, compile_and_read_round_trip )
+   {
+      ScenarioSource s;
+      ASSERT_TRUE( s.parse( source, "test" ) );
+      Scenario sc;
+      ASSERT_TRUE( sc.openCompiled( compileScenario( s ), "test" ) );
+
+      EXPECT_STREQ( sc.getName(), "test-run" );
+      EXPECT_FLOAT_EQ( sc.getHeader().ambient, 0.25f );
+      ASSERT_EQ( sc.getSkyCount(), 1u );
+      EXPECT_STREQ( sc.getSky( 0 ), "images/day.jpg" );
+
+      ASSERT_EQ( sc.getObjectCount(), 2u );
+      EXPECT_STREQ( sc.string( sc.getObject( 0 ).modelOffset ), "models/grass.wrl" );
+      EXPECT_FLOAT_EQ( sc.getObject( 0 ).cullRadius, 285.0f );
+      EXPECT_STREQ( sc.string( sc.getObject( 1 ).labelOffset ), "Marker" );
+      EXPECT_FLOAT_EQ( sc.getObject( 1 ).scale[2], 1.0f ); // Defaults survive a short line
+      EXPECT_FLOAT_EQ( sc.getObject( 1 ).texRepeat, 0.0f );
+
+      EXPECT_NEAR( sc.getHeader().startHeading, 1.5707963f, 1e-5f );
+      EXPECT_FLOAT_EQ( sc.getHeader().startAirspeed, 2.0f );
+      EXPECT_FLOAT_EQ( sc.getCube().x, 10.0f );
+      ASSERT_EQ( sc.getRoute().size(), 2u );
+      EXPECT_FLOAT_EQ( sc.getRoute()[0].x, 60.0f );
+      ASSERT_EQ( sc.getObjectiveCount(), 2u );
+      EXPECT_EQ( sc.getObjective( 1 ).kind, ScenarioFormat::okLAND );
+      EXPECT_FLOAT_EQ( sc.getObjective( 1 ).timeLimitSec, 30.0f );
+   }
+
+   TEST( Scenario, text_and_compiled_files_open_alike )
+   {
+      ScenarioSource s;
+      ASSERT_TRUE( s.parse( source, "test" ) );
+      std::ofstream( "Scenario_test.scn" ) << source;
+      {
+         const std::string bytes = compileScenario( s );
+         std::ofstream( "Scenario_test.scnb", std::ios::binary ).write( bytes.data(), bytes.size() );
+      }
+
+      Scenario text, compiled;
+      ASSERT_TRUE( text.open( "Scenario_test.scn" ) );
+      ASSERT_TRUE( compiled.open( "Scenario_test.scnb" ) );
+      EXPECT_STREQ( text.getName(), compiled.getName() );
+      EXPECT_EQ( text.getHeader().fileSize, compiled.getHeader().fileSize );
+      EXPECT_FLOAT_EQ( compiled.getObstacle( 0 ).size, 8.0f );
+      compiled.close();
+      text.close();
+
+      std::remove( "Scenario_test.scn" );
+      std::remove( "Scenario_test.scnb" );
+   }
+
+   TEST( Scenario, rejects_malformed_input )
+   {
+      ScenarioSource s;
+      EXPECT_FALSE( s.parse( "object Grass models/grass.wrl 0 0\n", "test" ) );
+      EXPECT_FALSE( s.parse( "objective orbit 0 0 0 5\n", "test" ) );
+      EXPECT_FALSE( s.parse( "teleport 1 2 3\n", "test" ) );
+      EXPECT_FALSE( s.parse( "planner 0 0 0 100 -5 16 4 3\n", "test" ) );
+      EXPECT_FALSE( s.parse( "planner 0 0 0 100 0 16 4 3\n", "test" ) );
+      EXPECT_FALSE( s.parse( "planner 0 0 0 4096 4096 2 4 3\n", "test" ) );
+      EXPECT_TRUE( s.parse( "planner 0 0 0 4096 4096 1 4 3\n", "test" ) );
+
+      ASSERT_TRUE( s.parse( source, "test" ) );
+      std::string bytes = compileScenario( s );
+      Scenario sc;
+      EXPECT_FALSE( sc.openCompiled( bytes.substr( 0, bytes.size() - 4 ), "truncated" ) );
+
+      // An object pointing past the string table is caught before anything reads through it
+      ScenarioFormat::Object* o = reinterpret_cast<ScenarioFormat::Object*>( &bytes[sizeof( ScenarioFormat::Header )] );
+      o->modelOffset = 1u << 20;
+      EXPECT_FALSE( sc.openCompiled( bytes, "corrupt" ) );
+      EXPECT_FALSE( sc.isOpen() );
+
+      // As is a planner grid whose cell count would overflow OccupancyGrid's int indices
+      bytes = compileScenario( s );
+      ScenarioFormat::Header* h = reinterpret_cast<ScenarioFormat::Header*>( &bytes[0] );
+      h->plannerCells[0] = h->plannerCells[1] = h->plannerCells[2] = 2048;
+      EXPECT_FALSE( sc.openCompiled( bytes, "huge grid" ) );
+   }
+
+   TEST( Scenario, objective_tracker )
+   {
+      ScenarioSource s;
+      ASSERT_TRUE( s.parse( source, "test" ) );
+      Scenario sc;
+      ASSERT_TRUE( sc.openCompiled( compileScenario( s ), "test" ) );
+
+      ObjectiveTracker tracker;
+      tracker.reset( sc );
+      FlightState f;
+      f.position = Vector( 58, 1, 19 );
+      f.airspeed = 4.0f;
+      EXPECT_EQ( tracker.update( sc, f, 10.0f, 1.1f ), 1 );
+      EXPECT_EQ( tracker.getStatus( 0 ), ObjectiveTracker::Status::DONE );
+      EXPECT_FLOAT_EQ( tracker.getCompletedAt( 0 ), 10.0f );
+
+      // Over the landing spot but still flying, then past its time limit
+      f.position = Vector( 0, 0, 1.1f );
+      EXPECT_EQ( tracker.update( sc, f, 20.0f, 1.1f ), 0 );
+      EXPECT_EQ( tracker.update( sc, f, 31.0f, 1.1f ), 0 );
+      EXPECT_EQ( tracker.getStatus( 1 ), ObjectiveTracker::Status::FAILED );
+      EXPECT_TRUE( tracker.isFinished() );
+      EXPECT_EQ( tracker.getCompleted(), 1 );
+
+      EXPECT_TRUE( tracker.hitsObstacle( sc, Vector( 53, 3, 12 ), 0.0f ) );
+      EXPECT_FALSE( tracker.hitsObstacle( sc, Vector( 56, 0, 10 ), 1.0f ) );
+      EXPECT_TRUE( tracker.hitsObstacle( sc, Vector( 56, 0, 10 ), 2.5f ) );
+   }
+}
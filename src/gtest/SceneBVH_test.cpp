@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+#include "SceneBVH.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Aftr;
+namespace
+{
+   TEST( SceneBVH, frustum_query_matches_brute_force )
+   {
+      std::mt19937 rng( 7 );
+      std::uniform_real_distribution<float> pos( -500.0f, 500.0f ), size( 0.5f, 6.0f );
+
+      const int count = 10000;
+      std::vector<Aabb> boxes( count );
+      std::vector<int> proxies( count );
+      SceneBVH bvh;
+      for( int i = 0; i < count; ++i )
+      {
+         Vector c{ pos( rng ), pos( rng ), pos( rng ) * 0.1f + 50.0f };
+         float s = size( rng );
+         boxes[i] = Aabb{ c - Vector{ s, s, s }, c + Vector{ s, s, s } };
+         proxies[i] = bvh.createProxy( boxes[i], i );
+      }
+
+      // Move a third of the boxes; small moves stay inside their fat boxes
+      for( int i = 0; i < count; i += 3 )
+      {
+         Vector d{ ( i % 7 ) * 1.5f, 0, 0 };
+         boxes[i] = Aabb{ boxes[i].lo + d, boxes[i].hi + d };
+         bvh.moveProxy( proxies[i], boxes[i] );
+      }
+
+      Frustum f = Frustum::fromCamera( Vector{ 0, 0, 50 }, Vector{ 1, 0.3f, -0.1f }, Vector{ 0, 0, 1 }, 1.0f, 16.0f / 9.0f, 0.1f, 400.0f );
+
+      std::vector<char> hit( count, 0 );
+      auto start = std::chrono::steady_clock::now();
+      bvh.queryFrustum( f, [&hit]( int id ) { hit[id] = 1; } );
+      std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+
+      int visible = 0, reported = 0;
+      for( int i = 0; i < count; ++i )
+      {
+         const bool expected = f.classify( boxes[i] ) != Frustum::OUTSIDE;
+         if( expected )
+         {
+            ++visible;
+            EXPECT_TRUE( hit[i] ) << "box " << i << " visible but culled";
+         }
+         reported += hit[i];
+      }
+      EXPECT_GT( visible, 0 );
+      EXPECT_LT( reported, count / 2 );
+      EXPECT_LT( bvh.getLastNodesTested(), static_cast<size_t>( count ) );
+      printf( "Culled %d boxes to %d (%d truly visible) testing %zu nodes in %.3f ms, tree height %d\n",
+              count, reported, visible, bvh.getLastNodesTested(), ms.count(), bvh.getHeight() );
+
+      for( int i = 0; i < count; i += 2 )
+         bvh.destroyProxy( proxies[i] );
+      int remaining = 0;
+      bvh.queryFrustum( Frustum::fromCamera( Vector{ 0, 0, 50 }, Vector{ 1, 0, 0 }, Vector{ 0, 0, 1 }, 3.0f, 1.0f, 0.0f, 1e6f ), [&]( int id ) { EXPECT_EQ( id % 2, 1 ); ++remaining; } );
+      EXPECT_GT( remaining, 0 );
+   }
+}
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+#include "VoiceManager.h"
+
+using namespace Aftr;
+namespace
+{
+   VoiceManager::Emitter at( float x, float priority = 1.0f )
+   {
+      VoiceManager::Emitter e;
+      e.position = Vector{ x, 0, 0 };
+      e.priority = priority;
+      return e;
+   }
+
+   TEST( VoiceManager, only_the_most_audible_emitters_get_real_voices )
+   {
+      AudioBank bank; // No engine: selection runs, nothing plays
+      VoiceManagerParams p;
+      p.maxRealVoices = 8;
+      VoiceManager voices( bank, p );
+
+      std::vector<int> ids;
+      for( int i = 0; i < 100; ++i )
+         ids.push_back( voices.add( at( 20.0f + 10.0f * i ) ) );
+      voices.update( Vector{ 0, 0, 0 }, 0.016f );
+
+      EXPECT_EQ( voices.getRealCount(), 8 );
+      EXPECT_EQ( voices.getVirtualCount(), 92 );
+      for( int i = 0; i < 100; ++i )
+         EXPECT_EQ( voices.isReal( ids[i] ), i < 8 ) << i;
+
+      // A high priority emitter far away still outranks the nearby ones
+      int important = voices.add( at( 500.0f, 100.0f ) );
+      voices.update( Vector{ 0, 0, 0 }, 0.016f );
+      EXPECT_TRUE( voices.isReal( important ) );
+      EXPECT_FALSE( voices.isReal( ids[7] ) );
+      EXPECT_EQ( voices.getRealCount(), 8 );
+   }
+
+   TEST( VoiceManager, reranks_at_the_evaluation_rate_with_hysteresis )
+   {
+      AudioBank bank;
+      VoiceManagerParams p;
+      p.maxRealVoices = 1;
+      p.evaluateHz = 4.0f;
+      VoiceManager voices( bank, p );
+
+      int a = voices.add( at( 20.0f ) );
+      int b = voices.add( at( 22.0f ) );
+      voices.update( Vector{ 0, 0, 0 }, 0.016f );
+      ASSERT_TRUE( voices.isReal( a ) );
+
+      // b is now slightly closer, but not by the hysteresis margin
+      voices.move( b, Vector{ 19.0f, 0, 0 }, Vector{ 0, 0, 0 } );
+      voices.update( Vector{ 0, 0, 0 }, 0.3f );
+      EXPECT_TRUE( voices.isReal( a ) );
+
+      // Much closer: it wins, but only once the next evaluation is due
+      voices.move( b, Vector{ 5.0f, 0, 0 }, Vector{ 0, 0, 0 } );
+      voices.move( a, Vector{ 60.0f, 0, 0 }, Vector{ 0, 0, 0 } );
+      voices.update( Vector{ 0, 0, 0 }, 0.1f );
+      EXPECT_TRUE( voices.isReal( a ) );
+      voices.update( Vector{ 0, 0, 0 }, 0.2f );
+      EXPECT_TRUE( voices.isReal( b ) );
+      EXPECT_FALSE( voices.isReal( a ) );
+   }
+
+   TEST( VoiceManager, virtual_one_shots_finish_on_time_and_inaudible_ones_stay_virtual )
+   {
+      AudioBank bank;
+      VoiceManagerParams p;
+      p.defaultOneShotSec = 1.0f;
+      VoiceManager voices( bank, p );
+
+      VoiceManager::Emitter bang = at( 10.0f );
+      bang.looped = false;
+      int id = voices.add( bang );
+      int silent = voices.add( at( 1.0e6f ) );
+      voices.update( Vector{ 0, 0, 0 }, 0.5f );
+      EXPECT_TRUE( voices.isValid( id ) );
+      EXPECT_FALSE( voices.isReal( silent ) );
+      voices.update( Vector{ 0, 0, 0 }, 0.6f );
+      EXPECT_FALSE( voices.isValid( id ) );
+      EXPECT_EQ( voices.getVirtualCount(), 1 );
+
+      voices.remove( silent );
+      voices.update( Vector{ 0, 0, 0 }, 0.1f );
+      EXPECT_EQ( voices.getRealCount() + voices.getVirtualCount(), 0 );
+   }
+
+   TEST( VoiceManager, records_when_each_sound_fired )
+   {
+      AudioBank bank;
+      VoiceManager voices( bank );
+      voices.setRecordEvents( true );
+
+      VoiceManager::Emitter engine = at( 0.0f );
+      voices.add( engine );
+      for( int i = 0; i < 60; ++i )
+         voices.update( Vector{ 0, 0, 0 }, 1.0f / 60.0f );
+      VoiceManager::Emitter bang = at( 5.0f );
+      bang.sound = SoundId::EXPLOSION;
+      bang.looped = false;
+      voices.add( bang );
+
+      const std::vector<VoiceManager::Event>& events = voices.getEvents();
+      ASSERT_EQ( events.size(), 2u );
+      EXPECT_EQ( events[0].sound, SoundId::ENGINE_LOOP );
+      EXPECT_FLOAT_EQ( events[0].timeSec, 0.0f );
+      EXPECT_EQ( events[1].sound, SoundId::EXPLOSION );
+      EXPECT_NEAR( events[1].timeSec, 1.0f, 1e-4f );
+      EXPECT_FLOAT_EQ( events[1].position.x, 5.0f );
+   }
+}
@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include "WindField.h"
+#include <cmath>
+#include <vector>
+
+using namespace Aftr;
+namespace
+{
+   TEST( WindField, turbulence_is_deterministic_and_tileable )
+   {
+      TurbulenceParams p;
+      p.seed = 42;
+      p.log2Size = 4;
+      p.cellSize = 2.0f;
+
+      TurbulenceVolume a, b;
+      a.generate( p );
+      b.generate( p );
+
+      const float period = p.cellSize * ( 1 << p.log2Size );
+      for( int i = 0; i < 50; ++i )
+      {
+         Vector pos{ i * 1.37f, i * -2.11f, i * 0.53f };
+         EXPECT_TRUE( a.sample( pos ) == b.sample( pos ) );
+
+         Vector wrapped = pos + Vector{ period, -period, 2 * period };
+         Vector d = a.sample( pos ) - a.sample( wrapped );
+         EXPECT_LT( d.length(), 1e-4f );
+      }
+
+      p.seed = 43;
+      TurbulenceVolume c;
+      c.generate( p );
+      EXPECT_FALSE( a.sample( Vector{ 1, 2, 3 } ) == c.sample( Vector{ 1, 2, 3 } ) );
+   }
+
+   TEST( WindField, batch_matches_single_samples )
+   {
+      WindModel wind;
+      wind.getMeanField().setUniform( Vector{ 3, 0, 0 } );
+      wind.getTurbulence().generate( TurbulenceParams{} );
+
+      std::vector<Vector> pos, out( 16 );
+      for( int i = 0; i < 16; ++i )
+         pos.push_back( Vector{ i * 10.0f, 5.0f, 20.0f } );
+
+      wind.sampleBatch( pos.data(), pos.size(), 12.5f, out.data() );
+      for( size_t i = 0; i < pos.size(); ++i )
+         EXPECT_TRUE( out[i] == wind.sample( pos[i], 12.5f ) );
+   }
+}
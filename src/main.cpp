@@ -6,7 +6,9 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <chrono>
 #include "GLViewNewModule.h" //GLView subclass instantiated to drive this simulation
+#include "AudioService.h" //Sound device and bank, kept open across restarts
 
 /**
    This creates a GLView subclass instance and begins the GLView's main loop.
@@ -14,19 +16,29 @@
    request causes the entire GLView to be destroyed (since its exits scope) and
    begin again (simStatus == -1). This loop exits when a request to exit the 
    application is received (simStatus == 0 ).
+
+   The sound device and bank live in Aftr::AudioService for the whole process, so a restart
+   only rebuilds the world; each start's time is printed with the audio share of it.
 */
 int main( int argc, char* argv[] )
 {
    std::vector< std::string > args{ argv, argv + argc }; ///< Command line arguments passed via argc and argv, reserved to size of argc
    int simStatus = 0;
+   int starts = 0;
 
    do
    {
+      auto start = std::chrono::steady_clock::now();
       std::unique_ptr< Aftr::GLViewNewModule > glView( Aftr::GLViewNewModule::New( args ) );
+      const std::chrono::duration< double, std::milli > ms = std::chrono::steady_clock::now() - start;
+      std::cout << ( starts++ == 0 ? "Cold start: " : "Restart: " ) << ms.count() << " ms, of which audio "
+                << Aftr::AudioService::get().getLastAcquireMs() << " ms" << std::endl;
       simStatus = glView->startWorldSimulationLoop(); // Runs until simulation exits or requests a restart (values 0 or -1, respectively)
    }
    while( simStatus != 0 );
 
+   Aftr::AudioService::get().shutdown();
+
    std::cout << "Exited AftrBurner Engine Normally..." << std::endl;
    return 0;
 }
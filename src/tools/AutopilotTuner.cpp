@@ -0,0 +1,387 @@
+//**********************************************************************************
+// Headless autopilot gain-tuning sweep.
+//
+// Runs the module's FlightModel + Autopilot in fast time (no GLView, no window) over a
+// set of step-response scenarios and searches PID gains by grid search or a separable
+// CMA-ES. Candidates are evaluated in parallel across all cores. Each candidate is scored
+// on overshoot, settling time and control effort; the best gains are printed in a form
+// that can be pasted into AutopilotGains.
+//
+// Usage:
+//    AutopilotTuner [--loop altitude|heading] [--search grid|cmaes] [--grid N]
+//                   [--generations N] [--lambda N] [--threads N] [--seed N] [--csv file]
+//**********************************************************************************
+
+#include "Autopilot.h"
+#include "FlightModel.h"
+#include "WindField.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Aftr;
+
+namespace
+{
+    constexpr int NumGains = 6; // outer kp, ki, kd then inner kp, ki, kd
+
+    enum class Loop { ALTITUDE, HEADING };
+
+    struct Scenario
+    {
+        const char* name;
+        FlightState initial;
+        AutopilotTargets targets;
+        uint32_t modes;
+        float durationSec;
+        const WindModel* wind;
+    };
+
+    struct Score
+    {
+        float overshoot = 0.0f;   // Fraction of the commanded step
+        float settlingSec = 0.0f; // Last time the response was outside a 5% band
+        float effort = 0.0f;      // Integral of squared stick and thrust rate
+        float cost = 0.0f;
+    };
+
+    struct Candidate
+    {
+        float gains[NumGains];
+        Score score;
+    };
+
+    // Search ranges for each gain, sampled in log10 space since useful PID gains span decades.
+    struct Range { float lo, hi; };
+    const Range altitudeRanges[NumGains] = { { 0.01f, 0.3f }, { 0.0005f, 0.05f }, { 0.01f, 0.5f }, { 1.0f, 12.0f }, { 0.05f, 2.0f }, { 0.02f, 1.0f } };
+    const Range headingRanges[NumGains] = { { 0.2f, 4.0f }, { 0.001f, 0.2f }, { 0.05f, 1.5f }, { 1.0f, 10.0f }, { 0.02f, 1.5f }, { 0.01f, 0.8f } };
+
+    AutopilotGains toGains(Loop loop, const float* g)
+    {
+        AutopilotGains gains;
+        PidGains& outer = loop == Loop::ALTITUDE ? gains.altitude : gains.heading;
+        PidGains& inner = loop == Loop::ALTITUDE ? gains.pitch : gains.roll;
+        outer.kp = g[0]; outer.ki = g[1]; outer.kd = g[2];
+        inner.kp = g[3]; inner.ki = g[4]; inner.kd = g[5];
+        return gains;
+    }
+
+    Score runScenario(Loop loop, const AutopilotGains& gains, const Scenario& sc)
+    {
+        const float dt = FlightModel::FixedStepSec;
+        FlightModel model;
+        Autopilot ap(gains);
+        AutopilotState state;
+        state.modes = sc.modes;
+        state.engaged = true;
+        FlightState f = sc.initial;
+
+        const float start = loop == Loop::ALTITUDE ? f.position.z : f.heading;
+        const float target = loop == Loop::ALTITUDE ? sc.targets.altitude : sc.targets.heading;
+        const float step = std::fabs(target - start);
+        const float band = std::max(step * 0.05f, 1e-3f);
+        const float dir = target >= start ? 1.0f : -1.0f;
+
+        Score s;
+        float prevThrust = 0.0f;
+        float t = 0.0f;
+        const int steps = static_cast<int>(sc.durationSec / dt);
+        for (int i = 0; i < steps; ++i, t += dt)
+        {
+            FlightControls c = ap.step(state, sc.targets, f, FlightControls{}, model.getParams(), dt);
+            Vector w = sc.wind ? sc.wind->sample(f.position, t) : Vector(0, 0, 0);
+            model.step(f, c, w, dt);
+
+            const float y = loop == Loop::ALTITUDE ? f.position.z : f.heading;
+            s.overshoot = std::max(s.overshoot, (y - target) * dir / std::max(step, 1e-3f));
+            if (std::fabs(y - target) > band)
+                s.settlingSec = t + dt;
+            s.effort += (c.roll * c.roll + c.pitch * c.pitch + (c.thrust - prevThrust) * (c.thrust - prevThrust) / dt) * dt;
+            prevThrust = c.thrust;
+            if (!std::isfinite(y))
+            {
+                s.settlingSec = sc.durationSec;
+                s.overshoot = 10.0f;
+                break;
+            }
+        }
+        return s;
+    }
+
+    Score evaluate(Loop loop, const float* g, const std::vector<Scenario>& scenarios)
+    {
+        AutopilotGains gains = toGains(loop, g);
+        Score total;
+        for (const Scenario& sc : scenarios)
+        {
+            Score s = runScenario(loop, gains, sc);
+            total.overshoot += s.overshoot;
+            total.settlingSec += s.settlingSec;
+            total.effort += s.effort;
+        }
+        const float n = static_cast<float>(scenarios.size());
+        total.overshoot /= n;
+        total.settlingSec /= n;
+        total.effort /= n;
+        total.cost = 20.0f * total.overshoot + total.settlingSec + 0.05f * total.effort;
+        return total;
+    }
+
+    // Scores every candidate in parallel. Work is handed out through an atomic cursor so the
+    // slow (unstable, never-settling) candidates don't leave cores idle.
+    void evaluateAll(Loop loop, std::vector<Candidate>& cands, const std::vector<Scenario>& scenarios, unsigned threads)
+    {
+        std::atomic<size_t> next{ 0 };
+        auto worker = [&]()
+        {
+            for (size_t i = next++; i < cands.size(); i = next++)
+                cands[i].score = evaluate(loop, cands[i].gains, scenarios);
+        };
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto& th : pool)
+            th.join();
+    }
+
+    float fromUnit(const Range& r, float u)
+    {
+        u = std::clamp(u, 0.0f, 1.0f);
+        return std::pow(10.0f, std::log10(r.lo) + u * (std::log10(r.hi) - std::log10(r.lo)));
+    }
+
+    Candidate gridSearch(Loop loop, const Range* ranges, int perAxis, const std::vector<Scenario>& scenarios, unsigned threads, std::vector<Candidate>& all)
+    {
+        size_t total = 1;
+        for (int d = 0; d < NumGains; ++d)
+            total *= perAxis;
+
+        all.resize(total);
+        for (size_t i = 0; i < total; ++i)
+        {
+            size_t idx = i;
+            for (int d = 0; d < NumGains; ++d)
+            {
+                float u = perAxis > 1 ? static_cast<float>(idx % perAxis) / (perAxis - 1) : 0.5f;
+                all[i].gains[d] = fromUnit(ranges[d], u);
+                idx /= perAxis;
+            }
+        }
+        evaluateAll(loop, all, scenarios, threads);
+        return *std::min_element(all.begin(), all.end(), [](const Candidate& a, const Candidate& b) { return a.score.cost < b.score.cost; });
+    }
+
+    // Separable CMA-ES (diagonal covariance) over the unit cube that maps onto the log-scaled ranges.
+    Candidate cmaes(Loop loop, const Range* ranges, int generations, int lambda, uint64_t seed, const std::vector<Scenario>& scenarios, unsigned threads, std::vector<Candidate>& all)
+    {
+        const int n = NumGains;
+        const int mu = lambda / 2;
+        std::vector<double> w(mu);
+        double wsum = 0.0, w2sum = 0.0;
+        for (int i = 0; i < mu; ++i)
+        {
+            w[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+            wsum += w[i];
+        }
+        for (auto& x : w)
+        {
+            x /= wsum;
+            w2sum += x * x;
+        }
+        const double mueff = 1.0 / w2sum;
+        const double cs = (mueff + 2.0) / (n + mueff + 5.0);
+        const double ds = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff - 1.0) / (n + 1.0)) - 1.0) + cs;
+        const double cc = 4.0 / (n + 4.0);
+        const double c1 = 2.0 / ((n + 1.3) * (n + 1.3) + mueff) * (n + 2.0) / 3.0;
+        const double cmu = std::min(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) / ((n + 2.0) * (n + 2.0) + mueff) * (n + 2.0) / 3.0);
+        const double chiN = std::sqrt(static_cast<double>(n)) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+        std::vector<double> mean(n, 0.5), diagC(n, 1.0), ps(n, 0.0), pc(n, 0.0);
+        double sigma = 0.3;
+        std::mt19937_64 rng(seed);
+        std::normal_distribution<double> normal;
+
+        std::vector<Candidate> pop(lambda);
+        std::vector<std::vector<double>> z(lambda, std::vector<double>(n)), y(lambda, std::vector<double>(n));
+        std::vector<int> order(lambda);
+        Candidate best;
+        best.score.cost = 1e30f;
+
+        for (int gen = 0; gen < generations; ++gen)
+        {
+            for (int k = 0; k < lambda; ++k)
+                for (int d = 0; d < n; ++d)
+                {
+                    z[k][d] = normal(rng);
+                    y[k][d] = std::sqrt(diagC[d]) * z[k][d];
+                    pop[k].gains[d] = fromUnit(ranges[d], static_cast<float>(mean[d] + sigma * y[k][d]));
+                }
+            evaluateAll(loop, pop, scenarios, threads);
+            all.insert(all.end(), pop.begin(), pop.end());
+
+            for (int k = 0; k < lambda; ++k)
+                order[k] = k;
+            std::sort(order.begin(), order.end(), [&](int a, int b) { return pop[a].score.cost < pop[b].score.cost; });
+            if (pop[order[0]].score.cost < best.score.cost)
+                best = pop[order[0]];
+
+            std::vector<double> yw(n, 0.0), zw(n, 0.0);
+            for (int i = 0; i < mu; ++i)
+                for (int d = 0; d < n; ++d)
+                {
+                    yw[d] += w[i] * y[order[i]][d];
+                    zw[d] += w[i] * z[order[i]][d];
+                }
+
+            double psNorm = 0.0;
+            for (int d = 0; d < n; ++d)
+            {
+                mean[d] = std::clamp(mean[d] + sigma * yw[d], 0.0, 1.0);
+                ps[d] = (1.0 - cs) * ps[d] + std::sqrt(cs * (2.0 - cs) * mueff) * zw[d];
+                psNorm += ps[d] * ps[d];
+            }
+            psNorm = std::sqrt(psNorm);
+            const bool hsig = psNorm / std::sqrt(1.0 - std::pow(1.0 - cs, 2.0 * (gen + 1))) < (1.4 + 2.0 / (n + 1.0)) * chiN;
+
+            for (int d = 0; d < n; ++d)
+            {
+                pc[d] = (1.0 - cc) * pc[d] + (hsig ? std::sqrt(cc * (2.0 - cc) * mueff) : 0.0) * yw[d];
+                double rankMu = 0.0;
+                for (int i = 0; i < mu; ++i)
+                    rankMu += w[i] * y[order[i]][d] * y[order[i]][d];
+                diagC[d] = (1.0 - c1 - cmu) * diagC[d] + c1 * (pc[d] * pc[d] + (hsig ? 0.0 : cc * (2.0 - cc) * diagC[d])) + cmu * rankMu;
+            }
+            // The search space is the unit cube, so a step size beyond it only produces clamped samples
+            sigma = std::min(sigma * std::exp((cs / ds) * (psNorm / chiN - 1.0)), 0.5);
+
+            printf("gen %3d  best cost %.4f  sigma %.4f\n", gen, best.score.cost, sigma);
+        }
+        return best;
+    }
+
+    std::vector<Scenario> makeScenarios(Loop loop, const WindModel& gusty)
+    {
+        std::vector<Scenario> s;
+        auto add = [&](const char* name, float from, float to, float speed, const WindModel* wind)
+        {
+            Scenario sc{};
+            sc.name = name;
+            sc.initial.position = Vector(0, 0, loop == Loop::ALTITUDE ? from : 30.0f);
+            sc.initial.heading = loop == Loop::HEADING ? from : 0.0f;
+            sc.initial.airspeed = speed;
+            sc.targets.airspeed = speed;
+            sc.targets.altitude = loop == Loop::ALTITUDE ? to : 30.0f;
+            sc.targets.heading = loop == Loop::HEADING ? to : 0.0f;
+            sc.modes = apmSPEED_HOLD | (loop == Loop::ALTITUDE ? apmALTITUDE_HOLD : (apmHEADING_HOLD | apmALTITUDE_HOLD));
+            sc.durationSec = 40.0f;
+            sc.wind = wind;
+            s.push_back(sc);
+        };
+        if (loop == Loop::ALTITUDE)
+        {
+            add("climb 10->30", 10.0f, 30.0f, 4.0f, nullptr);
+            add("descend 40->25", 40.0f, 25.0f, 5.0f, nullptr);
+            add("small step slow", 20.0f, 24.0f, 2.5f, nullptr);
+            add("climb in turbulence", 10.0f, 30.0f, 4.0f, &gusty);
+        }
+        else
+        {
+            add("turn 0->90", 0.0f, 1.5708f, 4.0f, nullptr);
+            add("turn 45->-45", 0.785f, -0.785f, 5.0f, nullptr);
+            add("small turn slow", 0.0f, 0.3f, 2.5f, nullptr);
+            add("turn in turbulence", 0.0f, 1.5708f, 4.0f, &gusty);
+        }
+        return s;
+    }
+
+    void writeCsv(const std::string& path, const std::vector<Candidate>& all)
+    {
+        std::ofstream fout(path);
+        fout << "outer_kp,outer_ki,outer_kd,inner_kp,inner_ki,inner_kd,overshoot,settling_sec,effort,cost\n";
+        for (const Candidate& c : all)
+        {
+            for (float g : c.gains)
+                fout << g << ",";
+            fout << c.score.overshoot << "," << c.score.settlingSec << "," << c.score.effort << "," << c.score.cost << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Loop loop = Loop::ALTITUDE;
+    bool useGrid = false;
+    int perAxis = 4;
+    int generations = 40;
+    int lambda = 24;
+    uint64_t seed = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string csvPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : ""; };
+        if (a == "--loop")
+            loop = std::strcmp(next(), "heading") == 0 ? Loop::HEADING : Loop::ALTITUDE;
+        else if (a == "--search")
+            useGrid = std::strcmp(next(), "grid") == 0;
+        else if (a == "--grid")
+            perAxis = std::max(1, std::atoi(next()));
+        else if (a == "--generations")
+            generations = std::max(1, std::atoi(next()));
+        else if (a == "--lambda")
+            lambda = std::max(4, std::atoi(next()));
+        else if (a == "--threads")
+            threads = static_cast<unsigned>(std::max(1, std::atoi(next())));
+        else if (a == "--seed")
+            seed = std::strtoull(next(), nullptr, 10);
+        else if (a == "--csv")
+            csvPath = next();
+        else
+        {
+            printf("Unknown argument '%s'\n", a.c_str());
+            return 1;
+        }
+    }
+
+    WindModel gusty;
+    TurbulenceParams tp;
+    tp.seed = seed;
+    tp.sigma = Vector(0.8f, 0.8f, 0.4f);
+    gusty.getTurbulence().generate(tp);
+
+    std::vector<Scenario> scenarios = makeScenarios(loop, gusty);
+    const Range* ranges = loop == Loop::ALTITUDE ? altitudeRanges : headingRanges;
+
+    printf("Tuning %s loop: %zu scenarios, %s search, %u threads\n", loop == Loop::ALTITUDE ? "altitude/pitch" : "heading/roll",
+           scenarios.size(), useGrid ? "grid" : "CMA-ES", threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Candidate> all;
+    Candidate best = useGrid ? gridSearch(loop, ranges, perAxis, scenarios, threads, all)
+                             : cmaes(loop, ranges, generations, lambda, seed, scenarios, threads, all);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const char* outer = loop == Loop::ALTITUDE ? "altitude" : "heading";
+    const char* inner = loop == Loop::ALTITUDE ? "pitch" : "roll";
+    printf("\nEvaluated %zu candidates (%zu scenario runs) in %.2f s\n", all.size(), all.size() * scenarios.size(), elapsed.count());
+    printf("Best cost %.4f: overshoot %.1f%%, settling %.2f s, effort %.3f\n", best.score.cost, best.score.overshoot * 100.0f,
+           best.score.settlingSec, best.score.effort);
+    printf("    gains.%s.kp = %.5ff; gains.%s.ki = %.5ff; gains.%s.kd = %.5ff;\n", outer, best.gains[0], outer, best.gains[1], outer, best.gains[2]);
+    printf("    gains.%s.kp = %.5ff; gains.%s.ki = %.5ff; gains.%s.kd = %.5ff;\n", inner, best.gains[3], inner, best.gains[4], inner, best.gains[5]);
+
+    if (!csvPath.empty())
+        writeCsv(csvPath, all);
+    return 0;
+}
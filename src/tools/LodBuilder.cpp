@@ -0,0 +1,81 @@
+//**********************************************************************************
+// Offline level-of-detail builder for the traffic aircraft.
+//
+// Reads a VRML model, writes progressively coarser vertex-clustered copies of it and a
+// flat impostor card, all as VRML the engine loads like any other model:
+//
+//    <out>_lod1.wrl ... <out>_lodN.wrl, <out>_impostor.wrl
+//
+// Cell sizes are fractions of the model's bounding-box diagonal, doubling per level. The
+// module picks these files up from its mm/models/ directory and falls back to the full
+// mesh for any level that is missing.
+//
+// Usage:
+//    LodBuilder <in.wrl> <outPrefix> [--levels N] [--finest fraction]
+//    e.g. LodBuilder ../../../shared/mm/models/jet_wheels_down_PP.wrl ../mm/models/jet_wheels_down_PP
+//**********************************************************************************
+
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace Aftr;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        printf("Usage: LodBuilder <in.wrl> <outPrefix> [--levels N] [--finest fraction]\n");
+        return 1;
+    }
+
+    const std::string inPath = argv[1];
+    const std::string outPrefix = argv[2];
+    int levels = 2;
+    float finest = 1.0f / 48.0f;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : ""; };
+        if (a == "--levels")
+            levels = std::max(1, std::atoi(next()));
+        else if (a == "--finest")
+            finest = static_cast<float>(std::atof(next()));
+        else
+        {
+            printf("Unknown argument '%s'\n", a.c_str());
+            return 1;
+        }
+    }
+
+    IndexedMesh full;
+    if (!MeshSimplifier::readVrml(inPath, full))
+    {
+        printf("No IndexedFaceSet geometry read from %s\n", inPath.c_str());
+        return 1;
+    }
+
+    Vector lo, hi;
+    full.bounds(lo, hi);
+    const float diagonal = (hi - lo).length();
+    printf("%s: %zu vertices, %zu triangles, diagonal %.2f\n", inPath.c_str(), full.points.size(), full.triangleCount(), diagonal);
+
+    float cell = diagonal * finest;
+    for (int level = 1; level <= levels; ++level, cell *= 2.0f)
+    {
+        IndexedMesh lod = MeshSimplifier::clusterVertices(full, cell);
+        const std::string path = outPrefix + "_lod" + std::to_string(level) + ".wrl";
+        if (!MeshSimplifier::writeVrml(path, lod))
+            return 1;
+        printf("  lod%d  cell %.3f: %zu vertices, %zu triangles (%.1f%%) -> %s\n", level, cell, lod.points.size(), lod.triangleCount(),
+               100.0 * lod.triangleCount() / std::max<size_t>(1, full.triangleCount()), path.c_str());
+    }
+
+    const std::string impostorPath = outPrefix + "_impostor.wrl";
+    if (!MeshSimplifier::writeVrml(impostorPath, MeshSimplifier::makeImpostorCard(full)))
+        return 1;
+    printf("  impostor card -> %s\n", impostorPath.c_str());
+    return 0;
+}
@@ -0,0 +1,257 @@
+//**********************************************************************************
+// Compiles scenario files and batch-runs them headless.
+//
+// compile turns a text scenario (see Scenario.h) into the binary form loadMap maps without
+// parsing. run flies every given scenario in fast time with the module's FlightModel +
+// Autopilot -- no GLView, no window -- and scores it with the same ObjectiveTracker the
+// module uses. Scenarios without waypoints are routed around their obstacles to each
+// objective in turn by the RoutePlanner. Runs are spread across all cores.
+//
+// Usage:
+//    ScenarioTool compile <in.scn> <out.scnb>
+//    ScenarioTool run <scenario files or folders...> [--threads N] [--csv file]
+//    e.g. ScenarioTool run ../mm/scenarios --csv results.csv
+//**********************************************************************************
+
+#include "Autopilot.h"
+#include "FlightModel.h"
+#include "RoutePlanner.h"
+#include "Scenario.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Aftr;
+
+namespace
+{
+    constexpr float CruiseAirspeed = 4.0f;
+    constexpr float CollisionMargin = 1.0f; // Roughly the jet's half span
+
+    struct RunResult
+    {
+        std::string path;
+        std::string name;
+        bool loaded = false;
+        bool routed = true;
+        bool collided = false;
+        int completed = 0;
+        int objectives = 0;
+        float simSec = 0.0f;
+        double wallMs = 0.0;
+    };
+
+    double msSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // The scenario's own waypoints, or a planned route through each reach objective in order
+    bool buildRoute(const Scenario& sc, std::vector<Vector>& route)
+    {
+        route = sc.getRoute();
+        if (!route.empty())
+            return true;
+
+        const ScenarioFormat::Header& h = sc.getHeader();
+        RoutePlanner planner;
+        planner.init(Vector(h.plannerOrigin[0], h.plannerOrigin[1], h.plannerOrigin[2]), static_cast<int>(h.plannerCells[0]),
+                     static_cast<int>(h.plannerCells[1]), static_cast<int>(h.plannerCells[2]), h.plannerCellSize, h.plannerClearance);
+        for (uint32_t i = 0; i < sc.getObstacleCount(); ++i)
+        {
+            const ScenarioFormat::Obstacle& o = sc.getObstacle(i);
+            const Vector c(o.center[0], o.center[1], o.center[2]);
+            const Vector half(o.size * 0.5f, o.size * 0.5f, o.size * 0.5f);
+            planner.addObstacle(c - half, c + half);
+        }
+
+        Vector from = sc.getStart();
+        for (uint32_t i = 0; i < sc.getObjectiveCount(); ++i)
+        {
+            const ScenarioFormat::Objective& o = sc.getObjective(i);
+            if (o.kind != ScenarioFormat::okREACH)
+                continue;
+            const Vector to(o.position[0], o.position[1], o.position[2]);
+            std::vector<Vector> leg;
+            if (!planner.plan(from, to, leg))
+                return false;
+            route.insert(route.end(), leg.begin(), leg.end());
+            from = to;
+        }
+        return true;
+    }
+
+    RunResult runScenario(const std::string& path)
+    {
+        auto start = std::chrono::steady_clock::now();
+        RunResult r;
+        r.path = path;
+
+        Scenario sc;
+        if (!sc.open(path))
+            return r;
+        r.loaded = true;
+        r.name = sc.getName();
+        r.objectives = static_cast<int>(sc.getObjectiveCount());
+
+        std::vector<Vector> route;
+        r.routed = buildRoute(sc, route);
+
+        const float dt = FlightModel::FixedStepSec;
+        FlightModel model;
+        Autopilot ap;
+        AutopilotState state;
+        state.engaged = true;
+        state.modes = apmWAYPOINT_NAV | apmSPEED_HOLD;
+        AutopilotTargets targets;
+        targets.airspeed = CruiseAirspeed;
+        targets.waypoints = route.data();
+        targets.waypointCount = route.size();
+
+        FlightState f;
+        f.position = sc.getStart();
+        f.heading = sc.getHeader().startHeading;
+        f.airspeed = sc.getHeader().startAirspeed;
+
+        ObjectiveTracker tracker;
+        tracker.reset(sc);
+        const int steps = static_cast<int>(sc.getHeader().durationSec / dt);
+        for (int i = 0; i < steps && !tracker.isFinished(); ++i)
+        {
+            FlightControls c = ap.step(state, targets, f, FlightControls{}, model.getParams(), dt);
+            model.step(f, c, Vector(0, 0, 0), dt);
+            r.simSec += dt;
+            tracker.update(sc, f, r.simSec, model.getParams().groundLevel);
+            if (tracker.hitsObstacle(sc, f.position, CollisionMargin))
+            {
+                r.collided = true;
+                break;
+            }
+        }
+        r.completed = tracker.getCompleted();
+        r.wallMs = msSince(start);
+        return r;
+    }
+
+    void addScenarioPaths(const std::string& arg, std::vector<std::string>& paths)
+    {
+        namespace fs = std::filesystem;
+        if (!fs::is_directory(arg))
+        {
+            paths.push_back(arg);
+            return;
+        }
+        std::vector<std::string> found;
+        for (const fs::directory_entry& e : fs::directory_iterator(arg))
+        {
+            const fs::path& p = e.path();
+            if (p.extension() == ".scnb")
+                found.push_back(p.string());
+            else if (p.extension() == ".scn" && !fs::exists(fs::path(p).replace_extension(".scnb")))
+                found.push_back(p.string()); // A compiled copy, when present, is run instead
+        }
+        std::sort(found.begin(), found.end());
+        paths.insert(paths.end(), found.begin(), found.end());
+    }
+
+    int compile(const std::string& in, const std::string& out)
+    {
+        ScenarioSource source;
+        if (!source.load(in))
+            return 1;
+        const std::string bytes = compileScenario(source);
+
+        // Written beside the target and renamed over it: a running module may have the old file
+        // mapped, and the rename leaves that mapping intact where truncating in place would not
+        const std::string temp = out + ".tmp";
+        {
+            std::ofstream fout(temp, std::ios::binary);
+            if (!fout.write(bytes.data(), static_cast<std::streamsize>(bytes.size())))
+            {
+                printf("Cannot write %s\n", temp.c_str());
+                return 1;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, out, ec);
+        if (ec)
+        {
+            printf("Cannot replace %s: %s\n", out.c_str(), ec.message().c_str());
+            return 1;
+        }
+        printf("Compiled %s: %zu objects, %zu obstacles, %zu objectives, %zu bytes\n", source.name.c_str(), source.objects.size(),
+               source.obstacles.size(), source.objectives.size(), bytes.size());
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "compile" && argc == 4)
+        return compile(argv[2], argv[3]);
+    if (mode != "run" || argc < 3)
+    {
+        printf("Usage: ScenarioTool compile <in.scn> <out.scnb>\n"
+               "       ScenarioTool run <scenario files or folders...> [--threads N] [--csv file]\n");
+        return 1;
+    }
+
+    std::vector<std::string> paths;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string csvPath;
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        if (a == "--threads" && i + 1 < argc)
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        else if (a == "--csv" && i + 1 < argc)
+            csvPath = argv[++i];
+        else
+            addScenarioPaths(a, paths);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<RunResult> results(paths.size());
+    std::atomic<size_t> next{ 0 };
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < std::min<size_t>(threads, paths.size()); ++t)
+    {
+        pool.emplace_back([&]()
+            {
+                for (size_t i; (i = next.fetch_add(1)) < paths.size();)
+                    results[i] = runScenario(paths[i]);
+            });
+    }
+    for (std::thread& t : pool)
+        t.join();
+    const double totalMs = msSince(start);
+
+    int passed = 0;
+    for (const RunResult& r : results)
+    {
+        const bool ok = r.loaded && r.routed && !r.collided && r.completed == r.objectives;
+        passed += ok ? 1 : 0;
+        printf("%-4s %-24s %d/%d objectives  %6.1f s sim  %7.2f ms%s%s%s\n", ok ? "PASS" : "FAIL", r.loaded ? r.name.c_str() : r.path.c_str(),
+               r.completed, r.objectives, r.simSec, r.wallMs, r.loaded ? "" : "  (failed to load)", r.routed ? "" : "  (no route)",
+               r.collided ? "  (collided)" : "");
+    }
+    printf("%d of %zu scenarios passed in %.1f ms on %u threads\n", passed, results.size(), totalMs, threads);
+
+    if (!csvPath.empty())
+    {
+        std::ofstream fout(csvPath);
+        fout << "path,name,loaded,routed,collided,completed,objectives,sim_sec,wall_ms\n";
+        for (const RunResult& r : results)
+            fout << r.path << ',' << r.name << ',' << r.loaded << ',' << r.routed << ',' << r.collided << ',' << r.completed << ','
+                 << r.objectives << ',' << r.simSec << ',' << r.wallMs << '\n';
+    }
+    return passed == static_cast<int>(results.size()) ? 0 : 1;
+}
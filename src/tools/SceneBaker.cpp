@@ -0,0 +1,139 @@
+//**********************************************************************************
+// Offline baker for the airfield's untextured models and static props.
+//
+// Compiles a scene description (see BakedScene.h) and the VRML models it names into one
+// binary blob the module memory-maps at startup and uploads without parsing anything.
+// --bench then times both startup paths for the same scene: parsing every VRML model
+// versus mapping and validating the blob. The first round is as cold as the OS cache
+// allows; later rounds are warm.
+//
+// --audio packs every sound in a folder into one page-aligned sounds.apak (see AudioPack.h),
+// which AudioBank maps and serves to irrKlang instead of opening each file.
+//
+// Usage:
+//    SceneBaker <scene file> <shared mm folder> <out.bscene> [--bench rounds]
+//    SceneBaker --audio <sounds folder> [out.apak]
+//    e.g. SceneBaker ../mm/scenes/airfield.scene ../../../shared/mm ../mm/scenes/airfield.bscene --bench 5
+//         SceneBaker --audio ../mm/sounds
+//**********************************************************************************
+
+#include "BakedScene.h"
+#include "AudioPack.h"
+#include "AudioBank.h"
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+using namespace Aftr;
+
+namespace
+{
+    double msSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double timeParse(const SceneDescription& scene, const std::string& mmRoot)
+    {
+        auto start = std::chrono::steady_clock::now();
+        IndexedMesh mesh;
+        for (const SceneDescription::Model& m : scene.models)
+            MeshSimplifier::readVrml(mmRoot + "/" + m.path, mesh);
+        return msSince(start);
+    }
+
+    double timeMapped(const std::string& path)
+    {
+        auto start = std::chrono::steady_clock::now();
+        BakedScene baked;
+        if (!baked.open(path))
+            return -1.0;
+
+        // Touch every page the upload would read, so both paths end with the data in memory
+        volatile float sink = 0.0f;
+        for (uint32_t i = 0; i < baked.getMeshCount(); ++i)
+        {
+            const float* v = baked.getVertices(i);
+            for (uint32_t k = 0; k < baked.getMesh(i).vertexCount * 6; k += 1024)
+                sink = sink + v[k];
+        }
+        return msSince(start);
+    }
+
+    int bakeAudio(const std::string& folder, const std::string& outPath)
+    {
+        std::vector<std::string> files;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(folder, ec))
+        {
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (entry.is_regular_file() && (ext == ".wav" || ext == ".ogg" || ext == ".mp3" || ext == ".flac" || ext == ".synth"))
+                files.push_back(entry.path().filename().string());
+        }
+        if (ec || files.empty())
+        {
+            printf("No sounds found in %s\n", folder.c_str());
+            return 1;
+        }
+        std::sort(files.begin(), files.end());
+
+        auto start = std::chrono::steady_clock::now();
+        if (!bakeAudioPack(folder, files, outPath))
+            return 1;
+        AudioPack pack;
+        if (!pack.open(outPath))
+            return 1;
+        printf("Packed %zu sounds into %s in %.1f ms\n", files.size(), outPath.c_str(), msSince(start));
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 3 && std::string(argv[1]) == "--audio")
+        return bakeAudio(argv[2], argc >= 4 ? argv[3] : std::string(argv[2]) + "/" + AudioBank::PackName);
+    if (argc < 4)
+    {
+        printf("Usage: SceneBaker <scene file> <shared mm folder> <out.bscene> [--bench rounds]\n"
+               "       SceneBaker --audio <sounds folder> [out.apak]\n");
+        return 1;
+    }
+
+    const std::string scenePath = argv[1];
+    const std::string mmRoot = argv[2];
+    const std::string outPath = argv[3];
+    int benchRounds = 0;
+    for (int i = 4; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        if (a == "--bench" && i + 1 < argc)
+            benchRounds = std::max(1, std::atoi(argv[++i]));
+        else
+        {
+            printf("Unknown argument '%s'\n", a.c_str());
+            return 1;
+        }
+    }
+
+    SceneDescription scene;
+    if (!scene.load(scenePath))
+        return 1;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!bakeScene(scene, mmRoot, outPath))
+        return 1;
+    printf("Baked %zu models, %zu placements into %s in %.1f ms\n", scene.models.size(), scene.placements.size(), outPath.c_str(), msSince(start));
+
+    for (int round = 0; round < benchRounds; ++round)
+    {
+        const double mapped = timeMapped(outPath);
+        const double parsed = timeParse(scene, mmRoot);
+        printf("  %s round %d: parse VRML %.2f ms, map baked %.3f ms\n", round == 0 ? "cold" : "warm", round, parsed, mapped);
+    }
+    return 0;
+}
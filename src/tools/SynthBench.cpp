@@ -0,0 +1,98 @@
+//**********************************************************************************
+// Per-block cost of the procedural engine sound (see EngineSynth.h).
+//
+// Renders the same sweep of spool and thrust through the SSE and the scalar partial
+// paths, one EngineSynth::BlockFrames block at a time as irrKlang's mixer would ask for
+// it, and reports the mean and worst time per block against the block's real-time
+// length. A block that costs more than its length would starve the mixer.
+//
+// Usage:
+//    SynthBench [seconds of audio, default 60] [preset.synth]
+//    e.g. SynthBench 120 ../mm/sounds/engine.synth
+//**********************************************************************************
+
+#include "EngineSynth.h"
+#include "ConfigRegistry.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace Aftr;
+
+namespace
+{
+    struct Result
+    {
+        double meanNs = 0.0;
+        double worstNs = 0.0;
+        float checksum = 0.0f; // Keeps the work from being optimized away
+    };
+
+    Result run(const EngineSynthPreset& preset, bool simd, int blocks)
+    {
+        EngineSynthControls controls;
+        EngineSynth synth(preset, &controls);
+        synth.setUseSimd(simd);
+        float out[EngineSynth::BlockFrames];
+        Result r;
+        double total = 0.0;
+        for (int b = 0; b < blocks; ++b)
+        {
+            const float t = static_cast<float>(b % 2000) / 2000.0f; // Sweep the throttle every 2000 blocks
+            controls.set(EngineSynthInput{ t, t < 0.5f ? 0.3f : 1.0f });
+            auto start = std::chrono::steady_clock::now();
+            synth.renderBlock(out);
+            const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            total += ns;
+            r.worstNs = std::max(r.worstNs, ns);
+            r.checksum += out[b % EngineSynth::BlockFrames];
+        }
+        r.meanNs = total / blocks;
+        return r;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const double seconds = argc > 1 ? std::max(1.0, std::atof(argv[1])) : 60.0;
+    EngineSynthPreset preset;
+    if (argc > 2)
+    {
+        std::ifstream in(argv[2]);
+        if (!in)
+        {
+            printf("Cannot read %s\n", argv[2]);
+            return 1;
+        }
+        const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        ConfigRegistry registry;
+        EngineSynthPreset::registerWith(registry, preset);
+        const auto values = ConfigRegistry::parseConf(text);
+        registry.resolve([&values](const std::string& key)
+            {
+                auto it = values.find(key);
+                return it != values.end() ? it->second : std::string();
+            });
+    }
+
+    const int blocks = static_cast<int>(seconds * preset.sampleRate / EngineSynth::BlockFrames);
+    const double blockNs = 1e9 * EngineSynth::BlockFrames / preset.sampleRate;
+    printf("%d blocks of %d frames at %d Hz (%.0f us of audio each)\n", blocks, EngineSynth::BlockFrames, preset.sampleRate, blockNs / 1000.0);
+
+    std::vector<bool> paths = { false };
+    if (EngineSynth::hasSimd())
+        paths.insert(paths.begin(), true);
+    for (bool simd : paths)
+    {
+        run(preset, simd, std::min(blocks, 2000)); // Warm up
+        const Result r = run(preset, simd, blocks);
+        printf("  %-6s mean %7.0f ns/block (%.2f%% of real time), worst %7.0f ns  [%g]\n", simd ? "SSE" : "scalar", r.meanNs,
+               100.0 * r.meanNs / blockNs, r.worstNs, r.checksum);
+    }
+    return 0;
+}